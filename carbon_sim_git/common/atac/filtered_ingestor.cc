@@ -4,10 +4,21 @@
 #include "tile.h"
 #include "capi.h"
 #include "packet_type.h"
+#include "log.h"
 //#include "packet_data.h"
 
 //#include "message.h"
 
+static void FilteredIngestorNetworkCallback(void* obj, NetPacket packet) {
+  FilteredIngestor *ingestor = (FilteredIngestor *) obj;
+  assert(ingestor != NULL);
+
+  // the network releases its reference to the payload after the callback:
+  // the filter keeps one (shared with the other receivers of the broadcast)
+  packet.getPayload()->addRef();
+
+  ingestor->receive_packet(packet);
+}
 
 FilteredIngestor::FilteredIngestor(Tile* m_tile_arg) {  
   // accept all messages by default for VCs that you are subscribed to
@@ -15,23 +26,95 @@ FilteredIngestor::FilteredIngestor(Tile* m_tile_arg) {
   filter_match_operation = FilterOperations::ALL;
   filter_match_signature = 0;
   
-  // initially don't subscribe to any VCs
-  for(int i=0; i<MAX_VIRTUAL_CHANNELS; i++) {
-    virtual_channel_memberships[i] = false;
-  }
-  out_to_processor = new queue<Message *>();
-	
+  // initially don't subscribe to any VCs (receive all of them)
+
+  the_network = NULL;
   m_tile = m_tile_arg;
+
+  enabled = false;
+  filtered_pkt_type = USER_1;
+
+  total_packets_passed = 0;
+  total_packets_dropped = 0;
 }
 
 FilteredIngestor::~FilteredIngestor() {
+  if(enabled) {
+    the_network->unregisterCallback(filtered_pkt_type);
+  }
+  for(std::vector<NetPacket>::iterator it = filtered_packets.begin(); it != filtered_packets.end(); it++) {
+    (*it).releasePayload();
+  }
+}
+
+void FilteredIngestor::enable(PacketType pkt_type) {
+  if(enabled) {
+    LOG_ASSERT_ERROR(pkt_type == filtered_pkt_type, "Filter enabled for packet type(%i), not(%i)", filtered_pkt_type, pkt_type);
+    return;
+  }
+  // the packets that arrived before the filter was enabled are filtered
+  // first: the callback waits on the lock to append the later ones
+  filter_lock.acquire();
+  enabled = true;
+  filtered_pkt_type = pkt_type;
+  the_network->registerCallback(pkt_type, FilteredIngestorNetworkCallback, this);
+
+  while(true) {
+    NetPacket packet = read_from_network(pkt_type);
+    if(!packet.found) {
+      break;
+    }
+    // netRecv() hands out a private copy: hold it in a payload like the
+    // packets of the callback
+    const Byte *data = (const Byte *) packet.data;
+    packet.data = NetPacketPayload::create(data, packet.length)->getData();
+    packet.shared_payload = true;
+    delete [] data;
+    filter_packet(packet);
+  }
+  filter_lock.release();
+}
+
+void FilteredIngestor::receive_packet(NetPacket packet) {
+  filter_lock.acquire();
+  filter_packet(packet);
+  filter_lock.release();
+}
+
+void FilteredIngestor::filter_packet(NetPacket packet) {
+  Message *msg = (Message *) packet.data;
+  if(passes_filter(packet) && subscribed_to_channel(msg)) {
+    filtered_packets.push_back(packet);
+    total_packets_passed++;
+  } else {
+    // discard this message and don't pass to processor (and free its slot in the lambda queue)
+    m_tile->getCore()->getLambdaQueueFlowControl()->releaseCredit(packet);
+    packet.releasePayload();
+    total_packets_dropped++;
+  }
+}
+
+void FilteredIngestor::outputSummary(std::ostream &os) {
+  os << "Receive Filter Summary:\n";
+  os << "    Total Packets Passed: " << total_packets_passed << std::endl;
+  os << "    Total Packets Dropped: " << total_packets_dropped << std::endl;
+}
+
+void FilteredIngestor::pop_filtered_packets(std::vector<NetPacket>& packets) {
+  filter_lock.acquire();
+  packets.swap(filtered_packets);
+  filtered_packets.clear();
+  filter_lock.release();
 }
 
 int FilteredIngestor::set_filter(unsigned int filter_mask_arg, unsigned int filter_match_operation_arg, unsigned int filter_match_signature_arg) {
+  filter_lock.acquire();
   filter_mask = filter_mask_arg;
   filter_match_operation = filter_match_operation_arg;
   filter_match_signature = filter_match_signature_arg;
-  cout << "Filter is set! mask: " << filter_mask << " op: " << filter_match_operation << " sig: " << filter_match_signature << endl;
+  filter_lock.release();
+  enable(filtered_pkt_type);
+  LOG_PRINT("Filter is set: mask(%u), op(%u), sig(%u)", filter_mask, filter_match_operation, filter_match_signature);
   return 1;
 }
 
@@ -93,23 +176,44 @@ bool FilteredIngestor::passes_filter(NetPacket packet) {
  * 
  */
 bool FilteredIngestor::subscribed_to_channel(Message *curr_message) {
-  return virtual_channel_memberships[curr_message->get_vc_id()];
+  if(virtual_channel_memberships.empty()) { return true; }
+  return (virtual_channel_memberships.count(curr_message->get_vc_id()) > 0);
 }
 
 // note: naming of this function and above function (subscribed_to_channel) intentionally
 // inconsistent because otherwise the function names are off by one character and that it 
 // too error-prone.f
 void FilteredIngestor::subscribe_to_virtual_channel(int vc_id) {
-  virtual_channel_memberships[vc_id] = true;
+  assert(vc_id >= 0 && vc_id < MAX_VIRTUAL_CHANNELS);
+  filter_lock.acquire();
+  virtual_channel_memberships.insert(vc_id);
+  filter_lock.release();
+  enable(filtered_pkt_type);
 }
 
 void FilteredIngestor::unsubscribe_from_virtual_channel(int vc_id) {
-  virtual_channel_memberships[vc_id] = false;
+  filter_lock.acquire();
+  virtual_channel_memberships.erase(vc_id);
+  filter_lock.release();
 }
 
 
 NetPacket FilteredIngestor::receive_filtered(PacketType pkt_type) { 
   NetPacket packet;
+  // the packets were filtered when they arrived
+  if(enabled && (pkt_type == filtered_pkt_type)) {
+    filter_lock.acquire();
+    bool found = !filtered_packets.empty();
+    if(found) {
+      packet = filtered_packets.front();
+      filtered_packets.erase(filtered_packets.begin());
+      packet.found = true;
+    }
+    filter_lock.release();
+    if(found) {
+      return packet;
+    }
+  }
   //const int max_trial = 10;
   //for(int i = 0; i < max_trial; ++i){
   while(true){
@@ -128,33 +232,3 @@ NetPacket FilteredIngestor::receive_filtered(PacketType pkt_type) {
   }
   return packet;
 }
-
-NetPacket FilteredIngestor::receive_filtered_from(core_id_t src, PacketType pkt_type) { 
-  NetPacket packet;
-  //const int max_trial = 10;
-  //for(int i = 0; i < max_trial; ++i){
-  while(true){
-    packet = the_network->netRecvNonBlock(src, pkt_type);
-    //PacketData *pdata = (PacketData *)packet.data;
-    if(!packet.found){
-      //cout << "[Empty buffer] " << pdata->payload << ", " << pdata->signature << endl;
-      break;
-    } if(passes_filter(packet)) {
-      break;
-    } else {
-      // discard this message and don't pass to processor
-      cout << "BOMBING OUT" ;
-      cout << " = packet: from {"<< packet.sender.tile_id << ", " << packet.sender.core_type << "}, to {" << packet.receiver.tile_id << ", "<< packet.receiver.core_type << "}, type " << (SInt32)packet.type << ", len "<< packet.length <<endl;
-    }
-  }
-  return packet;
-}
-
-
-
-
-
-
-
-
-
@@ -1,10 +1,14 @@
 #ifndef FILTERED_INGESTOR_H
 #define FILTERED_INGESTOR_H
 
+#include <vector>
+#include <set>
+
 #include "network.h"
 #include "tile.h"
 #include "capi.h"
 #include "packet_type.h"
+#include "lock.h"
 
 #include "message.h"
 #include "common.h"
@@ -25,36 +29,68 @@ namespace FilterOperations {
   enum e { ALL, NONE, AND, OR, XOR }; 
 };
 
+/*
+ * Receive filter of the ONet, as in hardware: once enabled, the packets of the
+ * virtual channel network are filtered in the receive path of the Network (a
+ * network callback) as they arrive at the tile. The packets that do not pass
+ * the filter, or are on a virtual channel the tile is not subscribed to, are
+ * dropped there; the others wait in arrival order for pop_filtered_packets().
+ * A tile that has not subscribed to any virtual channel receives all of them.
+ */
 class FilteredIngestor {
   
   unsigned int filter_mask;
   unsigned int filter_match_operation;
   unsigned int filter_match_signature;
 
-  bool virtual_channel_memberships[MAX_VIRTUAL_CHANNELS];
-	
-  queue<Message*> *out_to_processor;
+  // sparse: only the virtual channels subscribed to
+  std::set<int> virtual_channel_memberships;
+
   Network *the_network;
   
   Tile *m_tile;
 
-  
+  // packet type of the virtual channel network, once the filter is enabled
+  bool enabled;
+  PacketType filtered_pkt_type;
+
+  // protects the filter and the packets that passed it (the network thread
+  // filters, the core pops)
+  Lock filter_lock;
+  std::vector<NetPacket> filtered_packets;
+
+  // Event Counters
+  UInt64 total_packets_passed;
+  UInt64 total_packets_dropped;
+
   NetPacket read_from_network(PacketType pkt_type);
+  bool passes_filter(NetPacket packet);
+  // Called with filter_lock held
+  void filter_packet(NetPacket packet);
   
 public: 
   FilteredIngestor(Tile* m_tile_arg);
   ~FilteredIngestor();
   void set_network(Network *network);
-  bool passes_filter(NetPacket packet);
   NetPacket receive_filtered(PacketType pkt_type);
-  NetPacket receive_filtered_from(core_id_t src, PacketType pkt_type);
+
+  // Start filtering the packets of 'pkt_type' on arrival (packets already
+  // waiting in the network are filtered now)
+  void enable(PacketType pkt_type);
+  // Takes a reference to the payload of the packet
+  void receive_packet(NetPacket packet);
+  // Packets that passed the filter since the last call, in arrival order
+  // (the caller releases their payloads)
+  void pop_filtered_packets(std::vector<NetPacket>& packets);
   
   int set_filter(unsigned int filter_mask, unsigned int filter_match_operation, unsigned int filter_match_signature);
   void subscribe_to_virtual_channel(int vc_id);
 	void unsubscribe_from_virtual_channel(int vc_id);
 	bool subscribed_to_channel(Message *curr_message);
+
+  void outputSummary(std::ostream &os);
 };
   
 
 // TODO: set up operation enums
-#endif 
\ No newline at end of file
+#endif 
@@ -0,0 +1,153 @@
+#include <algorithm>
+using std::max;
+
+#include "lambda_queue_flow_control.h"
+#include "core.h"
+#include "core_model.h"
+#include "network.h"
+#include "network_model.h"
+#include "simulator.h"
+#include "config.h"
+#include "log.h"
+
+static void LambdaQueueFlowControlNetworkCallback(void* obj, NetPacket packet)
+{
+   LambdaQueueFlowControl* flow_control = (LambdaQueueFlowControl*) obj;
+   assert(flow_control);
+
+   switch (packet.type)
+   {
+   case LAMBDA_QUEUE_CREDIT_TYPE:
+      flow_control->receiveCredit(packet);
+      break;
+
+   default:
+      LOG_PRINT_ERROR("Got unrecognized packet type(%u)", packet.type);
+      break;
+   }
+}
+
+LambdaQueueFlowControl::LambdaQueueFlowControl(Core* core)
+   : m_core(core)
+   , m_enabled(false)
+   , m_lambda_queue_length(0)
+   , m_num_broadcasts_sent(0)
+   , m_min_credits_returned(0)
+   , m_num_receivers_at_min(0)
+   , m_min_credit_time(0)
+   , m_prev_min_credits_returned(0)
+{
+   try
+   {
+      m_lambda_queue_length = (UInt64) Sim()->getCfg()->getInt("atac/design/lambda_queue_length", 100);
+   }
+   catch (...)
+   {
+      LOG_PRINT_ERROR("Could not read atac/design/lambda_queue_length from the cfg file");
+   }
+
+   // The broadcasts of an application tile are received by the other application tiles
+   SInt32 num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   m_enabled = (m_lambda_queue_length > 0) && (num_application_tiles > 1) &&
+               (m_core->getTileId() < (tile_id_t) num_application_tiles);
+   if (!m_enabled)
+      return;
+
+   m_credits_returned.resize(num_application_tiles, 0);
+   m_num_receivers_at_min = num_application_tiles - 1;
+
+   m_core->getNetwork()->registerCallback(LAMBDA_QUEUE_CREDIT_TYPE, LambdaQueueFlowControlNetworkCallback, this);
+}
+
+LambdaQueueFlowControl::~LambdaQueueFlowControl()
+{
+   if (m_enabled)
+      m_core->getNetwork()->unregisterCallback(LAMBDA_QUEUE_CREDIT_TYPE);
+}
+
+bool
+LambdaQueueFlowControl::acquireBroadcastCredits(PacketType packet_type)
+{
+   if (!m_enabled)
+      return true;
+   // The receivers only see (and return credits for) real broadcasts
+   if (!m_core->getNetwork()->getNetworkModelFromPacketType(packet_type)->hasBroadcastCapability())
+      return true;
+
+   UInt64 stall_cycles = 0;
+
+   m_lock.acquire();
+   if (!hasBroadcastCredits())
+   {
+      LOG_PRINT("Tile(%i): no lambda queue credits, broadcasts(%llu), min credits returned(%llu)",
+                m_core->getTileId(), m_num_broadcasts_sent, m_min_credits_returned);
+      m_lock.release();
+      return false;
+   }
+
+   // The slot was freed by the credit that last raised the minimum: stall
+   // until it arrived
+   if (m_num_broadcasts_sent >= m_prev_min_credits_returned + m_lambda_queue_length)
+   {
+      UInt64 cycle_count = m_core->getPerformanceModel()->getCycleCount();
+      if (m_min_credit_time > cycle_count)
+         stall_cycles = m_min_credit_time - cycle_count;
+   }
+   m_num_broadcasts_sent ++;
+   m_lock.release();
+
+   if (stall_cycles > 0)
+      m_core->getPerformanceModel()->queueDynamicInstruction(new FlowControlInstruction(stall_cycles));
+   return true;
+}
+
+void
+LambdaQueueFlowControl::releaseCredit(const NetPacket& packet)
+{
+   if (!m_enabled)
+      return;
+   if ((packet.type != USER_1) && (packet.type != USER_2))
+      return;
+   if ((packet.receiver.tile_id != NetPacket::BROADCAST) || (packet.sender.tile_id == m_core->getTileId()))
+      return;
+
+   m_core->getNetwork()->netSend(packet.sender, LAMBDA_QUEUE_CREDIT_TYPE, NULL, 0);
+}
+
+void
+LambdaQueueFlowControl::receiveCredit(const NetPacket& credit)
+{
+   tile_id_t receiver = credit.sender.tile_id;
+   LOG_ASSERT_ERROR((0 <= receiver) && (receiver < (tile_id_t) m_credits_returned.size()) && (receiver != m_core->getTileId()),
+                    "Tile(%i): credit from tile(%i)", m_core->getTileId(), receiver);
+
+   m_lock.acquire();
+
+   UInt64 credits_returned = m_credits_returned[receiver] ++;
+   if (credits_returned == m_min_credits_returned)
+   {
+      m_num_receivers_at_min --;
+      if (m_num_receivers_at_min == 0)
+      {
+         // All the receivers returned the credit of the oldest broadcast. This
+         // happens once every (number of receivers) credits
+         m_prev_min_credits_returned = m_min_credits_returned;
+         m_min_credits_returned = UINT64_MAX_;
+         for (tile_id_t tile_id = 0; tile_id < (tile_id_t) m_credits_returned.size(); tile_id++)
+         {
+            if (tile_id == m_core->getTileId())
+               continue;
+            if (m_credits_returned[tile_id] < m_min_credits_returned)
+            {
+               m_min_credits_returned = m_credits_returned[tile_id];
+               m_num_receivers_at_min = 0;
+            }
+            if (m_credits_returned[tile_id] == m_min_credits_returned)
+               m_num_receivers_at_min ++;
+         }
+         m_min_credit_time = max<UInt64>(m_min_credit_time, credit.time);
+      }
+   }
+
+   m_lock.release();
+}
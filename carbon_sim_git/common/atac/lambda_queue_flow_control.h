@@ -0,0 +1,73 @@
+#ifndef LAMBDA_QUEUE_FLOW_CONTROL_H
+#define LAMBDA_QUEUE_FLOW_CONTROL_H
+
+#include <vector>
+using std::vector;
+
+#include "fixed_types.h"
+#include "lock.h"
+#include "packet_type.h"
+
+class Core;
+class NetPacket;
+
+// Credit-based flow control of the ATAC lambda queues: the optical receive
+// queue of each tile has 'atac/design/lambda_queue_length' slots for the
+// broadcasts of each sender.
+//   A sender holds one credit per slot of each receiver. A broadcast takes a
+// credit from every receiver. While any receiver has no free slot the
+// broadcast fails (CAPI_message_send_w returns -1) and the application
+// retries it: the sender is not blocked in the host, so it keeps receiving
+// (and returning the credits of) the broadcasts of the others, and the thread
+// manager and the clock skew minimization schemes still see it running. A
+// broadcast that takes a slot freed by a credit from the future stalls the
+// core model until the arrival of that credit. A receiver returns the
+// credit to the sender over the network (LAMBDA_QUEUE_CREDIT_TYPE packets)
+// when the broadcast leaves its lambda queue: received by the core, moved to
+// the virtual channel buffers or dropped by the receive filter.
+//   The credits are counted in the sender tile, so the model works for any
+// number of tiles and across processes. Only the minimum of the credits
+// returned by the receivers is needed: it is updated in O(1) amortized time
+// per credit, and a broadcast is O(1).
+//   The broadcasts reach the application tiles, so flow control requires a
+// user network with broadcast capability (ATAC); a lambda_queue_length of 0
+// disables it.
+class LambdaQueueFlowControl
+{
+public:
+   LambdaQueueFlowControl(Core* core);
+   ~LambdaQueueFlowControl();
+
+   // Sender: take a slot in the lambda queue of every receiver, false if
+   // one of them is full (the broadcast must not be sent)
+   bool acquireBroadcastCredits(PacketType packet_type);
+   // Receiver: the packet left the lambda queue
+   void releaseCredit(const NetPacket& packet);
+   // Sender: a receiver returned a credit
+   void receiveCredit(const NetPacket& credit);
+
+   bool isEnabled() { return m_enabled; }
+
+private:
+   Core* m_core;
+   bool m_enabled;
+   UInt64 m_lambda_queue_length;
+
+   // Protects the credits (returned by the network thread)
+   Lock m_lock;
+
+   UInt64 m_num_broadcasts_sent;
+   // Credits returned by each receiver, their minimum, and the number of
+   // receivers at the minimum
+   vector<UInt64> m_credits_returned;
+   UInt64 m_min_credits_returned;
+   SInt32 m_num_receivers_at_min;
+   // Time of the credit that last raised the minimum, and the minimum before
+   UInt64 m_min_credit_time;
+   UInt64 m_prev_min_credits_returned;
+
+   bool hasBroadcastCredits()
+   { return (m_num_broadcasts_sent < m_min_credits_returned + m_lambda_queue_length); }
+};
+
+#endif // LAMBDA_QUEUE_FLOW_CONTROL_H
@@ -2,12 +2,15 @@
 #include "message.h"
 
 MessageBuffer::MessageBuffer() {  
-  for(int i=0; i<MAX_VIRTUAL_CHANNELS; i++) {
-    message_queues[i] = new queue<NetPacket>();
-  }
 }
 
 MessageBuffer::~MessageBuffer() {
+  for(map<int, queue<NetPacket> >::iterator it = message_queues.begin(); it != message_queues.end(); it++) {
+    while(!it->second.empty()) {
+      it->second.front().releasePayload();
+      it->second.pop();
+    }
+  }
 }
 
 bool MessageBuffer::enqueue_message(NetPacket packet_to_enqueue) {
@@ -15,16 +18,17 @@ bool MessageBuffer::enqueue_message(NetPacket packet_to_enqueue) {
   int vc_id = message_to_enqueue->get_vc_id();
   assert(vc_id >= 0);
   assert(vc_id < MAX_VIRTUAL_CHANNELS);
-  message_queues[vc_id]->push(packet_to_enqueue);
+  message_queues[vc_id].push(packet_to_enqueue);
   return true;
 }
 
 NetPacket MessageBuffer::dequeue_filtered_message(int virtual_channel_id) {
-  if(message_queues[virtual_channel_id]->size() > 0) {
-    NetPacket message_to_return = message_queues[virtual_channel_id]->front();
-    message_queues[virtual_channel_id]->pop();
+  map<int, queue<NetPacket> >::iterator it = message_queues.find(virtual_channel_id);
+  if((it != message_queues.end()) && (it->second.size() > 0)) {
+    NetPacket message_to_return = it->second.front();
+    it->second.pop();
     return message_to_return;
   } else {
     return NetPacket();
   }
-}
\ No newline at end of file
+}
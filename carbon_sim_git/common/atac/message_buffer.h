@@ -6,8 +6,11 @@
 //#include "message.h"
 #include "network.h"
 
+// Messages of the virtual channels, waiting for the core to dequeue them. The
+// queues are sparse: a queue is only created for a virtual channel that
+// receives a message.
 class MessageBuffer {
-  queue<NetPacket> *message_queues[MAX_VIRTUAL_CHANNELS];
+  map<int, queue<NetPacket> > message_queues;
 
 public: 
   MessageBuffer();
@@ -16,4 +19,4 @@ public:
   NetPacket dequeue_filtered_message(int virtual_channel_id);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,147 @@
+#include <string.h>
+#include <errno.h>
+#include <cassert>
+
+#include "checkpoint.h"
+#include "log.h"
+
+// Large stdio buffers: the caches and the memory are written in big chunks
+#define CHECKPOINT_BUFFER_SIZE      (1 << 20)
+
+// CheckpointWriter
+
+CheckpointWriter::CheckpointWriter(std::string file_name)
+   : m_file_name(file_name)
+   , m_offset(0)
+{
+   m_file = fopen(file_name.c_str(), "wb");
+   LOG_ASSERT_ERROR(m_file, "Could not open checkpoint file(%s) for writing: %s", file_name.c_str(), strerror(errno));
+   setvbuf(m_file, NULL, _IOFBF, CHECKPOINT_BUFFER_SIZE);
+
+   put<UInt64>((UInt64) MAGIC);
+   put<UInt32>((UInt32) VERSION);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+   LOG_ASSERT_ERROR(m_section_stack.empty(), "Checkpoint file(%s): %u sections not ended",
+                    m_file_name.c_str(), (UInt32) m_section_stack.size());
+   __attribute__((unused)) int ret = fclose(m_file);
+   LOG_ASSERT_ERROR(ret == 0, "Could not write checkpoint file(%s): %s", m_file_name.c_str(), strerror(errno));
+}
+
+void
+CheckpointWriter::beginSection(std::string name)
+{
+   put(name);
+   // Length of the section, written by endSection()
+   m_section_stack.push_back(m_offset);
+   put<UInt64>(0);
+}
+
+void
+CheckpointWriter::endSection()
+{
+   assert(!m_section_stack.empty());
+   off_t length_offset = m_section_stack.back();
+   m_section_stack.pop_back();
+
+   off_t end_offset = m_offset;
+   UInt64 length = end_offset - (length_offset + sizeof(UInt64));
+   fseeko(m_file, length_offset, SEEK_SET);
+   put<UInt64>(length);
+   fseeko(m_file, end_offset, SEEK_SET);
+   m_offset = end_offset;
+}
+
+void
+CheckpointWriter::put(const std::string& str)
+{
+   put<UInt32>((UInt32) str.size());
+   write(str.data(), str.size());
+}
+
+void
+CheckpointWriter::write(const void* data, UInt64 size)
+{
+   __attribute__((unused)) size_t written = fwrite(data, 1, size, m_file);
+   LOG_ASSERT_ERROR(written == size, "Could not write checkpoint file(%s): %s", m_file_name.c_str(), strerror(errno));
+   m_offset += size;
+}
+
+// CheckpointReader
+
+CheckpointReader::CheckpointReader(std::string file_name)
+   : m_file_name(file_name)
+   , m_offset(0)
+{
+   m_file = fopen(file_name.c_str(), "rb");
+   LOG_ASSERT_ERROR(m_file, "Could not open checkpoint file(%s) for reading: %s", file_name.c_str(), strerror(errno));
+   setvbuf(m_file, NULL, _IOFBF, CHECKPOINT_BUFFER_SIZE);
+
+   UInt64 magic = 0;
+   UInt32 version = 0;
+   get<UInt64>(magic);
+   LOG_ASSERT_ERROR(magic == CheckpointWriter::MAGIC, "File(%s) is not a checkpoint", file_name.c_str());
+   get<UInt32>(version);
+   LOG_ASSERT_ERROR(version == CheckpointWriter::VERSION, "Checkpoint file(%s) has version %u, expected %u",
+                    file_name.c_str(), version, CheckpointWriter::VERSION);
+}
+
+CheckpointReader::~CheckpointReader()
+{
+   fclose(m_file);
+}
+
+void
+CheckpointReader::beginSection(std::string name)
+{
+   std::string section_name;
+   get(section_name);
+   LOG_ASSERT_ERROR(section_name == name, "Checkpoint file(%s): expected section(%s), found(%s)",
+                    m_file_name.c_str(), name.c_str(), section_name.c_str());
+
+   UInt64 length = 0;
+   get<UInt64>(length);
+   m_section_stack.push_back(m_offset + length);
+}
+
+void
+CheckpointReader::endSection()
+{
+   assert(!m_section_stack.empty());
+   if (m_offset != m_section_stack.back())
+   {
+      m_offset = m_section_stack.back();
+      fseeko(m_file, m_offset, SEEK_SET);
+   }
+   m_section_stack.pop_back();
+}
+
+UInt64
+CheckpointReader::getSectionRemaining()
+{
+   assert(!m_section_stack.empty());
+   return m_section_stack.back() - m_offset;
+}
+
+void
+CheckpointReader::get(std::string& str)
+{
+   UInt32 size = 0;
+   get<UInt32>(size);
+   std::vector<char> chars(size);
+   if (size > 0)
+      read(&chars[0], size);
+   str.assign(chars.begin(), chars.end());
+}
+
+void
+CheckpointReader::read(void* data, UInt64 size)
+{
+   LOG_ASSERT_ERROR(m_section_stack.empty() || ((UInt64) (m_section_stack.back() - m_offset) >= size),
+                    "Checkpoint file(%s): read past the end of a section", m_file_name.c_str());
+   __attribute__((unused)) size_t num_read = fread(data, 1, size, m_file);
+   LOG_ASSERT_ERROR(num_read == size, "Checkpoint file(%s) is truncated", m_file_name.c_str());
+   m_offset += size;
+}
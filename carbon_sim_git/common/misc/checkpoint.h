@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "fixed_types.h"
+
+// Binary checkpoint of the state of the models (see Simulator::checkpointCurrentProcess()).
+//   A checkpoint file starts with a magic number and a version and holds a
+// tree of sections. A section is a name and a length followed by the state
+// of one object, so a reader can check that it is reading the object it
+// expects and skip the state it cannot use (e.g. the history of a queue
+// model of another type): endSection() always moves to the end of the
+// section, whatever was read of it.
+//   The values are written in the byte order of the host, so a checkpoint can
+// only be restored on the same kind of machine.
+class CheckpointWriter
+{
+public:
+   static const UInt64 MAGIC = 0x00544e494f504b43ULL;    // "CKPOINT"
+   static const UInt32 VERSION = 3;
+
+   CheckpointWriter(std::string file_name);
+   ~CheckpointWriter();
+
+   void beginSection(std::string name);
+   void endSection();
+
+   template<class T> void put(const T* data, UInt64 num);
+   template<class T> void put(const T& data) { put<T>(&data, 1); }
+   void put(const std::string& str);
+
+   // Wrappers, as for UnstructuredBuffer
+   template<class T>
+   CheckpointWriter& operator<<(const T& data)                        { put<T>(data); return *this; }
+   CheckpointWriter& operator<<(std::pair<const void*, UInt64> buffer)
+   { write(buffer.first, buffer.second); return *this; }
+
+private:
+   std::string m_file_name;
+   FILE* m_file;
+   // Kept here, as ftello() can cost a system call
+   off_t m_offset;
+   // Offsets of the lengths of the open sections
+   std::vector<off_t> m_section_stack;
+
+   void write(const void* data, UInt64 size);
+};
+
+class CheckpointReader
+{
+public:
+   CheckpointReader(std::string file_name);
+   ~CheckpointReader();
+
+   void beginSection(std::string name);
+   void endSection();
+   // Bytes left in the current section
+   UInt64 getSectionRemaining();
+
+   template<class T> void get(T* data, UInt64 num);
+   template<class T> void get(T& data) { get<T>(&data, 1); }
+   void get(std::string& str);
+
+   template<class T>
+   CheckpointReader& operator>>(T& data)                              { get<T>(data); return *this; }
+   CheckpointReader& operator>>(std::pair<void*, UInt64> buffer)
+   { read(buffer.first, buffer.second); return *this; }
+
+private:
+   std::string m_file_name;
+   FILE* m_file;
+   off_t m_offset;
+   // Offsets of the ends of the open sections
+   std::vector<off_t> m_section_stack;
+
+   void read(void* data, UInt64 size);
+};
+
+template<class T> void CheckpointWriter::put(const T* data, UInt64 num)
+{
+   write((const void*) data, num * sizeof(T));
+}
+
+template<class T> void CheckpointReader::get(T* data, UInt64 num)
+{
+   read((void*) data, num * sizeof(T));
+}
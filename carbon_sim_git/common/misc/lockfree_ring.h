@@ -0,0 +1,128 @@
+#ifndef LOCKFREE_RING_H
+#define LOCKFREE_RING_H
+
+#include "fixed_types.h"
+
+// Bounded lock-free queue (array of sequenced cells). Any number of
+// threads may push and pop concurrently; a push claims a cell with a
+// single CAS on the enqueue position and publishes it by bumping the
+// cell's sequence number, so neither side ever takes a lock.
+//   The capacity is rounded up to a power of two.
+
+template <class T>
+class LockFreeRing
+{
+public:
+   LockFreeRing(UInt32 capacity);
+   ~LockFreeRing();
+
+   // Return false if the ring is full / empty
+   bool push(const T& value);
+   bool pop(T& value);
+
+   bool empty() const { return (m_dequeue_pos == m_enqueue_pos); }
+   UInt32 capacity() const { return m_mask + 1; }
+
+private:
+   struct Cell
+   {
+      volatile UInt64 sequence;
+      T value;
+   };
+
+   // Keep producer and consumer positions on separate cache lines
+   Cell* m_buffer;
+   UInt64 m_mask;
+   char m_pad0[64];
+   volatile UInt64 m_enqueue_pos;
+   char m_pad1[64];
+   volatile UInt64 m_dequeue_pos;
+   char m_pad2[64];
+};
+
+template <class T>
+LockFreeRing<T>::LockFreeRing(UInt32 capacity)
+   : m_enqueue_pos(0)
+   , m_dequeue_pos(0)
+{
+   UInt64 size = 2;
+   while (size < capacity)
+      size <<= 1;
+
+   m_buffer = new Cell[size];
+   m_mask = size - 1;
+   for (UInt64 i = 0; i < size; i++)
+      m_buffer[i].sequence = i;
+}
+
+template <class T>
+LockFreeRing<T>::~LockFreeRing()
+{
+   delete [] m_buffer;
+}
+
+template <class T>
+bool LockFreeRing<T>::push(const T& value)
+{
+   Cell* cell;
+   UInt64 pos = m_enqueue_pos;
+   while (true)
+   {
+      cell = &m_buffer[pos & m_mask];
+      SInt64 diff = (SInt64) cell->sequence - (SInt64) pos;
+      if (diff == 0)
+      {
+         if (__sync_bool_compare_and_swap(&m_enqueue_pos, pos, pos + 1))
+            break;
+         pos = m_enqueue_pos;
+      }
+      else if (diff < 0)
+      {
+         // Full
+         return false;
+      }
+      else
+      {
+         pos = m_enqueue_pos;
+      }
+   }
+
+   cell->value = value;
+   __sync_synchronize();
+   cell->sequence = pos + 1;
+   return true;
+}
+
+template <class T>
+bool LockFreeRing<T>::pop(T& value)
+{
+   Cell* cell;
+   UInt64 pos = m_dequeue_pos;
+   while (true)
+   {
+      cell = &m_buffer[pos & m_mask];
+      SInt64 diff = (SInt64) cell->sequence - (SInt64) (pos + 1);
+      if (diff == 0)
+      {
+         if (__sync_bool_compare_and_swap(&m_dequeue_pos, pos, pos + 1))
+            break;
+         pos = m_dequeue_pos;
+      }
+      else if (diff < 0)
+      {
+         // Empty
+         return false;
+      }
+      else
+      {
+         pos = m_dequeue_pos;
+      }
+   }
+
+   value = cell->value;
+   __sync_synchronize();
+   cell->sequence = pos + m_mask + 1;
+   return true;
+}
+
+#endif // LOCKFREE_RING_H
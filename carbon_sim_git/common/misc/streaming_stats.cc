@@ -0,0 +1,136 @@
+#include <cmath>
+#include <cstring>
+
+#include "streaming_stats.h"
+#include "log.h"
+
+HyperLogLog::HyperLogLog(UInt32 log_num_registers)
+   : m_log_num_registers(log_num_registers)
+{
+   LOG_ASSERT_ERROR(log_num_registers >= 4 && log_num_registers <= 16,
+                    "Number of HyperLogLog registers(2^%u) out of range", log_num_registers);
+   m_registers = new UInt8[getNumRegisters()];
+   memset(m_registers, 0, getNumRegisters());
+}
+
+HyperLogLog::HyperLogLog(const HyperLogLog& hll)
+   : m_log_num_registers(hll.m_log_num_registers)
+{
+   m_registers = new UInt8[getNumRegisters()];
+   memcpy(m_registers, hll.m_registers, getNumRegisters());
+}
+
+HyperLogLog::~HyperLogLog()
+{
+   delete [] m_registers;
+}
+
+HyperLogLog&
+HyperLogLog::operator=(const HyperLogLog& hll)
+{
+   if (this != &hll)
+   {
+      delete [] m_registers;
+      m_log_num_registers = hll.m_log_num_registers;
+      m_registers = new UInt8[getNumRegisters()];
+      memcpy(m_registers, hll.m_registers, getNumRegisters());
+   }
+   return *this;
+}
+
+UInt64
+HyperLogLog::estimate() const
+{
+   UInt32 num_registers = getNumRegisters();
+
+   double sum = 0;
+   UInt32 num_zero_registers = 0;
+   for (UInt32 i = 0; i < num_registers; i++)
+   {
+      sum += ldexp(1.0, -m_registers[i]);
+      if (m_registers[i] == 0)
+         num_zero_registers ++;
+   }
+
+   double alpha;
+   switch (num_registers)
+   {
+   case 16:
+      alpha = 0.673;
+      break;
+   case 32:
+      alpha = 0.697;
+      break;
+   case 64:
+      alpha = 0.709;
+      break;
+   default:
+      alpha = 0.7213 / (1 + 1.079 / num_registers);
+      break;
+   }
+
+   double estimate = alpha * num_registers * num_registers / sum;
+   // Small range correction: linear counting
+   if ((estimate <= 2.5 * num_registers) && (num_zero_registers > 0))
+      estimate = num_registers * log(((double) num_registers) / num_zero_registers);
+
+   return (UInt64) (estimate + 0.5);
+}
+
+CountMinSketch::CountMinSketch(UInt32 width, UInt32 depth)
+   : m_depth(depth)
+   , m_total(0)
+{
+   LOG_ASSERT_ERROR(width > 0 && depth > 0, "Count-Min Sketch needs width(%u) and depth(%u) > 0", width, depth);
+   m_width = 1;
+   while (m_width < width)
+      m_width <<= 1;
+   m_counters = new UInt64[m_width * m_depth];
+   memset(m_counters, 0, m_width * m_depth * sizeof(UInt64));
+}
+
+CountMinSketch::~CountMinSketch()
+{
+   delete [] m_counters;
+}
+
+UInt64
+CountMinSketch::insert(UInt64 key)
+{
+   // Conservative update: only raise the counters that are below the new
+   // estimate, which keeps the other keys hashed to them from being inflated
+   UInt64 estimate = this->estimate(key) + 1;
+   UInt64 hash = streamingStatsHash(key);
+   for (UInt32 row = 0; row < m_depth; row++)
+   {
+      UInt64& count = m_counters[getIndex(hash, row)];
+      if (count < estimate)
+         count = estimate;
+   }
+   m_total ++;
+   return estimate;
+}
+
+UInt64
+CountMinSketch::estimate(UInt64 key) const
+{
+   UInt64 hash = streamingStatsHash(key);
+   UInt64 estimate = ~((UInt64) 0);
+   for (UInt32 row = 0; row < m_depth; row++)
+   {
+      UInt64 count = m_counters[getIndex(hash, row)];
+      if (count < estimate)
+         estimate = count;
+   }
+   return estimate;
+}
+
+// RunningStatistics
+
+double
+RunningStatistics::getConfidenceInterval(double z) const
+{
+   if (m_count < 2)
+      return 0.0;
+   return z * sqrt(getVariance() / m_count);
+}
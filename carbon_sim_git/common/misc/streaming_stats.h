@@ -0,0 +1,117 @@
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+#include "fixed_types.h"
+
+// Fixed-size summaries of a stream of keys (e.g. addresses), updated in
+// O(1) and estimated on demand, for statistics that would otherwise need a
+// map holding every key ever seen.
+
+// Hash used by the sketches (64-bit finalizer of MurmurHash3)
+inline UInt64 streamingStatsHash(UInt64 key)
+{
+   key ^= key >> 33;
+   key *= 0xff51afd7ed558ccdULL;
+   key ^= key >> 33;
+   key *= 0xc4ceb9fe1a85ec53ULL;
+   key ^= key >> 33;
+   return key;
+}
+
+// Number of distinct keys.
+//   2^log_num_registers registers of one byte; the relative standard error
+// is about 1.04 / sqrt(2^log_num_registers). Small counts (up to a few
+// times the number of registers) are estimated by linear counting and are
+// much more accurate.
+class HyperLogLog
+{
+   public:
+      HyperLogLog(UInt32 log_num_registers = 5);
+      HyperLogLog(const HyperLogLog& hll);
+      ~HyperLogLog();
+
+      HyperLogLog& operator=(const HyperLogLog& hll);
+
+      void insert(UInt64 key)
+      {
+         UInt64 hash = streamingStatsHash(key);
+         UInt32 index = hash >> (64 - m_log_num_registers);
+         // Position of the first 1 in the remaining bits
+         UInt64 remaining = hash << m_log_num_registers;
+         UInt8 rank = (remaining == 0) ? (65 - m_log_num_registers) : (__builtin_clzll(remaining) + 1);
+         if (rank > m_registers[index])
+            m_registers[index] = rank;
+      }
+
+      UInt64 estimate() const;
+      UInt32 getNumRegisters() const { return 1 << m_log_num_registers; }
+
+   private:
+      UInt32 m_log_num_registers;
+      UInt8* m_registers;
+};
+
+// Number of times each key was seen, never underestimated.
+//   'depth' rows of 'width' (rounded up to a power of 2) counters; the
+// estimate of a key exceeds its count by more than 2.7 * total / width with a
+// probability of at most e^-depth.
+class CountMinSketch
+{
+   public:
+      CountMinSketch(UInt32 width = 1024, UInt32 depth = 4);
+      ~CountMinSketch();
+
+      // Count one more occurrence of 'key' and return its new estimate
+      UInt64 insert(UInt64 key);
+      UInt64 estimate(UInt64 key) const;
+
+      UInt64 getTotal() const { return m_total; }
+
+   private:
+      UInt32 m_width;
+      UInt32 m_depth;
+      UInt64* m_counters;
+      UInt64 m_total;
+
+      // Counter of 'key' in row 'row' (double hashing: h1 + row * h2)
+      UInt32 getIndex(UInt64 hash, UInt32 row) const
+      {
+         UInt32 h1 = (UInt32) hash;
+         UInt32 h2 = (UInt32) (hash >> 32) | 1;
+         return row * m_width + ((h1 + row * h2) & (m_width - 1));
+      }
+
+      // Not copyable
+      CountMinSketch(const CountMinSketch&);
+      CountMinSketch& operator=(const CountMinSketch&);
+};
+
+// Mean of a stream of samples and the confidence interval of the mean, with
+// the variance updated incrementally (Welford's algorithm).
+class RunningStatistics
+{
+   public:
+      RunningStatistics() : m_count(0), m_mean(0.0), m_sum_of_squares(0.0) {}
+
+      void insert(double sample)
+      {
+         m_count ++;
+         double delta = sample - m_mean;
+         m_mean += delta / m_count;
+         m_sum_of_squares += delta * (sample - m_mean);
+      }
+
+      UInt64 getCount() const    { return m_count; }
+      double getMean() const     { return m_mean; }
+      double getVariance() const { return (m_count > 1) ? (m_sum_of_squares / (m_count - 1)) : 0.0; }
+      // Half-width of the confidence interval of the mean, for the normal
+      // quantile 'z' (1.96 for 95%)
+      double getConfidenceInterval(double z = 1.96) const;
+
+   private:
+      UInt64 m_count;
+      double m_mean;
+      double m_sum_of_squares;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <cstring>
 #include <cassert>
+#include <sys/time.h>
 #include "utils.h"
 
 string myDecStr(UInt64 v, UInt32 w)
@@ -202,3 +203,10 @@ double computeCoefficientOfVariation(double mean, double stddev)
 {
    return stddev / mean;
 }
+
+UInt64 getTimeInUs()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return ((UInt64) tv.tv_sec) * 1000000 + tv.tv_usec;
+}
@@ -148,4 +148,7 @@ double computeMean(const vector<UInt64>& vec);
 double computeStddev(const vector<UInt64>& vec);
 double computeCoefficientOfVariation(double mean, double stddev);
 
+// Wall-clock time of the host (in microseconds)
+UInt64 getTimeInUs();
+
 #endif
@@ -26,6 +26,8 @@ public:
    void processPacket(const NetPacket& pkt, vector<SInt32>& output_port_list,
                       UInt64& zero_load_delay, UInt64& contention_delay);
    
+   UInt64 getDelay()                                        { return _delay; }
+
    // Event Counters
    UInt64 getTotalBufferWrites()                            { return _total_buffer_writes; }
    UInt64 getTotalBufferReads()                             { return _total_buffer_reads; }
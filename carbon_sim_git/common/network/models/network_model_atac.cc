@@ -32,6 +32,8 @@ SInt32 NetworkModelAtac::_sub_cluster_width;
 SInt32 NetworkModelAtac::_sub_cluster_height;
 // Cluster Boundaries and Access Points
 vector<NetworkModelAtac::ClusterInfo> NetworkModelAtac::_cluster_info_list;
+// Routing Tables
+vector<NetworkModelAtac::TileInfo> NetworkModelAtac::_tile_info_list;
 // Type of Receive Network
 NetworkModelAtac::ReceiveNetType NetworkModelAtac::_receive_net_type;
 // Num Receive Nets
@@ -66,6 +68,9 @@ NetworkModelAtac::NetworkModelAtac(Network *net, SInt32 network_id):
 
    // Initialize ENet, ONet and BNet parameters
    createANetRouterAndLinkModels();
+
+   // Build the ENet Routing Tables
+   initializeENetRoutingTables();
 }
 
 NetworkModelAtac::~NetworkModelAtac()
@@ -156,6 +161,69 @@ NetworkModelAtac::initializeANetTopologyParams()
    _enet_height = _enet_width;
    
    initializeClusters();
+
+   initializeTileInfoList();
+}
+
+void
+NetworkModelAtac::initializeTileInfoList()
+{
+   SInt32 num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   _tile_info_list.resize(num_application_tiles);
+
+   for (tile_id_t tile_id = 0; tile_id < num_application_tiles; tile_id++)
+   {
+      TileInfo& tile_info = _tile_info_list[tile_id];
+      computePositionOnENet(tile_id, tile_info._x, tile_info._y);
+      tile_info._cluster_id = getClusterID(tile_id);
+      tile_info._nearest_access_point = getNearestAccessPoint(tile_id);
+      tile_info._receive_net_id = computeReceiveNetID(tile_id);
+   }
+
+   for (SInt32 cluster_id = 0; cluster_id < _num_clusters; cluster_id++)
+   {
+      ClusterInfo& cluster_info = _cluster_info_list[cluster_id];
+      cluster_info._optical_hub = getTileIDWithOpticalHub(cluster_id);
+      getTileIDListInCluster(cluster_id, cluster_info._tile_id_list);
+      for (SInt32 idx = 0; idx < (SInt32) cluster_info._tile_id_list.size(); idx++)
+         _tile_info_list[cluster_info._tile_id_list[idx]]._index_in_cluster = idx;
+   }
+}
+
+void
+NetworkModelAtac::initializeENetRoutingTables()
+{
+   if (isSystemTile(_tile_id))
+      return;
+
+   SInt32 num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   SInt32 cx = _tile_info_list[_tile_id]._x;
+   SInt32 cy = _tile_info_list[_tile_id]._y;
+
+   _enet_next_dest_table.resize(_num_enet_router_ports);
+   _enet_next_dest_table[SELF] = NextDest(_tile_id, SELF, RECEIVE_TILE);
+   _enet_next_dest_table[LEFT] = NextDest(computeTileIDOnENet(cx-1,cy), LEFT, EMESH);
+   _enet_next_dest_table[RIGHT] = NextDest(computeTileIDOnENet(cx+1,cy), RIGHT, EMESH);
+   _enet_next_dest_table[DOWN] = NextDest(computeTileIDOnENet(cx,cy-1), DOWN, EMESH);
+   _enet_next_dest_table[UP] = NextDest(computeTileIDOnENet(cx,cy+1), UP, EMESH);
+
+   _enet_output_port_table.resize(num_application_tiles);
+   for (tile_id_t receiver = 0; receiver < num_application_tiles; receiver++)
+   {
+      SInt32 dx = _tile_info_list[receiver]._x;
+      SInt32 dy = _tile_info_list[receiver]._y;
+
+      if (cx > dx)
+         _enet_output_port_table[receiver] = LEFT;
+      else if (cx < dx)
+         _enet_output_port_table[receiver] = RIGHT;
+      else if (cy > dy)
+         _enet_output_port_table[receiver] = DOWN;
+      else if (cy < dy)
+         _enet_output_port_table[receiver] = UP;
+      else // (cx == dx) && (cy == dy)
+         _enet_output_port_table[receiver] = SELF;
+   }
 }
 
 void
@@ -390,27 +458,23 @@ NetworkModelAtac::routePacket(const NetPacket& pkt, queue<Hop>& next_hops)
    }
 }
 
+UInt64
+NetworkModelAtac::getLookahead()
+{
+   // A hop to another tile goes through the ENet router and a link, or
+   // through the send hub and the optical link to another cluster
+   UInt64 lookahead = _enet_router->getDelay() + _enet_link_list[0]->getDelay();
+   if (_tile_id == getTileIDWithOpticalHub(getClusterID(_tile_id)))
+      lookahead = min<UInt64>(lookahead, _send_hub_router->getDelay() + _optical_link->getDelay());
+   return lookahead;
+}
+
 void
 NetworkModelAtac::routePacketOnENet(const NetPacket& pkt, tile_id_t pkt_sender, tile_id_t pkt_receiver, queue<Hop>& next_hops)
 {
    LOG_ASSERT_ERROR(pkt_receiver != NetPacket::BROADCAST, "Cannot broadcast packets on ENet");
 
-   SInt32 cx, cy, dx, dy;
-   computePositionOnENet(_tile_id, cx, cy);
-   computePositionOnENet(pkt_receiver, dx, dy); 
-
-   NextDest next_dest;
-
-   if (cx > dx)
-      next_dest = NextDest(computeTileIDOnENet(cx-1,cy), LEFT, EMESH);
-   else if (cx < dx)
-      next_dest = NextDest(computeTileIDOnENet(cx+1,cy), RIGHT, EMESH);
-   else if (cy > dy)
-      next_dest = NextDest(computeTileIDOnENet(cx,cy-1), DOWN, EMESH);
-   else if (cy < dy)
-      next_dest = NextDest(computeTileIDOnENet(cx,cy+1), UP, EMESH);
-   else // (cx == dx) && (cy == dy)
-      next_dest = NextDest(_tile_id, SELF, RECEIVE_TILE);
+   const NextDest& next_dest = _enet_next_dest_table[_enet_output_port_table[pkt_receiver]];
 
    UInt64 zero_load_delay = 0;
    UInt64 contention_delay = 0;
@@ -430,8 +494,9 @@ NetworkModelAtac::routePacketOnONet(const NetPacket& pkt, tile_id_t pkt_sender,
 {
    if (pkt.node_type == EMESH)
    {
-      assert(getClusterID(pkt_sender) == getClusterID(_tile_id));
-      if (isAccessPoint(_tile_id))
+      const TileInfo& tile_info = _tile_info_list[_tile_id];
+      assert(_tile_info_list[pkt_sender]._cluster_id == tile_info._cluster_id);
+      if (tile_info._nearest_access_point == _tile_id)
       {
          UInt64 zero_load_delay = 0;
          UInt64 contention_delay = 0;
@@ -439,12 +504,12 @@ NetworkModelAtac::routePacketOnONet(const NetPacket& pkt, tile_id_t pkt_sender,
          _enet_router->processPacket(pkt, _num_enet_router_ports, zero_load_delay, contention_delay);
          _enet_link_list[_num_enet_router_ports]->processPacket(pkt, zero_load_delay);
 
-         Hop hop(pkt, getTileIDWithOpticalHub(getClusterID(_tile_id)), SEND_HUB, zero_load_delay, contention_delay);
+         Hop hop(pkt, _cluster_info_list[tile_info._cluster_id]._optical_hub, SEND_HUB, zero_load_delay, contention_delay);
          next_hops.push(hop);
       }
       else // (!isAccessPoint(_tile_id))
       {
-         tile_id_t access_point = getNearestAccessPoint(pkt_sender);
+         tile_id_t access_point = _tile_info_list[pkt_sender]._nearest_access_point;
          routePacketOnENet(pkt, pkt_sender, access_point, next_hops);
       }
    }
@@ -463,7 +528,7 @@ NetworkModelAtac::routePacketOnONet(const NetPacket& pkt, tile_id_t pkt_sender,
             
             for (SInt32 i = 0; i < _num_clusters; i++)
             {
-               Hop hop(pkt, getTileIDWithOpticalHub(i), RECEIVE_HUB, zero_load_delay, contention_delay);
+               Hop hop(pkt, _cluster_info_list[i]._optical_hub, RECEIVE_HUB, zero_load_delay, contention_delay);
                next_hops.push(hop);
             }
          }
@@ -478,7 +543,7 @@ NetworkModelAtac::routePacketOnONet(const NetPacket& pkt, tile_id_t pkt_sender,
                _optical_link->processPacket(pkt, 1 /* send to only 1 endpoint */, zero_load_delay);
               
                LOG_PRINT_WARNING("i(%i), contention delay(%llu)", i, contention_delay); 
-               Hop hop(pkt, getTileIDWithOpticalHub(i), RECEIVE_HUB, zero_load_delay, contention_delay);
+               Hop hop(pkt, _cluster_info_list[i]._optical_hub, RECEIVE_HUB, zero_load_delay, contention_delay);
                next_hops.push(hop);
             }
          }
@@ -495,19 +560,18 @@ NetworkModelAtac::routePacketOnONet(const NetPacket& pkt, tile_id_t pkt_sender,
          _send_hub_router->processPacket(pkt, 0, zero_load_delay, contention_delay);
          _optical_link->processPacket(pkt, 1 /* send to only 1 endpoint */, zero_load_delay);
 
-         Hop hop(pkt, getTileIDWithOpticalHub(getClusterID(pkt_receiver)), RECEIVE_HUB, zero_load_delay, contention_delay);
+         Hop hop(pkt, _cluster_info_list[_tile_info_list[pkt_receiver]._cluster_id]._optical_hub, RECEIVE_HUB, zero_load_delay, contention_delay);
          next_hops.push(hop);
       }
    }
 
    else if (pkt.node_type == RECEIVE_HUB)
    {
-      vector<tile_id_t> tile_id_list;
-      getTileIDListInCluster(getClusterID(_tile_id), tile_id_list);
+      vector<tile_id_t>& tile_id_list = _cluster_info_list[_tile_info_list[_tile_id]._cluster_id]._tile_id_list;
       assert(_cluster_size == (SInt32) tile_id_list.size());
 
       // get receive net id
-      SInt32 receive_net_id = computeReceiveNetID(pkt_sender);
+      SInt32 receive_net_id = _tile_info_list[pkt_sender]._receive_net_id;
 
       UInt64 zero_load_delay = 0;
       UInt64 contention_delay = 0;
@@ -538,7 +602,8 @@ NetworkModelAtac::routePacketOnONet(const NetPacket& pkt, tile_id_t pkt_sender,
          }
          else // (pkt_receiver != NetPacket::BROADCAST)
          {
-            SInt32 idx = getIndexInList(pkt_receiver, tile_id_list);
+            SInt32 idx = _tile_info_list[pkt_receiver]._index_in_cluster;
+            assert(tile_id_list[idx] == pkt_receiver);
             assert(idx >= 0 && idx < (SInt32) _cluster_size);
 
             _star_net_router_list[receive_net_id]->processPacket(pkt, idx, zero_load_delay, contention_delay);
@@ -766,19 +831,6 @@ NetworkModelAtac::getTileIDListInCluster(SInt32 cluster_id, vector<tile_id_t>& t
    }
 }
 
-SInt32
-NetworkModelAtac::getIndexInList(tile_id_t tile_id, vector<tile_id_t>& tile_id_list)
-{
-   SInt32 idx = 0;
-   for (vector<tile_id_t>::iterator it = tile_id_list.begin(); it != tile_id_list.end(); it++, idx++)
-   {
-      if (tile_id == *it)
-         return idx;
-   }
-   LOG_PRINT_ERROR("Could not find (%i)", tile_id);
-   return -1;
-}
-
 SInt32
 NetworkModelAtac::computeNumHopsOnENet(tile_id_t sender, tile_id_t receiver)
 {
@@ -822,11 +874,13 @@ NetworkModelAtac::computeGlobalRoute(tile_id_t sender, tile_id_t receiver)
    if (receiver == NetPacket::BROADCAST)
       return GLOBAL_ONET;
 
-   if (getClusterID(sender) == getClusterID(receiver))
+   const TileInfo& sender_info = _tile_info_list[sender];
+   const TileInfo& receiver_info = _tile_info_list[receiver];
+   if (sender_info._cluster_id == receiver_info._cluster_id)
    {
       return GLOBAL_ENET;
    }
-   else // (getClusterID(sender) != getClusterID(receiver))
+   else // (sender_info._cluster_id != receiver_info._cluster_id)
    {
       if (_global_routing_strategy == CLUSTER_BASED)
       {
@@ -834,7 +888,7 @@ NetworkModelAtac::computeGlobalRoute(tile_id_t sender, tile_id_t receiver)
       }
       else // (_global_routing_strategy == DISTANCE_BASED)
       {
-         SInt32 num_hops_on_enet = computeNumHopsOnENet(sender, receiver);
+         SInt32 num_hops_on_enet = abs(sender_info._x - receiver_info._x) + abs(sender_info._y - receiver_info._y);
          return (num_hops_on_enet <= _unicast_distance_threshold) ? GLOBAL_ENET : GLOBAL_ONET;
       }
    }
@@ -27,6 +27,10 @@ public:
 
    void outputSummary(std::ostream &out);
 
+   // Network Event Engine
+   bool supportsEventEngine() { return true; }
+   UInt64 getLookahead();
+
 private:
    enum NodeType
    {
@@ -101,9 +105,41 @@ private:
       };
       Boundary _boundary;
       vector<tile_id_t> _access_point_list;
+      // Tile with the optical hub
+      tile_id_t _optical_hub;
+      // Tiles in the cluster, in the order of the ports of the receive network
+      vector<tile_id_t> _tile_id_list;
    };
 
    static vector<ClusterInfo> _cluster_info_list;
+
+   // Routing Tables
+   // Built once from the topology, so that routing a hop is a lookup instead
+   // of a computation on the positions of the tiles on the ENet
+   class TileInfo
+   {
+   public:
+      TileInfo()
+         : _x(0), _y(0), _cluster_id(0), _nearest_access_point(INVALID_TILE_ID)
+         , _index_in_cluster(0), _receive_net_id(0) {}
+      ~TileInfo() {}
+
+      // Position on the ENet
+      SInt32 _x, _y;
+      SInt32 _cluster_id;
+      tile_id_t _nearest_access_point;
+      // Index in the tile list of the cluster
+      SInt32 _index_in_cluster;
+      // Receive network used by the packets sent by this tile
+      SInt32 _receive_net_id;
+   };
+
+   static vector<TileInfo> _tile_info_list;
+
+   // ENet: output port towards each receiver (X-Y routing), and next
+   // destination through each output port (for the router of this tile)
+   vector<UInt8> _enet_output_port_table;
+   vector<NextDest> _enet_next_dest_table;
    
    // Type of Receive Network
    static ReceiveNetType _receive_net_type;
@@ -148,6 +184,8 @@ private:
    void routePacketOnONet(const NetPacket& pkt, tile_id_t sender, tile_id_t receiver, queue<Hop>& next_hops);
 
    static void initializeANetTopologyParams();
+   static void initializeTileInfoList();
+   void initializeENetRoutingTables();
    void initializeLaserModes();
    void createANetRouterAndLinkModels();
    void destroyANetRouterAndLinkModels();
@@ -165,7 +203,6 @@ private:
    bool isAccessPoint(tile_id_t tile_id);
    static tile_id_t getTileIDWithOpticalHub(SInt32 cluster_id);
    static void getTileIDListInCluster(SInt32 cluster_id, vector<tile_id_t>& tile_id_list);
-   static SInt32 getIndexInList(tile_id_t tile_id, vector<tile_id_t>& tile_id_list);
     
    static SInt32 computeNumHopsOnENet(tile_id_t sender, tile_id_t receiver);
    static void computePositionOnENet(tile_id_t tile_id, SInt32& x, SInt32& y);
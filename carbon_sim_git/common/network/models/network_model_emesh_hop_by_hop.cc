@@ -37,6 +37,9 @@ NetworkModelEMeshHopByHop::NetworkModelEMeshHopByHop(Network* net, SInt32 networ
    // Create Router & Link Models
    _num_mesh_router_ports = 5;
    createRouterAndLinkModels();
+
+   // Build the Routing Tables
+   initializeRoutingTables();
 }
 
 NetworkModelEMeshHopByHop::~NetworkModelEMeshHopByHop()
@@ -141,6 +144,95 @@ NetworkModelEMeshHopByHop::destroyRouterAndLinkModels()
       delete _mesh_link_list[i];
 }
 
+void
+NetworkModelEMeshHopByHop::initializeRoutingTables()
+{
+   if (isSystemTile(_tile_id))
+      return;
+
+   SInt32 num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+
+   SInt32 cx, cy;
+   computePosition(_tile_id, cx, cy);
+
+   // Next destination through each output port
+   _next_dest_table.resize(_num_mesh_router_ports);
+   _next_dest_table[SELF] = NextDest(_tile_id, SELF, RECEIVE_TILE);
+   _next_dest_table[LEFT] = NextDest(computeTileID(cx-1,cy), LEFT, EMESH);
+   _next_dest_table[RIGHT] = NextDest(computeTileID(cx+1,cy), RIGHT, EMESH);
+   _next_dest_table[DOWN] = NextDest(computeTileID(cx,cy-1), DOWN, EMESH);
+   _next_dest_table[UP] = NextDest(computeTileID(cx,cy+1), UP, EMESH);
+
+   // Unicast: X-Y routing
+   _output_port_table.resize(num_application_tiles);
+   for (tile_id_t receiver = 0; receiver < num_application_tiles; receiver++)
+   {
+      SInt32 dx, dy;
+      computePosition(receiver, dx, dy);
+
+      if (cx > dx)
+         _output_port_table[receiver] = LEFT;
+      else if (cx < dx)
+         _output_port_table[receiver] = RIGHT;
+      else if (cy > dy)
+         _output_port_table[receiver] = DOWN;
+      else if (cy < dy)
+         _output_port_table[receiver] = UP;
+      else
+         _output_port_table[receiver] = SELF;
+   }
+
+   // Broadcast: a tree is identified by the set of output ports (other than
+   // SELF) it goes through. The next destinations are kept in the order of
+   // the tree: UP, DOWN, RIGHT, LEFT and then SELF
+   SInt32 tree_output_port_order[] = {UP, DOWN, RIGHT, LEFT, SELF};
+
+   _broadcast_tree_list.resize(1 << _num_mesh_router_ports);
+   for (SInt32 tree_id = 0; tree_id < (SInt32) _broadcast_tree_list.size(); tree_id++)
+   {
+      BroadcastTree& broadcast_tree = _broadcast_tree_list[tree_id];
+      for (SInt32 i = 0; i < _num_mesh_router_ports; i++)
+      {
+         SInt32 output_port = tree_output_port_order[i];
+         if ((output_port != SELF) && !(tree_id & (1 << output_port)))
+            continue;
+
+         const NextDest& next_dest = _next_dest_table[output_port];
+         if (next_dest._tile_id == INVALID_TILE_ID)
+            continue;
+         broadcast_tree._next_dest_list.push_back(next_dest);
+         broadcast_tree._output_port_list.push_back(output_port);
+      }
+   }
+
+   _broadcast_tree_id_table.resize(num_application_tiles);
+   for (tile_id_t sender = 0; sender < num_application_tiles; sender++)
+   {
+      SInt32 sx, sy;
+      computePosition(sender, sx, sy);
+      _broadcast_tree_id_table[sender] = computeBroadcastTreeID(sx, sy, cx, cy);
+   }
+}
+
+UInt8
+NetworkModelEMeshHopByHop::computeBroadcastTreeID(SInt32 sx, SInt32 sy, SInt32 cx, SInt32 cy)
+{
+   // A broadcast goes up and down the column of the sender, and then along the rows
+   UInt8 tree_id = 0;
+   if (cy >= sy)
+      tree_id |= (1 << UP);
+   if (cy <= sy)
+      tree_id |= (1 << DOWN);
+   if (cy == sy)
+   {
+      if (cx >= sx)
+         tree_id |= (1 << RIGHT);
+      if (cx <= sx)
+         tree_id |= (1 << LEFT);
+   }
+   return tree_id;
+}
+
 void
 NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, queue<Hop> &next_hops)
 {
@@ -161,49 +253,19 @@ NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, queue<Hop> &next_ho
    {
       if (pkt_receiver == NetPacket::BROADCAST)
       {
-         SInt32 sx, sy, cx, cy;
-         computePosition(pkt_sender, sx, sy);
-         computePosition(_tile_id, cx, cy);
-
-         list<NextDest> next_dest_list;
-
-         if (cy >= sy)
-            next_dest_list.push_back(NextDest(computeTileID(cx,cy+1), UP, EMESH));
-         if (cy <= sy)
-            next_dest_list.push_back(NextDest(computeTileID(cx,cy-1), DOWN, EMESH));
-         if (cy == sy)
-         {
-            if (cx >= sx)
-               next_dest_list.push_back(NextDest(computeTileID(cx+1,cy), RIGHT, EMESH));
-            if (cx <= sx)
-               next_dest_list.push_back(NextDest(computeTileID(cx-1,cy), LEFT, EMESH));
-         }
-         next_dest_list.push_back(NextDest(_tile_id, SELF, RECEIVE_TILE));
+         BroadcastTree& broadcast_tree = _broadcast_tree_list[_broadcast_tree_id_table[pkt_sender]];
 
          UInt64 zero_load_delay = 0;
          UInt64 contention_delay = 0;
         
-         // Get the link delay as well as a vector of directions
-         // Remove the tile_ids' that are invalid
+         // Get the link delay
          UInt64 max_link_delay = 0;
-         vector<SInt32> output_port_list;
-         for (list<NextDest>::iterator it = next_dest_list.begin(); it != next_dest_list.end(); )
+         vector<SInt32>& output_port_list = broadcast_tree._output_port_list;
+         for (vector<SInt32>::iterator it = output_port_list.begin(); it != output_port_list.end(); it++)
          {
-            if ((*it)._tile_id != INVALID_TILE_ID)
-            {
-               SInt32 output_port = (*it)._output_port;
-               output_port_list.push_back(output_port);
-            
-               UInt64 link_delay = 0;
-               _mesh_link_list[output_port]->processPacket(pkt, link_delay);
-               max_link_delay = max<UInt64>(max_link_delay, link_delay);
-
-               it ++;
-            }
-            else
-            {
-               it = next_dest_list.erase(it);
-            }
+            UInt64 link_delay = 0;
+            _mesh_link_list[*it]->processPacket(pkt, link_delay);
+            max_link_delay = max<UInt64>(max_link_delay, link_delay);
          }
          // Update the zero_load_delay
          zero_load_delay += max_link_delay;
@@ -212,7 +274,8 @@ NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, queue<Hop> &next_ho
          _mesh_router->processPacket(pkt, output_port_list, zero_load_delay, contention_delay);
 
          // Populate the next_hops queue
-         for (list<NextDest>::iterator it = next_dest_list.begin(); it != next_dest_list.end(); it++)
+         vector<NextDest>& next_dest_list = broadcast_tree._next_dest_list;
+         for (vector<NextDest>::iterator it = next_dest_list.begin(); it != next_dest_list.end(); it++)
          {
             Hop hop(pkt, (*it)._tile_id, (*it)._node_type, zero_load_delay, contention_delay);
             next_hops.push(hop);
@@ -221,22 +284,7 @@ NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, queue<Hop> &next_ho
 
       else // (pkt_receiver != NetPacket::BROADCAST)
       {
-         SInt32 cx, cy, dx, dy;
-         computePosition(_tile_id, cx, cy);
-         computePosition(pkt_receiver, dx, dy);
-
-         NextDest next_dest;
-
-         if (cx > dx)
-            next_dest = NextDest(computeTileID(cx-1,cy), LEFT, EMESH);
-         else if (cx < dx)
-            next_dest = NextDest(computeTileID(cx+1,cy), RIGHT, EMESH);
-         else if (cy > dy)
-            next_dest = NextDest(computeTileID(cx,cy-1), DOWN, EMESH);
-         else if (cy < dy)
-            next_dest = NextDest(computeTileID(cx,cy+1), UP, EMESH);
-         else
-            next_dest = NextDest(_tile_id, SELF, RECEIVE_TILE);
+         const NextDest& next_dest = _next_dest_table[_output_port_table[pkt_receiver]];
 
          UInt64 zero_load_delay = 0;
          UInt64 contention_delay = 0;
@@ -262,6 +310,13 @@ NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, queue<Hop> &next_ho
    }
 }
 
+UInt64
+NetworkModelEMeshHopByHop::getLookahead()
+{
+   // Every hop to another tile goes through the mesh router and a link
+   return _mesh_router->getDelay() + _mesh_link_list[0]->getDelay();
+}
+
 void
 NetworkModelEMeshHopByHop::computePosition(tile_id_t tile_id, SInt32 &x, SInt32 &y)
 {
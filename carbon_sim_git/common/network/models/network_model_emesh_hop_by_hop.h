@@ -27,6 +27,10 @@ public:
 
    static SInt32 computeDistance(tile_id_t sender, tile_id_t receiver);
 
+   // Network Event Engine
+   bool supportsEventEngine() { return true; }
+   UInt64 getLookahead();
+
 private:
    enum NodeType
    {
@@ -58,6 +62,29 @@ private:
    RouterModel* _mesh_router;
    vector<ElectricalLinkModel*> _mesh_link_list;
 
+   // Routing Tables
+   // Built with the router of this tile, so that routing a hop is a lookup
+   // instead of a computation on the positions of the tiles in the mesh
+   class BroadcastTree
+   {
+   public:
+      BroadcastTree() {}
+      ~BroadcastTree() {}
+
+      // Next destinations (the tiles outside the mesh are pruned) and their output ports
+      vector<NextDest> _next_dest_list;
+      vector<SInt32> _output_port_list;
+   };
+
+   // Output port towards each receiver (X-Y routing)
+   vector<UInt8> _output_port_table;
+   // Next destination through each output port
+   vector<NextDest> _next_dest_table;
+   // The broadcast tree of a sender only depends on the direction of the
+   // sender from this tile: one tree per combination of output ports
+   vector<UInt8> _broadcast_tree_id_table;
+   vector<BroadcastTree> _broadcast_tree_list;
+
    // Routing Function
    void routePacket(const NetPacket &pkt, queue<Hop> &next_hops);
    
@@ -68,6 +95,10 @@ private:
    void createRouterAndLinkModels();
    void destroyRouterAndLinkModels();
 
+   // Routing Tables
+   void initializeRoutingTables();
+   static UInt8 computeBroadcastTreeID(SInt32 sx, SInt32 sy, SInt32 cx, SInt32 cy);
+
    // Utilities
    static void computePosition(tile_id_t tile, SInt32 &x, SInt32 &y);
    static tile_id_t computeTileID(SInt32 x, SInt32 y);
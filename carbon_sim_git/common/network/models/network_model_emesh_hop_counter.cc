@@ -35,6 +35,9 @@ NetworkModelEMeshHopCounter::NetworkModelEMeshHopCounter(Network *net, SInt32 ne
    _has_broadcast_capability = false;
 
    createRouterAndLinkModels();
+
+   // Build the Routing Tables
+   initializeRoutingTables();
    
    // Initialize event counters
    initializeEventCounters();
@@ -106,6 +109,26 @@ NetworkModelEMeshHopCounter::destroyRouterAndLinkModels()
    }
 }
 
+void
+NetworkModelEMeshHopCounter::initializeRoutingTables()
+{
+   if (isSystemTile(_tile_id))
+      return;
+
+   // A packet is routed by its sender, so the distances from this tile are enough
+   SInt32 num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   SInt32 sx, sy;
+   computePosition(_tile_id, sx, sy);
+
+   _num_hops_table.resize(num_application_tiles);
+   for (tile_id_t receiver = 0; receiver < num_application_tiles; receiver++)
+   {
+      SInt32 dx, dy;
+      computePosition(receiver, dx, dy);
+      _num_hops_table[receiver] = computeDistance(sx, sy, dx, dy);
+   }
+}
+
 void
 NetworkModelEMeshHopCounter::initializeEventCounters()
 {
@@ -142,12 +165,9 @@ NetworkModelEMeshHopCounter::computeDistance(SInt32 x1, SInt32 y1, SInt32 x2, SI
 void
 NetworkModelEMeshHopCounter::routePacket(const NetPacket &pkt, queue<Hop> &next_hops)
 {
-   SInt32 sx, sy, dx, dy;
-
-   computePosition(TILE_ID(pkt.sender), sx, sy);
-   computePosition(TILE_ID(pkt.receiver), dx, dy);
+   assert(TILE_ID(pkt.sender) == _tile_id);
 
-   UInt32 num_hops = computeDistance(sx, sy, dx, dy);
+   UInt32 num_hops = _num_hops_table[TILE_ID(pkt.receiver)];
    UInt64 latency = (isModelEnabled(pkt)) ? (num_hops * _hop_latency) : 0;
 
    updateDynamicEnergy(pkt, num_hops);
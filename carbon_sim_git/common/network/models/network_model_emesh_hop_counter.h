@@ -26,6 +26,8 @@ private:
    ElectricalLinkPowerModel* _electrical_link_power_model;
    // Latency parameters
    UInt64 _hop_latency;
+   // Number of hops from this tile to each receiver
+   vector<UInt32> _num_hops_table;
 
    // Event counters
    UInt64 _buffer_writes;
@@ -38,6 +40,7 @@ private:
    void createRouterAndLinkModels();
    void initializeEventCounters();
    void destroyRouterAndLinkModels();
+   void initializeRoutingTables();
    
    void computePosition(tile_id_t tile, SInt32 &x, SInt32 &y);
    SInt32 computeDistance(SInt32 x1, SInt32 y1, SInt32 x2, SInt32 y2);
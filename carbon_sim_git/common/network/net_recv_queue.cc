@@ -0,0 +1,241 @@
+#include <climits>
+#include <cassert>
+#include <algorithm>
+using std::find;
+
+#include "net_recv_queue.h"
+#include "log.h"
+
+NetRecvQueue::NetRecvQueue()
+   : _next_seq_num(0)
+   , _size(0)
+{}
+
+NetRecvQueue::~NetRecvQueue()
+{
+   LOG_ASSERT_WARNING(_waiters.empty(), "%u threads still waiting on destroyed receive queue", _waiters.size());
+}
+
+bool
+NetRecvQueue::Key::operator<(const Key& rhs) const
+{
+   if (_receiver_tile_id != rhs._receiver_tile_id)
+      return _receiver_tile_id < rhs._receiver_tile_id;
+   if (_receiver_core_type != rhs._receiver_core_type)
+      return _receiver_core_type < rhs._receiver_core_type;
+   if (_type != rhs._type)
+      return _type < rhs._type;
+   if (_sender_tile_id != rhs._sender_tile_id)
+      return _sender_tile_id < rhs._sender_tile_id;
+   return _sender_core_type < rhs._sender_core_type;
+}
+
+NetRecvQueue::Key
+NetRecvQueue::getKey(const NetPacket& packet)
+{
+   // Broadcast packets match every receiver on the tile, so they all go
+   // to a single receiver slot irrespective of the core type
+   if (packet.receiver.tile_id == NetPacket::BROADCAST)
+      return Key(NetPacket::BROADCAST, BROADCAST_CORE_TYPE, packet.type, packet.sender);
+   else
+      return Key(packet.receiver.tile_id, packet.receiver.core_type, packet.type, packet.sender);
+}
+
+bool
+NetRecvQueue::isMatch(const NetMatch& match, core_id_t receiver, const NetPacket& packet)
+{
+   if ( (packet.receiver.tile_id != receiver.tile_id || packet.receiver.core_type != receiver.core_type) &&
+        (packet.receiver.tile_id != NetPacket::BROADCAST) )
+      return false;
+
+   if (!match.types.empty() &&
+       find(match.types.begin(), match.types.end(), packet.type) == match.types.end())
+      return false;
+
+   for (vector<core_id_t>::const_iterator it = match.senders.begin(); it != match.senders.end(); it++)
+   {
+      if (it->tile_id == packet.sender.tile_id && it->core_type == packet.sender.core_type)
+         return true;
+   }
+   return match.senders.empty();
+}
+
+void
+NetRecvQueue::enqueue(const NetPacket& packet)
+{
+   ScopedLock sl(_lock);
+
+   _bins[getKey(packet)].push_back(Entry(_next_seq_num ++, packet));
+   _size ++;
+
+   // Wake up only the threads that can accept this packet
+   for (list<Waiter*>::iterator it = _waiters.begin(); it != _waiters.end(); it++)
+   {
+      if (isMatch((*it)->_match, (*it)->_receiver, packet))
+         (*it)->_cond.signal();
+   }
+}
+
+NetPacket
+NetRecvQueue::dequeue(const NetMatch& match, core_id_t receiver)
+{
+   ScopedLock sl(_lock);
+
+   Bin::iterator entry;
+   BinMap::iterator bin = findBin(match, receiver, false, entry);
+   if (bin == _bins.end())
+   {
+      // Go to sleep until a matching packet arrives
+      Waiter waiter(match, receiver);
+      _waiters.push_back(&waiter);
+      do
+      {
+         waiter._cond.wait(_lock);
+         bin = findBin(match, receiver, false, entry);
+      }
+      while (bin == _bins.end());
+      _waiters.remove(&waiter);
+   }
+
+   return remove(bin, entry);
+}
+
+bool
+NetRecvQueue::tryDequeue(const NetMatch& match, core_id_t receiver, NetPacket& packet)
+{
+   ScopedLock sl(_lock);
+
+   Bin::iterator entry;
+   BinMap::iterator bin = findBin(match, receiver, true, entry);
+   if (bin == _bins.end())
+      return false;
+
+   packet = remove(bin, entry);
+   return true;
+}
+
+UInt32
+NetRecvQueue::size()
+{
+   ScopedLock sl(_lock);
+   return _size;
+}
+
+NetRecvQueue::BinMap::iterator
+NetRecvQueue::findBin(const NetMatch& match, core_id_t receiver, bool earliest_time, Bin::iterator& entry)
+{
+   BinMap::iterator best_bin = _bins.end();
+
+   searchReceiver(match, receiver.tile_id, receiver.core_type, earliest_time, best_bin, entry);
+   searchReceiver(match, NetPacket::BROADCAST, BROADCAST_CORE_TYPE, earliest_time, best_bin, entry);
+
+   return best_bin;
+}
+
+void
+NetRecvQueue::searchReceiver(const NetMatch& match, SInt32 receiver_tile_id, UInt32 receiver_core_type,
+                             bool earliest_time, BinMap::iterator& best_bin, Bin::iterator& best_entry)
+{
+   const core_id_t lowest_sender = {INT_MIN, 0};
+
+   if (!match.types.empty())
+   {
+      for (vector<PacketType>::const_iterator type = match.types.begin(); type != match.types.end(); type++)
+      {
+         if (!match.senders.empty())
+         {
+            // Exact lookups
+            for (vector<core_id_t>::const_iterator sender = match.senders.begin(); sender != match.senders.end(); sender++)
+            {
+               BinMap::iterator bin = _bins.find(Key(receiver_tile_id, receiver_core_type, *type, *sender));
+               if (bin != _bins.end())
+                  searchBin(bin, earliest_time, best_bin, best_entry);
+            }
+         }
+         else
+         {
+            // All non-empty bins of (receiver, type)
+            for (BinMap::iterator bin = _bins.lower_bound(Key(receiver_tile_id, receiver_core_type, *type, lowest_sender));
+                 (bin != _bins.end()) &&
+                 (bin->first._receiver_tile_id == receiver_tile_id) &&
+                 (bin->first._receiver_core_type == receiver_core_type) &&
+                 (bin->first._type == *type);
+                 bin++)
+            {
+               searchBin(bin, earliest_time, best_bin, best_entry);
+            }
+         }
+      }
+   }
+   else
+   {
+      // All non-empty bins of the receiver, filtered by sender
+      for (BinMap::iterator bin = _bins.lower_bound(Key(receiver_tile_id, receiver_core_type, INVALID_PACKET_TYPE, lowest_sender));
+           (bin != _bins.end()) &&
+           (bin->first._receiver_tile_id == receiver_tile_id) &&
+           (bin->first._receiver_core_type == receiver_core_type);
+           bin++)
+      {
+         bool sender_match = match.senders.empty();
+         for (vector<core_id_t>::const_iterator sender = match.senders.begin();
+              (sender != match.senders.end()) && !sender_match; sender++)
+         {
+            sender_match = (sender->tile_id == bin->first._sender_tile_id) &&
+                           (sender->core_type == bin->first._sender_core_type);
+         }
+         if (sender_match)
+            searchBin(bin, earliest_time, best_bin, best_entry);
+      }
+   }
+}
+
+void
+NetRecvQueue::searchBin(BinMap::iterator bin, bool earliest_time,
+                        BinMap::iterator& best_bin, Bin::iterator& best_entry)
+{
+   Bin& entries = bin->second;
+   assert(!entries.empty());
+
+   // Packets within a bin are in arrival order, so the oldest one is at the
+   // front. Packet times need not be monotonic though, so look at all of them
+   // when searching for the earliest time.
+   Bin::iterator candidate = entries.begin();
+   if (earliest_time)
+   {
+      for (Bin::iterator it = entries.begin(); it != entries.end(); it++)
+      {
+         if (it->_packet.time < candidate->_packet.time)
+            candidate = it;
+      }
+   }
+
+   if (best_bin == _bins.end())
+   {
+      best_bin = bin;
+      best_entry = candidate;
+      return;
+   }
+
+   bool better = earliest_time
+                 ? ( (candidate->_packet.time < best_entry->_packet.time) ||
+                     ((candidate->_packet.time == best_entry->_packet.time) && (candidate->_seq_num < best_entry->_seq_num)) )
+                 : (candidate->_seq_num < best_entry->_seq_num);
+   if (better)
+   {
+      best_bin = bin;
+      best_entry = candidate;
+   }
+}
+
+NetPacket
+NetRecvQueue::remove(BinMap::iterator bin, Bin::iterator entry)
+{
+   NetPacket packet = entry->_packet;
+
+   bin->second.erase(entry);
+   if (bin->second.empty())
+      _bins.erase(bin);
+   _size --;
+
+   return packet;
+}
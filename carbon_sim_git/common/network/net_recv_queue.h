@@ -0,0 +1,105 @@
+#ifndef NET_RECV_QUEUE_H
+#define NET_RECV_QUEUE_H
+
+#include <map>
+#include <deque>
+#include <list>
+using std::map;
+using std::deque;
+using std::list;
+
+#include "network.h"
+#include "cond.h"
+#include "lock.h"
+#include "fixed_types.h"
+
+// Demultiplexed receive queue used by Network for synchronous I/O.
+//   Packets are binned by (receiver, packet type, sender) so that a
+// receive only inspects the bins that can possibly match instead of
+// scanning every queued packet against every sender and every type.
+// Bins are kept in an ordered map and erased as soon as they drain, so
+// wildcard matches (no senders / no types in the NetMatch) are range
+// scans over the non-empty bins only.
+//   Threads blocked in dequeue() register a waiter; enqueue() signals
+// only the waiters whose match accepts the new packet.
+
+class NetRecvQueue
+{
+public:
+   NetRecvQueue();
+   ~NetRecvQueue();
+
+   void enqueue(const NetPacket& packet);
+
+   // Returns the oldest (first enqueued) matching packet, sleeping until one arrives
+   NetPacket dequeue(const NetMatch& match, core_id_t receiver);
+   // Returns the earliest (smallest time) matching packet if any
+   bool tryDequeue(const NetMatch& match, core_id_t receiver, NetPacket& packet);
+
+   UInt32 size();
+
+private:
+   class Key
+   {
+   public:
+      Key(SInt32 receiver_tile_id, UInt32 receiver_core_type, PacketType type, core_id_t sender)
+         : _receiver_tile_id(receiver_tile_id)
+         , _receiver_core_type(receiver_core_type)
+         , _type(type)
+         , _sender_tile_id(sender.tile_id)
+         , _sender_core_type(sender.core_type)
+      {}
+
+      bool operator<(const Key& rhs) const;
+
+      SInt32 _receiver_tile_id;
+      UInt32 _receiver_core_type;
+      SInt32 _type;
+      SInt32 _sender_tile_id;
+      UInt32 _sender_core_type;
+   };
+
+   class Entry
+   {
+   public:
+      Entry(UInt64 seq_num, const NetPacket& packet)
+         : _seq_num(seq_num), _packet(packet) {}
+      UInt64 _seq_num;
+      NetPacket _packet;
+   };
+
+   typedef deque<Entry> Bin;
+   typedef map<Key, Bin> BinMap;
+
+   class Waiter
+   {
+   public:
+      Waiter(const NetMatch& match, core_id_t receiver)
+         : _match(match), _receiver(receiver) {}
+      const NetMatch& _match;
+      core_id_t _receiver;
+      ConditionVariable _cond;
+   };
+
+   BinMap _bins;
+   list<Waiter*> _waiters;
+   UInt64 _next_seq_num;
+   UInt32 _size;
+   Lock _lock;
+
+   static const UInt32 BROADCAST_CORE_TYPE = 0xffffffff;
+
+   static Key getKey(const NetPacket& packet);
+   static bool isMatch(const NetMatch& match, core_id_t receiver, const NetPacket& packet);
+
+   // Finds the bin holding the best match according to 'earliest_time'
+   // (smallest packet time) or else smallest sequence number
+   BinMap::iterator findBin(const NetMatch& match, core_id_t receiver, bool earliest_time, Bin::iterator& entry);
+   void searchReceiver(const NetMatch& match, SInt32 receiver_tile_id, UInt32 receiver_core_type,
+                       bool earliest_time, BinMap::iterator& best_bin, Bin::iterator& best_entry);
+   void searchBin(BinMap::iterator bin, bool earliest_time,
+                  BinMap::iterator& best_bin, Bin::iterator& best_entry);
+   NetPacket remove(BinMap::iterator bin, Bin::iterator entry);
+};
+
+#endif // NET_RECV_QUEUE_H
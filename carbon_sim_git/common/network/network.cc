@@ -1,3 +1,7 @@
+#include <new>
+#include <sstream>
+#include <string.h>
+
 #include "transport.h"
 #include "tile.h"
 #include "network.h"
@@ -7,6 +11,8 @@
 #include "clock_converter.h"
 #include "fxsupport.h"
 #include "network_model.h"
+#include "network_event_engine.h"
+#include "net_recv_queue.h"
 #include "statistics_manager.h"
 #include "utils.h"
 #include "log.h"
@@ -25,8 +31,17 @@ using namespace std;
 bool* Network::_utilizationTraceEnabled;
 ofstream* Network::_utilizationTraceFiles;
 
+// Event engines of the networks that route through them
+NetworkEventEngine* Network::_eventEngines[NUM_STATIC_NETWORKS];
+
+// Trace of the packets sent, for the trace-driven network driver
+bool Network::_packetTraceEnabled[NUM_STATIC_NETWORKS];
+ofstream* Network::_packetTraceFile = NULL;
+Lock Network::_packetTraceLock;
+
 Network::Network(Tile *tile)
       : _tile(tile)
+      , _waitingForPacket(false)
 {
    LOG_ASSERT_ERROR(sizeof(g_type_to_static_network_map) / sizeof(EStaticNetwork) == NUM_PACKET_TYPES,
                     "Static network type map has incorrect number of entries.");
@@ -35,6 +50,7 @@ Network::Network(Tile *tile)
    _tid = _tile->getId();
 
    _transport = Transport::getSingleton()->createNode(_tile->getId());
+   _netRecvQueue = new NetRecvQueue();
 
    _callbacks = new NetworkCallback [NUM_PACKET_TYPES];
    _callbackObjs = new void* [NUM_PACKET_TYPES];
@@ -67,6 +83,7 @@ Network::~Network()
    delete [] _callbackObjs;
    delete [] _callbacks;
 
+   delete _netRecvQueue;
    delete _transport;
 
    LOG_PRINT("Destroyed.");
@@ -92,6 +109,14 @@ void Network::outputSummary(std::ostream &out) const
       out << "  Network model " << i << ":\n";
       _models[i]->outputSummary(out);
    }
+   for (UInt32 i = 0; i < NUM_STATIC_NETWORKS; i++)
+   {
+      if (_eventEngines[i])
+      {
+         out << "  Network event engine " << i << ":\n";
+         _eventEngines[i]->outputSummary(out, _tile->getId());
+      }
+   }
 }
 
 // Polling function that performs background activities, such as
@@ -104,7 +129,9 @@ void Network::netPullFromTransport()
    {
       LOG_PRINT("Entering netPullFromTransport");
 
-      NetPacket packet(_transport->recv());
+      Byte* buffer = _transport->recv();
+      NetPacket packet(buffer);
+      _transport->releaseBuffer(buffer);
 
       LOG_PRINT("Pull packet : type %i, from {%i, %i}, time %llu",
             (SInt32)packet.type, packet.sender.tile_id, packet.sender.core_type, packet.time);
@@ -137,9 +164,8 @@ void Network::netPullFromTransport()
 
             callback(_callbackObjs[packet.type], packet);
 
-            // De-allocate packet payload
-            if (packet.length > 0)
-               delete [] (Byte*) packet.data;
+            // Release the reference of the packet to the payload
+            packet.releasePayload();
          }
 
          // synchronous I/O support
@@ -149,11 +175,16 @@ void Network::netPullFromTransport()
                   (SInt32)packet.type, packet.sender.tile_id, packet.sender.core_type, packet.receiver.tile_id, packet.receiver.core_type,
                   _tile->getId(), (long long unsigned int) packet.time);
 
-            _netQueueLock.acquire();
-            _netQueue.push_back(packet);
-            _netQueueLock.release();
+            // The receivers of netRecv() own the payload (and delete it)
+            if (packet.shared_payload)
+            {
+               Byte* data_buffer = new Byte[packet.length];
+               memcpy(data_buffer, packet.data, packet.length);
+               packet.releasePayload();
+               packet.data = data_buffer;
+            }
 
-            _netQueueCond.broadcast();
+            _netRecvQueue->enqueue(packet);
          }
       }
 
@@ -164,9 +195,8 @@ void Network::netPullFromTransport()
                packet.receiver.tile_id, packet.receiver.core_type, _tile->getId(), packet.time);
          forwardPacket(packet);
          
-         // De-allocate packet payload
-         if (packet.length > 0)
-            delete [] (Byte*) packet.data;
+         // Release the reference of the packet to the payload
+         packet.releasePayload();
       }
    }
    while (_transport->query());
@@ -174,9 +204,20 @@ void Network::netPullFromTransport()
 
 SInt32 Network::forwardPacket(const NetPacket& packet)
 {
-   // Create a buffer suitable for forwarding
-   Byte* buffer = packet.makeBuffer();
-   NetPacket* buf_pkt = (NetPacket*) buffer;
+   LOG_ASSERT_ERROR((packet.length == 0) || packet.shared_payload,
+                    "Packet type(%u), length(%u) without a shared payload", packet.type, packet.length);
+
+   // Routed hop-by-hop by the event engine of the network
+   NetworkEventEngine* event_engine = _eventEngines[g_type_to_static_network_map[packet.type]];
+   if (event_engine)
+   {
+      event_engine->injectPacket(packet);
+      return packet.length;
+   }
+
+   // Only the header is rewritten for each hop, the hops share the payload
+   NetPacket hop_pkt(packet);
+   NetPacket* buf_pkt = &hop_pkt;
 
    LOG_ASSERT_ERROR((buf_pkt->type >= 0) && (buf_pkt->type < NUM_PACKET_TYPES),
          "buf_pkt->type(%u)", buf_pkt->type);
@@ -211,15 +252,33 @@ SInt32 Network::forwardPacket(const NetPacket& packet)
                    buf_pkt->receiver.tile_id, buf_pkt->receiver.core_type,
                    hop._next_tile_id,
                    _tile->getId(), hop._time);
-         _transport->send(hop._next_tile_id, buffer, packet.bufferSize());
+         sendPacket(hop._next_tile_id, *buf_pkt);
       }
    }
 
-   delete [] buffer;
-
    return packet.length;
 }
 
+void Network::sendPacket(tile_id_t next_tile_id, const NetPacket& packet)
+{
+   Config* config = Config::getSingleton();
+   if (config->getProcessNumForTile(next_tile_id) == config->getCurrentProcessNum())
+   {
+      // Only the header goes through the transport, with a new reference to the payload
+      NetPacketPayload* payload = packet.getPayload();
+      if (payload)
+         payload->addRef();
+      _transport->send(next_tile_id, &packet, sizeof(NetPacket));
+   }
+   else
+   {
+      // Serialized at the process boundary
+      Byte* buffer = packet.makeBuffer();
+      _transport->send(next_tile_id, buffer, packet.bufferSize());
+      delete [] buffer;
+   }
+}
+
 NetworkModel* Network::getNetworkModelFromPacketType(PacketType packet_type)
 {
    return _models[g_type_to_static_network_map[packet_type]];
@@ -243,138 +302,44 @@ SInt32 Network::netSend(NetPacket& packet)
                                    _tile->getCore()->getPerformanceModel()->getFrequency(),
                                    model->getFrequency());
 
+   if (_packetTraceFile)
+      tracePacket(packet, model);
+
+   // The payload is copied once, and shared by all the hops and receivers
+   NetPacket shared_packet(packet);
+   if (packet.length > 0)
+   {
+      shared_packet.data = NetPacketPayload::create(packet.data, packet.length)->getData();
+      shared_packet.shared_payload = true;
+   }
+
    // Send packet as multiple packets if model has not broadcast capability and receiver is ALL
    if ( (TILE_ID(packet.receiver) == NetPacket::BROADCAST) && (!model->hasBroadcastCapability()) )
    {
       for (tile_id_t i = 0; i < (tile_id_t) Config::getSingleton()->getTotalTiles(); i++)
       {
          packet.receiver = CORE_ID(i);
-         __attribute(__unused__) SInt32 ret = forwardPacket(packet);
+         shared_packet.receiver = packet.receiver;
+         __attribute(__unused__) SInt32 ret = forwardPacket(shared_packet);
          LOG_ASSERT_ERROR(ret == (SInt32) packet.length, "ret(%i) != packet.length(%u)", ret, packet.length);
       }
    }
 
    else // (packet.receiver != NetPacket::BROADCAST) || (model->hasBroadcastCapability())
    {
-      __attribute(__unused__) SInt32 ret = forwardPacket(packet);
+      __attribute(__unused__) SInt32 ret = forwardPacket(shared_packet);
       LOG_ASSERT_ERROR(ret == (SInt32) packet.length, "ret(%i) != packet.length(%u)", ret, packet.length);
    }
 
+   shared_packet.releasePayload();
+
    return packet.length;
 }
 
-// Stupid helper class to eliminate special cases for empty
-// sender/type vectors in a NetMatch
-class NetRecvIterator
-{
-   public:
-      NetRecvIterator(UInt32 i)
-            : _mode(INT)
-            , _max(i)
-            , _i(0)
-      {
-      }
-      NetRecvIterator(const std::vector<core_id_t> &v)
-            : _mode(SENDER_VECTOR)
-            , _senders(&v)
-            , _i(0)
-      {
-      }
-      NetRecvIterator(const std::vector<PacketType> &v)
-            : _mode(TYPE_VECTOR)
-            , _types(&v)
-            , _i(0)
-      {
-      }
-
-      inline UInt32 get()
-      {
-         switch (_mode)
-         {
-         case INT:
-            return _i;
-         case TYPE_VECTOR:
-            return (UInt32)_types->at(_i);
-         default:
-            assert(false);
-            return (UInt32)-1;
-         };
-      }
-
-      inline core_id_t getId()
-      {
-         switch (_mode)
-         {
-         case INT:
-            return Tile::getMainCoreId(_i);
-         case SENDER_VECTOR:
-            return (core_id_t)_senders->at(_i);
-         default:
-            assert(false);
-            return INVALID_CORE_ID;
-         };
-      }
-
-      inline Boolean done()
-      {
-         switch (_mode)
-         {
-         case INT:
-            return _i >= _max;
-         case SENDER_VECTOR:
-            return _i >= _senders->size();
-         case TYPE_VECTOR:
-            return _i >= _types->size();
-         default:
-            assert(false);
-            return true;
-         };
-      }
-
-      inline void next()
-      {
-         ++_i;
-      }
-
-      inline void reset()
-      {
-         _i = 0;
-      }
-
-   private:
-      enum
-      {
-         INT, SENDER_VECTOR, TYPE_VECTOR
-      } _mode;
-
-      union
-      {
-         UInt32 _max;
-         const std::vector<core_id_t> *_senders;
-         const std::vector<PacketType> *_types;
-      };
-
-      UInt32 _i;
-};
-
 NetPacket Network::netRecv(const NetMatch &match)
 {
    LOG_PRINT("Entering netRecv.");
 
-   // Track via iterator to minimize copying
-   NetQueue::iterator itr;
-   Boolean found;
-
-   found = false;
-
-   NetRecvIterator sender = match.senders.empty()
-                            ? NetRecvIterator(_numMod)
-                            : NetRecvIterator(match.senders);
-
-   NetRecvIterator type = match.types.empty()
-                          ? NetRecvIterator((UInt32)NUM_PACKET_TYPES)
-                          : NetRecvIterator(match.types);
-
    core_id_t receiver = match.receiver.tile_id == INVALID_TILE_ID 
                         ? _tile->getCore()->getId() 
                         : match.receiver;
@@ -383,58 +348,17 @@ NetPacket Network::netRecv(const NetMatch &match)
                     "Tile and/or performance model not initialized.");
    UInt64 start_time = _tile->getCore()->getPerformanceModel()->getCycleCount();
 
-   _netQueueLock.acquire();
-
-   while (!found)
-   {
-      itr = _netQueue.end();
-
-      // check every entry in the queue
-      for (NetQueue::iterator i = _netQueue.begin();
-            (i != _netQueue.end()) && !found;
-            i++)
-      {
-         // make sure that this core is the proper destination core for this tile
-         if (i->receiver.tile_id != receiver.tile_id || i->receiver.core_type != receiver.core_type)
-         {
-            if (i->receiver.tile_id != NetPacket::BROADCAST)
-               continue;
-         }
+   // Sleeps until a matching packet arrives. The packet may be held back by
+   // the event engines until the clock of this tile stops bounding them
+   bool waiting = _waitingForPacket;
+   _waitingForPacket = true;
+   advanceEventEngines();
+   NetPacket packet = _netRecvQueue->dequeue(match, receiver);
+   _waitingForPacket = waiting;
 
-         // only find packets that match
-         for (sender.reset(); !sender.done() && !found; sender.next())
-         {
-            if (i->sender.tile_id != sender.getId().tile_id || i->sender.core_type != sender.getId().core_type)
-               continue;
-
-            for (type.reset(); !type.done() && !found; type.next())
-            {
-               if (i->type != (PacketType)type.get())
-                  continue;
-
-               found = true;
-               itr = i;
-            }
-         }
-      }
-
-      // go to sleep until a packet arrives if none have been found
-      if (!found)
-      {
-         _netQueueCond.wait(_netQueueLock);
-      }
-   }
-
-   assert(found == true && itr != _netQueue.end());
-   assert(0 <= itr->sender.tile_id && itr->sender.tile_id < _numMod);
-   assert(0 <= itr->type && itr->type < NUM_PACKET_TYPES);
-   assert((itr->receiver.tile_id == _tile->getId()) || (itr->receiver.tile_id == NetPacket::BROADCAST));
-
-   // Copy result
-   NetPacket packet = *itr;
-   _netQueue.erase(itr);
-
-   _netQueueLock.release();
+   assert(0 <= packet.sender.tile_id && packet.sender.tile_id < _numMod);
+   assert(0 <= packet.type && packet.type < NUM_PACKET_TYPES);
+   assert((packet.receiver.tile_id == _tile->getId()) || (packet.receiver.tile_id == NetPacket::BROADCAST));
 
    LOG_PRINT("packet.time(%llu), start_time(%llu)", packet.time, start_time);
 
@@ -502,20 +426,6 @@ NetPacket Network::netRecvNonBlock(const NetMatch &match)
 {   
    LOG_PRINT("Entering netRecv Non block.");
 
-   // Track via iterator to minimize copying
-   NetQueue::iterator itr;
-   Boolean found;
-
-   found = false;
-
-   NetRecvIterator sender = match.senders.empty()
-                            ? NetRecvIterator(_numMod)
-                            : NetRecvIterator(match.senders);
-
-   NetRecvIterator type = match.types.empty()
-                          ? NetRecvIterator((UInt32)NUM_PACKET_TYPES)
-                          : NetRecvIterator(match.types);
-
    core_id_t receiver = match.receiver.tile_id == INVALID_TILE_ID
                         ? _tile->getCore()->getId()
                         : match.receiver;
@@ -524,51 +434,9 @@ NetPacket Network::netRecvNonBlock(const NetMatch &match)
                     "Tile and/or performance model not initialized.");
    UInt64 start_time = _tile->getCore()->getPerformanceModel()->getCycleCount();
 
-   _netQueueLock.acquire();
-
-	itr = _netQueue.end();
-
-	// check every entry in the queue
-	for (NetQueue::iterator i = _netQueue.begin();
-		i != _netQueue.end();
-		i++)
-	{
-      // make sure that this core is the proper destination core for this tile
-      if (i->receiver.tile_id != receiver.tile_id || i->receiver.core_type != receiver.core_type)
-         if (i->receiver.tile_id != NetPacket::BROADCAST)
-             continue;
-
-      // only find packets that match
-      for (sender.reset(); !sender.done(); sender.next()){
-         if (i->sender.tile_id != sender.getId().tile_id || i->sender.core_type != sender.getId().core_type)
-             continue;
-
-         for (type.reset(); !type.done(); type.next()){
-            if (i->type != (PacketType)type.get())
-               continue;
-
-            found = true;
-
-            // find the earliest packet
-            if (itr == _netQueue.end() || itr->time > i->time){
-               itr = i;
-            }
-         }
-      }
-	}
-   
-   //assert(found == true && itr != _netQueue.end());
-   //assert(0 <= itr->sender.tile_id && itr->sender.tile_id < _numMod);
-   //assert(0 <= itr->type && itr->type < NUM_PACKET_TYPES);
-   //assert((itr->receiver.tile_id == _tile->getId()) || (itr->receiver.tile_id == NetPacket::BROADCAST));
-
-   // Copy result
-   NetPacket packet = *itr;
-   
-   if(found == true)
-      _netQueue.erase(itr);
-
-   _netQueueLock.release();
+   // Picks the earliest matching packet
+   NetPacket packet;
+   Boolean found = _netRecvQueue->tryDequeue(match, receiver, packet);
 
    LOG_PRINT("packet.time(%llu), start_time(%llu)", packet.time, start_time);
 
@@ -612,6 +480,141 @@ NetPacket Network::netRecvType(PacketType type, core_id_t recv)
    return netRecv(match);
 }
 
+void Network::createEventEngines()
+{
+   bool enabled = false;
+   SInt32 num_threads = 1;
+   try
+   {
+      enabled = Sim()->getCfg()->getBool("network/event_engine/enabled", false);
+      num_threads = Sim()->getCfg()->getInt("network/event_engine/num_threads", 1);
+   }
+   catch (...)
+   {
+      LOG_PRINT_ERROR("Could not read network/event_engine parameters from the cfg file");
+   }
+
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+      _eventEngines[network_id] = NULL;
+
+   if (!enabled)
+      return;
+
+   LOG_ASSERT_ERROR(Config::getSingleton()->getProcessCount() == 1,
+                    "Cannot Enable the Network Event Engine for (%i) processes", Config::getSingleton()->getProcessCount());
+
+   // Only for the networks whose models route hop-by-hop
+   Tile* tile = Sim()->getTileManager()->getTileFromID(0);
+   assert(tile);
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+   {
+      if (tile->getNetwork()->getNetworkModel(network_id)->supportsEventEngine())
+         _eventEngines[network_id] = new NetworkEventEngine(network_id, num_threads);
+   }
+}
+
+void Network::advanceEventEngines()
+{
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+   {
+      if (_eventEngines[network_id])
+         _eventEngines[network_id]->advance();
+   }
+}
+
+void Network::synchronizeEventEngines(tile_id_t tile_id)
+{
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+   {
+      if (_eventEngines[network_id])
+         _eventEngines[network_id]->synchronize(tile_id);
+   }
+}
+
+void Network::destroyEventEngines()
+{
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+   {
+      delete _eventEngines[network_id];
+      _eventEngines[network_id] = NULL;
+   }
+}
+
+void Network::openPacketTraceFile()
+{
+   bool enabled = false;
+   string enabled_networks_line;
+   string file_name;
+   try
+   {
+      enabled = Sim()->getCfg()->getBool("network/packet_trace/enabled", false);
+      if (enabled)
+      {
+         enabled_networks_line = Sim()->getCfg()->getString("network/packet_trace/networks");
+         file_name = Sim()->getCfg()->getString("network/packet_trace/file");
+      }
+   }
+   catch (...)
+   {
+      LOG_PRINT_ERROR("Could not read network/packet_trace parameters from the cfg file");
+   }
+
+   if (!enabled)
+      return;
+
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+      _packetTraceEnabled[network_id] = false;
+
+   vector<string> enabled_networks;
+   splitIntoTokens(enabled_networks_line, enabled_networks, ", ");
+   for (vector<string>::iterator it = enabled_networks.begin(); it != enabled_networks.end(); it ++)
+   {
+      bool found = false;
+      for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id ++)
+      {
+         if (g_static_network_name_list[network_id] == *it)
+         {
+            _packetTraceEnabled[network_id] = true;
+            found = true;
+         }
+      }
+      LOG_ASSERT_ERROR(found, "Unrecognized network(%s) in network/packet_trace/networks", (*it).c_str());
+   }
+
+   ostringstream process_file_name;
+   process_file_name << file_name << "." << Config::getSingleton()->getCurrentProcessNum();
+   string full_file_name = Config::getSingleton()->formatOutputFileName(process_file_name.str());
+
+   _packetTraceFile = new ofstream(full_file_name.c_str());
+   LOG_ASSERT_ERROR(_packetTraceFile->good(), "Could not open packet trace file(%s)", full_file_name.c_str());
+   *_packetTraceFile << "# time sender receiver type length" << endl;
+}
+
+void Network::closePacketTraceFile()
+{
+   if (!_packetTraceFile)
+      return;
+
+   _packetTraceFile->close();
+   delete _packetTraceFile;
+   _packetTraceFile = NULL;
+}
+
+void Network::tracePacket(const NetPacket& packet, NetworkModel* model)
+{
+   // Only the packets the models see
+   if (!_packetTraceEnabled[g_type_to_static_network_map[packet.type]] || !model->isModelEnabled(packet))
+      return;
+
+   tile_id_t receiver = TILE_ID(packet.receiver);
+   if (receiver == NetPacket::BROADCAST)
+      receiver = -1;
+
+   ScopedLock sl(_packetTraceLock);
+   *_packetTraceFile << packet.time << " " << TILE_ID(packet.sender) << " " << receiver << " "
+                     << (SInt32) packet.type << " " << model->getModeledLength(packet) << "\n";
+}
+
 void Network::enableModels()
 {
    LOG_PRINT("enableModels(%i) start", getTile()->getId());
@@ -752,6 +755,7 @@ NetPacket::NetPacket()
    , data(0)
    , zero_load_delay(0)
    , contention_delay(0)
+   , shared_payload(false)
 {
 }
 
@@ -764,6 +768,7 @@ NetPacket::NetPacket(UInt64 t, PacketType ty, SInt32 s,
    , data(d)
    , zero_load_delay(0)
    , contention_delay(0)
+   , shared_payload(false)
 {
    sender = Tile::getMainCoreId(s);
    receiver = Tile::getMainCoreId(r);
@@ -781,6 +786,7 @@ NetPacket::NetPacket(UInt64 t, PacketType ty, core_id_t s,
    , data(d)
    , zero_load_delay(0)
    , contention_delay(0)
+   , shared_payload(false)
 {
 }
 
@@ -789,14 +795,13 @@ NetPacket::NetPacket(Byte *buffer)
    memcpy(this, buffer, sizeof(*this));
 
    // LOG_ASSERT_ERROR(length > 0, "type(%u), sender(%i), receiver(%i), length(%u)", type, sender, receiver, length);
-   if (length > 0)
+   // A shared payload comes with the reference of the sender (see Network::sendPacket()),
+   // a serialized one follows the packet in the buffer
+   if ((length > 0) && !shared_payload)
    {
-      Byte* data_buffer = new Byte[length];
-      memcpy(data_buffer, buffer + sizeof(*this), length);
-      data = data_buffer;
+      data = NetPacketPayload::create(buffer + sizeof(*this), length)->getData();
+      shared_payload = true;
    }
-
-   delete [] buffer;
 }
 
 // This implementation is slightly wasteful because there is no need
@@ -816,6 +821,36 @@ Byte* NetPacket::makeBuffer() const
 
    memcpy(buffer, this, sizeof(*this));
    memcpy(buffer + sizeof(*this), data, length);
+   ((NetPacket*) buffer)->shared_payload = false;
 
    return buffer;
 }
+
+void NetPacket::releasePayload()
+{
+   if (shared_payload)
+   {
+      getPayload()->release();
+      data = NULL;
+      shared_payload = false;
+   }
+}
+
+// -- NetPacketPayload
+
+NetPacketPayload* NetPacketPayload::create(const void* data, UInt32 length)
+{
+   Byte* buffer = new Byte[sizeof(NetPacketPayload) + length];
+   NetPacketPayload* payload = new (buffer) NetPacketPayload(length);
+   memcpy(buffer + sizeof(NetPacketPayload), data, length);
+   return payload;
+}
+
+void NetPacketPayload::release()
+{
+   if (__sync_sub_and_fetch(&_ref_count, 1) == 0)
+   {
+      this->~NetPacketPayload();
+      delete [] (Byte*) this;
+   }
+}
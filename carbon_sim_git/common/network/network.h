@@ -19,9 +19,37 @@ using std::list;
 class Tile;
 class Network;
 class NetworkModel;
+class NetworkEventEngine;
+class NetRecvQueue;
 
 // -- Network Packets -- //
 
+// Immutable payload of a packet, shared by the hops and the receivers of the
+// packet in the process (see Network::sendPacket()). It is allocated with the
+// data following it, and freed when the last reference is released.
+class NetPacketPayload
+{
+public:
+   // Copy of the data, with one reference
+   static NetPacketPayload* create(const void* data, UInt32 length);
+   static NetPacketPayload* fromData(const void* data)
+   { return ((NetPacketPayload*) data) - 1; }
+
+   void addRef() { __sync_fetch_and_add(&_ref_count, 1); }
+   void release();
+
+   const Byte* getData() const { return (const Byte*) (this + 1); }
+   UInt32 getLength() const { return _length; }
+
+private:
+   NetPacketPayload(UInt32 length)
+      : _ref_count(1), _length(length) {}
+   ~NetPacketPayload() {}
+
+   volatile SInt32 _ref_count;
+   UInt32 _length;
+};
+
 class NetPacket
 {
 public:
@@ -39,6 +67,9 @@ public:
    UInt64 zero_load_delay;
    UInt64 contention_delay;
 
+   // Is 'data' a reference to a NetPacketPayload
+   bool shared_payload;
+
    NetPacket();
    explicit NetPacket(Byte*);
    NetPacket(UInt64 time, PacketType type, core_id_t sender, 
@@ -49,6 +80,10 @@ public:
    UInt32 bufferSize() const;
    Byte *makeBuffer() const;
 
+   NetPacketPayload* getPayload() const
+   { return shared_payload ? NetPacketPayload::fromData(data) : NULL; }
+   void releasePayload();
+
    static const SInt32 BROADCAST = 0xDEADBABE;
    
 //ATAC fix start
@@ -57,8 +92,6 @@ public:
 //ATAC fix end
 };
 
-typedef list<NetPacket> NetQueue;
-
 // -- Network Matches -- //
 
 class NetMatch
@@ -125,6 +158,25 @@ public:
    NetworkModel* getNetworkModel(SInt32 network_id) { return _models[network_id]; }
    NetworkModel* getNetworkModelFromPacketType(PacketType packet_type);
 
+   // -- Network Event Engines -- //
+   // Shared by the tiles, created once all the tiles exist
+   static void createEventEngines();
+   static void destroyEventEngines();
+   static NetworkEventEngine* getEventEngine(SInt32 network_id) { return _eventEngines[network_id]; }
+   // Route the events the event engines were holding back, when a core
+   // stops holding them back (waits for a packet, exits) or at its periodic
+   // synchronization
+   static void advanceEventEngines();
+   static void synchronizeEventEngines(tile_id_t tile_id);
+   // The application thread of the tile waits for a packet (in netRecv() or
+   // a memory access), so its clock does not hold back the event engines
+   void setWaitingForPacket(bool waiting) { _waitingForPacket = waiting; }
+   bool isWaitingForPacket() { return _waitingForPacket; }
+
+   // -- Packet Trace (see [network/packet_trace] in the cfg file) -- //
+   static void openPacketTraceFile();
+   static void closePacketTraceFile();
+
 private:
    NetworkModel * _models[NUM_STATIC_NETWORKS];
 
@@ -137,9 +189,7 @@ private:
    SInt32 _tid;
    SInt32 _numMod;
 
-   NetQueue _netQueue;
-   Lock _netQueueLock;
-   ConditionVariable _netQueueCond;
+   NetRecvQueue* _netRecvQueue;
    
    // -- Network Injection/Ejection Rate Trace -- //
    static bool* _utilizationTraceEnabled;
@@ -148,7 +198,21 @@ private:
    // Is shortCut available through shared memory
    bool _sharedMemoryShortcutEnabled;
 
+   // -- Network Event Engines -- //
+   static NetworkEventEngine* _eventEngines[NUM_STATIC_NETWORKS];
+   volatile bool _waitingForPacket;
+
+   // -- Packet Trace -- //
+   static bool _packetTraceEnabled[NUM_STATIC_NETWORKS];
+   static ofstream* _packetTraceFile;
+   static Lock _packetTraceLock;
+
+   friend class NetworkEventEngine;
+
    SInt32 forwardPacket(const NetPacket& packet);
+   // Send one hop of the packet to the next tile
+   void sendPacket(tile_id_t next_tile_id, const NetPacket& packet);
+   void tracePacket(const NetPacket& packet, NetworkModel* model);
    
    // -- Network Injection/Ejection Rate Trace -- //
    static void computeTraceEnabledNetworks();
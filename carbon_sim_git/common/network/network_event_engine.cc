@@ -0,0 +1,539 @@
+#include <algorithm>
+#include <cassert>
+#include <sched.h>
+using namespace std;
+
+#include "network_event_engine.h"
+#include "network.h"
+#include "network_model.h"
+#include "transport.h"
+#include "tile.h"
+#include "tile_manager.h"
+#include "core.h"
+#include "core_model.h"
+#include "clock_converter.h"
+#include "clock_skew_minimization_object.h"
+#include "simulator.h"
+#include "config.h"
+#include "log.h"
+
+NetworkEventEngine::NetworkEventEngine(SInt32 network_id, SInt32 num_threads)
+   : _network_id(network_id)
+   , _lookahead(UINT64_MAX_)
+   , _running(false)
+   , _advance_requested(false)
+   , _synchronized(false)
+   , _horizon(UINT64_MAX_)
+   , _limiting_tile(INVALID_TILE_ID)
+   , _window_end(0)
+   , _num_busy_workers(0)
+   , _finished(false)
+   , _total_windows(0)
+   , _total_parallel_windows(0)
+   , _total_late_injections(0)
+{
+   LOG_ASSERT_ERROR(Config::getSingleton()->getProcessCount() == 1,
+                    "The network event engine requires a single process, found (%u)",
+                    Config::getSingleton()->getProcessCount());
+   LOG_ASSERT_ERROR(num_threads >= 1, "num_threads(%i)", num_threads);
+
+   SInt32 num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   SInt32 total_tiles = (SInt32) Config::getSingleton()->getTotalTiles();
+
+   // Routers
+   _router_list.resize(total_tiles);
+   for (tile_id_t tile_id = 0; tile_id < total_tiles; tile_id++)
+   {
+      Tile* tile = Sim()->getTileManager()->getTileFromID(tile_id);
+      LOG_ASSERT_ERROR(tile, "Could not find tile(%i)", tile_id);
+
+      Router& router = _router_list[tile_id];
+      router._network = tile->getNetwork();
+      router._model = tile->getNetwork()->getNetworkModel(network_id);
+      LOG_ASSERT_ERROR(router._model->supportsEventEngine(),
+                       "Network model of network(%i) does not support the event engine", network_id);
+
+      // The system tiles route their packets directly to the receivers
+      if (tile_id < num_application_tiles)
+      {
+         router._core = tile->getCore();
+         _lookahead = min<UInt64>(_lookahead, router._model->getLookahead());
+      }
+   }
+
+   // The clocks of the cores only bound each other with a clock skew
+   // minimization scheme
+   std::string scheme = Sim()->getCfg()->getString("clock_skew_minimization/scheme", "lax");
+   _synchronized = (ClockSkewMinimizationObject::parseScheme(scheme) != ClockSkewMinimizationObject::LAX);
+   if (!_synchronized)
+   {
+      LOG_PRINT_WARNING("Network(%i): no clock skew minimization scheme, the event engine routes the packets "
+                        "on injection, so the results depend on the host thread interleaving", network_id);
+   }
+
+   if (_lookahead == 0)
+   {
+      LOG_PRINT_WARNING("Network(%i): zero delay hops between routers, "
+                        "the events of a cycle may be processed out of order", network_id);
+   }
+
+   // Partition the application tiles into contiguous blocks (rows of the
+   // mesh). The system tiles go with the last block
+   num_threads = min<SInt32>(num_threads, num_application_tiles);
+   _partition_list.resize(num_threads);
+   for (SInt32 i = 0; i < num_threads; i++)
+   {
+      _partition_list[i]._first_tile_id = (i * num_application_tiles) / num_threads;
+      _partition_list[i]._last_tile_id = ((i+1) * num_application_tiles) / num_threads;
+   }
+   _partition_list[num_threads-1]._last_tile_id = total_tiles;
+
+   // The thread routing the packets processes the first partition itself
+   for (SInt32 i = 1; i < num_threads; i++)
+   {
+      Worker* worker = new Worker(this, i);
+      worker->start();
+      _worker_list.push_back(worker);
+   }
+
+   LOG_PRINT("Network(%i): event engine with %i threads, lookahead(%llu)", network_id, num_threads, _lookahead);
+}
+
+NetworkEventEngine::~NetworkEventEngine()
+{
+   _window_lock.acquire();
+   _finished = true;
+   for (vector<Worker*>::iterator it = _worker_list.begin(); it != _worker_list.end(); it++)
+      (*it)->_cond.signal();
+   _window_lock.release();
+
+   // Wait till the workers exit
+   for (vector<Worker*>::iterator it = _worker_list.begin(); it != _worker_list.end(); it++)
+   {
+      _window_lock.acquire();
+      while (!(*it)->_exited)
+      {
+         _window_lock.release();
+         sched_yield();
+         _window_lock.acquire();
+      }
+      _window_lock.release();
+      delete (*it);
+   }
+
+   LOG_ASSERT_WARNING(!_running && _injection_list.empty(), "Network(%i): packets still in the event engine", _network_id);
+   for (vector<Router>::iterator it = _router_list.begin(); it != _router_list.end(); it++)
+   {
+      while (!(*it)._event_queue.empty())
+      {
+         deletePacket((*it)._event_queue.top()._packet);
+         (*it)._event_queue.pop();
+      }
+   }
+}
+
+void
+NetworkEventEngine::injectPacket(const NetPacket& packet)
+{
+   LOG_ASSERT_ERROR(packet.node_type == NetworkModel::SEND_TILE, "node_type(%i)", packet.node_type);
+
+   // The header is copied, the payload is shared
+   NetPacket* injected_packet = new NetPacket(packet);
+   NetPacketPayload* payload = packet.getPayload();
+   if (payload)
+      payload->addRef();
+
+   _injection_lock.acquire();
+   _injection_list.push_back(injected_packet);
+   if (_running)
+   {
+      // Routed by the thread in the engine
+      _injection_lock.release();
+      return;
+   }
+   routeEvents();
+}
+
+void
+NetworkEventEngine::advance()
+{
+   _injection_lock.acquire();
+   if (_running)
+   {
+      // The thread in the engine reads the clocks again
+      _advance_requested = true;
+      _injection_lock.release();
+      return;
+   }
+   routeEvents();
+}
+
+void
+NetworkEventEngine::synchronize(tile_id_t tile_id)
+{
+   if (!_synchronized)
+      return;
+
+   Router& router = _router_list[tile_id];
+   if (router._sync_time == UINT64_MAX_)
+      return;
+
+   CoreModel* core_model = router._core->getPerformanceModel();
+   UInt64 clock = convertCycleCount(core_model->getCycleCount(), core_model->getFrequency(), router._model->getFrequency());
+   if (clock >= router._sync_time)
+   {
+      // Set again once the engine is idle
+      router._sync_time = UINT64_MAX_;
+      advance();
+   }
+}
+
+void
+NetworkEventEngine::routeEvents()
+{
+   _running = true;
+
+   bool processed = false;
+   while (true)
+   {
+      // The clocks are read again when no window could be processed
+      bool update_limits = !processed || _advance_requested;
+      _advance_requested = false;
+
+      vector<NetPacket*> injection_list;
+      injection_list.swap(_injection_list);
+      _injection_lock.release();
+
+      scheduleInjectedPackets(injection_list);
+      if (update_limits)
+         updateLimits();
+      processed = processWindow();
+
+      _injection_lock.acquire();
+      if (!processed && update_limits && _injection_list.empty() && !_advance_requested)
+         break;
+   }
+
+   updateSyncTimes();
+
+   _running = false;
+   _injection_lock.release();
+}
+
+void
+NetworkEventEngine::updateLimits()
+{
+   UInt64 min_clock = UINT64_MAX_;
+   _limiting_tile = INVALID_TILE_ID;
+
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) _router_list.size(); tile_id++)
+   {
+      Router& router = _router_list[tile_id];
+      router._clock = UINT64_MAX_;
+      if (!_synchronized || !router._core)
+         continue;
+
+      // Only a running core injects packets from its clock on
+      Core::State state = router._core->getState();
+      CoreModel* core_model = router._core->getPerformanceModel();
+      if ( ((state != Core::RUNNING) && (state != Core::WAKING_UP)) ||
+           router._network->isWaitingForPacket() || !core_model->isEnabled() )
+         continue;
+
+      router._clock = convertCycleCount(core_model->getCycleCount(), core_model->getFrequency(), router._model->getFrequency());
+      if (router._clock < min_clock)
+      {
+         min_clock = router._clock;
+         _limiting_tile = tile_id;
+      }
+   }
+
+   _horizon = (min_clock == UINT64_MAX_) ? UINT64_MAX_ : (min_clock + _lookahead);
+   for (vector<Router>::iterator it = _router_list.begin(); it != _router_list.end(); it++)
+      (*it)._limit = min<UInt64>((*it)._clock, _horizon);
+}
+
+void
+NetworkEventEngine::updateSyncTimes()
+{
+   for (vector<Router>::iterator it = _router_list.begin(); it != _router_list.end(); it++)
+      (*it)._sync_time = UINT64_MAX_;
+   if (!_synchronized)
+      return;
+
+   // No event is below the limit of its router: it is held back either by
+   // the clock of the core of its router, or by the horizon
+   for (vector<Router>::iterator it = _router_list.begin(); it != _router_list.end(); it++)
+   {
+      if ((*it)._event_queue.empty())
+         continue;
+
+      UInt64 time = (*it)._event_queue.top()._time;
+      if (time >= (*it)._clock)
+      {
+         (*it)._sync_time = min<UInt64>((UInt64) (*it)._sync_time, time + 1);
+      }
+      else if (_limiting_tile != INVALID_TILE_ID)
+      {
+         Router& limiting_router = _router_list[_limiting_tile];
+         UInt64 sync_time = (time + 1 > _lookahead) ? (time + 1 - _lookahead) : 0;
+         limiting_router._sync_time = min<UInt64>((UInt64) limiting_router._sync_time, sync_time);
+      }
+   }
+}
+
+void
+NetworkEventEngine::scheduleInjectedPackets(vector<NetPacket*>& injection_list)
+{
+   for (vector<NetPacket*>::iterator it = injection_list.begin(); it != injection_list.end(); it++)
+   {
+      NetPacket* pkt = *it;
+
+      tile_id_t sender = TILE_ID(pkt->sender);
+      LOG_ASSERT_ERROR(0 <= sender && sender < (tile_id_t) _router_list.size(), "sender(%i)", sender);
+
+      Router& router = _router_list[sender];
+      Event event(pkt->time, sender, router._num_events_scheduled ++, sender, *it);
+      if (event < router._last_event)
+         _total_late_injections ++;
+      router._event_queue.push(event);
+   }
+}
+
+bool
+NetworkEventEngine::processWindow()
+{
+   // The window starts at the earliest event
+   vector<UInt64> partition_start_list(_partition_list.size(), UINT64_MAX_);
+   UInt64 window_start = UINT64_MAX_;
+   for (UInt32 i = 0; i < _partition_list.size(); i++)
+   {
+      for (tile_id_t tile_id = _partition_list[i]._first_tile_id; tile_id < _partition_list[i]._last_tile_id; tile_id++)
+      {
+         EventQueue& event_queue = _router_list[tile_id]._event_queue;
+         if (!event_queue.empty())
+            partition_start_list[i] = min<UInt64>(partition_start_list[i], event_queue.top()._time);
+      }
+      window_start = min<UInt64>(window_start, partition_start_list[i]);
+   }
+   if (window_start >= _horizon)
+      return false;
+
+   _window_end = min<UInt64>(window_start + max<UInt64>(_lookahead, 1), _horizon);
+
+   // The partitions with an event below the limit of its router
+   vector<SInt32> busy_partition_list;
+   for (UInt32 i = 0; i < _partition_list.size(); i++)
+   {
+      if (partition_start_list[i] >= _window_end)
+         continue;
+      for (tile_id_t tile_id = _partition_list[i]._first_tile_id; tile_id < _partition_list[i]._last_tile_id; tile_id++)
+      {
+         Router& router = _router_list[tile_id];
+         if (!router._event_queue.empty() &&
+             (router._event_queue.top()._time < min<UInt64>(_window_end, router._limit)))
+         {
+            busy_partition_list.push_back(i);
+            break;
+         }
+      }
+   }
+   if (busy_partition_list.empty())
+      return false;
+
+   _total_windows ++;
+
+   if (busy_partition_list.size() == 1)
+   {
+      // No need to wake up the workers
+      processPartition(_partition_list[busy_partition_list.front()]);
+   }
+   else
+   {
+      _total_parallel_windows ++;
+
+      _window_lock.acquire();
+      for (vector<SInt32>::iterator it = busy_partition_list.begin(); it != busy_partition_list.end(); it++)
+      {
+         if (*it == 0)
+            continue;
+         Worker* worker = _worker_list[*it - 1];
+         worker->_has_work = true;
+         _num_busy_workers ++;
+         worker->_cond.signal();
+      }
+      _window_lock.release();
+
+      if (busy_partition_list.front() == 0)
+         processPartition(_partition_list[0]);
+
+      _window_lock.acquire();
+      while (_num_busy_workers > 0)
+         _window_done_cond.wait(_window_lock);
+      _window_lock.release();
+   }
+
+   exchangeEvents();
+   return true;
+}
+
+void
+NetworkEventEngine::processPartition(Partition& partition)
+{
+   for (tile_id_t tile_id = partition._first_tile_id; tile_id < partition._last_tile_id; tile_id++)
+   {
+      Router& router = _router_list[tile_id];
+      UInt64 window_end = min<UInt64>(_window_end, router._limit);
+      // Events scheduled on the router itself in the window are processed too
+      while (!router._event_queue.empty() && (router._event_queue.top()._time < window_end))
+      {
+         Event event = router._event_queue.top();
+         router._event_queue.pop();
+         router._last_event = Event(event._time, event._origin, event._seq_num, event._tile_id, NULL);
+         processEvent(router, event, partition);
+      }
+   }
+}
+
+void
+NetworkEventEngine::processEvent(Router& router, const Event& event, Partition& partition)
+{
+   NetPacket* pkt = event._packet;
+
+   queue<NetworkModel::Hop> hop_queue;
+   router._model->__routePacket(*pkt, hop_queue);
+   router._total_events_processed ++;
+
+   while (!hop_queue.empty())
+   {
+      NetworkModel::Hop hop = hop_queue.front();
+      hop_queue.pop();
+
+      NetPacket* next_pkt = new NetPacket(*pkt);
+      NetPacketPayload* payload = pkt->getPayload();
+      if (payload)
+         payload->addRef();
+      next_pkt->node_type = hop._next_node_type;
+      next_pkt->time = hop._time;
+      next_pkt->zero_load_delay = hop._zero_load_delay;
+      next_pkt->contention_delay = hop._contention_delay;
+
+      Event next_event(hop._time, event._tile_id, router._num_events_scheduled ++, hop._next_tile_id, next_pkt);
+
+      if (hop._next_node_type == NetworkModel::RECEIVE_TILE)
+      {
+         partition._delivery_list.push_back(next_event);
+      }
+      else if (hop._next_tile_id == event._tile_id)
+      {
+         router._event_queue.push(next_event);
+      }
+      else
+      {
+         LOG_ASSERT_ERROR((_lookahead == 0) || (hop._time >= _window_end),
+                          "Network(%i): hop from tile(%i) to tile(%i) at time(%llu) within the window ending at(%llu)",
+                          _network_id, event._tile_id, hop._next_tile_id, hop._time, _window_end);
+         partition._outbox.push_back(next_event);
+      }
+   }
+
+   deletePacket(event._packet);
+}
+
+void
+NetworkEventEngine::exchangeEvents()
+{
+   vector<Event> delivery_list;
+
+   for (vector<Partition>::iterator it = _partition_list.begin(); it != _partition_list.end(); it++)
+   {
+      // The order of the events in a router queue does not depend on the
+      // order they are pushed in
+      for (vector<Event>::iterator e = (*it)._outbox.begin(); e != (*it)._outbox.end(); e++)
+         _router_list[(*e)._tile_id]._event_queue.push(*e);
+      (*it)._outbox.clear();
+
+      delivery_list.insert(delivery_list.end(), (*it)._delivery_list.begin(), (*it)._delivery_list.end());
+      (*it)._delivery_list.clear();
+   }
+
+   // Send the packets to their receivers in event order
+   sort(delivery_list.begin(), delivery_list.end());
+   for (vector<Event>::iterator it = delivery_list.begin(); it != delivery_list.end(); it++)
+   {
+      NetPacket* pkt = (*it)._packet;
+      LOG_PRINT("Send packet : type %i, from {%i,%i}, to {%i,%i}, next_hop %i, tile_id %i, time %llu",
+                (SInt32) pkt->type,
+                pkt->sender.tile_id, pkt->sender.core_type,
+                pkt->receiver.tile_id, pkt->receiver.core_type,
+                (*it)._tile_id, (*it)._origin, pkt->time);
+      _router_list[(*it)._origin]._network->sendPacket((*it)._tile_id, *pkt);
+      deletePacket(pkt);
+   }
+}
+
+void
+NetworkEventEngine::deletePacket(NetPacket* packet)
+{
+   packet->releasePayload();
+   delete packet;
+}
+
+void
+NetworkEventEngine::outputSummary(ostream& out, tile_id_t tile_id)
+{
+   out << "    Lookahead (in clock cycles): " << _lookahead << endl;
+   out << "    Windows: " << _total_windows << endl;
+   out << "    Parallel Windows: " << _total_parallel_windows << endl;
+   out << "    Late Injections: " << _total_late_injections << endl;
+   out << "    Router Events Processed: " << _router_list[tile_id]._total_events_processed << endl;
+}
+
+// Worker
+
+NetworkEventEngine::Worker::Worker(NetworkEventEngine* engine, SInt32 partition_id)
+   : _engine(engine)
+   , _partition_id(partition_id)
+   , _thread(NULL)
+   , _has_work(false)
+   , _exited(false)
+{}
+
+NetworkEventEngine::Worker::~Worker()
+{
+   delete _thread;
+}
+
+void
+NetworkEventEngine::Worker::start()
+{
+   _thread = Thread::create(this);
+   _thread->run();
+}
+
+void
+NetworkEventEngine::Worker::run()
+{
+   LOG_PRINT("Network(%i): event engine worker(%i) starting", _engine->_network_id, _partition_id);
+
+   _engine->_window_lock.acquire();
+   while (true)
+   {
+      while (!_has_work && !_engine->_finished)
+         _cond.wait(_engine->_window_lock);
+      if (!_has_work)
+         break;
+
+      _engine->_window_lock.release();
+      _engine->processPartition(_engine->_partition_list[_partition_id]);
+      _engine->_window_lock.acquire();
+
+      _has_work = false;
+      if ((-- _engine->_num_busy_workers) == 0)
+         _engine->_window_done_cond.signal();
+   }
+   _exited = true;
+   _engine->_window_lock.release();
+
+   LOG_PRINT("Network(%i): event engine worker(%i) exiting", _engine->_network_id, _partition_id);
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <iostream>
+using std::vector;
+using std::priority_queue;
+using std::ostream;
+
+#include "fixed_types.h"
+#include "thread.h"
+#include "lock.h"
+#include "cond.h"
+
+class Network;
+class NetworkModel;
+class NetPacket;
+class Core;
+
+// Conservative parallel discrete-event engine for the network models that
+// route a packet hop-by-hop through the routers of the tiles
+// (emesh_hop_by_hop, atac). Without it, each hop of a packet is routed when
+// the packet reaches a tile, so the order in which the packets go through
+// the contention models of a router depends on the interleaving of the host
+// threads.
+//   Here, a hop is an event in the queue of the router it goes through,
+// ordered by (time, router that scheduled it, sequence number in that
+// router). The engine processes the events in windows of 'lookahead'
+// cycles, the minimum delay of a hop from one router to another:
+//   - within a window, a router only processes its own events, so the
+//     routers are partitioned across host threads and processed in parallel
+//   - the events a router schedules on other routers are exchanged at the
+//     end of the window (they are at least 'lookahead' cycles later, so
+//     they are in a later window)
+//   - the packets that reach their receivers in a window are sent in event
+//     order at the end of the window
+// The packets are injected by the senders, and routed by whichever thread
+// finds the engine idle.
+//   With a clock skew minimization scheme, the engine only routes the
+// events below a safe horizon: a router processes the events earlier than
+// the clock of its core (the core injects its next packets from its clock
+// on), and than the minimum clock of the cores plus the lookahead (the
+// earliest hop another core can still cause). The cores that do not run,
+// and the cores waiting for a packet, do not hold back the engine. The
+// events held back are routed when a core injects or waits for a packet,
+// exits, or reaches the time of the events at its periodic synchronization.
+// Without a scheme ('lax'), the engine routes every event on injection.
+//   A packet injected earlier than the last event processed on the router
+// of its sender is late: it is routed in the next window, out of order.
+// The memory models (sending the requests of a core waiting for a memory
+// access, or reacting to a packet on a sim thread) and the cores woken up by
+// a packet inject with no lookahead, so they can be late. Without late injections, the results do not depend on the
+// number of host threads or on their interleaving; with them, only the
+// late packets (and the packets they contend with) depend on it.
+//   The engine calls the models of every tile, so it requires a single
+// process (as the shared memory shortcut does).
+class NetworkEventEngine
+{
+public:
+   NetworkEventEngine(SInt32 network_id, SInt32 num_threads);
+   ~NetworkEventEngine();
+
+   // Route the packet from its sender to its receivers
+   void injectPacket(const NetPacket& packet);
+   // Route the events below the safe horizon
+   void advance();
+   // Periodic synchronization of an application tile: routes the events its
+   // clock was holding back, if it has reached them
+   void synchronize(tile_id_t tile_id);
+
+   UInt64 getLookahead() { return _lookahead; }
+   UInt64 getTotalWindows() { return _total_windows; }
+   UInt64 getTotalLateInjections() { return _total_late_injections; }
+   void outputSummary(ostream& out, tile_id_t tile_id);
+
+private:
+   class Event
+   {
+   public:
+      Event(UInt64 time, tile_id_t origin, UInt64 seq_num, tile_id_t tile_id, NetPacket* packet)
+         : _time(time), _origin(origin), _seq_num(seq_num), _tile_id(tile_id), _packet(packet) {}
+      ~Event() {}
+
+      // Deterministic order of the events
+      bool operator<(const Event& event) const
+      {
+         if (_time != event._time)
+            return (_time < event._time);
+         if (_origin != event._origin)
+            return (_origin < event._origin);
+         return (_seq_num < event._seq_num);
+      }
+      bool operator>(const Event& event) const { return (event < *this); }
+
+      UInt64 _time;
+      // Router that scheduled the event and its sequence number there
+      tile_id_t _origin;
+      UInt64 _seq_num;
+      // Router the event is processed on (receiver for a delivery)
+      tile_id_t _tile_id;
+      // Header of the packet for this hop, holding a reference to the payload
+      NetPacket* _packet;
+   };
+
+   typedef priority_queue<Event, vector<Event>, std::greater<Event> > EventQueue;
+
+   class Router
+   {
+   public:
+      Router()
+         : _network(NULL), _model(NULL), _core(NULL)
+         , _num_events_scheduled(0)
+         , _last_event(0, INVALID_TILE_ID, 0, INVALID_TILE_ID, NULL)
+         , _clock(UINT64_MAX_), _limit(UINT64_MAX_), _sync_time(UINT64_MAX_)
+         , _total_events_processed(0) {}
+      ~Router() {}
+
+      Network* _network;
+      NetworkModel* _model;
+      // Core of an application tile, NULL for a system tile
+      Core* _core;
+      EventQueue _event_queue;
+      UInt64 _num_events_scheduled;
+      // Last event processed (its packet is deleted)
+      Event _last_event;
+      // Clock of the core (if it holds back the engine), and the events
+      // earlier than '_limit' can be processed
+      UInt64 _clock;
+      UInt64 _limit;
+      // Clock of the core at which its periodic synchronization routes the
+      // events held back
+      volatile UInt64 _sync_time;
+      UInt64 _total_events_processed;
+   };
+
+   // Routers processed by one host thread
+   class Partition
+   {
+   public:
+      Partition()
+         : _first_tile_id(0), _last_tile_id(0) {}
+      ~Partition() {}
+
+      tile_id_t _first_tile_id;
+      tile_id_t _last_tile_id;
+      // Events for the routers of other partitions, and deliveries
+      vector<Event> _outbox;
+      vector<Event> _delivery_list;
+   };
+
+   class Worker : public Runnable
+   {
+   public:
+      Worker(NetworkEventEngine* engine, SInt32 partition_id);
+      ~Worker();
+
+      void start();
+      void run();
+
+      NetworkEventEngine* _engine;
+      SInt32 _partition_id;
+      Thread* _thread;
+      ConditionVariable _cond;
+      bool _has_work;
+      bool _exited;
+   };
+
+   friend class Worker;
+
+   SInt32 _network_id;
+   UInt64 _lookahead;
+
+   vector<Router> _router_list;
+   vector<Partition> _partition_list;
+   vector<Worker*> _worker_list;
+
+   // Packets injected since the last window, and whether a thread is routing
+   Lock _injection_lock;
+   vector<NetPacket*> _injection_list;
+   bool _running;
+   // Clocks changed while a thread was routing
+   bool _advance_requested;
+
+   // Safe horizon, and the tile whose clock sets it
+   bool _synchronized;
+   UInt64 _horizon;
+   tile_id_t _limiting_tile;
+
+   // End of the current window (excluded)
+   UInt64 _window_end;
+   // Protects the worker state
+   Lock _window_lock;
+   ConditionVariable _window_done_cond;
+   SInt32 _num_busy_workers;
+   bool _finished;
+
+   // Event Counters
+   UInt64 _total_windows;
+   UInt64 _total_parallel_windows;
+   UInt64 _total_late_injections;
+
+   // Called with '_injection_lock' held, releases it
+   void routeEvents();
+   void updateLimits();
+   void updateSyncTimes();
+   void scheduleInjectedPackets(vector<NetPacket*>& injection_list);
+   void deletePacket(NetPacket* packet);
+   bool processWindow();
+   void processPartition(Partition& partition);
+   void processEvent(Router& router, const Event& event, Partition& partition);
+   void exchangeEvents();
+};
@@ -200,6 +200,11 @@ NetworkModel::getModeledLength(const NetPacket& pkt)
       UInt32 data_size = getNetwork()->getTile()->getCore()->getMemoryManager()->getModeledLength(pkt.data);
       return metadata_size + data_size;
    }
+   else if (pkt.type == NETWORK_TRACE_REPLAY_TYPE)
+   {
+      // The payload is not materialized (see tools/network_trace_driver)
+      return pkt.length;
+   }
    else
    {
       return pkt.bufferSize();
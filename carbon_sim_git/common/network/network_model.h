@@ -90,6 +90,12 @@ public:
    // Tracing Network Injection/Ejection Rate
    void popCurrentUtilizationStatistics(UInt64& total_flits_sent, UInt64& total_flits_broadcasted, UInt64& total_flits_received);
 
+   // Network Event Engine (see network_event_engine.h): only the models that
+   // route hop-by-hop through the tiles support it. The lookahead is the
+   // minimum delay of a hop from the router of this tile to that of another
+   virtual bool supportsEventEngine() { return false; }
+   virtual UInt64 getLookahead() { return 0; }
+
 protected:
    class NextDest
    {
@@ -0,0 +1,110 @@
+#include <cmath>
+#include <queue>
+using std::queue;
+using std::make_pair;
+
+#include "network_traffic.h"
+#include "utils.h"
+#include "log.h"
+
+static const char* _type_names[SyntheticTrafficPattern::NUM_TYPES] =
+{
+   "uniform_random", "bit_complement", "shuffle", "transpose", "tornado", "nearest_neighbor", "broadcast"
+};
+
+SyntheticTrafficPattern::SyntheticTrafficPattern(Type type, SInt32 num_tiles)
+   : _type(type)
+   , _num_tiles(num_tiles)
+{
+   LOG_ASSERT_ERROR((type >= 0) && (type < NUM_TYPES), "Unrecognized Traffic Pattern(%i)", type);
+   LOG_ASSERT_ERROR(isPower2(num_tiles) && isPerfectSquare(num_tiles) && (num_tiles > 1),
+                    "Num Tiles(%i) must be a power of 2, a perfect square and > 1", num_tiles);
+   _mesh_width = (SInt32) sqrt((double) num_tiles);
+   _mesh_height = num_tiles / _mesh_width;
+}
+
+tile_id_t
+SyntheticTrafficPattern::computeReceiver(tile_id_t sender, UInt64 rand_num) const
+{
+   SInt32 sx = sender % _mesh_width;
+   SInt32 sy = sender / _mesh_width;
+   SInt32 mask = _num_tiles - 1;
+
+   switch (_type)
+   {
+   case UNIFORM_RANDOM:
+      return (sender + 1 + (rand_num % (_num_tiles - 1))) % _num_tiles;
+   case BIT_COMPLEMENT:
+      return (~sender) & mask;
+   case SHUFFLE:
+      return ((sender >> (floorLog2(_num_tiles) - 1)) & 1) | ((sender << 1) & mask);
+   case TRANSPOSE:
+      return (sx * _mesh_width) + sy;
+   case TORNADO:
+      return (((sy + _mesh_height/2) % _mesh_height) * _mesh_width) + ((sx + _mesh_width/2) % _mesh_width);
+   case NEAREST_NEIGHBOR:
+      return (((sy + 1) % _mesh_height) * _mesh_width) + ((sx + 1) % _mesh_width);
+   case BROADCAST:
+      return NetPacket::BROADCAST;
+   default:
+      LOG_PRINT_ERROR("Unrecognized Traffic Pattern(%i)", _type);
+      return INVALID_TILE_ID;
+   }
+}
+
+SyntheticTrafficPattern::Type
+SyntheticTrafficPattern::parseType(string type)
+{
+   for (SInt32 i = 0; i < NUM_TYPES; i++)
+   {
+      if (type == _type_names[i])
+         return (Type) i;
+   }
+   return NUM_TYPES;
+}
+
+const char*
+SyntheticTrafficPattern::getName(Type type)
+{
+   LOG_ASSERT_ERROR((type >= 0) && (type < NUM_TYPES), "Unrecognized Traffic Pattern(%i)", type);
+   return _type_names[type];
+}
+
+UInt64
+routePacketThroughModels(const NetPacket& packet, const vector<NetworkModel*>& model_list,
+                         vector<pair<tile_id_t, NetPacket> >& received_packets)
+{
+   queue<pair<tile_id_t, NetPacket> > hop_queue;
+   hop_queue.push(make_pair(TILE_ID(packet.sender), packet));
+
+   UInt64 num_hops = 0;
+   while (!hop_queue.empty())
+   {
+      tile_id_t tile_id = hop_queue.front().first;
+      NetPacket pkt = hop_queue.front().second;
+      hop_queue.pop();
+
+      if (pkt.node_type == NetworkModel::RECEIVE_TILE)
+      {
+         received_packets.push_back(make_pair(tile_id, pkt));
+         continue;
+      }
+
+      queue<NetworkModel::Hop> next_hops;
+      model_list[tile_id]->__routePacket(pkt, next_hops);
+      num_hops ++;
+
+      while (!next_hops.empty())
+      {
+         const NetworkModel::Hop& hop = next_hops.front();
+         NetPacket next_pkt = pkt;
+         next_pkt.node_type = hop._next_node_type;
+         next_pkt.time = hop._time;
+         next_pkt.zero_load_delay = hop._zero_load_delay;
+         next_pkt.contention_delay = hop._contention_delay;
+         hop_queue.push(make_pair(hop._next_tile_id, next_pkt));
+         next_hops.pop();
+      }
+   }
+   return num_hops;
+}
@@ -0,0 +1,66 @@
+#ifndef NETWORK_TRAFFIC_H
+#define NETWORK_TRAFFIC_H
+
+#include <vector>
+#include <string>
+#include <utility>
+using std::vector;
+using std::string;
+using std::pair;
+
+#include "network.h"
+#include "network_model.h"
+#include "fixed_types.h"
+
+// Traffic of the tools and benchmarks that drive the network models without
+// the network threads (tools/network_trace_driver,
+// tests/unit/network_routing_throughput).
+
+// The synthetic traffic patterns of synthetic_network_traffic_generator, and a
+// broadcast from every tile. The tiles are laid out as a square mesh: their
+// number must be a power of 2 and a perfect square.
+class SyntheticTrafficPattern
+{
+public:
+   enum Type
+   {
+      UNIFORM_RANDOM = 0,
+      BIT_COMPLEMENT,
+      SHUFFLE,
+      TRANSPOSE,
+      TORNADO,
+      NEAREST_NEIGHBOR,
+      BROADCAST,
+      NUM_TYPES
+   };
+
+   SyntheticTrafficPattern(Type type, SInt32 num_tiles);
+   ~SyntheticTrafficPattern() {}
+
+   Type getType() const { return _type; }
+
+   // Receiver of a packet of 'sender' (NetPacket::BROADCAST for a broadcast).
+   // A uniform random packet goes to the other tile 'rand_num' tiles away,
+   // modulo the number of the other tiles
+   tile_id_t computeReceiver(tile_id_t sender, UInt64 rand_num) const;
+
+   // NUM_TYPES for an unrecognized name
+   static Type parseType(string type);
+   static const char* getName(Type type);
+
+private:
+   Type _type;
+   SInt32 _num_tiles;
+   SInt32 _mesh_width;
+   SInt32 _mesh_height;
+};
+
+// Route the packet from its sender to its receivers, through the models of
+// the tiles it goes through (indexed by tile id), as the network threads do.
+// The packets that reach a receiver are appended to 'received_packets' with
+// the receiver, without being processed by its model. Returns the number of
+// hops routed
+UInt64 routePacketThroughModels(const NetPacket& packet, const vector<NetworkModel*>& model_list,
+                                vector<pair<tile_id_t, NetPacket> >& received_packets);
+
+#endif // NETWORK_TRAFFIC_H
@@ -29,6 +29,10 @@ enum PacketType
    CLOCK_SKEW_MINIMIZATION,
    RESET_CACHE_COUNTERS,   // Deprecated
    DISABLE_CACHE_COUNTERS, // Deprecated
+   SYNC_SERVER_REQUEST_TYPE,
+   SYNC_SERVER_RESPONSE_TYPE,
+   LAMBDA_QUEUE_CREDIT_TYPE,
+   NETWORK_TRACE_REPLAY_TYPE, // Packets replayed by the network trace driver: 'length' is the modeled length
    NUM_PACKET_TYPES
 };
 
@@ -80,7 +84,11 @@ static EStaticNetwork g_type_to_static_network_map[] __attribute__((unused)) =
    STATIC_NETWORK_SYSTEM,        // SYSTEM_INITIALIZATION_FINI
    STATIC_NETWORK_SYSTEM,        // CLOCK_SKEW_MINIMIZATION
    STATIC_NETWORK_SYSTEM,        // RESET_CACHE_COUNTERS
-   STATIC_NETWORK_SYSTEM         // DISABLE_CACHE_COUNTERS
+   STATIC_NETWORK_SYSTEM,        // DISABLE_CACHE_COUNTERS
+   STATIC_NETWORK_USER_1,        // SYNC_SERVER_REQ
+   STATIC_NETWORK_USER_1,        // SYNC_SERVER_RESP
+   STATIC_NETWORK_USER_1,        // LAMBDA_QUEUE_CREDIT
+   STATIC_NETWORK_USER_2         // NETWORK_TRACE_REPLAY
 };
 
 #endif
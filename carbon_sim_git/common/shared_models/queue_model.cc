@@ -4,6 +4,7 @@
 #include "queue_model_basic.h"
 #include "queue_model_history_list.h"
 #include "queue_model_history_tree.h"
+#include "checkpoint.h"
 #include "log.h"
 
 QueueModel::QueueModel(Type type)
@@ -60,3 +61,32 @@ QueueModel::getQueueUtilization()
    UInt64 total_cycles = _last_request_time;
    return (total_cycles > 0) ? (((float) _total_utilized_cycles) / total_cycles) : 0.0;
 }
+
+void
+QueueModel::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("queue_model");
+   writer << (UInt32) _type;
+   writer << _total_utilized_cycles << _last_request_time << _total_requests;
+   checkpointHistory(writer);
+   writer.endSection();
+}
+
+void
+QueueModel::restore(CheckpointReader& reader)
+{
+   reader.beginSection("queue_model");
+   UInt32 type;
+   reader >> type;
+   if (type == (UInt32) _type)
+   {
+      reader >> _total_utilized_cycles >> _last_request_time >> _total_requests;
+      restoreHistory(reader);
+   }
+   else
+   {
+      LOG_PRINT_WARNING("Queue model type(%u) differs from the checkpoint(%u), starting with an empty queue",
+                        _type, type);
+   }
+   reader.endSection();
+}
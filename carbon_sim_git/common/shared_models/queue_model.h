@@ -4,6 +4,9 @@
 
 #include "fixed_types.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class QueueModel
 {
 public:
@@ -25,9 +28,16 @@ public:
 
    static QueueModel* create(std::string model_type, UInt64 min_processing_time);
 
+   // The history is only restored into a queue model of the same type
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 protected:
    void updateQueueUtilizationCounters(UInt64 request_time, UInt64 processing_time, UInt64 queue_delay);
 
+   virtual void checkpointHistory(CheckpointWriter& writer) = 0;
+   virtual void restoreHistory(CheckpointReader& reader) = 0;
+
 private:
    Type _type;
 
@@ -2,6 +2,7 @@
 #include "config.h"
 #include "queue_model_basic.h"
 #include "utils.h"
+#include "checkpoint.h"
 #include "log.h"
 
 QueueModelBasic::QueueModelBasic()
@@ -59,3 +60,17 @@ QueueModelBasic::computeQueueDelay(UInt64 pkt_time, UInt64 processing_time, tile
 
    return queue_delay;
 }
+
+// The window of the moving average is not kept, it fills up again with the
+// next requests
+void
+QueueModelBasic::checkpointHistory(CheckpointWriter& writer)
+{
+   writer << _queue_time;
+}
+
+void
+QueueModelBasic::restoreHistory(CheckpointReader& reader)
+{
+   reader >> _queue_time;
+}
@@ -12,6 +12,10 @@ public:
 
    UInt64 computeQueueDelay(UInt64 pkt_time, UInt64 processing_time, tile_id_t requester = INVALID_TILE_ID);
 
+protected:
+   void checkpointHistory(CheckpointWriter& writer);
+   void restoreHistory(CheckpointReader& reader);
+
 private:
    UInt64 _queue_time;
    MovingAverage<UInt64>* _moving_average;
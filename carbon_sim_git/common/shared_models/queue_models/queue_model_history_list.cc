@@ -5,6 +5,7 @@
 #include "tile_manager.h"
 #include "config.h"
 #include "queue_model_history_list.h"
+#include "checkpoint.h"
 #include "log.h"
 
 QueueModelHistoryList::QueueModelHistoryList(UInt64 min_processing_time)
@@ -144,3 +145,35 @@ QueueModelHistoryList::computeUsingHistoryList(UInt64 pkt_time, UInt64 processin
 
    return queue_delay;
 }
+
+void
+QueueModelHistoryList::checkpointHistory(CheckpointWriter& writer)
+{
+   _queue_model_m_g_1->checkpoint(writer);
+   writer << _total_requests_using_analytical_model;
+
+   writer << (UInt32) _free_interval_list.size();
+   for (FreeIntervalList::iterator it = _free_interval_list.begin(); it != _free_interval_list.end(); it++)
+      writer << (*it).first << (*it).second;
+}
+
+void
+QueueModelHistoryList::restoreHistory(CheckpointReader& reader)
+{
+   _queue_model_m_g_1->restore(reader);
+   reader >> _total_requests_using_analytical_model;
+
+   UInt32 num_intervals;
+   reader >> num_intervals;
+   LOG_ASSERT_ERROR(num_intervals >= 1, "Free Interval list size < 1");
+   _free_interval_list.clear();
+   for (UInt32 i = 0; i < num_intervals; i++)
+   {
+      std::pair<UInt64,UInt64> interval;
+      reader >> interval.first >> interval.second;
+      _free_interval_list.push_back(interval);
+   }
+   // Keep the newest intervals if the list is shorter in this run
+   while (_free_interval_list.size() > _max_free_interval_list_size)
+      _free_interval_list.pop_front();
+}
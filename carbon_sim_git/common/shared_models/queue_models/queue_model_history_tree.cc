@@ -1,11 +1,14 @@
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
 #include <cassert>
+#include <vector>
+#include <algorithm>
 
 #include "simulator.h"
 #include "tile_manager.h"
 #include "config.h"
 #include "queue_model_history_tree.h"
+#include "checkpoint.h"
 #include "log.h"
 
 #define PAIR(x_,y_)  (make_pair<UInt64,UInt64>(x_,y_))
@@ -168,3 +171,47 @@ QueueModelHistoryTree::releaseNode(IntervalTree::Node* node)
          "_free_memory_block_list_tail(%i)", _free_memory_block_list_tail);
    _free_memory_block_list[_free_memory_block_list_tail] = index;
 }
+
+void
+QueueModelHistoryTree::checkpointHistory(CheckpointWriter& writer)
+{
+   _queue_model_m_g_1->checkpoint(writer);
+   writer << _total_requests_using_analytical_model;
+
+   // The nodes in the tree are the memory blocks that are not free
+   vector<bool> free_block(_max_free_interval_size, false);
+   for (SInt32 i = 0; i <= _free_memory_block_list_tail; i++)
+      free_block[_free_memory_block_list[i]] = true;
+
+   writer << (UInt32) _interval_tree->size();
+   for (SInt32 i = 0; i < _max_free_interval_size; i++)
+   {
+      if (!free_block[i])
+         writer << _memory_blocks[i].interval.first << _memory_blocks[i].interval.second;
+   }
+}
+
+void
+QueueModelHistoryTree::restoreHistory(CheckpointReader& reader)
+{
+   _queue_model_m_g_1->restore(reader);
+   reader >> _total_requests_using_analytical_model;
+
+   UInt32 num_intervals;
+   reader >> num_intervals;
+   vector<pair<UInt64,UInt64> > intervals(num_intervals);
+   for (UInt32 i = 0; i < num_intervals; i++)
+      reader >> intervals[i].first >> intervals[i].second;
+   LOG_ASSERT_ERROR(num_intervals >= 1, "Empty history tree in the checkpoint");
+
+   // Rebuild the tree, keeping the newest intervals if it is smaller in this run
+   sort(intervals.begin(), intervals.end());
+   UInt32 first = (num_intervals > (UInt32) _max_free_interval_size) ? (num_intervals - _max_free_interval_size) : 0;
+
+   delete _interval_tree;
+   releaseMemory();
+   allocateMemory();
+   _interval_tree = new IntervalTree(allocateNode(intervals[first]));
+   for (UInt32 i = first + 1; i < num_intervals; i++)
+      _interval_tree->insert(allocateNode(intervals[i]));
+}
@@ -14,6 +14,10 @@ public:
    UInt64 computeQueueDelay(UInt64 pkt_time, UInt64 processing_time, tile_id_t requester = INVALID_TILE_ID);
    UInt64 getTotalRequestsUsingAnalyticalModel() { return _total_requests_using_analytical_model; }
 
+protected:
+   void checkpointHistory(CheckpointWriter& writer);
+   void restoreHistory(CheckpointReader& reader);
+
 private:
    void allocateMemory();
    void releaseMemory();
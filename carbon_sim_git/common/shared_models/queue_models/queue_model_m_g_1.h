@@ -2,6 +2,9 @@
 
 #include "fixed_types.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class QueueModelMG1
 {
 public:
@@ -11,6 +14,9 @@ public:
    UInt64 computeQueueDelay(UInt64 pkt_time, UInt64 service_time, tile_id_t requester = INVALID_TILE_ID);
    void updateQueue(UInt64 pkt_time, UInt64 service_time, UInt64 waiting_time_queue);
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
    // Service Time distribution Parameters
    volatile double _sigma_service_time_square;
@@ -6,6 +6,8 @@
 #include "clock_skew_minimization_object.h"
 #include "lax_barrier_sync_client.h"
 #include "lax_barrier_sync_server.h"
+#include "lax_barrier_tree_sync_client.h"
+#include "lax_barrier_tree_sync_server.h"
 #include "lax_p2p_sync_client.h"
 
 #include "log.h"
@@ -25,6 +27,8 @@ ClockSkewMinimizationObject::parseScheme(std::string scheme)
       return LAX;
    else if (scheme == "lax_barrier")
       return LAX_BARRIER;
+   else if (scheme == "lax_barrier_tree")
+      return LAX_BARRIER_TREE;
    else if (scheme == "lax_p2p")
       return LAX_P2P;
    else
@@ -47,6 +51,9 @@ ClockSkewMinimizationClient::create(std::string scheme_str, Core* core)
       case LAX_BARRIER:
          return new LaxBarrierSyncClient(core);
 
+      case LAX_BARRIER_TREE:
+         return new LaxBarrierTreeSyncClient(core);
+
       case LAX_P2P:
          return new LaxP2PSyncClient(core);
 
@@ -65,6 +72,7 @@ ClockSkewMinimizationManager::create(std::string scheme_str)
    {
       case LAX:
       case LAX_BARRIER:
+      case LAX_BARRIER_TREE:
       case LAX_P2P:
          return (ClockSkewMinimizationManager*) NULL;
 
@@ -87,6 +95,9 @@ ClockSkewMinimizationServer::create(std::string scheme_str, Network& network, Un
       case LAX_BARRIER:
          return new LaxBarrierSyncServer(network, recv_buff);
 
+      case LAX_BARRIER_TREE:
+         return new LaxBarrierTreeSyncServer(network, recv_buff);
+
       case LAX_P2P:
          return (ClockSkewMinimizationServer*) NULL;
 
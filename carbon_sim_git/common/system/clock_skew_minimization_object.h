@@ -17,6 +17,7 @@ public:
    {
       LAX = 0,
       LAX_BARRIER,
+      LAX_BARRIER_TREE,
       LAX_P2P,
       NUM_SCHEMES
    };
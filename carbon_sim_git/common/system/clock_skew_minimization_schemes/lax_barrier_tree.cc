@@ -0,0 +1,197 @@
+#include "lax_barrier_tree.h"
+#include "simulator.h"
+#include "config.h"
+#include "log.h"
+
+LaxBarrierTree::LaxBarrierTree()
+{
+   UInt32 fan_in = 0;
+   bool process_aligned = false;
+   try
+   {
+      fan_in = (UInt32) Sim()->getCfg()->getInt("clock_skew_minimization/lax_barrier_tree/fan_in");
+      process_aligned = Sim()->getCfg()->getBool("clock_skew_minimization/lax_barrier_tree/process_aligned");
+   }
+   catch(...)
+   {
+      LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/lax_barrier_tree' parameters from the config file");
+   }
+   LOG_ASSERT_ERROR(fan_in >= 2, "clock_skew_minimization/lax_barrier_tree/fan_in(%u) must be >= 2", fan_in);
+
+   Config* config = Config::getSingleton();
+   UInt32 num_application_tiles = config->getApplicationTiles();
+
+   std::vector< std::vector<tile_id_t> > groups;
+   if (process_aligned)
+   {
+      for (UInt32 proc_num = 0; proc_num < config->getProcessCount(); proc_num++)
+      {
+         const Config::TileList& tile_list = config->getTileListForProcess(proc_num);
+         std::vector<tile_id_t> group;
+         for (Config::TileList::const_iterator it = tile_list.begin(); it != tile_list.end(); it++)
+         {
+            if (config->isApplicationTile(*it))
+               group.push_back(*it);
+         }
+         if (!group.empty())
+            groups.push_back(group);
+      }
+   }
+   else
+   {
+      groups.push_back(std::vector<tile_id_t>());
+      for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_application_tiles; tile_id++)
+         groups.back().push_back(tile_id);
+   }
+
+   m_root = build(groups, fan_in, num_application_tiles, m_parent);
+
+   m_children.resize(num_application_tiles);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_application_tiles; tile_id++)
+   {
+      if (m_parent[tile_id] != INVALID_TILE_ID)
+         m_children[m_parent[tile_id]].push_back(tile_id);
+   }
+}
+
+LaxBarrierTree::~LaxBarrierTree()
+{}
+
+tile_id_t
+LaxBarrierTree::build(const std::vector< std::vector<tile_id_t> >& groups, UInt32 fan_in,
+                      UInt32 num_tiles, std::vector<tile_id_t>& parent)
+{
+   parent.assign(num_tiles, INVALID_TILE_ID);
+
+   std::vector<tile_id_t> group_roots;
+   for (UInt32 i = 0; i < groups.size(); i++)
+   {
+      const std::vector<tile_id_t>& group = groups[i];
+      for (UInt32 j = 1; j < group.size(); j++)
+         parent[group[j]] = group[(j-1) / fan_in];
+      group_roots.push_back(group[0]);
+   }
+
+   for (UInt32 j = 1; j < group_roots.size(); j++)
+      parent[group_roots[j]] = group_roots[(j-1) / fan_in];
+
+   return group_roots[0];
+}
+
+// -- LaxBarrierTreeNode -- //
+
+static const UInt64 NO_WAIT_TIME = ~((UInt64) 0);
+
+LaxBarrierTreeNode::LaxBarrierTreeNode(tile_id_t parent, const std::vector<tile_id_t>& children,
+                                       UInt64 first_barrier_time)
+   : m_parent(parent)
+   , m_children(children)
+   , m_epoch(0)
+   , m_next_barrier_time(first_barrier_time)
+   , m_waiting(false)
+   , m_wait_time(0)
+   , m_self_pending(false)
+   , m_num_pending_children(0)
+   , m_children_min_wait_time(NO_WAIT_TIME)
+   // Nothing is expected to reach the first barrier, the MCP waits for
+   // the arrival of every running tile
+   , m_done_sent(true)
+{}
+
+LaxBarrierTreeNode::~LaxBarrierTreeNode()
+{}
+
+void
+LaxBarrierTreeNode::processBarrierWait(UInt64 time)
+{
+   if (time < m_next_barrier_time)
+   {
+      LOG_PRINT("Sent 'SIM_BARRIER_RELEASE' immediately time(%llu), m_next_barrier_time(%llu)", time, m_next_barrier_time);
+      releaseCore();
+      return;
+   }
+
+   m_waiting = true;
+   m_wait_time = time;
+
+   if (m_self_pending)
+   {
+      m_self_pending = false;
+      checkSubtreeDone();
+   }
+   else
+   {
+      // The MCP did not expect this tile to reach the barrier
+      sendLateArrival(m_epoch, time);
+   }
+}
+
+void
+LaxBarrierTreeNode::processBarrierRelease(UInt32 epoch, UInt64 next_barrier_time, bool running)
+{
+   m_epoch = epoch;
+   m_next_barrier_time = next_barrier_time;
+
+   if (m_waiting && (m_wait_time < m_next_barrier_time))
+   {
+      m_waiting = false;
+      releaseCore();
+   }
+
+   m_self_pending = running && !m_waiting;
+
+   m_num_pending_children = m_children.size();
+   m_children_min_wait_time = NO_WAIT_TIME;
+   m_done_sent = false;
+
+   checkSubtreeDone();
+}
+
+void
+LaxBarrierTreeNode::processSubtreeDone(UInt32 epoch, UInt64 min_wait_time)
+{
+   LOG_ASSERT_ERROR(epoch == m_epoch && m_num_pending_children > 0,
+                    "Unexpected subtree done, epoch(%u), m_epoch(%u), pending children(%u)",
+                    epoch, m_epoch, m_num_pending_children);
+
+   m_num_pending_children --;
+   if (min_wait_time < m_children_min_wait_time)
+      m_children_min_wait_time = min_wait_time;
+
+   checkSubtreeDone();
+}
+
+void
+LaxBarrierTreeNode::processExcuse(UInt32 epoch)
+{
+   // The excuse may be for an earlier barrier if the core resumed since
+   if (epoch != m_epoch)
+      return;
+
+   if (m_self_pending)
+   {
+      m_self_pending = false;
+      checkSubtreeDone();
+   }
+   else if (m_waiting)
+   {
+      // The core resumed and reached the barrier before the excuse came in,
+      // so the tree took its arrival but the MCP no longer counts on the
+      // tree for it
+      sendLateArrival(m_epoch, m_wait_time);
+   }
+}
+
+void
+LaxBarrierTreeNode::checkSubtreeDone()
+{
+   if (m_done_sent || m_self_pending || (m_num_pending_children > 0))
+      return;
+
+   UInt64 min_wait_time = m_children_min_wait_time;
+   if (m_waiting && (m_wait_time < min_wait_time))
+      min_wait_time = m_wait_time;
+
+   sendSubtreeDone(m_parent, m_epoch, min_wait_time);
+   m_done_sent = true;
+}
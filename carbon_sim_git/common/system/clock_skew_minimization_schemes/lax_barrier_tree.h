@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "fixed_types.h"
+
+// Shape of the combining tree of the lax_barrier_tree scheme.
+//   Every application tile is a node of the tree and its parent is another
+// tile, except for the root whose parent is the MCP. The tiles of a group
+// are laid out as a heap with 'fan_in' children per node and the roots of
+// the groups as another heap, so a group root has at most 2 * fan_in
+// children and the depth is O(log N). With 'process_aligned' set, there is
+// one group per process and only the group roots talk across processes.
+class LaxBarrierTree
+{
+public:
+   // Message types, as the first UInt32 of a CLOCK_SKEW_MINIMIZATION packet
+   // (or after MCP_MESSAGE_CLOCK_SKEW_MINIMIZATION for the MCP)
+   enum MsgType
+   {
+      BARRIER_WAIT = 0,       // tile -> its node: time
+      BARRIER_RELEASE,        // parent -> node: epoch, next barrier time, running tiles
+      SUBTREE_DONE,           // node -> parent: epoch, min waiting time in the subtree
+      EXCUSE,                 // MCP -> node: epoch
+      LATE_ARRIVAL            // node -> MCP: epoch, time
+   };
+
+   LaxBarrierTree();
+   ~LaxBarrierTree();
+
+   tile_id_t getRoot() const                          { return m_root; }
+   tile_id_t getParent(tile_id_t tile_id) const       { return m_parent[tile_id]; }
+   const std::vector<tile_id_t>& getChildren(tile_id_t tile_id) const
+   { return m_children[tile_id]; }
+
+   // Builds the tree over the tiles in 'groups', tile ids must be < num_tiles
+   static tile_id_t build(const std::vector< std::vector<tile_id_t> >& groups, UInt32 fan_in,
+                          UInt32 num_tiles, std::vector<tile_id_t>& parent);
+
+private:
+   tile_id_t m_root;
+   std::vector<tile_id_t> m_parent;
+   std::vector< std::vector<tile_id_t> > m_children;
+};
+
+// Node of a tile in the combining tree (see LaxBarrierTreeSyncClient),
+// independent of how its messages are carried
+class LaxBarrierTreeNode
+{
+public:
+   LaxBarrierTreeNode(tile_id_t parent, const std::vector<tile_id_t>& children, UInt64 first_barrier_time);
+   virtual ~LaxBarrierTreeNode();
+
+   // Core of the tile waiting at the barrier at 'time'
+   void processBarrierWait(UInt64 time);
+   // 'running' tells whether the MCP expects the core at the next barrier
+   void processBarrierRelease(UInt32 epoch, UInt64 next_barrier_time, bool running);
+   void processSubtreeDone(UInt32 epoch, UInt64 min_wait_time);
+   void processExcuse(UInt32 epoch);
+
+   tile_id_t getParent() const                        { return m_parent; }
+   const std::vector<tile_id_t>& getChildren() const  { return m_children; }
+   UInt32 getEpoch() const                            { return m_epoch; }
+
+protected:
+   virtual void releaseCore() = 0;
+   // To the parent, or to the MCP if 'parent' is INVALID_TILE_ID
+   virtual void sendSubtreeDone(tile_id_t parent, UInt32 epoch, UInt64 min_wait_time) = 0;
+   virtual void sendLateArrival(UInt32 epoch, UInt64 time) = 0;
+
+private:
+   tile_id_t m_parent;
+   std::vector<tile_id_t> m_children;
+
+   UInt32 m_epoch;
+   UInt64 m_next_barrier_time;
+   // Core waiting at the barrier
+   bool m_waiting;
+   UInt64 m_wait_time;
+   // Core expected to reach the barrier in this epoch
+   bool m_self_pending;
+   UInt32 m_num_pending_children;
+   UInt64 m_children_min_wait_time;
+   bool m_done_sent;
+
+   void checkSubtreeDone();
+};
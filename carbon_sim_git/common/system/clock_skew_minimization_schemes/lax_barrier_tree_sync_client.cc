@@ -0,0 +1,222 @@
+#include <cassert>
+
+#include "tile.h"
+#include "lax_barrier_tree_sync_client.h"
+#include "simulator.h"
+#include "config.h"
+#include "message_types.h"
+#include "packet_type.h"
+#include "packetize.h"
+#include "network.h"
+#include "core.h"
+#include "core_model.h"
+#include "clock_converter.h"
+#include "fxsupport.h"
+#include "log.h"
+
+UInt64 LaxBarrierTreeSyncClient::MAX_TIME = ~((UInt64) 0);
+
+LaxBarrierTreeSyncClient::LaxBarrierTreeSyncClient(Core* core):
+   m_core(core),
+   m_tree_node(NULL)
+{
+   try
+   {
+      m_barrier_interval = (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/lax_barrier_tree/quantum");
+   }
+   catch(...)
+   {
+      LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/lax_barrier_tree/quantum' from the config file");
+   }
+   m_next_sync_time = m_barrier_interval;
+
+   tile_id_t tile_id = m_core->getTile()->getId();
+   if (Config::getSingleton()->isApplicationTile(tile_id))
+   {
+      LaxBarrierTree tree;
+      m_tree_node = new TreeNode(m_core, tree.getParent(tile_id), tree.getChildren(tile_id), m_barrier_interval);
+
+      // Register Call-back
+      m_core->getNetwork()->registerCallback(CLOCK_SKEW_MINIMIZATION, ClockSkewMinimizationClientNetworkCallback, this);
+   }
+}
+
+LaxBarrierTreeSyncClient::~LaxBarrierTreeSyncClient()
+{
+   if (m_tree_node)
+   {
+      m_core->getNetwork()->unregisterCallback(CLOCK_SKEW_MINIMIZATION);
+      delete m_tree_node;
+   }
+}
+
+void
+LaxBarrierTreeSyncClient::synchronize(UInt64 cycle_count)
+{
+   UnstructuredBuffer m_send_buff;
+   UnstructuredBuffer m_recv_buff;
+
+   // Floating Point Save/Restore
+   FloatingPointHandler floating_point_handler;
+
+   if (cycle_count == 0)
+      cycle_count = m_core->getPerformanceModel()->getCycleCount();
+
+   // Convert from tile clock to global clock
+   UInt64 curr_time = convertCycleCount(cycle_count, m_core->getPerformanceModel()->getFrequency(), 1.0);
+
+   if (curr_time >= m_next_sync_time)
+   {
+      // Send 'SIM_BARRIER_WAIT' to the tree node of this tile
+      UInt32 msg_type = LaxBarrierTree::BARRIER_WAIT;
+
+      m_send_buff << msg_type << curr_time;
+      m_core->getNetwork()->netSend(m_core->getId(), CLOCK_SKEW_MINIMIZATION, m_send_buff.getBuffer(), m_send_buff.size());
+
+      LOG_PRINT("Core(%i, %i), curr_time(%llu), m_next_sync_time(%llu) sent SIM_BARRIER_WAIT", m_core->getId().tile_id, m_core->getId().core_type, curr_time, m_next_sync_time);
+
+      // Receive 'BARRIER_RELEASE' response
+      NetPacket recv_pkt;
+      recv_pkt = m_core->getNetwork()->netRecv(m_core->getId(), m_core->getId(), MCP_SYSTEM_RESPONSE_TYPE);
+      assert(recv_pkt.length == sizeof(int));
+
+      unsigned int dummy;
+      m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
+      m_recv_buff >> dummy;
+      assert(dummy == BARRIER_RELEASE);
+
+      LOG_PRINT("Tile(%i) received SIM_BARRIER_RELEASE", m_core->getTile()->getId());
+
+      // Update 'm_next_sync_time'
+      m_next_sync_time = ((curr_time / m_barrier_interval) * m_barrier_interval) + m_barrier_interval;
+
+      // Delete the data buffer
+      delete [] (Byte*) recv_pkt.data;
+   }
+}
+
+// Called by network thread
+void
+LaxBarrierTreeSyncClient::netProcessSyncMsg(const NetPacket& recv_pkt)
+{
+   UnstructuredBuffer recv_buff;
+   recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
+
+   UInt32 msg_type;
+   recv_buff >> msg_type;
+
+   LOG_PRINT("Tile(%i), SyncMsg[sender(%i), type(%u)]", m_core->getTile()->getId(), recv_pkt.sender.tile_id, msg_type);
+
+   switch (msg_type)
+   {
+   case LaxBarrierTree::BARRIER_WAIT:
+      {
+         UInt64 time;
+         recv_buff >> time;
+         m_tree_node->processBarrierWait(time);
+      }
+      break;
+
+   case LaxBarrierTree::BARRIER_RELEASE:
+      processBarrierRelease(recv_pkt, recv_buff);
+      break;
+
+   case LaxBarrierTree::SUBTREE_DONE:
+      {
+         UInt32 epoch;
+         UInt64 min_wait_time;
+         recv_buff >> epoch >> min_wait_time;
+         m_tree_node->processSubtreeDone(epoch, min_wait_time);
+      }
+      break;
+
+   case LaxBarrierTree::EXCUSE:
+      {
+         UInt32 epoch;
+         recv_buff >> epoch;
+         m_tree_node->processExcuse(epoch);
+      }
+      break;
+
+   default:
+      LOG_PRINT_ERROR("Unrecognized message type(%u)", msg_type);
+      break;
+   }
+}
+
+void
+LaxBarrierTreeSyncClient::processBarrierRelease(const NetPacket& packet, UnstructuredBuffer& recv_buff)
+{
+   UInt32 epoch;
+   UInt64 next_barrier_time;
+   UInt32 num_words;
+   recv_buff >> epoch >> next_barrier_time >> num_words;
+
+   std::vector<UInt64> running_tiles(num_words);
+   recv_buff >> make_pair(&running_tiles[0], num_words * sizeof(UInt64));
+
+   LOG_PRINT("Tile(%i) released epoch(%u), next_barrier_time(%llu)", m_core->getTile()->getId(), epoch, next_barrier_time);
+
+   // Pass the release on, the children need the same information
+   const std::vector<tile_id_t>& children = m_tree_node->getChildren();
+   for (UInt32 i = 0; i < children.size(); i++)
+   {
+      m_core->getNetwork()->netSend(Tile::getMainCoreId(children[i]), CLOCK_SKEW_MINIMIZATION,
+                                    packet.data, packet.length);
+   }
+
+   tile_id_t tile_id = m_core->getTile()->getId();
+   bool running = (running_tiles[tile_id / 64] >> (tile_id % 64)) & 1;
+   m_tree_node->processBarrierRelease(epoch, next_barrier_time, running);
+}
+
+// -- LaxBarrierTreeSyncClient::TreeNode -- //
+
+LaxBarrierTreeSyncClient::TreeNode::TreeNode(Core* core, tile_id_t parent, const std::vector<tile_id_t>& children,
+                                             UInt64 first_barrier_time)
+   : LaxBarrierTreeNode(parent, children, first_barrier_time)
+   , m_core(core)
+{}
+
+LaxBarrierTreeSyncClient::TreeNode::~TreeNode()
+{}
+
+void
+LaxBarrierTreeSyncClient::TreeNode::releaseCore()
+{
+   unsigned int reply = BARRIER_RELEASE;
+   m_core->getNetwork()->netSend(m_core->getId(), MCP_SYSTEM_RESPONSE_TYPE, (char*) &reply, sizeof(reply));
+}
+
+void
+LaxBarrierTreeSyncClient::TreeNode::sendSubtreeDone(tile_id_t parent, UInt32 epoch, UInt64 min_wait_time)
+{
+   if (parent == INVALID_TILE_ID)
+   {
+      sendToMCP(LaxBarrierTree::SUBTREE_DONE, epoch, min_wait_time);
+   }
+   else
+   {
+      UnstructuredBuffer send_buff;
+      UInt32 msg_type = LaxBarrierTree::SUBTREE_DONE;
+      send_buff << msg_type << epoch << min_wait_time;
+      m_core->getNetwork()->netSend(Tile::getMainCoreId(parent), CLOCK_SKEW_MINIMIZATION,
+                                    send_buff.getBuffer(), send_buff.size());
+   }
+}
+
+void
+LaxBarrierTreeSyncClient::TreeNode::sendLateArrival(UInt32 epoch, UInt64 time)
+{
+   sendToMCP(LaxBarrierTree::LATE_ARRIVAL, epoch, time);
+}
+
+void
+LaxBarrierTreeSyncClient::TreeNode::sendToMCP(UInt32 msg_type, UInt32 epoch, UInt64 time)
+{
+   UnstructuredBuffer send_buff;
+   int mcp_msg_type = MCP_MESSAGE_CLOCK_SKEW_MINIMIZATION;
+   send_buff << mcp_msg_type << msg_type << epoch << time;
+   m_core->getNetwork()->netSend(Config::getSingleton()->getMCPCoreId(), MCP_SYSTEM_TYPE,
+                                 send_buff.getBuffer(), send_buff.size());
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+
+#include "clock_skew_minimization_object.h"
+#include "lax_barrier_tree.h"
+#include "fixed_types.h"
+#include "packetize.h"
+
+// Forward Decls
+class Core;
+
+// Client of the lax_barrier_tree scheme. Besides synchronizing its core, it
+// runs the node of its tile in the combining tree on the sim thread:
+//   - it holds its core at the barrier and releases it
+//   - it reports to its parent once its core and every child subtree have
+//     reached the barrier (or are not running), with the earliest time a
+//     core is waiting at in the subtree
+//   - it passes the releases from its parent on to its children
+// The MCP decides which tiles have to reach each barrier (the running ones)
+// and excuses a tile that stops running before reaching it. A tile that
+// starts running during a quantum reports its arrival to the MCP directly.
+// The protocol of the node is in LaxBarrierTreeNode.
+class LaxBarrierTreeSyncClient : public ClockSkewMinimizationClient
+{
+private:
+   // Node of the tile, carrying its messages over the network
+   class TreeNode : public LaxBarrierTreeNode
+   {
+   public:
+      TreeNode(Core* core, tile_id_t parent, const std::vector<tile_id_t>& children, UInt64 first_barrier_time);
+      ~TreeNode();
+
+   private:
+      Core* m_core;
+
+      void releaseCore();
+      void sendSubtreeDone(tile_id_t parent, UInt32 epoch, UInt64 min_wait_time);
+      void sendLateArrival(UInt32 epoch, UInt64 time);
+      void sendToMCP(UInt32 msg_type, UInt32 epoch, UInt64 time);
+   };
+
+   Core* m_core;
+
+   UInt64 m_barrier_interval;
+   UInt64 m_next_sync_time;
+
+   // Tree node, only accessed by the sim thread (NULL if not in the tree)
+   TreeNode* m_tree_node;
+
+   void processBarrierRelease(const NetPacket& packet, UnstructuredBuffer& recv_buff);
+
+public:
+   LaxBarrierTreeSyncClient(Core* core);
+   ~LaxBarrierTreeSyncClient();
+
+   void enable() {}
+   void disable() {}
+
+   void synchronize(UInt64 cycle_count);
+   void netProcessSyncMsg(const NetPacket& packet);
+
+   static const unsigned int BARRIER_RELEASE = 0xBABECAFE;
+   static UInt64 MAX_TIME;
+};
@@ -0,0 +1,169 @@
+#include <algorithm>
+
+#include "lax_barrier_tree_sync_client.h"
+#include "lax_barrier_tree_sync_server.h"
+#include "simulator.h"
+#include "thread_manager.h"
+#include "tile_manager.h"
+#include "network.h"
+#include "tile.h"
+#include "config.h"
+#include "statistics_thread.h"
+#include "log.h"
+
+LaxBarrierTreeSyncServer::LaxBarrierTreeSyncServer(Network &network, UnstructuredBuffer &recv_buff):
+   m_network(network),
+   m_recv_buff(recv_buff),
+   m_epoch(0),
+   m_late_min_wait_time(LaxBarrierTreeSyncClient::MAX_TIME),
+   // The first barrier is reached by the arrivals of the running tiles
+   m_tree_done(true),
+   m_tree_min_wait_time(LaxBarrierTreeSyncClient::MAX_TIME)
+{
+   m_thread_manager = Sim()->getThreadManager();
+   try
+   {
+      m_barrier_interval = (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/lax_barrier_tree/quantum");
+   }
+   catch(...)
+   {
+      LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/lax_barrier_tree/quantum' from the config file");
+   }
+
+   m_next_barrier_time = m_barrier_interval;
+   m_num_application_tiles = Config::getSingleton()->getApplicationTiles();
+   m_expected_list.resize(m_num_application_tiles, false);
+   m_late_arrival_list.resize(m_num_application_tiles, false);
+
+   LaxBarrierTree tree;
+   m_tree_root = tree.getRoot();
+}
+
+LaxBarrierTreeSyncServer::~LaxBarrierTreeSyncServer()
+{}
+
+void
+LaxBarrierTreeSyncServer::processSyncMsg(core_id_t core_id)
+{
+   UInt32 msg_type;
+   UInt32 epoch;
+   UInt64 time;
+   m_recv_buff >> msg_type >> epoch >> time;
+
+   LOG_PRINT("Received msg_type(%u) from Core(%i, %i), epoch(%u), time(%llu)", msg_type, core_id.tile_id, core_id.core_type, epoch, time);
+
+   switch (msg_type)
+   {
+   case LaxBarrierTree::SUBTREE_DONE:
+      LOG_ASSERT_ERROR(epoch == m_epoch && !m_tree_done, "Unexpected subtree done, epoch(%u), m_epoch(%u)", epoch, m_epoch);
+      m_tree_done = true;
+      m_tree_min_wait_time = time;
+      break;
+
+   case LaxBarrierTree::LATE_ARRIVAL:
+      // An arrival sent before the last release is covered by the tree
+      if (epoch == m_epoch)
+      {
+         m_late_arrival_list[core_id.tile_id] = true;
+         if (time < m_late_min_wait_time)
+            m_late_min_wait_time = time;
+      }
+      break;
+
+   default:
+      LOG_PRINT_ERROR("Unrecognized message type(%u)", msg_type);
+      break;
+   }
+
+   signal();
+}
+
+void
+LaxBarrierTreeSyncServer::signal()
+{
+   excuseStoppedTiles();
+
+   if (isBarrierReached())
+   {
+     barrierRelease(); 
+   }
+}
+
+void
+LaxBarrierTreeSyncServer::excuseStoppedTiles()
+{
+   // Tell the nodes not to wait for the tiles that stopped running
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) m_num_application_tiles; tile_id++)
+   {
+      if (m_expected_list[tile_id] && (m_thread_manager->isCoreRunning(tile_id) == INVALID_THREAD_ID))
+      {
+         m_expected_list[tile_id] = false;
+
+         UnstructuredBuffer send_buff;
+         UInt32 msg_type = LaxBarrierTree::EXCUSE;
+         send_buff << msg_type << m_epoch;
+         m_network.netSend(Tile::getMainCoreId(tile_id), CLOCK_SKEW_MINIMIZATION, send_buff.getBuffer(), send_buff.size());
+      }
+   }
+}
+
+bool
+LaxBarrierTreeSyncServer::isBarrierReached()
+{
+   if (!m_tree_done)
+      return false;
+
+   // The tiles the tree did not expect have to arrive as well
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) m_num_application_tiles; tile_id++)
+   {
+      if (!m_expected_list[tile_id] && !m_late_arrival_list[tile_id] &&
+          (m_thread_manager->isCoreRunning(tile_id) != INVALID_THREAD_ID))
+         return false;
+   }
+
+   // All least one thread must be waiting at the barrier
+   return ((m_tree_min_wait_time != LaxBarrierTreeSyncClient::MAX_TIME) ||
+           (m_late_min_wait_time != LaxBarrierTreeSyncClient::MAX_TIME));
+}
+
+void
+LaxBarrierTreeSyncServer::barrierRelease()
+{
+   LOG_PRINT("Sending 'BARRIER_RELEASE'");
+
+   // Advance m_next_barrier_time till a waiting thread can be resumed, to
+   // guarantee forward progress
+   UInt64 min_wait_time = std::min(m_tree_min_wait_time, m_late_min_wait_time);
+   do
+   {
+      m_next_barrier_time += m_barrier_interval;
+   }
+   while (m_next_barrier_time <= min_wait_time);
+   LOG_PRINT("m_next_barrier_time updated to (%llu)", m_next_barrier_time);
+
+   m_epoch ++;
+
+   // The tree waits for all the tiles running now
+   UInt32 num_words = (m_num_application_tiles + 63) / 64;
+   std::vector<UInt64> running_tiles(num_words, 0);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) m_num_application_tiles; tile_id++)
+   {
+      m_expected_list[tile_id] = (m_thread_manager->isCoreRunning(tile_id) != INVALID_THREAD_ID);
+      m_late_arrival_list[tile_id] = false;
+      if (m_expected_list[tile_id])
+         running_tiles[tile_id / 64] |= ((UInt64) 1) << (tile_id % 64);
+   }
+   m_late_min_wait_time = LaxBarrierTreeSyncClient::MAX_TIME;
+   m_tree_done = false;
+   m_tree_min_wait_time = LaxBarrierTreeSyncClient::MAX_TIME;
+
+   UnstructuredBuffer send_buff;
+   UInt32 msg_type = LaxBarrierTree::BARRIER_RELEASE;
+   send_buff << msg_type << m_epoch << m_next_barrier_time << num_words;
+   send_buff << make_pair(&running_tiles[0], num_words * sizeof(UInt64));
+   m_network.netSend(Tile::getMainCoreId(m_tree_root), CLOCK_SKEW_MINIMIZATION, send_buff.getBuffer(), send_buff.size());
+
+   // Notify Statistics thread about the global time
+   if (Sim()->getStatisticsThread())
+      Sim()->getStatisticsThread()->notify(m_next_barrier_time);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "clock_skew_minimization_object.h"
+#include "lax_barrier_tree.h"
+#include "fixed_types.h"
+#include "packetize.h"
+
+// Forward Decls
+class ThreadManager;
+class Network;
+
+// Root of the combining tree of the lax_barrier_tree scheme (see
+// LaxBarrierTreeSyncClient). The barrier is reached when the tree has
+// reported and every tile that started running during the quantum has
+// arrived; it is released with a single message to the root of the tree.
+class LaxBarrierTreeSyncServer : public ClockSkewMinimizationServer
+{
+private:
+   Network &m_network;
+   UnstructuredBuffer &m_recv_buff;
+   ThreadManager* m_thread_manager;
+
+   UInt64 m_barrier_interval;
+   UInt64 m_next_barrier_time;
+   UInt32 m_epoch;
+   tile_id_t m_tree_root;
+
+   // Tiles the tree waits for in this epoch
+   std::vector<bool> m_expected_list;
+   // Other tiles that reached the barrier
+   std::vector<bool> m_late_arrival_list;
+   UInt64 m_late_min_wait_time;
+
+   bool m_tree_done;
+   UInt64 m_tree_min_wait_time;
+
+   UInt32 m_num_application_tiles;
+
+   void excuseStoppedTiles();
+
+public:
+   LaxBarrierTreeSyncServer(Network &network, UnstructuredBuffer &recv_buff);
+   ~LaxBarrierTreeSyncServer();
+
+   void processSyncMsg(core_id_t core_id);
+   void signal();
+
+   bool isBarrierReached(void);
+   void barrierRelease(void);
+};
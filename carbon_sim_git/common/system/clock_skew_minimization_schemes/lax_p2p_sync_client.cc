@@ -1,3 +1,6 @@
+#include <sstream>
+#include <algorithm>
+
 #include "lax_p2p_sync_client.h"
 #include "simulator.h"
 #include "config.h"
@@ -9,6 +12,8 @@
 #include "log.h"
 #include "tile_manager.h"
 
+using std::endl;
+
 UInt64 LaxP2PSyncClient::MAX_TIME = ((UInt64) 1) << 60;
 
 LaxP2PSyncClient::LaxP2PSyncClient(Core* core):
@@ -16,7 +21,19 @@ LaxP2PSyncClient::LaxP2PSyncClient(Core* core):
    _last_sync_time(0),
    _quantum(0),
    _slack(0),
-   _sleep_fraction(0.0)
+   _sleep_fraction(0.0),
+   _adaptive(false),
+   _accuracy(0.0),
+   _target_sync_rate(0.0),
+   _target_slack(0),
+   _target_sleep_fraction(0.0),
+   _min_quantum(0),
+   _max_quantum(0),
+   _num_syncs(0),
+   _total_skew(0),
+   _num_skew_samples(0),
+   _period_start_wall_clock_time(0),
+   _sync_wall_clock_time(0)
 {
    LOG_ASSERT_ERROR(Sim()->getConfig()->getApplicationTiles() >= 3, 
          "Number of Cores must be >= 3 if 'random_pairs' scheme is used");
@@ -26,12 +43,37 @@ LaxP2PSyncClient::LaxP2PSyncClient(Core* core):
       _slack = (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/lax_p2p/slack");
       _quantum = (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/lax_p2p/quantum");
       _sleep_fraction = Sim()->getCfg()->getFloat("clock_skew_minimization/lax_p2p/sleep_fraction");
+      _adaptive = Sim()->getCfg()->getBool("clock_skew_minimization/lax_p2p/adaptive", false);
+      if (_adaptive)
+      {
+         _accuracy = Sim()->getCfg()->getFloat("clock_skew_minimization/lax_p2p/adaptation/accuracy");
+         _target_sync_rate = Sim()->getCfg()->getFloat("clock_skew_minimization/lax_p2p/adaptation/target_sync_rate");
+         _min_quantum = (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/lax_p2p/adaptation/min_quantum");
+         _max_quantum = (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/lax_p2p/adaptation/max_quantum");
+      }
    }
    catch(...)
    {
       LOG_PRINT_ERROR("Could not read clock_skew_minimization/random_pairs variables from config file");
    }
 
+   if (_adaptive)
+   {
+      LOG_ASSERT_ERROR(_accuracy >= 0.0 && _accuracy <= 1.0, "lax_p2p/adaptation/accuracy(%f) must be in [0,1]", _accuracy);
+      LOG_ASSERT_ERROR(_target_sync_rate > 0.0, "lax_p2p/adaptation/target_sync_rate(%f) must be > 0", _target_sync_rate);
+      LOG_ASSERT_ERROR(_min_quantum > 0 && _min_quantum <= _max_quantum,
+            "lax_p2p/adaptation: min_quantum(%llu) must be > 0 and <= max_quantum(%llu)", _min_quantum, _max_quantum);
+
+      // The configured slack is the skew the user is willing to accept, and
+      // the configured sleep fraction the strongest correction of the skew
+      _target_slack = _slack;
+      _target_sleep_fraction = _sleep_fraction;
+      if (_quantum < _min_quantum)
+         _quantum = _min_quantum;
+      if (_quantum > _max_quantum)
+         _quantum = _max_quantum;
+   }
+
    gettimeofday(&_start_wall_clock_time, NULL);
    _rand_num.seed(1);
 
@@ -42,6 +84,8 @@ LaxP2PSyncClient::LaxP2PSyncClient(Core* core):
 LaxP2PSyncClient::~LaxP2PSyncClient()
 {
    _core->getNetwork()->unregisterCallback(CLOCK_SKEW_MINIMIZATION);
+   if (_trace_file.is_open())
+      _trace_file.close();
 }
 
 void 
@@ -52,6 +96,12 @@ LaxP2PSyncClient::enable()
    assert(_last_sync_time == 0); 
    gettimeofday(&_start_wall_clock_time, NULL);
    assert(_msg_queue.empty());
+
+   _num_syncs = 0;
+   _total_skew = 0;
+   _num_skew_samples = 0;
+   _period_start_wall_clock_time = 0;
+   _sync_wall_clock_time = 0;
 }
 
 void
@@ -134,7 +184,8 @@ LaxP2PSyncClient::netProcessSyncMsg(const NetPacket& recv_pkt)
 void
 LaxP2PSyncClient::processSyncReq(const SyncMsg& sync_msg, bool sleeping)
 {
-   assert(sync_msg.time >= _slack);
+   // The slack of the sender may be smaller than this one in adaptive mode
+   assert(_adaptive || (sync_msg.time >= _slack));
 
    // I dont want to lock this, so I just try to read the cycle count
    // Even if this is an approximate value, this is OK
@@ -148,6 +199,9 @@ LaxP2PSyncClient::processSyncReq(const SyncMsg& sync_msg, bool sleeping)
    LOG_PRINT("Core(%i, %i): Time(%llu), SyncReq[sender(%i), msg_type(%u), time(%llu)]", 
       _core->getId().tile_id, _core->getId().core_type, curr_time, sync_msg.sender, sync_msg.type, sync_msg.time);
 
+   if (_adaptive)
+      recordSkew((curr_time > sync_msg.time) ? (curr_time - sync_msg.time) : (sync_msg.time - curr_time));
+
    // 3 possible scenarios
    if (curr_time > (sync_msg.time + _slack))
    {
@@ -169,14 +223,14 @@ LaxP2PSyncClient::processSyncReq(const SyncMsg& sync_msg, bool sleeping)
          _msg_queue.push_back(wait_msg);
       }
    }
-   else if ((curr_time <= (sync_msg.time + _slack)) && (curr_time >= (sync_msg.time - _slack)))
+   else if ((curr_time <= (sync_msg.time + _slack)) && ((curr_time + _slack) >= sync_msg.time))
    {
       // Both the cores are in sync (Good)
       UnstructuredBuffer send_buf;
       send_buf << (UInt32) SyncMsg::ACK << (UInt64) 0;
       _core->getNetwork()->netSend(sync_msg.sender, CLOCK_SKEW_MINIMIZATION, send_buf.getBuffer(), send_buf.size());
    }
-   else if (curr_time < (sync_msg.time - _slack))
+   else if ((curr_time + _slack) < sync_msg.time)
    {
       LOG_ASSERT_ERROR((sync_msg.time - curr_time) < MAX_TIME,
             "[<]: curr_time(%llu), sync_msg[sender(%i), msg_type(%u), time(%llu)]",
@@ -228,6 +282,8 @@ LaxP2PSyncClient::synchronize(UInt64 cycle_count)
       LOG_ASSERT_ERROR(_last_sync_time < MAX_TIME,
             "_last_sync_time(%llu)", _last_sync_time);
 
+      UInt64 sync_start_wall_clock_time = _adaptive ? getElapsedWallClockTime() : 0;
+
       // Send SyncMsg to another tile
       sendRandomSyncMsg(curr_time);
 
@@ -239,6 +295,15 @@ LaxP2PSyncClient::synchronize(UInt64 cycle_count)
       LOG_PRINT("Wait Time (%llu)", wait_time);
 
       gotoSleep(wait_time);
+
+      if (_adaptive)
+      {
+         _sync_wall_clock_time += getElapsedWallClockTime() - sync_start_wall_clock_time;
+         recordSkew(wait_time);
+
+         if (++_num_syncs == ADAPTATION_PERIOD)
+            adaptParameters(curr_time);
+      }
       
       _lock.release();
 
@@ -352,3 +417,58 @@ LaxP2PSyncClient::getElapsedWallClockTime()
    return ( ((UInt64) (curr_wall_clock_time.tv_sec - _start_wall_clock_time.tv_sec)) * 1000000 +
       (UInt64) (curr_wall_clock_time.tv_usec - _start_wall_clock_time.tv_usec));
 }
+
+void
+LaxP2PSyncClient::adaptParameters(UInt64 curr_time)
+{
+   UInt64 curr_wall_clock_time = getElapsedWallClockTime();
+   UInt64 period_wall_clock_time = curr_wall_clock_time - _period_start_wall_clock_time;
+   if (period_wall_clock_time == 0)
+      period_wall_clock_time = 1;
+
+   UInt64 average_skew = (_num_skew_samples > 0) ? (_total_skew / _num_skew_samples) : 0;
+   float sync_overhead = float(_sync_wall_clock_time) / period_wall_clock_time;
+   float sync_rate = float(_num_syncs) * 1000000 / period_wall_clock_time;
+
+   // Synchronizing costs more wall-clock time than allowed, or happens
+   // more often than the target rate
+   bool too_costly = (sync_overhead > _accuracy) || (sync_rate > _target_sync_rate);
+
+   if (!too_costly && (average_skew > _target_slack))
+   {
+      // Too much skew: synchronize more often, tolerate less skew and sleep
+      // for all of it
+      _quantum = std::max(_min_quantum, _quantum / 2);
+      _slack = std::max(_target_slack / 4, _slack / 2);
+      _sleep_fraction = std::min(_target_sleep_fraction, float(_sleep_fraction) * 2);
+   }
+   else if (too_costly || (average_skew < (_target_slack / 2)))
+   {
+      // Synchronizing costs too much or there is room: back off
+      _quantum = std::min(_max_quantum, _quantum + _min_quantum);
+      _slack = std::min(_target_slack, _slack + std::max(_target_slack / 4, (UInt64) 1));
+      _sleep_fraction = std::max(_target_sleep_fraction / 4, float(_sleep_fraction) / 2);
+   }
+
+   LOG_PRINT("Tile(%i) adapted: average_skew(%llu), sync_overhead(%f), sync_rate(%f), quantum(%llu), slack(%llu), sleep_fraction(%f)",
+         _core->getTileId(), average_skew, sync_overhead, sync_rate, _quantum, _slack, _sleep_fraction);
+
+   if (!_trace_file.is_open())
+   {
+      std::ostringstream filename;
+      filename << "lax_p2p_adaptation_" << _core->getTileId() << ".dat";
+      std::string full_file_name = Config::getSingleton()->formatOutputFileName(filename.str());
+      _trace_file.open(full_file_name.c_str());
+      LOG_ASSERT_ERROR(_trace_file.good(), "Could not open adaptation trace file(%s)", full_file_name.c_str());
+      _trace_file << "# Simulated Time (ns), Wall-Clock Time (us), Quantum (ns), Slack (ns), "
+                  << "Sleep Fraction, Average Skew (ns), Synchronizations per Second, Synchronization Overhead" << endl;
+   }
+   _trace_file << curr_time << " " << curr_wall_clock_time << " " << _quantum << " " << _slack << " "
+               << _sleep_fraction << " " << average_skew << " " << sync_rate << " " << sync_overhead << endl;
+
+   _num_syncs = 0;
+   _total_skew = 0;
+   _num_skew_samples = 0;
+   _period_start_wall_clock_time = curr_wall_clock_time;
+   _sync_wall_clock_time = 0;
+}
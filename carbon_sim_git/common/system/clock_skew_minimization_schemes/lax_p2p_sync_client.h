@@ -2,6 +2,7 @@
 
 #include <sys/time.h>
 #include <list>
+#include <fstream>
 
 #include "clock_skew_minimization_object.h"
 #include "tile.h"
@@ -56,6 +57,29 @@ private:
 
    bool _enabled;
 
+   // Adaptive mode: every ADAPTATION_PERIOD synchronizations, the quantum,
+   // slack and sleep fraction are tightened if the observed skew exceeds the
+   // configured slack, and relaxed if the skew is well below it, the core
+   // spent more than 'accuracy' of the wall-clock time synchronizing
+   // (waiting for acks and sleeping), or it synchronized more often than
+   // 'target_sync_rate' times per second of wall-clock time.
+   bool _adaptive;
+   float _accuracy;
+   float _target_sync_rate;
+   UInt64 _target_slack;
+   float _target_sleep_fraction;
+   UInt64 _min_quantum;
+   UInt64 _max_quantum;
+
+   UInt32 _num_syncs;
+   UInt64 _total_skew;
+   UInt32 _num_skew_samples;
+   UInt64 _period_start_wall_clock_time;
+   UInt64 _sync_wall_clock_time;
+   std::ofstream _trace_file;
+
+   static const UInt32 ADAPTATION_PERIOD = 32;
+
    static UInt64 MAX_TIME;
 
    // Called by user thread
@@ -63,6 +87,8 @@ private:
    void sendRandomSyncMsg(UInt64 curr_time);
    void gotoSleep(const UInt64 sleep_time);
    UInt64 getElapsedWallClockTime(void);
+   void adaptParameters(UInt64 curr_time);
+   void recordSkew(UInt64 skew) { _total_skew += skew; _num_skew_samples ++; }
   
    // Called by network thread 
    void processSyncReq(const SyncMsg& sync_msg, bool sleeping);
@@ -81,7 +81,7 @@ void LCP::processPacket()
       break;
    }
 
-   delete [] pkt;
+   m_transport->releaseBuffer(pkt);
 }
 
 void LCP::finish()
@@ -22,7 +22,7 @@ MCP::MCP(Network & network)
    , m_scratch(new char[m_MCP_SERVER_MAX_BUFF])
    , m_vm_manager()
    , m_syscall_server(m_network, m_send_buff, m_recv_buff, m_MCP_SERVER_MAX_BUFF, m_scratch)
-   , m_sync_server(m_network, m_recv_buff)
+   , m_sync_stall_tracker()
    , m_clock_skew_minimization_server(NULL)
    , m_network_model_analytical_server(m_network, m_recv_buff)
 {
@@ -66,34 +66,20 @@ void MCP::processPacket()
       m_finished = true;
       break;
 
-   case MCP_MESSAGE_MUTEX_INIT:
-      m_sync_server.mutexInit(recv_pkt.sender);
-      break;
-   case MCP_MESSAGE_MUTEX_LOCK:
-      m_sync_server.mutexLock(recv_pkt.sender);
-      break;
-   case MCP_MESSAGE_MUTEX_UNLOCK:
-      m_sync_server.mutexUnlock(recv_pkt.sender);
-      break;
-
-   case MCP_MESSAGE_COND_INIT:
-      m_sync_server.condInit(recv_pkt.sender);
-      break;
-   case MCP_MESSAGE_COND_WAIT:
-      m_sync_server.condWait(recv_pkt.sender);
-      break;
-   case MCP_MESSAGE_COND_SIGNAL:
-      m_sync_server.condSignal(recv_pkt.sender);
-      break;
-   case MCP_MESSAGE_COND_BROADCAST:
-      m_sync_server.condBroadcast(recv_pkt.sender);
-      break;
-
-   case MCP_MESSAGE_BARRIER_INIT:
-      m_sync_server.barrierInit(recv_pkt.sender);
-      break;
-   case MCP_MESSAGE_BARRIER_WAIT:
-      m_sync_server.barrierWait(recv_pkt.sender);
+   case MCP_MESSAGE_SYNC_THREAD_STALL:
+      {
+         core_id_t core_id;
+         UInt32 seq;
+         m_recv_buff >> core_id >> seq;
+         m_sync_stall_tracker.stall(core_id, seq);
+      }
+      break;
+   case MCP_MESSAGE_SYNC_THREAD_RESUME:
+      {
+         UInt32 seq;
+         m_recv_buff >> seq;
+         m_sync_stall_tracker.resume(recv_pkt.sender, seq);
+      }
       break;
 
    case MCP_MESSAGE_UTILIZATION_UPDATE:
@@ -36,7 +36,7 @@ class MCP : public Runnable
 
       VMManager m_vm_manager;
       SyscallServer m_syscall_server;
-      SyncServer m_sync_server;
+      SyncStallTracker m_sync_stall_tracker;
       ClockSkewMinimizationServer* m_clock_skew_minimization_server;
       NetworkModelAnalyticalServer m_network_model_analytical_server;
 
@@ -6,15 +6,8 @@ typedef enum
 {
    MCP_MESSAGE_QUIT,
    MCP_MESSAGE_SYS_CALL,
-   MCP_MESSAGE_MUTEX_INIT,
-   MCP_MESSAGE_MUTEX_LOCK,
-   MCP_MESSAGE_MUTEX_UNLOCK,
-   MCP_MESSAGE_COND_INIT,
-   MCP_MESSAGE_COND_WAIT,
-   MCP_MESSAGE_COND_SIGNAL,
-   MCP_MESSAGE_COND_BROADCAST,
-   MCP_MESSAGE_BARRIER_INIT,
-   MCP_MESSAGE_BARRIER_WAIT,
+   MCP_MESSAGE_SYNC_THREAD_STALL,
+   MCP_MESSAGE_SYNC_THREAD_RESUME,
    MCP_MESSAGE_UTILIZATION_UPDATE,
    MCP_MESSAGE_THREAD_SPAWN_REQUEST_FROM_REQUESTER,
    MCP_MESSAGE_THREAD_SPAWN_REPLY_FROM_SLAVE,
@@ -46,5 +39,21 @@ typedef enum
    LCP_MESSAGE_CLOCK_SKEW_MINIMIZATION
 } LCPMessageTypes;
 
+// Different types of messages that get passed to the home SyncServer of a
+// mutex/cond/barrier
+typedef enum
+{
+   SYNC_MESSAGE_MUTEX_LOCK,
+   SYNC_MESSAGE_MUTEX_UNLOCK,
+   SYNC_MESSAGE_COND_WAIT,
+   SYNC_MESSAGE_COND_SIGNAL,
+   SYNC_MESSAGE_COND_BROADCAST,
+   SYNC_MESSAGE_BARRIER_INIT,
+   SYNC_MESSAGE_BARRIER_WAIT,
+   // Sent between homes on behalf of a thread waiting on a cond
+   SYNC_MESSAGE_COND_MUTEX_LOCK,
+   SYNC_MESSAGE_COND_MUTEX_UNLOCK
+} SyncMessageTypes;
+
 #endif
 
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <sstream>
+#include <map>
 
 #include "simulator.h"
 #include "version.h"
@@ -8,6 +9,7 @@
 #include "mcp.h"
 #include "tile.h"
 #include "tile_manager.h"
+#include "network.h"
 #include "thread_manager.h"
 #include "thread_scheduler.h"
 #include "perf_counter_manager.h"
@@ -15,6 +17,11 @@
 #include "clock_skew_minimization_object.h"
 #include "statistics_manager.h"
 #include "statistics_thread.h"
+#include "core.h"
+#include "memory_manager.h"
+#include "cache.h"
+#include "dram_cntlr.h"
+#include "checkpoint.h"
 #include "fxsupport.h"
 #include "contrib/orion/orion.h"
 #include "mcpat_cache.h"
@@ -104,6 +111,8 @@ void Simulator::start()
  
    m_transport = Transport::create();
    m_tile_manager = new TileManager();
+   Network::createEventEngines();
+   Network::openPacketTraceFile();
    m_thread_manager = new ThreadManager(m_tile_manager);
    m_thread_scheduler = ThreadScheduler::create(m_thread_manager, m_tile_manager);
    m_perf_counter_manager = new PerfCounterManager(m_thread_manager);
@@ -166,12 +175,14 @@ Simulator::~Simulator()
          << "shutdown time\t" << (m_shutdown_time - m_boot_time) << endl;
 
       m_tile_manager->outputSummary(os);
+      m_transport->outputSummary(os);
       os.close();
    }
    else
    {
       stringstream temp;
       m_tile_manager->outputSummary(temp);
+      m_transport->outputSummary(temp);
       assert(temp.str().length() == 0);
    }
 
@@ -195,6 +206,8 @@ Simulator::~Simulator()
    delete m_perf_counter_manager;
    delete m_thread_manager;
    delete m_thread_scheduler;
+   Network::closePacketTraceFile();
+   Network::destroyEventEngines();
    delete m_tile_manager;
    m_tile_manager = NULL;
    delete m_transport;
@@ -303,4 +316,80 @@ void Simulator::disablePerformanceModelsInCurrentProcess()
    Sim()->stopTimer();
    for (UInt32 i = 0; i < Sim()->getConfig()->getNumLocalTiles(); i++)
       Sim()->getTileManager()->getTileFromIndex(i)->disablePerformanceModels();
+   // The clocks of the cores no longer hold back the network event engines
+   Network::advanceEventEngines();
+}
+
+static std::string getProcessCheckpointFileName(std::string file_name)
+{
+   std::ostringstream process_file_name;
+   process_file_name << file_name << "." << Sim()->getConfig()->getCurrentProcessNum();
+   return process_file_name.str();
+}
+
+UInt64 Simulator::hashMemoryOfCurrentProcess()
+{
+   if (!Sim()->getConfig()->isSimulatingSharedMemory())
+      return 0;
+
+   // The L1-D caches have the latest data of the lines they share with the L2
+   std::map<IntPtr, const Byte*> dirty_lines;
+   for (UInt32 i = 0; i < Sim()->getConfig()->getNumLocalTiles(); i++)
+   {
+      Cache* l1_dcache = Sim()->getTileManager()->getTileFromIndex(i)->getCore()->getMemoryManager()->getL1DCache();
+      if (l1_dcache)
+         l1_dcache->getDirtyLines(dirty_lines);
+   }
+   for (UInt32 i = 0; i < Sim()->getConfig()->getNumLocalTiles(); i++)
+   {
+      Cache* l2_cache = Sim()->getTileManager()->getTileFromIndex(i)->getCore()->getMemoryManager()->getL2Cache();
+      if (l2_cache)
+         l2_cache->getDirtyLines(dirty_lines);
+   }
+
+   UInt32 line_size = Sim()->getTileManager()->getTileFromIndex(0)->getCore()->getMemoryManager()->getCacheLineSize();
+   return DramCntlr::hashMemory(dirty_lines, line_size);
+}
+
+void Simulator::checkpointCurrentProcess(std::string file_name)
+{
+   std::string process_file_name = getProcessCheckpointFileName(file_name);
+   LOG_PRINT("checkpointCurrentProcess(%s) start", process_file_name.c_str());
+
+   CheckpointWriter writer(process_file_name);
+   writer.beginSection("process");
+   writer << Sim()->getConfig()->getCurrentProcessNum() << Sim()->getConfig()->getNumLocalTiles();
+   writer << hashMemoryOfCurrentProcess();
+   for (UInt32 i = 0; i < Sim()->getConfig()->getNumLocalTiles(); i++)
+      Sim()->getTileManager()->getTileFromIndex(i)->checkpoint(writer);
+   DramCntlr::checkpointBackingStore(writer);
+   writer.endSection();
+
+   LOG_PRINT("checkpointCurrentProcess(%s) end", process_file_name.c_str());
+}
+
+void Simulator::restoreCurrentProcess(std::string file_name)
+{
+   std::string process_file_name = getProcessCheckpointFileName(file_name);
+   LOG_PRINT("restoreCurrentProcess(%s) start", process_file_name.c_str());
+
+   CheckpointReader reader(process_file_name);
+   UInt32 process_num, num_local_tiles;
+   UInt64 memory_hash;
+   reader.beginSection("process");
+   reader >> process_num >> num_local_tiles >> memory_hash;
+   LOG_ASSERT_ERROR(num_local_tiles == Sim()->getConfig()->getNumLocalTiles(),
+                    "Checkpoint(%s) of %u tiles, process(%u) has %u tiles",
+                    process_file_name.c_str(), num_local_tiles, process_num, Sim()->getConfig()->getNumLocalTiles());
+   // The state of the models only applies to the memory it was saved with
+   UInt64 current_memory_hash = hashMemoryOfCurrentProcess();
+   LOG_ASSERT_ERROR(memory_hash == current_memory_hash,
+                    "Checkpoint(%s): memory hash(%#llx), the application reached the checkpoint with hash(%#llx)",
+                    process_file_name.c_str(), memory_hash, current_memory_hash);
+   for (UInt32 i = 0; i < num_local_tiles; i++)
+      Sim()->getTileManager()->getTileFromIndex(i)->restore(reader);
+   DramCntlr::restoreBackingStore(reader);
+   reader.endSection();
+
+   LOG_PRINT("restoreCurrentProcess(%s) end", process_file_name.c_str());
 }
@@ -47,6 +47,19 @@ public:
    static void enablePerformanceModelsInCurrentProcess();
    static void disablePerformanceModelsInCurrentProcess();
 
+   // Save/restore the state of the models of the local tiles and the
+   // simulated memory in '<file_name>.<process num>'. Only while no memory
+   // request is in flight (e.g. all the threads are at a barrier)
+   static void checkpointCurrentProcess(std::string file_name);
+   static void restoreCurrentProcess(std::string file_name);
+   // Hash of the simulated memory as the local tiles see it: the backing
+   // store of the process, with the lines that are dirty in the local caches
+   // in place of the stale stored copies. Saved in the checkpoint, and a
+   // restore aborts if the application did not reach the same memory state.
+   // With several processes, a line homed in one process and dirty in a
+   // cache of another counts in the process of the cache
+   static UInt64 hashMemoryOfCurrentProcess();
+
    void startTimer();
    void stopTimer();
    bool finished();
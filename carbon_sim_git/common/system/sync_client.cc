@@ -1,4 +1,5 @@
 #include "sync_client.h"
+#include "sync_server.h"
 #include "network.h"
 #include "core.h"
 #include "tile.h"
@@ -14,6 +15,8 @@ using namespace std;
 SyncClient::SyncClient(Core *core)
       : m_core(core)
       , m_network(core->getTile()->getNetwork())
+      , m_num_ids(0)
+      , m_seq(0)
 {
 }
 
@@ -21,65 +24,49 @@ SyncClient::~SyncClient()
 {
 }
 
-void SyncClient::mutexInit(carbon_mutex_t *mux)
+SInt32 SyncClient::allocateId()
 {
-   // Reset the buffers for the new transmission
-   m_recv_buff.clear();
-   m_send_buff.clear();
-
-   int msg_type = MCP_MESSAGE_MUTEX_INIT;
-
-   m_send_buff << msg_type;
-
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
-
-   NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(carbon_mutex_t));
-
-   *mux = *((carbon_mutex_t*)recv_pkt.data);
+   SInt32 total_tiles = (SInt32) Config::getSingleton()->getTotalTiles();
+   LOG_ASSERT_ERROR(m_num_ids < (INT_MAX - m_core->getTile()->getId()) / total_tiles,
+                    "Out of sync object ids on tile(%i)", m_core->getTile()->getId());
 
-   delete [](Byte*) recv_pkt.data;
+   SInt32 id = m_num_ids * total_tiles + m_core->getTile()->getId();
+   m_num_ids ++;
+   return id;
 }
 
-void SyncClient::mutexLock(carbon_mutex_t *mux)
+void SyncClient::sendRequest(SInt32 id)
 {
-   // Save/Restore Floating Point state
-   FloatingPointHandler floating_point_handler;
-
-   // Reset the buffers for the new transmission
-   m_recv_buff.clear();
-   m_send_buff.clear();
-
-   int msg_type = MCP_MESSAGE_MUTEX_LOCK;
-
-   // Core Clock to Global Clock
-   UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(),
-         m_core->getPerformanceModel()->getFrequency(), 1.0);
-
-   m_send_buff << msg_type << *mux << start_time;
-
-   LOG_PRINT("mutexLock(): mux(%u), start_time(%llu)", *mux, start_time);
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   core_id_t home = Tile::getMainCoreId(SyncServer::getHome(id));
+   m_network->netSend(home, SYNC_SERVER_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+}
 
+void SyncClient::waitForReply(unsigned int response, UInt64 start_time)
+{
    // Set the CoreState to 'STALLED'
    m_core->setState(Core::STALLED);
 
    NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(unsigned int) + sizeof(UInt64));
+   recv_pkt = m_network->netRecvType(SYNC_SERVER_RESPONSE_TYPE, m_core->getId());
+   assert(recv_pkt.length == sizeof(Reply));
 
    // Set the CoreState to 'RUNNING'
    m_core->setState(Core::WAKING_UP);
 
-   unsigned int dummy;
-   UInt64 time;
-   m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
-   m_recv_buff >> dummy;
-   assert(dummy == MUTEX_LOCK_RESPONSE);
+   Reply *reply = (Reply*) recv_pkt.data;
+   assert(reply->dummy == response);
 
-   m_recv_buff >> time;
+   if (reply->stalled)
+   {
+      // The home told the MCP this thread is stalled, so tell it that it is
+      // running again before doing anything else that involves the MCP
+      int msg_type = MCP_MESSAGE_SYNC_THREAD_RESUME;
+      m_send_buff.clear();
+      m_send_buff << msg_type << m_seq;
+      m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   }
 
+   UInt64 time = reply->time;
    if (time > start_time)
    {
       // Global Clock to Core Clock
@@ -92,39 +79,36 @@ void SyncClient::mutexLock(carbon_mutex_t *mux)
    delete [](Byte*) recv_pkt.data;
 }
 
-void SyncClient::mutexUnlock(carbon_mutex_t *mux)
+void SyncClient::mutexInit(carbon_mutex_t *mux)
+{
+   // The mutex is created at its home on first use
+   *mux = allocateId();
+}
+
+void SyncClient::mutexLock(carbon_mutex_t *mux)
 {
    // Save/Restore Floating Point state
    FloatingPointHandler floating_point_handler;
 
    // Reset the buffers for the new transmission
-   m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_MUTEX_UNLOCK;
+   int msg_type = SYNC_MESSAGE_MUTEX_LOCK;
 
    // Core Clock to Global Clock
-   UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
+   UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(),
          m_core->getPerformanceModel()->getFrequency(), 1.0);
 
-   m_send_buff << msg_type << *mux << start_time;
-
-   LOG_PRINT("mutexUnlock(): mux(%u), start_time(%llu)", *mux, start_time);
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   m_seq ++;
+   m_send_buff << msg_type << *mux << m_seq << start_time;
 
-   NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(unsigned int));
-
-   unsigned int dummy;
-   m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
-   m_recv_buff >> dummy;
-   assert(dummy == MUTEX_UNLOCK_RESPONSE);
+   LOG_PRINT("mutexLock(): mux(%u), start_time(%llu)", *mux, start_time);
+   sendRequest(*mux);
 
-   delete [](Byte*) recv_pkt.data;
+   waitForReply(MUTEX_LOCK_RESPONSE, start_time);
 }
 
-void SyncClient::condInit(carbon_cond_t *cond)
+void SyncClient::mutexUnlock(carbon_mutex_t *mux)
 {
    // Save/Restore Floating Point state
    FloatingPointHandler floating_point_handler;
@@ -133,73 +117,57 @@ void SyncClient::condInit(carbon_cond_t *cond)
    m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_COND_INIT;
+   int msg_type = SYNC_MESSAGE_MUTEX_UNLOCK;
 
    // Core Clock to Global Clock
    UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
          m_core->getPerformanceModel()->getFrequency(), 1.0);
 
-   m_send_buff << msg_type << *cond << start_time;
+   m_send_buff << msg_type << *mux << start_time;
 
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   LOG_PRINT("mutexUnlock(): mux(%u), start_time(%llu)", *mux, start_time);
+   sendRequest(*mux);
 
    NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(carbon_cond_t));
+   recv_pkt = m_network->netRecvType(SYNC_SERVER_RESPONSE_TYPE, m_core->getId());
+   assert(recv_pkt.length == sizeof(unsigned int));
 
-   *cond = *((carbon_cond_t*)recv_pkt.data);
+   unsigned int dummy;
+   m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
+   m_recv_buff >> dummy;
+   assert(dummy == MUTEX_UNLOCK_RESPONSE);
 
    delete [](Byte*) recv_pkt.data;
 }
 
+void SyncClient::condInit(carbon_cond_t *cond)
+{
+   // The cond is created at its home on first use
+   *cond = allocateId();
+}
+
 void SyncClient::condWait(carbon_cond_t *cond, carbon_mutex_t *mux)
 {
    // Save/Restore Floating Point state
    FloatingPointHandler floating_point_handler;
 
    // Reset the buffers for the new transmission
-   m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_COND_WAIT;
+   int msg_type = SYNC_MESSAGE_COND_WAIT;
 
    // Core Clock to Global Clock
    UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
          m_core->getPerformanceModel()->getFrequency(), 1.0);
 
-   m_send_buff << msg_type << *cond << *mux << start_time;
+   m_seq ++;
+   m_send_buff << msg_type << *cond << *mux << m_seq << start_time;
 
+   // The home of the cond releases the mutex on behalf of this thread
    LOG_PRINT("condWait(): cond(%u), mux(%u), start_time(%llu)", *cond, *mux, start_time);
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
-
-   // Set the CoreState to 'STALLED'
-   m_core->setState(Core::STALLED);
-
-   NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(unsigned int) + sizeof(UInt64));
-
-   // Set the CoreState to 'RUNNING'
-   m_core->setState(Core::WAKING_UP);
+   sendRequest(*cond);
 
-   unsigned int dummy;
-   m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
-   m_recv_buff >> dummy;
-   assert(dummy == COND_WAIT_RESPONSE);
-
-   UInt64 time;
-   m_recv_buff >> time;
-
-   if (time > start_time)
-   {
-      // Global Clock to Core Clock
-      UInt64 cycles_elapsed = convertCycleCount(time  - start_time, \
-            1.0, m_core->getPerformanceModel()->getFrequency());
-
-      m_core->getPerformanceModel()->queueDynamicInstruction(new SyncInstruction(cycles_elapsed));
-   }
-
-   delete [](Byte*) recv_pkt.data;
+   waitForReply(COND_WAIT_RESPONSE, start_time);
 }
 
 void SyncClient::condSignal(carbon_cond_t *cond)
@@ -211,7 +179,7 @@ void SyncClient::condSignal(carbon_cond_t *cond)
    m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_COND_SIGNAL;
+   int msg_type = SYNC_MESSAGE_COND_SIGNAL;
 
    // Core Clock to Global Clock
    UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
@@ -220,10 +188,10 @@ void SyncClient::condSignal(carbon_cond_t *cond)
    m_send_buff << msg_type << *cond << start_time;
 
    LOG_PRINT("condSignal(): cond(%u), start_time(%llu)", *cond, start_time);
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   sendRequest(*cond);
 
    NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
+   recv_pkt = m_network->netRecvType(SYNC_SERVER_RESPONSE_TYPE, m_core->getId());
    assert(recv_pkt.length == sizeof(unsigned int));
 
    unsigned int dummy;
@@ -243,7 +211,7 @@ void SyncClient::condBroadcast(carbon_cond_t *cond)
    m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_COND_BROADCAST;
+   int msg_type = SYNC_MESSAGE_COND_BROADCAST;
 
    // Core Clock to Global Clock
    UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
@@ -252,10 +220,10 @@ void SyncClient::condBroadcast(carbon_cond_t *cond)
    m_send_buff << msg_type << *cond << start_time;
 
    LOG_PRINT("condBroadcast(): cond(%u), start_time(%llu)", *cond, start_time);
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   sendRequest(*cond);
 
    NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
+   recv_pkt = m_network->netRecvType(SYNC_SERVER_RESPONSE_TYPE, m_core->getId());
    assert(recv_pkt.length == sizeof(unsigned int));
 
    unsigned int dummy;
@@ -275,21 +243,23 @@ void SyncClient::barrierInit(carbon_barrier_t *barrier, UInt32 count)
    m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_BARRIER_INIT;
+   int msg_type = SYNC_MESSAGE_BARRIER_INIT;
 
-   // Core Clock to Global Clock
-   UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
-         m_core->getPerformanceModel()->getFrequency(), 1.0);
+   *barrier = allocateId();
+   m_send_buff << msg_type << *barrier << count;
 
-   m_send_buff << msg_type << count << start_time;
-
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
+   // Wait for the home to create the barrier, so that it exists before any
+   // thread can wait on it
+   sendRequest(*barrier);
 
    NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(carbon_barrier_t));
+   recv_pkt = m_network->netRecvType(SYNC_SERVER_RESPONSE_TYPE, m_core->getId());
+   assert(recv_pkt.length == sizeof(unsigned int));
 
-   *barrier = *((carbon_barrier_t*)recv_pkt.data);
+   unsigned int dummy;
+   m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
+   m_recv_buff >> dummy;
+   assert(dummy == BARRIER_INIT_RESPONSE);
 
    delete [](Byte*) recv_pkt.data;
 }
@@ -300,46 +270,19 @@ void SyncClient::barrierWait(carbon_barrier_t *barrier)
    FloatingPointHandler floating_point_handler;
 
    // Reset the buffers for the new transmission
-   m_recv_buff.clear();
    m_send_buff.clear();
 
-   int msg_type = MCP_MESSAGE_BARRIER_WAIT;
+   int msg_type = SYNC_MESSAGE_BARRIER_WAIT;
 
    // Core Clock to Global Clock
    UInt64 start_time = convertCycleCount(m_core->getPerformanceModel()->getCycleCount(), \
          m_core->getPerformanceModel()->getFrequency(), 1.0);
 
-   m_send_buff << msg_type << *barrier << start_time;
+   m_seq ++;
+   m_send_buff << msg_type << *barrier << m_seq << start_time;
 
    LOG_PRINT("barrierWait(): barrier(%u), start_time(%llu)", *barrier, start_time);
-   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE, m_send_buff.getBuffer(), m_send_buff.size());
-
-   // Set the CoreState to 'STALLED'
-   m_core->setState(Core::STALLED);
-
-   NetPacket recv_pkt;
-   recv_pkt = m_network->netRecv(Config::getSingleton()->getMCPCoreId(), m_core->getId(), MCP_RESPONSE_TYPE);
-   assert(recv_pkt.length == sizeof(unsigned int) + sizeof(UInt64));
-
-   // Set the CoreState to 'RUNNING'
-   m_core->setState(Core::WAKING_UP);
-
-   unsigned int dummy;
-   m_recv_buff << make_pair(recv_pkt.data, recv_pkt.length);
-   m_recv_buff >> dummy;
-   assert(dummy == BARRIER_WAIT_RESPONSE);
-
-   UInt64 time;
-   m_recv_buff >> time;
+   sendRequest(*barrier);
 
-   if (time > start_time)
-   {
-      // Global Clock to Core Clock
-      UInt64 cycles_elapsed = convertCycleCount(time - start_time, \
-            1.0, m_core->getPerformanceModel()->getFrequency());
-
-      m_core->getPerformanceModel()->queueDynamicInstruction(new SyncInstruction(cycles_elapsed));
-   }
-
-   delete [](Byte*) recv_pkt.data;
+   waitForReply(BARRIER_WAIT_RESPONSE, start_time);
 }
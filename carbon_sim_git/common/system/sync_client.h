@@ -41,6 +41,17 @@ class SyncClient
       static const unsigned int COND_SIGNAL_RESPONSE  = 0xBEEFCAFE;
       static const unsigned int COND_BROADCAST_RESPONSE = 0xDEADCAFE;
       static const unsigned int BARRIER_WAIT_RESPONSE  = 0xCACACAFE;
+      static const unsigned int BARRIER_INIT_RESPONSE  = 0xCAFEBABE;
+
+      // Reply that wakes up a thread blocked in mutexLock(), condWait() or
+      // barrierWait(). 'stalled' is set if the home had to make the thread
+      // wait, and then it has to tell the MCP it is running again
+      struct Reply
+      {
+         UInt32 dummy;
+         UInt32 stalled;
+         UInt64 time;
+      };
 
    private:
       Core *m_core;
@@ -48,6 +59,16 @@ class SyncClient
       UnstructuredBuffer m_send_buff;
       UnstructuredBuffer m_recv_buff;
 
+      // Ids are handed out without a message to the home, they are unique
+      // since they are strided by the total number of tiles
+      SInt32 m_num_ids;
+      // Sequence number of the last blocking operation
+      UInt32 m_seq;
+
+      SInt32 allocateId();
+      void sendRequest(SInt32 id);
+      void waitForReply(unsigned int response, UInt64 start_time);
+
 };
 
 #endif
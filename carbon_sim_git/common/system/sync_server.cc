@@ -3,15 +3,12 @@
 #include "simulator.h"
 #include "thread_manager.h"
 #include "tile_manager.h"
+#include "tile.h"
+#include "message_types.h"
+#include "log.h"
 
 using namespace std;
 
-struct Reply
-{
-   UInt32 dummy;
-   UInt64 time __attribute__((packed));
-};
-
 // -- SimMutex -- //
 
 SimMutex::SimMutex()
@@ -32,7 +29,6 @@ bool SimMutex::lock(core_id_t core_id)
    }
    else
    {
-      Sim()->getThreadManager()->stallThread(core_id);
       m_waiting.push(core_id);
       return false;
    }
@@ -50,7 +46,6 @@ core_id_t SimMutex::unlock(core_id_t core_id)
    {
       m_owner =  m_waiting.front();
       m_waiting.pop();
-      Sim()->getThreadManager()->resumeThread(m_owner);
    }
    return m_owner;
 }
@@ -63,57 +58,28 @@ SimCond::~SimCond()
    assert(m_waiting.empty());
 }
 
-core_id_t SimCond::wait(core_id_t core_id, UInt64 time, StableIterator<SimMutex> & simMux)
+void SimCond::wait(core_id_t core_id, UInt64 time, carbon_mutex_t mux)
 {
-   Sim()->getThreadManager()->stallThread(core_id);
-
    // If we don't have any later signals, then put this request in the queue
-   m_waiting.push_back(CondWaiter(core_id, simMux, time));
-   return simMux->unlock(core_id);
+   m_waiting.push_back(CondWaiter(core_id, mux, time));
 }
 
-core_id_t SimCond::signal(core_id_t core_id, UInt64 time)
+bool SimCond::signal(core_id_t core_id, UInt64 time, CondWaiter &woken)
 {
-   // If there is a list of threads waiting, wake up one of them
-   if (!m_waiting.empty())
-   {
-      CondWaiter woken = *(m_waiting.begin());
-      m_waiting.erase(m_waiting.begin());
-
-      Sim()->getThreadManager()->resumeThread(woken.m_core_id);
-
-      if (woken.m_mutex->lock(woken.m_core_id))
-      {
-         // Woken up thread is able to grab lock immediately
-         return woken.m_core_id;
-      }
-      else
-      {
-         // Woken up thread is *NOT* able to grab lock immediately
-         return INVALID_CORE_ID;
-      }
-   }
-
    // There are *NO* threads waiting on the condition variable
-   return INVALID_CORE_ID;
+   if (m_waiting.empty())
+      return false;
+
+   // If there is a list of threads waiting, wake up one of them
+   woken = *(m_waiting.begin());
+   m_waiting.erase(m_waiting.begin());
+   return true;
 }
 
 void SimCond::broadcast(core_id_t core_id, UInt64 time, WakeupList &woken_list)
 {
-   for (ThreadQueue::iterator i = m_waiting.begin(); i != m_waiting.end(); i++)
-   {
-      CondWaiter woken = *(i);
-
-      Sim()->getThreadManager()->resumeThread(woken.m_core_id);
-
-      if (woken.m_mutex->lock(woken.m_core_id))
-      {
-         // Woken up thread is able to grab lock immediately
-         woken_list.push_back(woken.m_core_id);
-      }
-   }
-
-   // All waiting threads have been woken up from the CondVar queue
+   // All waiting threads are woken up from the CondVar queue
+   woken_list.swap(m_waiting);
    m_waiting.clear();
 }
 
@@ -133,8 +99,6 @@ void SimBarrier::wait(core_id_t core_id, UInt64 time, WakeupList &woken_list)
 {
    m_waiting.push_back(core_id);
 
-   Sim()->getThreadManager()->stallThread(core_id);
-
    assert(m_waiting.size() <= m_count);
 
    if (m_waiting.size() == 1)
@@ -146,230 +110,361 @@ void SimBarrier::wait(core_id_t core_id, UInt64 time, WakeupList &woken_list)
    if (m_waiting.size() == m_count)
    {
       woken_list = m_waiting;
-
-      for (WakeupList::iterator i = woken_list.begin(); i != woken_list.end(); i++)
-      {
-         // Resuming all the threads stalled at the barrier
-         Sim()->getThreadManager()->resumeThread(*i);
-      }
       m_waiting.clear();
    }
 }
 
+
 // -- SyncServer -- //
 
-SyncServer::SyncServer(Network &network, UnstructuredBuffer &recv_buffer)
-      : m_network(network),
-      m_recv_buffer(recv_buffer)
-{ }
+void SyncServerNetworkCallback(void* obj, NetPacket packet)
+{
+   SyncServer *sync_server = (SyncServer*) obj;
+   assert(sync_server != NULL);
+
+   switch (packet.type)
+   {
+   case SYNC_SERVER_REQUEST_TYPE:
+      sync_server->handleRequest(packet);
+      break;
+
+   default:
+      LOG_PRINT_ERROR("Got unrecognized packet type(%u)", packet.type);
+      break;
+   }
+}
+
+SyncServer::SyncServer(Tile* tile)
+      : m_tile(tile)
+      , m_network(tile->getNetwork())
+{
+   m_network->registerCallback(SYNC_SERVER_REQUEST_TYPE, SyncServerNetworkCallback, this);
+}
 
 SyncServer::~SyncServer()
-{ }
+{
+   m_network->unregisterCallback(SYNC_SERVER_REQUEST_TYPE);
+}
+
+tile_id_t SyncServer::getHome(SInt32 id)
+{
+   // The ids handed out by a tile are strided by the total number of tiles,
+   // so they are hashed before being spread over the application tiles
+   UInt32 hash = ((UInt32) id) * 2654435761U;
+   return (tile_id_t) ((((UInt64) hash) * Config::getSingleton()->getApplicationTiles()) >> 32);
+}
 
-void SyncServer::mutexInit(core_id_t core_id)
+void SyncServer::handleRequest(NetPacket &packet)
 {
-   m_mutexes.push_back(SimMutex());
-   UInt32 mux = (UInt32)m_mutexes.size()-1;
+   m_recv_buffer.clear();
+   m_recv_buffer << make_pair(packet.data, packet.length);
 
-   m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&mux, sizeof(mux));
+   int msg_type;
+   m_recv_buffer >> msg_type;
+
+   LOG_PRINT("Sync message type(%i), sender(%i,%i)", msg_type, packet.sender.tile_id, packet.sender.core_type);
+
+   switch (msg_type)
+   {
+   case SYNC_MESSAGE_MUTEX_LOCK:
+      mutexLock(packet.sender);
+      break;
+   case SYNC_MESSAGE_MUTEX_UNLOCK:
+      mutexUnlock(packet.sender);
+      break;
+
+   case SYNC_MESSAGE_COND_WAIT:
+      condWait(packet.sender);
+      break;
+   case SYNC_MESSAGE_COND_SIGNAL:
+      condSignal(packet.sender);
+      break;
+   case SYNC_MESSAGE_COND_BROADCAST:
+      condBroadcast(packet.sender);
+      break;
+
+   case SYNC_MESSAGE_BARRIER_INIT:
+      barrierInit(packet.sender);
+      break;
+   case SYNC_MESSAGE_BARRIER_WAIT:
+      barrierWait(packet.sender);
+      break;
+
+   case SYNC_MESSAGE_COND_MUTEX_LOCK:
+      condMutexLock();
+      break;
+   case SYNC_MESSAGE_COND_MUTEX_UNLOCK:
+      condMutexUnlock();
+      break;
+
+   default:
+      LOG_PRINT_ERROR("Unhandled sync message type: %i from %i", msg_type, packet.sender.tile_id);
+   }
 }
 
 void SyncServer::mutexLock(core_id_t core_id)
 {
    carbon_mutex_t mux;
-   m_recv_buffer >> mux;
-
+   UInt32 seq;
    UInt64 time;
-   m_recv_buffer >> time;
+   m_recv_buffer >> mux >> seq >> time;
 
-   LOG_ASSERT_ERROR((size_t)mux < m_mutexes.size(), "mux(%i), total muxes(%u)", mux, m_mutexes.size());
+   LOG_ASSERT_ERROR(getHome(mux) == m_tile->getId(), "mux(%i) homed at tile(%i), not tile(%i)",
+                    mux, getHome(mux), m_tile->getId());
 
-   SimMutex *psimmux = &m_mutexes[mux];
-
-   if (psimmux->lock(core_id))
+   if (m_mutexes[mux].lock(core_id))
    {
       // notify the owner
-      Reply r;
-      r.dummy = SyncClient::MUTEX_LOCK_RESPONSE;
-      r.time = time;
-      m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&r, sizeof(r));
+      sendReply(core_id, SyncClient::MUTEX_LOCK_RESPONSE, false, time);
    }
    else
    {
-      // nothing...thread goes to sleep
+      // thread goes to sleep
+      notifyThreadStalled(core_id, seq);
    }
 }
 
 void SyncServer::mutexUnlock(core_id_t core_id)
 {
    carbon_mutex_t mux;
-   m_recv_buffer >> mux;
-
    UInt64 time;
-   m_recv_buffer >> time;
+   m_recv_buffer >> mux >> time;
 
-   assert((size_t)mux < m_mutexes.size());
+   releaseMutex(core_id, mux, time);
 
-   SimMutex *psimmux = &m_mutexes[mux];
+   UInt32 dummy = SyncClient::MUTEX_UNLOCK_RESPONSE;
+   m_network->netSend(core_id, SYNC_SERVER_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
+}
 
-   core_id_t new_owner = psimmux->unlock(core_id);
+void SyncServer::releaseMutex(core_id_t core_id, carbon_mutex_t mux, UInt64 time)
+{
+   MutexMap::iterator it = m_mutexes.find(mux);
+   LOG_ASSERT_ERROR(it != m_mutexes.end(), "mux(%i) not held at tile(%i)", mux, m_tile->getId());
+
+   core_id_t new_owner = it->second.unlock(core_id);
 
    if (new_owner.tile_id != INVALID_TILE_ID)
    {
-      // wake up the new owner
-      Reply r;
-      r.dummy = SyncClient::MUTEX_LOCK_RESPONSE;
-      r.time = time;
-      m_network.netSend(new_owner, MCP_RESPONSE_TYPE, (char*)&r, sizeof(r));
-   }
-   else
-   {
-      // nothing...
+      // wake up the new owner, it was stalled in the mutex queue
+      sendReply(new_owner, SyncClient::MUTEX_LOCK_RESPONSE, true, time);
    }
-
-   UInt32 dummy = SyncClient::MUTEX_UNLOCK_RESPONSE;
-   m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
 }
 
 // -- Condition Variable Stuffs -- //
-void SyncServer::condInit(core_id_t core_id)
-{
-   m_conds.push_back(SimCond());
-   UInt32 cond = (UInt32)m_conds.size()-1;
-
-   m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&cond, sizeof(cond));
-}
-
 void SyncServer::condWait(core_id_t core_id)
 {
    carbon_cond_t cond;
    carbon_mutex_t mux;
-   m_recv_buffer >> cond;
-   m_recv_buffer >> mux;
-
+   UInt32 seq;
    UInt64 time;
-   m_recv_buffer >> time;
-
-   assert((size_t)mux < m_mutexes.size());
-   assert((size_t)cond < m_conds.size());
-
-   SimCond *psimcond = &m_conds[cond];
+   m_recv_buffer >> cond >> mux >> seq >> time;
 
-   StableIterator<SimMutex> it(m_mutexes, mux);
-   core_id_t new_mutex_owner = psimcond->wait(core_id, time, it);
+   m_conds[cond].wait(core_id, time, mux);
+   notifyThreadStalled(core_id, seq);
 
-   if (new_mutex_owner.tile_id != INVALID_TILE_ID)
-   {
-      // wake up the new owner
-      Reply r;
-
-      r.dummy = SyncClient::MUTEX_LOCK_RESPONSE;
-      r.time = time;
-      m_network.netSend(new_mutex_owner, MCP_RESPONSE_TYPE, (char*)&r, sizeof(r));
-   }
+   unlockForCondWaiter(core_id, mux, time);
 }
 
-
 void SyncServer::condSignal(core_id_t core_id)
 {
    carbon_cond_t cond;
-   m_recv_buffer >> cond;
-
    UInt64 time;
-   m_recv_buffer >> time;
-
-   assert((size_t)cond < m_conds.size());
-
-   SimCond *psimcond = &m_conds[cond];
+   m_recv_buffer >> cond >> time;
 
-   core_id_t woken = psimcond->signal(core_id, time);
-
-   if (woken.tile_id != INVALID_TILE_ID)
+   SimCond::CondWaiter woken(INVALID_CORE_ID, 0, 0);
+   if (m_conds[cond].signal(core_id, time, woken))
    {
-      // wake up the new owner
       // (note: COND_WAIT_RESPONSE == MUTEX_LOCK_RESPONSE, see header)
-      Reply r;
-      r.dummy = SyncClient::MUTEX_LOCK_RESPONSE;
-      r.time = time;
-      m_network.netSend(woken, MCP_RESPONSE_TYPE, (char*)&r, sizeof(r));
-   }
-   else
-   {
-      // nothing...
+      lockForCondWaiter(woken, time);
    }
 
    // Alert the signaler
    UInt32 dummy = SyncClient::COND_SIGNAL_RESPONSE;
-   m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
+   m_network->netSend(core_id, SYNC_SERVER_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
 }
 
 void SyncServer::condBroadcast(core_id_t core_id)
 {
    carbon_cond_t cond;
-   m_recv_buffer >> cond;
-
    UInt64 time;
-   m_recv_buffer >> time;
-
-   assert((size_t)cond < m_conds.size());
-
-   SimCond *psimcond = &m_conds[cond];
+   m_recv_buffer >> cond >> time;
 
    SimCond::WakeupList woken_list;
-   psimcond->broadcast(core_id, time, woken_list);
+   m_conds[cond].broadcast(core_id, time, woken_list);
 
    for (SimCond::WakeupList::iterator it = woken_list.begin(); it != woken_list.end(); it++)
    {
-      assert((*it).tile_id != INVALID_TILE_ID);
-
-      // wake up the new owner
-      // (note: COND_WAIT_RESPONSE == MUTEX_LOCK_RESPONSE, see header)
-      Reply r;
-      r.dummy = SyncClient::MUTEX_LOCK_RESPONSE;
-      r.time = time;
-      m_network.netSend((*it), MCP_RESPONSE_TYPE, (char*)&r, sizeof(r));
+      assert((*it).m_core_id.tile_id != INVALID_TILE_ID);
+      lockForCondWaiter(*it, time);
    }
 
    // Alert the signaler
    UInt32 dummy = SyncClient::COND_BROADCAST_RESPONSE;
-   m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
+   m_network->netSend(core_id, SYNC_SERVER_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
+}
+
+void SyncServer::lockForCondWaiter(const SimCond::CondWaiter &waiter, UInt64 time)
+{
+   tile_id_t mutex_home = getHome(waiter.m_mutex);
+   if (mutex_home == m_tile->getId())
+   {
+      if (m_mutexes[waiter.m_mutex].lock(waiter.m_core_id))
+      {
+         // Woken up thread is able to grab lock immediately
+         sendReply(waiter.m_core_id, SyncClient::COND_WAIT_RESPONSE, true, time);
+      }
+      // else the thread stays stalled in the mutex queue
+   }
+   else
+   {
+      int msg_type = SYNC_MESSAGE_COND_MUTEX_LOCK;
+      m_send_buffer.clear();
+      m_send_buffer << msg_type << waiter.m_core_id << waiter.m_mutex << time;
+      m_network->netSend(Tile::getMainCoreId(mutex_home), SYNC_SERVER_REQUEST_TYPE,
+                         m_send_buffer.getBuffer(), m_send_buffer.size());
+   }
+}
+
+void SyncServer::unlockForCondWaiter(core_id_t core_id, carbon_mutex_t mux, UInt64 time)
+{
+   tile_id_t mutex_home = getHome(mux);
+   if (mutex_home == m_tile->getId())
+   {
+      releaseMutex(core_id, mux, time);
+   }
+   else
+   {
+      int msg_type = SYNC_MESSAGE_COND_MUTEX_UNLOCK;
+      m_send_buffer.clear();
+      m_send_buffer << msg_type << core_id << mux << time;
+      m_network->netSend(Tile::getMainCoreId(mutex_home), SYNC_SERVER_REQUEST_TYPE,
+                         m_send_buffer.getBuffer(), m_send_buffer.size());
+   }
+}
+
+void SyncServer::condMutexLock()
+{
+   core_id_t core_id;
+   carbon_mutex_t mux;
+   UInt64 time;
+   m_recv_buffer >> core_id >> mux >> time;
+
+   lockForCondWaiter(SimCond::CondWaiter(core_id, mux, time), time);
+}
+
+void SyncServer::condMutexUnlock()
+{
+   core_id_t core_id;
+   carbon_mutex_t mux;
+   UInt64 time;
+   m_recv_buffer >> core_id >> mux >> time;
+
+   releaseMutex(core_id, mux, time);
 }
 
 void SyncServer::barrierInit(core_id_t core_id)
 {
+   carbon_barrier_t barrier;
    UInt32 count;
-   m_recv_buffer >> count;
+   m_recv_buffer >> barrier >> count;
 
-   m_barriers.push_back(SimBarrier(count));
-   UInt32 barrier = (UInt32)m_barriers.size()-1;
+   LOG_ASSERT_ERROR(m_barriers.find(barrier) == m_barriers.end(), "barrier(%i) already initialized", barrier);
+   m_barriers.insert(make_pair(barrier, SimBarrier(count)));
 
-   m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&barrier, sizeof(barrier));
+   UInt32 dummy = SyncClient::BARRIER_INIT_RESPONSE;
+   m_network->netSend(core_id, SYNC_SERVER_RESPONSE_TYPE, (char*)&dummy, sizeof(dummy));
 }
 
 void SyncServer::barrierWait(core_id_t core_id)
 {
    carbon_barrier_t barrier;
-   m_recv_buffer >> barrier;
-
+   UInt32 seq;
    UInt64 time;
-   m_recv_buffer >> time;
+   m_recv_buffer >> barrier >> seq >> time;
 
-   LOG_ASSERT_ERROR(barrier < (carbon_barrier_t) m_barriers.size(), "barrier = %i, m_barriers.size()= %u", barrier, m_barriers.size());
+   BarrierMap::iterator barrier_it = m_barriers.find(barrier);
+   LOG_ASSERT_ERROR(barrier_it != m_barriers.end(), "barrier(%i) not initialized", barrier);
 
-   SimBarrier *psimbarrier = &m_barriers[barrier];
+   SimBarrier *psimbarrier = &barrier_it->second;
 
    SimBarrier::WakeupList woken_list;
    psimbarrier->wait(core_id, time, woken_list);
 
+   if (woken_list.empty())
+   {
+      notifyThreadStalled(core_id, seq);
+      return;
+   }
+
    UInt64 max_time = psimbarrier->getMaxTime();
 
    for (SimBarrier::WakeupList::iterator it = woken_list.begin(); it != woken_list.end(); it++)
    {
       assert((*it).tile_id != INVALID_TILE_ID);
-      Reply r;
-      r.dummy = SyncClient::BARRIER_WAIT_RESPONSE;
-      r.time = max_time;
-      core_id_t core_id = (*it);
-      m_network.netSend(core_id, MCP_RESPONSE_TYPE, (char*)&r, sizeof(r));
+      // All but the last thread to arrive were stalled
+      bool stalled = ((*it).tile_id != core_id.tile_id) || ((*it).core_type != core_id.core_type);
+      sendReply(*it, SyncClient::BARRIER_WAIT_RESPONSE, stalled, max_time);
+   }
+}
+
+void SyncServer::sendReply(core_id_t core_id, UInt32 response, bool stalled, UInt64 time)
+{
+   SyncClient::Reply r;
+   r.dummy = response;
+   r.stalled = stalled;
+   r.time = time;
+   m_network->netSend(core_id, SYNC_SERVER_RESPONSE_TYPE, (char*)&r, sizeof(r));
+}
+
+void SyncServer::notifyThreadStalled(core_id_t core_id, UInt32 seq)
+{
+   int msg_type = MCP_MESSAGE_SYNC_THREAD_STALL;
+   m_send_buffer.clear();
+   m_send_buffer << msg_type << core_id << seq;
+   m_network->netSend(Config::getSingleton()->getMCPCoreId(), MCP_REQUEST_TYPE,
+                      m_send_buffer.getBuffer(), m_send_buffer.size());
+}
+
+// -- SyncStallTracker -- //
+
+SyncStallTracker::SyncStallTracker()
+      : m_stalled(Config::getSingleton()->getTotalTiles(), false)
+      , m_stalled_seq(Config::getSingleton()->getTotalTiles(), 0)
+      , m_resumed_seq(Config::getSingleton()->getTotalTiles(), 0)
+{ }
+
+SyncStallTracker::~SyncStallTracker()
+{ }
+
+void SyncStallTracker::stall(core_id_t core_id, UInt32 seq)
+{
+   tile_id_t tile_id = core_id.tile_id;
+
+   // The thread already told us it was woken up
+   if (seq <= m_resumed_seq[tile_id])
+      return;
+
+   if (seq > m_stalled_seq[tile_id])
+      m_stalled_seq[tile_id] = seq;
+   if (!m_stalled[tile_id])
+   {
+      m_stalled[tile_id] = true;
+      Sim()->getThreadManager()->stallThread(core_id);
+   }
+}
+
+void SyncStallTracker::resume(core_id_t core_id, UInt32 seq)
+{
+   tile_id_t tile_id = core_id.tile_id;
+
+   if (seq <= m_resumed_seq[tile_id])
+      return;
+   m_resumed_seq[tile_id] = seq;
+
+   // A stall of a later operation may have overtaken this resume
+   if (m_stalled[tile_id] && (m_stalled_seq[tile_id] <= seq))
+   {
+      m_stalled[tile_id] = false;
+      Sim()->getThreadManager()->resumeThread(core_id);
    }
 }
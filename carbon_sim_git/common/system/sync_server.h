@@ -3,6 +3,7 @@
 
 #include <queue>
 #include <vector>
+#include <map>
 #include <limits.h>
 #include <string.h>
 
@@ -10,7 +11,8 @@
 #include "transport.h"
 #include "network.h"
 #include "packetize.h"
-#include "stable_iterator.h"
+
+class Tile;
 
 class SimMutex
 {
@@ -38,27 +40,28 @@ class SimCond
 {
 
    public:
-      typedef std::vector<core_id_t> WakeupList;
-
-      SimCond();
-      ~SimCond();
-
-      // returns the thread that gets woken up when the mux is unlocked
-      core_id_t wait(core_id_t core_id, UInt64 time, StableIterator<SimMutex> & it);
-      core_id_t signal(core_id_t core_id, UInt64 time);
-      void broadcast(core_id_t core_id, UInt64 time, WakeupList &woken);
-
-   private:
       class CondWaiter
       {
          public:
-            CondWaiter(core_id_t core_id, StableIterator<SimMutex> mutex, UInt64 time)
+            CondWaiter(core_id_t core_id, carbon_mutex_t mutex, UInt64 time)
                   : m_core_id(core_id), m_mutex(mutex), m_arrival_time(time) {}
             core_id_t m_core_id;
-            StableIterator<SimMutex> m_mutex;
+            carbon_mutex_t m_mutex;
             UInt64 m_arrival_time;
       };
 
+      typedef std::vector<CondWaiter> WakeupList;
+
+      SimCond();
+      ~SimCond();
+
+      // The mutex is released by the server, possibly on another tile
+      void wait(core_id_t core_id, UInt64 time, carbon_mutex_t mux);
+      // returns false if there is no thread to wake up
+      bool signal(core_id_t core_id, UInt64 time, CondWaiter &woken);
+      void broadcast(core_id_t core_id, UInt64 time, WakeupList &woken);
+
+   private:
       typedef std::vector< CondWaiter > ThreadQueue;
       ThreadQueue m_waiting;
 };
@@ -83,39 +86,83 @@ class SimBarrier
       UInt64 m_max_time;
 };
 
+// Synchronization objects are homed on the application tiles by hashing
+// their id (see getHome()). Every tile runs a SyncServer for the objects
+// homed on it, on its sim thread, so the state machines need no locking and
+// the sync throughput scales with the number of tiles.
+//   A cond and the mutex passed to condWait() can have different homes: the
+// cond home releases and re-acquires the mutex on behalf of the waiting
+// thread with COND_MUTEX_UNLOCK/COND_MUTEX_LOCK messages to the mutex home.
+//   The thread states are kept by the ThreadManager on the MCP. A home tells
+// the MCP when it makes a thread wait (MCP_MESSAGE_SYNC_THREAD_STALL) and
+// the thread itself tells the MCP once it is woken up (see SyncClient).
 class SyncServer
 {
-      typedef std::vector<SimMutex> MutexVector;
-      typedef std::vector<SimCond> CondVector;
-      typedef std::vector<SimBarrier> BarrierVector;
+   public:
+      SyncServer(Tile* tile);
+      ~SyncServer();
 
-      MutexVector m_mutexes;
-      CondVector m_conds;
-      BarrierVector m_barriers;
+      // Home tile of a mutex/cond/barrier
+      static tile_id_t getHome(SInt32 id);
 
-      // FIXME: This should be better organized -- too much redundant crap
+      void handleRequest(NetPacket &packet);
 
-   public:
-      SyncServer(Network &network, UnstructuredBuffer &recv_buffer);
-      ~SyncServer();
+   private:
+      typedef std::map<carbon_mutex_t, SimMutex> MutexMap;
+      typedef std::map<carbon_cond_t, SimCond> CondMap;
+      typedef std::map<carbon_barrier_t, SimBarrier> BarrierMap;
+
+      Tile* m_tile;
+      Network* m_network;
+      UnstructuredBuffer m_recv_buffer;
+      UnstructuredBuffer m_send_buffer;
+
+      MutexMap m_mutexes;
+      CondMap m_conds;
+      BarrierMap m_barriers;
 
       // Remaining parameters to these functions are stored
       // in the recv buffer and get unpacked
-      void mutexInit(core_id_t core_id);
       void mutexLock(core_id_t core_id);
       void mutexUnlock(core_id_t core_id);
 
-      void condInit(core_id_t core_id);
       void condWait(core_id_t core_id);
       void condSignal(core_id_t core_id);
       void condBroadcast(core_id_t core_id);
 
-      void barrierInit(core_id_t);
-      void barrierWait(core_id_t);
+      void barrierInit(core_id_t core_id);
+      void barrierWait(core_id_t core_id);
+
+      void condMutexLock();
+      void condMutexUnlock();
+
+      // Mutex operations on behalf of a thread waiting on a cond
+      void lockForCondWaiter(const SimCond::CondWaiter &waiter, UInt64 time);
+      void unlockForCondWaiter(core_id_t core_id, carbon_mutex_t mux, UInt64 time);
+      void releaseMutex(core_id_t core_id, carbon_mutex_t mux, UInt64 time);
+
+      void sendReply(core_id_t core_id, UInt32 response, bool stalled, UInt64 time);
+      void notifyThreadStalled(core_id_t core_id, UInt32 seq);
+};
+
+// Applies the stall/resume notifications of the SyncServers to the thread
+// states on the MCP. The stall of a thread is sent by the home of the object
+// it waits on and its resume by the thread itself, so the two can arrive in
+// any order; each blocking operation of a core carries a sequence number to
+// match them up.
+class SyncStallTracker
+{
+   public:
+      SyncStallTracker();
+      ~SyncStallTracker();
+
+      void stall(core_id_t core_id, UInt32 seq);
+      void resume(core_id_t core_id, UInt32 seq);
 
    private:
-      Network &m_network;
-      UnstructuredBuffer &m_recv_buffer;
+      std::vector<bool> m_stalled;
+      std::vector<UInt32> m_stalled_seq;
+      std::vector<UInt32> m_resumed_seq;
 };
 
 #endif // SYNC_SERVER_H
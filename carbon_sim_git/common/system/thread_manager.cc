@@ -176,6 +176,9 @@ void ThreadManager::onThreadExit()
    // Set the CoreState to 'IDLE'
    core->setState(Core::IDLE);
 
+   // The clock of the core no longer holds back the network event engines
+   Network::advanceEventEngines();
+
    // terminate thread locally so we are ready for new thread requests on that tile
    m_tile_manager->terminateThread();
 
@@ -525,12 +528,12 @@ void ThreadManager::terminateThreadSpawners()
       LOG_PRINT ("Sent thread spawner quit message to proc %d", pid);
    }
 
-   // wait for all thread spawners to terminate
+   // wait for all thread spawners to terminate (the one of this process acks too)
    while (true)
    {
       {
          ScopedLock sl(m_thread_spawners_terminated_lock);
-         if (m_thread_spawners_terminated == (Config::getSingleton()->getProcessCount()-1))
+         if (m_thread_spawners_terminated == Config::getSingleton()->getProcessCount())
             break;
       }
       sched_yield();
@@ -3,12 +3,14 @@
 
 #include <vector>
 
+#include "decoded_instruction.h"
+
 class Instruction;
 
 class BasicBlock : public std::vector<Instruction*>
 {
 public:
-   BasicBlock(bool dynamic = false) 
+   BasicBlock(bool dynamic = false)
       : m_dynamic(dynamic)
       {}
 
@@ -26,8 +28,22 @@ public:
 
    bool isDynamic() { return m_dynamic; }
 
+   // Builds the contiguous array of decoded instructions the core models
+   // iterate over. Must be called once all the instructions are added (and
+   // their address and size set), before the basic block is queued
+   void decode()
+      {
+         m_decoded.resize(size());
+         for (unsigned int i = 0; i < size(); i++)
+            m_decoded[i].decode((*this)[i]);
+      }
+
+   bool isDecoded() const { return (m_decoded.size() == size()); }
+   const DecodedInstruction* getDecodedInstructions() const { return &m_decoded[0]; }
+
 private:
    bool m_dynamic;
+   std::vector<DecodedInstruction> m_decoded;
 };
 
 #endif
@@ -19,10 +19,6 @@
 
 using namespace std;
 
-int Core::s_rambda_buffer_count[MAX_CORES][MAX_CORES] = {{0,}, };
-bool Core::s_block_send[MAX_CORES] = {false, };
-
-
 Core::Core(Tile *tile, core_type_t core_type)
    : m_tile(tile)
    , m_core_id((core_id_t) {tile->getId(), core_type})
@@ -49,8 +45,7 @@ Core::Core(Tile *tile, core_type_t core_type)
 	m_queue_model = QueueModel::create("history_tree", min_processing_time);
 	CHECKBUFFER_COST = (UInt64) Sim()->getCfg()->getInt("atac/design/delay_to_access_queue", 0);
    cout << "[ATAC setting] delay_to_access_queue: " << CHECKBUFFER_COST << endl;
-   LAMBDA_QUEUE_LENGTH = (UInt64) Sim()->getCfg()->getInt("atac/design/lambda_queue_length", 100);
-   cout << "[ATAC setting] lambda_queue_length: " << LAMBDA_QUEUE_LENGTH << endl;
+   m_lambda_queue_flow_control = new LambdaQueueFlowControl(this);
 //ATAC fix end
 }
 
@@ -67,37 +62,50 @@ Core::~Core()
    delete m_sync_client;
    delete m_core_model;
    
+   delete m_lambda_queue_flow_control;//ATAC fix 
    delete message_buffer;//ATAC fix 
 }
 
-int Core::filter_incoming_messages(carbon_network_t net_type) { //Just one round.
+int Core::filter_incoming_messages(carbon_network_t net_type) {
   
   PacketType pkt_type = getPktTypeFromUserNetType(net_type); //Clean this up.
+
+  // The packets are filtered as they arrive at the tile: only the ones that
+  // passed the filter since the last call are processed here
+  m_tile->m_filtered_ingestor->enable(pkt_type);
+  vector<NetPacket> packets;
+  m_tile->m_filtered_ingestor->pop_filtered_packets(packets);
+
+  // Wait for the last of them to arrive
+  UInt64 start_time = getPerformanceModel()->getCycleCount();
+  UInt64 last_packet_time = start_time;
+  for (vector<NetPacket>::iterator it = packets.begin(); it != packets.end(); it++)
+     last_packet_time = max<UInt64>(last_packet_time, (*it).time);
+  if (last_packet_time > start_time)
+     getPerformanceModel()->queueDynamicInstruction(new RecvInstruction(last_packet_time - start_time));
 	
   int total_incoming = 0;
-  for(int i=0; i<NUMBER_OF_WAVELENGTHS; i++) {
-    core_id_t sender_core = (core_id_t) {i, this->getCoreType()};
-	  NetPacket packet = m_tile->m_filtered_ingestor->receive_filtered_from(sender_core, pkt_type); //CHECK whether the dimension of sender ids matches with number of wavelengths.
-	  //Check whether it is not found.
-	  if(packet.found){
-		  //TODO: ATAC PerfModel
-        #ifdef TEST_ATAC
-            AtacTester::modifyPacketTime(packet);
-        #endif
-		  UInt64 delay = m_queue_model->computeQueueDelay(packet.time, 10);
-			packet.time += delay; //TODO: check correctness.
-		  cout<< "** delay for a packet is " << delay << " PACKET.TIME = " << packet.time << " time elapsed = " << packet.time - packet.init_time 
-			    << " <sender, receiver>: <" << packet.sender.tile_id << ", " << packet.receiver.tile_id << ">" << endl;
-		  //TODO:manipulate packet.time to include the queuing delay.
-			m_core_model->increment_packet_processed_count();
-			//m_core_model->increment_packet_delay(delay);
-         m_core_model->increment_packet_delay(packet.time - packet.init_time);
-			
-		  
-		  if(!message_buffer->enqueue_message( packet )) //TODO: create message buffer in constructor.
-		     return -1; //TODO: raise exception here 
-		  total_incoming++;
-	  }
+  for (vector<NetPacket>::iterator it = packets.begin(); it != packets.end(); it++) {
+     NetPacket packet = *it;
+     //TODO: ATAC PerfModel
+     #ifdef TEST_ATAC
+        AtacTester::modifyPacketTime(packet);
+     #endif
+     UInt64 delay = m_queue_model->computeQueueDelay(packet.time, 10);
+     packet.time += delay; //TODO: check correctness.
+     LOG_PRINT("Delay for a packet is %llu, packet time(%llu), time elapsed(%llu), sender(%i), receiver(%i)",
+               delay, packet.time, packet.time - packet.init_time, packet.sender.tile_id, packet.receiver.tile_id);
+     //TODO:manipulate packet.time to include the queuing delay.
+     m_core_model->increment_packet_processed_count();
+     //m_core_model->increment_packet_delay(delay);
+     m_core_model->increment_packet_delay(packet.time - packet.init_time);
+
+     // the packet left the lambda queue
+     m_lambda_queue_flow_control->releaseCredit(packet);
+
+     if(!message_buffer->enqueue_message( packet )) //TODO: create message buffer in constructor.
+        return -1; //TODO: raise exception here 
+     total_incoming++;
   }
   return total_incoming;
 }
@@ -113,6 +121,7 @@ int Core::dequeue_filtered_message(int virtual_channel_id, char* msg_to_receive,
       
 	//TODO:check packet.time to determine.
 	memcpy(msg_to_receive, msg, msg_size);
+	packet.releasePayload();
 	return msg_size;
 }
 
@@ -124,19 +133,11 @@ int Core::coreSendW(int sender, int receiver, char* buffer, int size, carbon_net
    
    SInt32 sent;
    if (receiver == CAPI_ENDPOINT_ALL){
-      cout<< " capi endpoint all inside" << endl;
       //ATAC fix start
-      if (s_block_send[sender]){
-         cout<< " Cannot broadcast due to contention" << endl;
-         return -1; //Cannot broadcast due to contention.
-      }
-      for (int i = 0; i < MAX_CORES; i++){
-         Core::s_rambda_buffer_count[i][sender]++;
-         if (Core::s_rambda_buffer_count[i][sender] >= LAMBDA_QUEUE_LENGTH - 4){
-            //cout<< "[ATAC] STOP SEND ALERT for " << i <<endl;
-            s_block_send[i] = true; //STOP SEND ALERT
-         }
-      }
+      // Fails while a receiver has no free slot in its lambda queue: the
+      // application retries (and receives the broadcasts of the others)
+      if (!m_lambda_queue_flow_control->acquireBroadcastCredits(pkt_type))
+         return -1;
       //ATAC fix end
       sent = m_tile->getNetwork()->netBroadcast(pkt_type, buffer, size);
    } else{
@@ -154,13 +155,6 @@ int Core::coreSendW(int sender, int receiver, char* buffer, int size, carbon_net
 int Core::coreRecvW(int sender, int receiver, char* buffer, int size, carbon_network_t net_type)
 {
    PacketType pkt_type = getPktTypeFromUserNetType(net_type);
-   //ATAC fix start
-   Core::s_rambda_buffer_count[receiver][sender]--;
-   if (Core::s_rambda_buffer_count[receiver][sender] == LAMBDA_QUEUE_LENGTH - 4 - 1){
-      s_block_send[sender] = false; //STOP SEND ALERT REMOVE
-      cout<< "[ATAC] STOP SEND ALERT REMOVED for " << sender <<endl;
-   }
-   //ATAC fix end
 
    core_id_t sender_core = (core_id_t) {sender, getCoreType()};
 
@@ -177,9 +171,18 @@ int Core::coreRecvW(int sender, int receiver, char* buffer, int size, carbon_net
 
    memcpy(buffer, packet.data, size);
 
-   // De-allocate dynamic memory
+   //ATAC fix start
+   // the packet left the lambda queue
+   m_lambda_queue_flow_control->releaseCredit(packet);
+   //ATAC fix end
+
+   // De-allocate dynamic memory: the filtered packets hold a reference to a
+   // payload shared with the other receivers, netRecv() hands out a copy
    // Is this the best place to de-allocate packet.data ??
-   delete [](Byte*)packet.data;
+   if (packet.shared_payload)
+      packet.releasePayload();
+   else
+      delete [](Byte*)packet.data;
 
    return (unsigned)size == packet.length ? 0 : -1;
 }
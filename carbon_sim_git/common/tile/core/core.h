@@ -24,6 +24,7 @@ class PinMemoryManager;
 
 #include "message.h"
 #include "message_buffer.h"
+#include "lambda_queue_flow_control.h"
 
 using namespace std;
 
@@ -89,6 +90,7 @@ public:
    Network* getNetwork()                     { return m_network; }
    ShmemPerfModel* getShmemPerfModel()       { return m_shmem_perf_model; }
    MemoryManager *getMemoryManager()         { return m_memory_manager; }
+   LambdaQueueFlowControl *getLambdaQueueFlowControl() { return m_lambda_queue_flow_control; }
 
    State getState();
    void setState(State core_state);
@@ -117,10 +119,7 @@ protected:
    MessageBuffer *message_buffer;
 	QueueModel *m_queue_model;
 	int CHECKBUFFER_COST;
-   int LAMBDA_QUEUE_LENGTH;
-   static const int MAX_CORES = 65;
-   static int s_rambda_buffer_count[MAX_CORES][MAX_CORES];
-   static bool s_block_send[MAX_CORES];
+   LambdaQueueFlowControl *m_lambda_queue_flow_control;
 //ATAC fix end
 };
 
@@ -9,6 +9,9 @@
 #include "config.h"
 #include "fxsupport.h"
 #include "utils.h"
+#include "memory_manager.h"
+#include "shmem_perf_model.h"
+#include "checkpoint.h"
 
 CoreModel* CoreModel::create(Core* core)
 {
@@ -36,12 +39,61 @@ CoreModel::CoreModel(Core *core, float frequency)
    , m_total_time(0)
    , m_checkpointed_cycle_count(0)
    , m_enabled(false)
+   , m_trace_buffer(0)
+   , m_trace_batch_size(1)
+   , m_num_trace_records(0)
+   , m_trace_buffer_stale(false)
+   , m_sampling_enabled(false)
+   , m_sampling_mode(FAST_FORWARD)
+   , m_sampling_period(0)
+   , m_sampling_warmup(0)
+   , m_sampling_window(0)
+   , m_sampling_position(0)
+   , m_fast_forward_cpi(1.0)
+   , m_fast_forward_cycles(0.0)
+   , m_fast_forward_address(0)
+   , m_window_start_cycle_count(0)
+   , m_window_start_instruction_count(0)
+   , m_window_start_l1_dcache_accesses(0)
+   , m_window_start_l1_dcache_misses(0)
+   , m_window_start_l2_cache_accesses(0)
+   , m_window_start_l2_cache_misses(0)
    , m_current_ins_index(0)
    , m_bp(0)
 {
    // Create Branch Predictor
    m_bp = BranchPredictor::create();
 
+   try
+   {
+      m_trace_batch_size = (UInt32) Sim()->getCfg()->getInt("core/trace_buffer/batch_size", 64);
+   }
+   catch (...)
+   {
+      LOG_PRINT_ERROR("Could not read core/trace_buffer/batch_size from the cfg file");
+   }
+   LOG_ASSERT_ERROR(m_trace_batch_size >= 1, "core/trace_buffer/batch_size(%u) must be >= 1", m_trace_batch_size);
+   // A basic block and the info of its branch per instruction
+   m_trace_buffer = new TraceBuffer(2 * m_trace_batch_size);
+
+   try
+   {
+      m_sampling_enabled = Sim()->getCfg()->getBool("core/sampling/enabled", false);
+      if (m_sampling_enabled)
+      {
+         m_sampling_period = (UInt64) Sim()->getCfg()->getInt("core/sampling/period");
+         m_sampling_warmup = (UInt64) Sim()->getCfg()->getInt("core/sampling/warmup");
+         m_sampling_window = (UInt64) Sim()->getCfg()->getInt("core/sampling/detailed_window");
+      }
+   }
+   catch (...)
+   {
+      LOG_PRINT_ERROR("Could not read core/sampling parameters from the cfg file");
+   }
+   LOG_ASSERT_ERROR(!m_sampling_enabled || ((m_sampling_window > 0) && (m_sampling_warmup + m_sampling_window <= m_sampling_period)),
+                    "core/sampling: detailed_window(%llu) must be > 0 and warmup(%llu) + detailed_window must be <= period(%llu)",
+                    m_sampling_window, m_sampling_warmup, m_sampling_period);
+
    // Initialize Pipeline Stall Counters
    initializePipelineStallCounters();
 }
@@ -49,6 +101,7 @@ CoreModel::CoreModel(Core *core, float frequency)
 CoreModel::~CoreModel()
 {
    delete m_bp; m_bp = 0;
+   delete m_trace_buffer; m_trace_buffer = 0;
 }
 
 void CoreModel::outputSummary(ostream& os)
@@ -69,7 +122,20 @@ void CoreModel::outputSummary(ostream& os)
    os << "    Check Buffer Instruction Costs: " << m_total_check_buffer_instruction_costs << endl;
 	os << "    Total Instructions through Chip: " << m_total_packet_through_chip << endl;
    os << "    Average Whole Packet Delay: " << (m_total_packet_through_chip==0 ? 0 : ((double)m_total_packet_transport_delay / m_total_packet_through_chip)) << endl;
+   os << "    Total Flow Control Instructions: " << m_total_flow_control_instructions << endl;
+   os << "    Total Flow Control Stall Time (in ns): " << (UInt64) ((double) m_total_flow_control_stall_cycles / m_frequency) << endl;
 //ATAC fix end   
+   if (m_sampling_enabled)
+   {
+      os << "    Sampled Windows: " << m_sampled_ipc.getCount() << endl;
+      os << "    Sampled IPC: " << m_sampled_ipc.getMean() << endl;
+      os << "    Sampled IPC 95% Confidence Interval (+/-): " << m_sampled_ipc.getConfidenceInterval() << endl;
+      os << "    Sampled L1-D Cache Miss Rate (%): " << m_sampled_l1_dcache_miss_rate.getMean() << endl;
+      os << "    Sampled L1-D Cache Miss Rate 95% Confidence Interval (+/-): " << m_sampled_l1_dcache_miss_rate.getConfidenceInterval() << endl;
+      os << "    Sampled L2 Cache Miss Rate (%): " << m_sampled_l2_cache_miss_rate.getMean() << endl;
+      os << "    Sampled L2 Cache Miss Rate 95% Confidence Interval (+/-): " << m_sampled_l2_cache_miss_rate.getConfidenceInterval() << endl;
+   }
+
    // Branch Predictor Summary
    if (m_bp)
       m_bp->outputSummary(os);
@@ -83,12 +149,61 @@ void CoreModel::enable()
       return;
 
    m_enabled = true;
+
+   if (m_sampling_enabled)
+   {
+      // Start a new period. All the models were just enabled, as in WARMUP
+      m_sampling_position = 0;
+      m_sampling_mode = WARMUP;
+      switchSamplingMode(getSamplingMode(m_sampling_position));
+   }
    LOG_PRINT("enable() end");
 }
 
 void CoreModel::disable()
 {
    m_enabled = false;
+   m_trace_buffer_stale = true;
+}
+
+// Neither the sampling state nor the branch predictor are saved: sampling
+// starts a new period when the models are enabled
+void CoreModel::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("core_model");
+   writer << (float) m_frequency << m_cycle_count << m_instruction_count
+          << (float) m_average_frequency << m_total_time << m_checkpointed_cycle_count;
+   writer << m_total_recv_instructions << m_total_sync_instructions
+          << m_total_recv_instruction_stall_cycles << m_total_sync_instruction_stall_cycles
+          << m_total_memory_stall_cycles << m_total_execution_unit_stall_cycles
+          << m_total_check_buffer_instructions << m_total_check_buffer_instruction_costs
+          << m_total_packet_through_chip << m_total_packet_transport_delay
+          << m_total_flow_control_instructions << m_total_flow_control_stall_cycles;
+   checkpointStallCounters(writer);
+   writer.endSection();
+}
+
+void CoreModel::restore(CheckpointReader& reader)
+{
+   volatile float frequency = m_frequency;
+   float checkpoint_frequency, average_frequency;
+
+   reader.beginSection("core_model");
+   reader >> checkpoint_frequency >> m_cycle_count >> m_instruction_count
+          >> average_frequency >> m_total_time >> m_checkpointed_cycle_count;
+   reader >> m_total_recv_instructions >> m_total_sync_instructions
+          >> m_total_recv_instruction_stall_cycles >> m_total_sync_instruction_stall_cycles
+          >> m_total_memory_stall_cycles >> m_total_execution_unit_stall_cycles
+          >> m_total_check_buffer_instructions >> m_total_check_buffer_instruction_costs
+          >> m_total_packet_through_chip >> m_total_packet_transport_delay
+          >> m_total_flow_control_instructions >> m_total_flow_control_stall_cycles;
+   restoreStallCounters(reader);
+   reader.endSection();
+
+   m_frequency = checkpoint_frequency;
+   m_average_frequency = average_frequency;
+   if (checkpoint_frequency != frequency)
+      updateInternalVariablesOnFrequencyChange(frequency);
 }
 
 // This function is called:
@@ -109,6 +224,7 @@ void CoreModel::updateInternalVariablesOnFrequencyChange(volatile float frequenc
    m_total_execution_unit_stall_cycles = (UInt64) (((double) m_total_execution_unit_stall_cycles / old_frequency) * new_frequency);
    m_total_recv_instruction_stall_cycles = (UInt64) (((double) m_total_recv_instruction_stall_cycles / old_frequency) * new_frequency);
    m_total_sync_instruction_stall_cycles = (UInt64) (((double) m_total_sync_instruction_stall_cycles / old_frequency) * new_frequency);
+   m_total_flow_control_stall_cycles = (UInt64) (((double) m_total_flow_control_stall_cycles / old_frequency) * new_frequency);
 }
 
 // This function is called:
@@ -145,27 +261,34 @@ void CoreModel::initializePipelineStallCounters()
 	m_total_check_buffer_instruction_costs = 0;
    m_total_packet_through_chip = 0;
    m_total_packet_transport_delay = 0;
+   m_total_flow_control_instructions = 0;
+   m_total_flow_control_stall_cycles = 0;
 //ATAC fix end
 }
 
-void CoreModel::updatePipelineStallCounters(Instruction* i, UInt64 memory_stall_cycles, UInt64 execution_unit_stall_cycles)
+void CoreModel::updatePipelineStallCounters(const DecodedInstruction& i, UInt64 cost, UInt64 memory_stall_cycles, UInt64 execution_unit_stall_cycles)
 {
-   switch (i->getType())
+   switch (i.getType())
    {
       case INST_RECV:
          m_total_recv_instructions ++;
-         m_total_recv_instruction_stall_cycles += i->getCost();
+         m_total_recv_instruction_stall_cycles += cost;
          break;
 
       case INST_SYNC:
          m_total_sync_instructions ++;
-         m_total_sync_instruction_stall_cycles += i->getCost();
+         m_total_sync_instruction_stall_cycles += cost;
          break;
       
       case INST_CKBUFFER:
 		   m_total_check_buffer_instructions ++;
-			m_total_check_buffer_instruction_costs += i->getCost();
+			m_total_check_buffer_instruction_costs += cost;
 			break;
+
+      case INST_FLOW_CONTROL:
+         m_total_flow_control_instructions ++;
+         m_total_flow_control_stall_cycles += cost;
+         break;
 			
       default:
          break;
@@ -185,8 +308,16 @@ void CoreModel::queueDynamicInstruction(Instruction *i)
 
    BasicBlock *bb = new BasicBlock(true);
    bb->push_back(i);
-   ScopedLock sl(m_basic_block_queue_lock);
-   m_basic_block_queue.push(bb);
+   bb->decode();
+   flushTraceBuffer();
+   {
+      ScopedLock sl(m_basic_block_queue_lock);
+      m_basic_block_queue.push(bb);
+   }
+
+   // No basic block follows it while fast-forwarding
+   if (m_sampling_enabled && (m_sampling_mode == FAST_FORWARD))
+      modelBasicBlocks(0);
 }
 
 void CoreModel::queueBasicBlock(BasicBlock *basic_block)
@@ -194,11 +325,116 @@ void CoreModel::queueBasicBlock(BasicBlock *basic_block)
    if (!m_enabled || !Config::getSingleton()->getEnablePerformanceModeling())
       return;
 
+   flushTraceBuffer();
    ScopedLock sl(m_basic_block_queue_lock);
    m_basic_block_queue.push(basic_block);
 }
 
+void CoreModel::traceBasicBlock(BasicBlock *basic_block, bool flush)
+{
+   if (!m_enabled || !Config::getSingleton()->getEnablePerformanceModeling())
+      return;
+
+   if (m_sampling_enabled)
+   {
+      advanceSamplingPosition(basic_block->size());
+      if (m_sampling_mode == FAST_FORWARD)
+      {
+         fastForward(basic_block);
+         return;
+      }
+   }
+
+   TraceRecord record;
+   record.basic_block = basic_block;
+   traceRecord(record);
+
+   if (flush || (m_num_trace_records >= m_trace_batch_size))
+      drainTraceBuffer();
+}
+
+void CoreModel::traceDynamicInstructionInfo(const DynamicInstructionInfo &i)
+{
+   if (!m_enabled || !Config::getSingleton()->getEnablePerformanceModeling())
+      return;
+
+   if (m_sampling_enabled && (m_sampling_mode == FAST_FORWARD))
+   {
+      // Keep the branch predictor warm
+      if ((i.type == DynamicInstructionInfo::BRANCH) && m_bp)
+      {
+         bool prediction = m_bp->predict(m_fast_forward_address, i.branch_info.target);
+         m_bp->update(prediction, i.branch_info.taken, m_fast_forward_address, i.branch_info.target);
+      }
+      return;
+   }
+
+   TraceRecord record;
+   record.basic_block = NULL;
+   record.info = i;
+   traceRecord(record);
+}
+
+void CoreModel::traceRecord(const TraceRecord &record)
+{
+   discardStaleTraceRecords();
+   while (!m_trace_buffer->push(record))
+      flushTraceBuffer();
+   m_num_trace_records ++;
+}
+
+// Moves the buffered records to the basic block and dynamic info queues, in
+// order, so that they stay ordered with the instructions and infos queued
+// directly by the simulator
+void CoreModel::flushTraceBuffer()
+{
+   discardStaleTraceRecords();
+   if (m_trace_buffer->empty())
+      return;
+
+   ScopedLock bl(m_basic_block_queue_lock);
+   ScopedLock il(m_dynamic_info_queue_lock);
+
+   TraceRecord record;
+   while (m_trace_buffer->pop(record))
+   {
+      if (record.basic_block)
+         m_basic_block_queue.push(record.basic_block);
+      else
+         m_dynamic_info_queue.push(record.info);
+   }
+   m_num_trace_records = 0;
+}
+
+// The ring is only popped by the thread of the core, so disable() (called
+// from any thread) leaves the dropping to it
+void CoreModel::discardStaleTraceRecords()
+{
+   if (!m_trace_buffer_stale)
+      return;
+
+   m_trace_buffer_stale = false;
+   TraceRecord record;
+   while (m_trace_buffer->pop(record))
+      ;
+   m_num_trace_records = 0;
+}
+
+void CoreModel::drainTraceBuffer()
+{
+   if (!m_enabled || !Config::getSingleton()->getEnablePerformanceModeling())
+      return;
+
+   flushTraceBuffer();
+   iterate();
+}
+
 void CoreModel::iterate()
+{
+   modelBasicBlocks(1);
+}
+
+void CoreModel::modelBasicBlocks(UInt32 num_unmodeled)
 {
    // Because we will sometimes not have info available (we will throw
    // a DynamicInstructionInfoNotAvailable), we need to be able to
@@ -208,10 +444,12 @@ void CoreModel::iterate()
 
    ScopedLock sl(m_basic_block_queue_lock);
 
-   while (m_basic_block_queue.size() > 1)
+   while (m_basic_block_queue.size() > num_unmodeled)
    {
       LOG_PRINT("Basic Block Queue Size(%lu)", m_basic_block_queue.size());
       BasicBlock *current_bb = m_basic_block_queue.front();
+      LOG_ASSERT_ERROR(current_bb->isDecoded(), "Basic block queued before being decoded");
+      const DecodedInstruction *instructions = current_bb->getDecodedInstructions();
 
       try
       {
@@ -219,7 +457,7 @@ void CoreModel::iterate()
          {
             try
             {
-               handleInstruction(current_bb->at(m_current_ins_index));
+               handleInstruction(instructions[m_current_ins_index]);
             }
             catch (AbortInstructionException)
             {
@@ -246,7 +484,12 @@ void CoreModel::pushDynamicInstructionInfo(DynamicInstructionInfo &i)
    if (!m_enabled || !Config::getSingleton()->getEnablePerformanceModeling())
       return;
 
+   // Only the instructions modeled in detail consume infos
+   if (m_sampling_enabled && (m_sampling_mode == FAST_FORWARD))
+      return;
+
    LOG_PRINT("Push Info(%u)", i.type);
+   flushTraceBuffer();
    ScopedLock sl(m_dynamic_info_queue_lock);
    m_dynamic_info_queue.push(i);
 }
@@ -295,3 +538,101 @@ void CoreModel::increment_packet_processed_count(){
 void CoreModel::increment_packet_delay(UInt64 delay){
    m_total_packet_transport_delay += delay;
 }
+
+// Sampling
+
+void CoreModel::advanceSamplingPosition(UInt32 num_instructions)
+{
+   // The position is only wrapped before the next basic block, so that the
+   // last basic block of a period is modeled in the mode of its window
+   bool new_period = (m_sampling_position >= m_sampling_period);
+   if (new_period)
+      m_sampling_position %= m_sampling_period;
+
+   SamplingMode mode = getSamplingMode(m_sampling_position);
+   // A new period starts a new measurement window even if there is no
+   // fast-forwarding in between
+   if ((mode != m_sampling_mode) || (new_period && (mode == MEASUREMENT)))
+      switchSamplingMode(mode);
+
+   m_sampling_position += num_instructions;
+}
+
+void CoreModel::switchSamplingMode(SamplingMode mode)
+{
+   LOG_PRINT("Sampling mode %u -> %u, Instructions(%llu), Time(%llu)",
+             m_sampling_mode, mode, m_instruction_count, m_cycle_count);
+
+   // Finish modeling the instructions of the previous mode. All the infos
+   // of the queued instructions are there, but the last instruction may
+   // still have a branch info coming if the next one is modeled in detail
+   flushTraceBuffer();
+   modelBasicBlocks((mode == FAST_FORWARD) ? 0 : 1);
+
+   if (m_sampling_mode == MEASUREMENT)
+      recordSample();
+
+   if (mode == FAST_FORWARD)
+   {
+      getCore()->getShmemPerfModel()->disable();
+      getCore()->getMemoryManager()->disableCoreModels();
+      m_fast_forward_cycles = 0.0;
+   }
+   else if (m_sampling_mode == FAST_FORWARD)
+   {
+      getCore()->getShmemPerfModel()->enable();
+      getCore()->getMemoryManager()->enableCoreModels();
+   }
+
+   if (mode == MEASUREMENT)
+   {
+      m_window_start_cycle_count = m_cycle_count;
+      m_window_start_instruction_count = m_instruction_count;
+
+      Cache* l1_dcache = getCore()->getMemoryManager()->getL1DCache();
+      m_window_start_l1_dcache_accesses = l1_dcache ? l1_dcache->getTotalAccesses() : 0;
+      m_window_start_l1_dcache_misses = l1_dcache ? l1_dcache->getTotalMisses() : 0;
+      Cache* l2_cache = getCore()->getMemoryManager()->getL2Cache();
+      m_window_start_l2_cache_accesses = l2_cache ? l2_cache->getTotalAccesses() : 0;
+      m_window_start_l2_cache_misses = l2_cache ? l2_cache->getTotalMisses() : 0;
+   }
+
+   m_sampling_mode = mode;
+}
+
+void CoreModel::fastForward(BasicBlock *basic_block)
+{
+   // Kept for warming up the branch predictor with the branch info that follows
+   m_fast_forward_address = basic_block->back()->getAddress();
+
+   m_instruction_count += basic_block->size();
+   m_fast_forward_cycles += m_fast_forward_cpi * basic_block->size();
+   UInt64 cycles = (UInt64) m_fast_forward_cycles;
+   m_cycle_count += cycles;
+   m_fast_forward_cycles -= cycles;
+}
+
+void CoreModel::recordSample()
+{
+   // Spawns and frequency changes can move the cycle count back
+   if ((m_instruction_count <= m_window_start_instruction_count) || (m_cycle_count <= m_window_start_cycle_count))
+      return;
+
+   UInt64 instructions = m_instruction_count - m_window_start_instruction_count;
+   UInt64 cycles = m_cycle_count - m_window_start_cycle_count;
+   m_sampled_ipc.insert((double) instructions / cycles);
+   m_fast_forward_cpi = (double) cycles / instructions;
+
+   Cache* l1_dcache = getCore()->getMemoryManager()->getL1DCache();
+   if (l1_dcache && (l1_dcache->getTotalAccesses() > m_window_start_l1_dcache_accesses))
+   {
+      m_sampled_l1_dcache_miss_rate.insert(100.0 * (l1_dcache->getTotalMisses() - m_window_start_l1_dcache_misses) /
+                                           (l1_dcache->getTotalAccesses() - m_window_start_l1_dcache_accesses));
+   }
+   Cache* l2_cache = getCore()->getMemoryManager()->getL2Cache();
+   if (l2_cache && (l2_cache->getTotalAccesses() > m_window_start_l2_cache_accesses))
+   {
+      m_sampled_l2_cache_miss_rate.insert(100.0 * (l2_cache->getTotalMisses() - m_window_start_l2_cache_misses) /
+                                          (l2_cache->getTotalAccesses() - m_window_start_l2_cache_accesses));
+   }
+}
@@ -9,11 +9,15 @@
 // Forward Decls
 class Core;
 class BranchPredictor;
+class CheckpointWriter;
+class CheckpointReader;
 
 #include "instruction.h"
 #include "basic_block.h"
 #include "fixed_types.h"
 #include "lock.h"
+#include "lockfree_ring.h"
+#include "streaming_stats.h"
 #include "dynamic_instruction_info.h"
 
 class CoreModel
@@ -27,6 +31,16 @@ public:
    void queueBasicBlock(BasicBlock *basic_block);
    void iterate();
 
+   // Called by the Pin analysis routines of the thread running on the core.
+   // The records are buffered and modeled in batches of
+   // 'core/trace_buffer/batch_size', or right away if 'flush' is set
+   void traceBasicBlock(BasicBlock *basic_block, bool flush);
+   void traceDynamicInstructionInfo(const DynamicInstructionInfo &i);
+   // Moves the buffered records to the queues and models the queued basic
+   // blocks but the last one, which may still get a branch info. Modeling
+   // stops earlier at an instruction whose memory info is not there yet
+   void drainTraceBuffer();
+
    volatile float getFrequency() { return m_frequency; }
    virtual void updateInternalVariablesOnFrequencyChange(volatile float frequency);
    void recomputeAverageFrequency(); 
@@ -48,6 +62,11 @@ public:
 
    virtual void outputSummary(std::ostream &os) = 0;
 
+   // Clock and counters of the core. The cycle counts of a checkpoint taken
+   // at another frequency are converted as on a frequency change
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
    class AbortInstructionException { };
 
    void increment_packet_processed_count();
@@ -73,6 +92,14 @@ protected:
    typedef std::queue<DynamicInstructionInfo> DynamicInstructionInfoQueue;
    typedef std::queue<BasicBlock *> BasicBlockQueue;
 
+   // A basic block, or the dynamic info of an instruction if NULL
+   struct TraceRecord
+   {
+      BasicBlock *basic_block;
+      DynamicInstructionInfo info;
+   };
+   typedef LockFreeRing<TraceRecord> TraceBuffer;
+
    Core* getCore() { return m_core; }
 
    UInt64 m_cycle_count;
@@ -80,13 +107,17 @@ protected:
    
    volatile float m_frequency;
 
-   void updatePipelineStallCounters(Instruction* i, UInt64 memory_stall_cycles, UInt64 execution_unit_stall_cycles);
+   void updatePipelineStallCounters(const DecodedInstruction& i, UInt64 cost, UInt64 memory_stall_cycles, UInt64 execution_unit_stall_cycles);
+
+   // Counters of the core model type
+   virtual void checkpointStallCounters(CheckpointWriter& writer) {}
+   virtual void restoreStallCounters(CheckpointReader& reader) {}
 
 private:
 
    class DynamicInstructionInfoNotAvailableException { };
 
-   virtual void handleInstruction(Instruction *instruction) = 0;
+   virtual void handleInstruction(const DecodedInstruction &instruction) = 0;
 
    // Pipeline Stall Counters
    void initializePipelineStallCounters();
@@ -105,6 +136,71 @@ private:
    DynamicInstructionInfoQueue m_dynamic_info_queue;
    Lock m_dynamic_info_queue_lock;
 
+   // Records appended by Pin and not yet moved to the queues above
+   TraceBuffer *m_trace_buffer;
+   UInt32 m_trace_batch_size;
+   UInt32 m_num_trace_records;
+   // Set by disable(): the records buffered before are dropped by the
+   // thread of the core instead of being modeled after the next enable()
+   volatile bool m_trace_buffer_stale;
+
+   void traceRecord(const TraceRecord &record);
+   void flushTraceBuffer();
+   void discardStaleTraceRecords();
+   // Models the queued basic blocks but the last 'num_unmodeled' ones
+   void modelBasicBlocks(UInt32 num_unmodeled);
+
+   // Sampled simulation ([sampling] in the cfg file). Every 'period'
+   // instructions executed under Pin, the last 'detailed_window' ones are
+   // modeled in detail and measured, after 'warmup' instructions modeled in
+   // detail to warm up the core and memory timing models. The other
+   // instructions are only counted and take the CPI of the last window,
+   // with the branch predictor kept warm and the memory timing models (but
+   // not the caches and directories, that are always accessed) disabled.
+   enum SamplingMode
+   {
+      FAST_FORWARD = 0,
+      WARMUP,
+      MEASUREMENT
+   };
+
+   bool m_sampling_enabled;
+   SamplingMode m_sampling_mode;
+   UInt64 m_sampling_period;
+   UInt64 m_sampling_warmup;
+   UInt64 m_sampling_window;
+   // Instructions into the current period
+   UInt64 m_sampling_position;
+
+   double m_fast_forward_cpi;
+   double m_fast_forward_cycles;
+   IntPtr m_fast_forward_address;
+
+   // Counters at the start of the measurement window
+   UInt64 m_window_start_cycle_count;
+   UInt64 m_window_start_instruction_count;
+   UInt64 m_window_start_l1_dcache_accesses;
+   UInt64 m_window_start_l1_dcache_misses;
+   UInt64 m_window_start_l2_cache_accesses;
+   UInt64 m_window_start_l2_cache_misses;
+
+   RunningStatistics m_sampled_ipc;
+   RunningStatistics m_sampled_l1_dcache_miss_rate;
+   RunningStatistics m_sampled_l2_cache_miss_rate;
+
+   SamplingMode getSamplingMode(UInt64 position)
+   {
+      if (position + m_sampling_window >= m_sampling_period)
+         return MEASUREMENT;
+      if (position + m_sampling_window + m_sampling_warmup >= m_sampling_period)
+         return WARMUP;
+      return FAST_FORWARD;
+   }
+   void advanceSamplingPosition(UInt32 num_instructions);
+   void switchSamplingMode(SamplingMode mode);
+   void fastForward(BasicBlock *basic_block);
+   void recordSample();
+
    UInt32 m_current_ins_index;
 
    BranchPredictor *m_bp;
@@ -121,6 +217,8 @@ private:
 	UInt64 m_total_check_buffer_instruction_costs;
 	UInt64 m_total_packet_through_chip;
 	UInt64 m_total_packet_transport_delay;
+   UInt64 m_total_flow_control_instructions;
+   UInt64 m_total_flow_control_stall_cycles;
 //ATAC fix end
 };
 
@@ -0,0 +1,67 @@
+#ifndef DECODED_INSTRUCTION_H
+#define DECODED_INSTRUCTION_H
+
+#include "instruction.h"
+#include "fixed_types.h"
+
+// Fixed-size, pre-decoded form of an Instruction, built once when the
+// instruction is created so the core models neither walk its operand list
+// nor call into it for every dynamic instance:
+//   - the static cost is looked up once; only the instructions whose cost
+//     depends on the execution (branches, spawn and dynamic instructions)
+//     are asked for it
+//   - the register operands are kept as short arrays of distinct Pin
+//     register numbers, one for the reads and one for the writes
+//   - the memory operands are kept in order (the order in which their
+//     dynamic infos are queued) as a count and a mask of the writes
+class DecodedInstruction
+{
+public:
+   static const UInt32 MAX_MEMORY_OPERANDS = 8;
+   static const UInt32 MAX_REGISTER_OPERANDS = 16;
+   // Pin register numbers are below this
+   static const UInt32 NUM_REGISTERS = 512;
+
+   void decode(Instruction *instruction);
+
+   UInt64 getCost() const
+   { return m_has_static_cost ? m_cost : m_instruction->getCost(); }
+
+   Instruction* getInstruction() const         { return m_instruction; }
+   InstructionType getType() const             { return m_type; }
+   IntPtr getAddress() const                   { return m_address; }
+   UInt32 getSize() const                      { return m_size; }
+   bool isDynamic() const                      { return m_is_dynamic; }
+   bool isSimpleMemoryLoad() const             { return m_is_simple_memory_load; }
+
+   UInt32 getNumReadRegisters() const          { return m_num_read_registers; }
+   UInt32 getReadRegister(UInt32 index) const  { return m_read_registers[index]; }
+   UInt32 getNumWriteRegisters() const         { return m_num_write_registers; }
+   UInt32 getWriteRegister(UInt32 index) const { return m_write_registers[index]; }
+
+   UInt32 getNumMemoryOperands() const         { return m_num_memory_operands; }
+   bool isMemoryWrite(UInt32 index) const      { return (m_memory_write_mask >> index) & 1; }
+   bool hasMemoryWrite() const                 { return (m_memory_write_mask != 0); }
+
+private:
+   Instruction* m_instruction;
+   IntPtr m_address;
+   UInt64 m_cost;
+   InstructionType m_type;
+   UInt32 m_size;
+
+   bool m_has_static_cost;
+   bool m_is_dynamic;
+   bool m_is_simple_memory_load;
+   UInt8 m_num_memory_operands;
+   UInt8 m_memory_write_mask;
+   UInt8 m_num_read_registers;
+   UInt8 m_num_write_registers;
+
+   UInt16 m_read_registers[MAX_REGISTER_OPERANDS];
+   UInt16 m_write_registers[MAX_REGISTER_OPERANDS];
+
+   static void addRegister(UInt16 *registers, UInt8 &num_registers, UInt32 reg);
+};
+
+#endif
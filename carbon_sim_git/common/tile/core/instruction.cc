@@ -1,4 +1,5 @@
 #include "instruction.h"
+#include "decoded_instruction.h"
 #include "simulator.h"
 #include "tile_manager.h"
 #include "tile.h"
@@ -71,6 +72,61 @@ void Instruction::initializeStaticInstructionModel()
    }
 }
 
+// DecodedInstruction
+
+void DecodedInstruction::decode(Instruction *instruction)
+{
+   m_instruction = instruction;
+   m_address = instruction->getAddress();
+   m_type = instruction->getType();
+   m_size = instruction->getSize();
+
+   m_has_static_cost = instruction->hasStaticCost();
+   m_cost = m_has_static_cost ? instruction->getCost() : 0;
+   m_is_dynamic = instruction->isDynamic();
+   m_is_simple_memory_load = instruction->isSimpleMemoryLoad();
+
+   m_num_memory_operands = 0;
+   m_memory_write_mask = 0;
+   m_num_read_registers = 0;
+   m_num_write_registers = 0;
+
+   const OperandList& ops = instruction->getOperands();
+   for (unsigned int i = 0; i < ops.size(); i++)
+   {
+      const Operand& o = ops[i];
+      if (o.m_type == Operand::MEMORY)
+      {
+         LOG_ASSERT_ERROR(m_num_memory_operands < MAX_MEMORY_OPERANDS,
+                          "Too many memory operands(%u)", m_num_memory_operands + 1);
+         if (o.m_direction == Operand::WRITE)
+            m_memory_write_mask |= (1 << m_num_memory_operands);
+         m_num_memory_operands ++;
+      }
+      else if (o.m_type == Operand::REG)
+      {
+         LOG_ASSERT_ERROR(o.m_value < NUM_REGISTERS,
+                          "Register value out of range: %llu", o.m_value);
+         if (o.m_direction == Operand::READ)
+            addRegister(m_read_registers, m_num_read_registers, o.m_value);
+         else
+            addRegister(m_write_registers, m_num_write_registers, o.m_value);
+      }
+   }
+}
+
+void DecodedInstruction::addRegister(UInt16 *registers, UInt8 &num_registers, UInt32 reg)
+{
+   for (UInt32 i = 0; i < num_registers; i++)
+   {
+      if (registers[i] == reg)
+         return;
+   }
+   LOG_ASSERT_ERROR(num_registers < MAX_REGISTER_OPERANDS,
+                    "Too many register operands(%u)", num_registers + 1);
+   registers[num_registers++] = (UInt16) reg;
+}
+
 // DynamicInstruction
 
 DynamicInstruction::DynamicInstruction(UInt64 cost, InstructionType type)
@@ -20,6 +20,7 @@ enum InstructionType
    INST_DYNAMIC_MISC,
    INST_RECV,
    INST_CKBUFFER,
+   INST_FLOW_CONTROL,
    INST_SYNC,
    INST_SPAWN,
    INST_STRING,
@@ -28,7 +29,7 @@ enum InstructionType
 };
 
 __attribute__ ((unused)) static const char * INSTRUCTION_NAMES [] = 
-{"generic","add","sub","mul","div","fadd","fsub","fmul","fdiv","jmp","dynamic_misc","recv","ckbuffer","sync","spawn","string","branch"};
+{"generic","add","sub","mul","div","fadd","fsub","fmul","fdiv","jmp","dynamic_misc","recv","ckbuffer","flow_control","sync","spawn","string","branch"};
 
 class Operand
 {
@@ -74,6 +75,10 @@ public:
 
    virtual ~Instruction() { };
    virtual UInt64 getCost();
+   // False if getCost() depends on the execution and must be called for
+   // every dynamic instance of the instruction
+   virtual bool hasStaticCost() const
+   { return true; }
 
    static void initializeStaticInstructionModel();
 
@@ -95,7 +100,8 @@ public:
 
    bool isSimpleMemoryLoad() const;
    bool isDynamic() const
-   { return ((m_type == INST_DYNAMIC_MISC) || (m_type == INST_RECV) || (m_type == INST_SYNC) || (m_type == INST_CKBUFFER)); }
+   { return ((m_type == INST_DYNAMIC_MISC) || (m_type == INST_RECV) || (m_type == INST_SYNC) || (m_type == INST_CKBUFFER) ||
+             (m_type == INST_FLOW_CONTROL)); }
 
    void print() const;
 
@@ -146,6 +152,8 @@ public:
    ~DynamicInstruction();
 
    UInt64 getCost();
+   bool hasStaticCost() const
+   { return false; }
 
 private:
    UInt64 m_cost;
@@ -167,6 +175,15 @@ public:
    {}
 };
 
+// Stall of a sender waiting for credits of the receive queues
+class FlowControlInstruction : public DynamicInstruction
+{
+public:
+   FlowControlInstruction(UInt64 cost)
+      : DynamicInstruction(cost, INST_FLOW_CONTROL)
+   {}
+};
+
 class SyncInstruction : public DynamicInstruction
 {
 public:
@@ -179,6 +196,8 @@ class SpawnInstruction : public Instruction
 public:
    SpawnInstruction(UInt64 time);
    UInt64 getCost();
+   bool hasStaticCost() const
+   { return false; }
 
 private:
    UInt64 m_time;
@@ -191,6 +210,8 @@ public:
    BranchInstruction(UInt64 opcode, OperandList &l);
 
    UInt64 getCost();
+   bool hasStaticCost() const
+   { return false; }
 };
 
 #endif
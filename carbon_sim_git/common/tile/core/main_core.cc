@@ -71,7 +71,11 @@ MainCore::initiateMemoryAccess(MemComponent::Type mem_component,
    // Setting the initial time
    UInt64 initial_time = time;
    if (time == 0)
+   {
+      // Model the instructions buffered before this access first
+      m_core_model->drainTraceBuffer();
       initial_time = getPerformanceModel()->getCycleCount();
+   }
 
    getShmemPerfModel()->setCycleCount(initial_time);
 
@@ -87,6 +91,20 @@ MainCore::initiateMemoryAccess(MemComponent::Type mem_component,
    IntPtr end_addr_aligned = end_addr - (end_addr % cache_line_size);
    Byte *curr_data_buffer_head = (Byte*) data_buf;
 
+   // The clock of the core does not hold back the network event engines
+   // while it waits for the replies. Nor does the clock of the core of the
+   // calling thread, if it accesses the memory of another core (the unit
+   // tests do), since it cannot advance till the access completes
+   Network* network = getTile()->getNetwork();
+   bool waiting = network->isWaitingForPacket();
+   network->setWaitingForPacket(true);
+
+   Tile* current_tile = Sim()->getTileManager()->getCurrentTile();
+   Network* current_network = (current_tile && (current_tile != getTile())) ? current_tile->getNetwork() : NULL;
+   bool current_waiting = current_network ? current_network->isWaitingForPacket() : false;
+   if (current_network)
+      current_network->setWaitingForPacket(true);
+
    for (IntPtr curr_addr_aligned = begin_addr_aligned; curr_addr_aligned <= end_addr_aligned; curr_addr_aligned += cache_line_size)
    {
       // Access the cache one line at a time
@@ -141,6 +159,10 @@ MainCore::initiateMemoryAccess(MemComponent::Type mem_component,
       curr_data_buffer_head += curr_size;
    }
 
+   network->setWaitingForPacket(waiting);
+   if (current_network)
+      current_network->setWaitingForPacket(current_waiting);
+
    // Get the final cycle time
    UInt64 final_time = getShmemPerfModel()->getCycleCount();
    LOG_ASSERT_ERROR(final_time >= initial_time, "final_time(%llu) < initial_time(%llu)", final_time, initial_time);
@@ -8,11 +8,12 @@ using namespace std;
 #include "config.hpp"
 #include "simulator.h"
 #include "branch_predictor.h"
+#include "checkpoint.h"
 
 IOCOOMCoreModel::IOCOOMCoreModel(Core *core, float frequency)
    : CoreModel(core, frequency)
-   , m_register_scoreboard(512)
-   , m_register_wait_unit_list(512)
+   , m_register_scoreboard(DecodedInstruction::NUM_REGISTERS)
+   , m_register_wait_unit_list(DecodedInstruction::NUM_REGISTERS)
    , m_store_buffer(0)
    , m_load_buffer(0)
 {
@@ -90,58 +91,72 @@ void IOCOOMCoreModel::updateInternalVariablesOnFrequencyChange(volatile float fr
    CoreModel::updateInternalVariablesOnFrequencyChange(frequency);
 }
 
-void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
+// The register scoreboard and the load/store buffers hold the completion
+// times of the instructions in flight and are not saved: none are in flight
+// at a checkpoint
+void IOCOOMCoreModel::checkpointStallCounters(CheckpointWriter& writer)
+{
+   writer << m_total_load_buffer_stall_cycles << m_total_store_buffer_stall_cycles
+          << m_total_l1icache_stall_cycles
+          << m_total_intra_ins_l1dcache_read_stall_cycles << m_total_inter_ins_l1dcache_read_stall_cycles
+          << m_total_l1dcache_write_stall_cycles
+          << m_total_intra_ins_execution_unit_stall_cycles << m_total_inter_ins_execution_unit_stall_cycles;
+}
+
+void IOCOOMCoreModel::restoreStallCounters(CheckpointReader& reader)
+{
+   reader >> m_total_load_buffer_stall_cycles >> m_total_store_buffer_stall_cycles
+          >> m_total_l1icache_stall_cycles
+          >> m_total_intra_ins_l1dcache_read_stall_cycles >> m_total_inter_ins_l1dcache_read_stall_cycles
+          >> m_total_l1dcache_write_stall_cycles
+          >> m_total_intra_ins_execution_unit_stall_cycles >> m_total_inter_ins_execution_unit_stall_cycles;
+}
+
+void IOCOOMCoreModel::handleInstruction(const DecodedInstruction &instruction)
 {
    // Execute this first so that instructions have the opportunity to
    // abort further processing (via AbortInstructionException)
-   UInt64 cost = instruction->getCost();
+   UInt64 cost = instruction.getCost();
 
    // Model Instruction Fetch Stage
    UInt64 instruction_ready = m_cycle_count;
-   UInt64 instruction_memory_access_latency = modelICache(instruction->getAddress(), instruction->getSize());
+   UInt64 instruction_memory_access_latency = modelICache(instruction.getAddress(), instruction.getSize());
    instruction_ready += (instruction_memory_access_latency - 1);
 
    // Model instruction in the following steps:
    // - find when read operations are available
    // - find latency of instruction
    // - update write operands
-   const OperandList &ops = instruction->getOperands();
-
    // buffer write operands to be updated after instruction executes
-   DynamicInstructionInfoQueue write_info;
+   DynamicInstructionInfo write_info[DecodedInstruction::MAX_MEMORY_OPERANDS];
+   UInt32 num_write_info = 0;
 
    // Time when register operands are ready (waiting for either the load unit or the execution unit)
    UInt64 read_register_operands_ready_load_unit_wait = instruction_ready;
    UInt64 read_register_operands_ready_execution_unit_wait = instruction_ready;
 
    // REG read operands
-   for (unsigned int i = 0; i < ops.size(); i++)
+   for (UInt32 i = 0; i < instruction.getNumReadRegisters(); i++)
    {
-      const Operand &o = ops[i];
-
-      if ( (o.m_direction != Operand::READ) || (o.m_type != Operand::REG) )
-         continue;
-
-      LOG_ASSERT_ERROR(o.m_value < m_register_scoreboard.size(),
-                       "Register value out of range: %llu", o.m_value);
+      UInt32 reg = instruction.getReadRegister(i);
 
       // Compute the ready time for registers that are waiting on the LOAD_UNIT
       // and on the EXECUTION_UNIT
       // The final ready time is the max of this
-      if (m_register_wait_unit_list[o.m_value] == LOAD_UNIT)
+      if (m_register_wait_unit_list[reg] == LOAD_UNIT)
       {
-         if (read_register_operands_ready_load_unit_wait < m_register_scoreboard[o.m_value])
-            read_register_operands_ready_load_unit_wait = m_register_scoreboard[o.m_value];
+         if (read_register_operands_ready_load_unit_wait < m_register_scoreboard[reg])
+            read_register_operands_ready_load_unit_wait = m_register_scoreboard[reg];
       }
-      else if (m_register_wait_unit_list[o.m_value] == EXECUTION_UNIT)
+      else if (m_register_wait_unit_list[reg] == EXECUTION_UNIT)
       {
-         if (read_register_operands_ready_execution_unit_wait < m_register_scoreboard[o.m_value])
-            read_register_operands_ready_execution_unit_wait = m_register_scoreboard[o.m_value];
+         if (read_register_operands_ready_execution_unit_wait < m_register_scoreboard[reg])
+            read_register_operands_ready_execution_unit_wait = m_register_scoreboard[reg];
       }
       else
       {
-         LOG_ASSERT_ERROR(m_register_scoreboard[o.m_value] <= instruction_ready,
-                          "Unrecognized Core Unit(%u)", m_register_wait_unit_list[o.m_value]);
+         LOG_ASSERT_ERROR(m_register_scoreboard[reg] <= instruction_ready,
+                          "Unrecognized Core Unit(%u)", m_register_wait_unit_list[reg]);
       }
    }
    
@@ -155,16 +170,11 @@ void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
    UInt64 load_buffer_ready = read_register_operands_ready;
    UInt64 read_memory_operands_ready = read_register_operands_ready;
    // MEMORY read & write operands
-   for (unsigned int i = 0; i < ops.size(); i++)
+   for (UInt32 i = 0; i < instruction.getNumMemoryOperands(); i++)
    {
-      const Operand &o = ops[i];
-
-      if (o.m_type != Operand::MEMORY)
-         continue;
-         
       DynamicInstructionInfo &info = getDynamicInstructionInfo();
 
-      if (o.m_direction == Operand::READ)
+      if (!instruction.isMemoryWrite(i))
       {
          LOG_ASSERT_ERROR(info.type == DynamicInstructionInfo::MEMORY_READ,
                           "Expected memory read info, got: %d.", info.type);
@@ -187,7 +197,7 @@ void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
          LOG_ASSERT_ERROR(info.type == DynamicInstructionInfo::MEMORY_WRITE,
                           "Expected memory write info, got: %d.", info.type);
 
-         write_info.push(info);
+         write_info[num_write_info++] = info;
       }
       
       popDynamicInstructionInfo();
@@ -210,49 +220,34 @@ void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
    // for all the read operands of an instruction to be available before
    // we issue it
    // Assume that the register file can be written in one cycle
-   for (unsigned int i = 0; i < ops.size(); i++)
+   for (UInt32 i = 0; i < instruction.getNumWriteRegisters(); i++)
    {
-      const Operand &o = ops[i];
-
-      // REG write operands
-      if ( (o.m_direction != Operand::WRITE) || (o.m_type != Operand::REG) )
-         continue;
+      UInt32 reg = instruction.getWriteRegister(i);
 
       // The only case where this assertion is not true is when the register is written
       // into but is never read before the next write operation. We assume
       // that this never happend
       // LOG_ASSERT_ERROR(write_operands_ready > m_register_scoreboard[o.m_value],
       //       "Write Operands Ready(%llu), Register Scoreboard Value(%llu)",
-      //       write_operands_ready, m_register_scoreboard[o.m_value]);
-      m_register_scoreboard[o.m_value] = write_operands_ready;
+      //       write_operands_ready, m_register_scoreboard[reg]);
+      m_register_scoreboard[reg] = write_operands_ready;
 
       // Update the unit that the register is waiting for
-      if (instruction->isSimpleMemoryLoad())
-         m_register_wait_unit_list[o.m_value] = LOAD_UNIT;
+      if (instruction.isSimpleMemoryLoad())
+         m_register_wait_unit_list[reg] = LOAD_UNIT;
       else
-         m_register_wait_unit_list[o.m_value] = EXECUTION_UNIT;
+         m_register_wait_unit_list[reg] = EXECUTION_UNIT;
    }
 
    UInt64 store_buffer_ready = write_operands_ready;
-   bool has_memory_write_operand = false;
+   bool has_memory_write_operand = instruction.hasMemoryWrite();
    // MEMORY write operands
    // This is done before doing register
    // operands to make sure the scoreboard is updated correctly
-   for (unsigned int i = 0; i < ops.size(); i++)
+   for (UInt32 i = 0; i < num_write_info; i++)
    {
-      const Operand &o = ops[i];
-
-      // MEMORY write operands
-      if ( (o.m_direction != Operand::WRITE) || (o.m_type != Operand::MEMORY) )
-         continue;
-
-      // Instruction has a MEMORY WRITE operand
-      has_memory_write_operand = true;
-
-      const DynamicInstructionInfo &info = write_info.front();
       // This just updates the contents of the store buffer
-      UInt64 store_time = executeStore(write_operands_ready, info);
-      write_info.pop();
+      UInt64 store_time = executeStore(write_operands_ready, write_info[i]);
 
       if (store_buffer_ready < store_time)
          store_buffer_ready = store_time;
@@ -270,7 +265,7 @@ void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
    // If it is a simple load instruction, execute the next instruction after load_buffer_ready,
    // else wait till all the operands are fetched to execute the next instruction
    // Just add the cost for dynamic instructions since they involve pipeline stalls
-   if (instruction->isDynamic())
+   if (instruction.isDynamic())
    {
       m_cycle_count += cost;
    }
@@ -292,7 +287,7 @@ void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
       
       m_cycle_count = load_buffer_ready + 1;
 
-      if (!instruction->isSimpleMemoryLoad())
+      if (!instruction.isSimpleMemoryLoad())
       {
          // Memory Read Operands - Wait for L1-D Cache
          memory_stall_cycles += (read_memory_operands_ready - load_buffer_ready);
@@ -314,16 +309,14 @@ void IOCOOMCoreModel::handleInstruction(Instruction *instruction)
       }
    }
 
-   LOG_ASSERT_ERROR(write_info.empty(), "Some write info left over?");
-
    // Update Statistics
    m_instruction_count++;
 
    // Update Common Pipeline Stall Counters
-   updatePipelineStallCounters(instruction, memory_stall_cycles, execution_unit_stall_cycles);
+   updatePipelineStallCounters(instruction, cost, memory_stall_cycles, execution_unit_stall_cycles);
 
    // Update Event Counters
-   m_mcpat_core_interface->updateEventCounters(instruction, m_cycle_count);
+   m_mcpat_core_interface->updateEventCounters(instruction.getInstruction(), m_cycle_count);
 }
 
 pair<UInt64,UInt64>
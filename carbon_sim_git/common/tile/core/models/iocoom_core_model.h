@@ -31,7 +31,10 @@ private:
       EXECUTION_UNIT = 3
    };
 
-   void handleInstruction(Instruction *instruction);
+   void handleInstruction(const DecodedInstruction &instruction);
+
+   void checkpointStallCounters(CheckpointWriter& writer);
+   void restoreStallCounters(CheckpointReader& reader);
 
    UInt64 modelICache(IntPtr ins_address, UInt32 ins_size);
    std::pair<UInt64,UInt64> executeLoad(UInt64 time, const DynamicInstructionInfo &);
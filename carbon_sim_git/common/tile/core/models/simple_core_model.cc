@@ -2,6 +2,7 @@
 #include "log.h"
 #include "simple_core_model.h"
 #include "branch_predictor.h"
+#include "checkpoint.h"
 
 using std::endl;
 
@@ -43,53 +44,57 @@ void SimpleCoreModel::updateInternalVariablesOnFrequencyChange(volatile float fr
    CoreModel::updateInternalVariablesOnFrequencyChange(frequency);
 }
 
-void SimpleCoreModel::handleInstruction(Instruction *instruction)
+void SimpleCoreModel::checkpointStallCounters(CheckpointWriter& writer)
+{
+   writer << m_total_l1icache_stall_cycles << m_total_l1dcache_read_stall_cycles << m_total_l1dcache_write_stall_cycles;
+}
+
+void SimpleCoreModel::restoreStallCounters(CheckpointReader& reader)
+{
+   reader >> m_total_l1icache_stall_cycles >> m_total_l1dcache_read_stall_cycles >> m_total_l1dcache_write_stall_cycles;
+}
+
+void SimpleCoreModel::handleInstruction(const DecodedInstruction &instruction)
 {
    // Execute this first so that instructions have the opportunity to
    // abort further processing (via AbortInstructionException)
-   UInt64 cost = instruction->getCost();
+   UInt64 cost = instruction.getCost();
 
    UInt64 memory_stall_cycles = 0;
    UInt64 execution_unit_stall_cycles = 0;
 
    // Instruction Memory Modeling
-   UInt64 instruction_memory_access_latency = modelICache(instruction->getAddress(), instruction->getSize());
+   UInt64 instruction_memory_access_latency = modelICache(instruction.getAddress(), instruction.getSize());
    memory_stall_cycles += instruction_memory_access_latency;
    m_total_l1icache_stall_cycles += instruction_memory_access_latency;
 
-   const OperandList &ops = instruction->getOperands();
-   for (unsigned int i = 0; i < ops.size(); i++)
+   for (UInt32 i = 0; i < instruction.getNumMemoryOperands(); i++)
    {
-      const Operand &o = ops[i];
+      DynamicInstructionInfo &info = getDynamicInstructionInfo();
 
-      if (o.m_type == Operand::MEMORY)
+      if (!instruction.isMemoryWrite(i))
       {
-         DynamicInstructionInfo &info = getDynamicInstructionInfo();
-
-         if (o.m_direction == Operand::READ)
-         {
-            LOG_ASSERT_ERROR(info.type == DynamicInstructionInfo::MEMORY_READ,
-                             "Expected memory read info, got: %d.", info.type);
-
-            memory_stall_cycles += info.memory_info.latency;
-            m_total_l1dcache_read_stall_cycles += info.memory_info.latency;
-            // ignore address
-         }
-         else
-         {
-            LOG_ASSERT_ERROR(info.type == DynamicInstructionInfo::MEMORY_WRITE,
-                             "Expected memory write info, got: %d.", info.type);
-
-            memory_stall_cycles += info.memory_info.latency;
-            m_total_l1dcache_write_stall_cycles += info.memory_info.latency;
-            // ignore address
-         }
-
-         popDynamicInstructionInfo();
+         LOG_ASSERT_ERROR(info.type == DynamicInstructionInfo::MEMORY_READ,
+                          "Expected memory read info, got: %d.", info.type);
+
+         memory_stall_cycles += info.memory_info.latency;
+         m_total_l1dcache_read_stall_cycles += info.memory_info.latency;
+         // ignore address
       }
+      else
+      {
+         LOG_ASSERT_ERROR(info.type == DynamicInstructionInfo::MEMORY_WRITE,
+                          "Expected memory write info, got: %d.", info.type);
+
+         memory_stall_cycles += info.memory_info.latency;
+         m_total_l1dcache_write_stall_cycles += info.memory_info.latency;
+         // ignore address
+      }
+
+      popDynamicInstructionInfo();
    }
 
-   if (instruction->isDynamic())
+   if (instruction.isDynamic())
    {
       assert(memory_stall_cycles == 0);
       m_cycle_count += cost;
@@ -104,7 +109,7 @@ void SimpleCoreModel::handleInstruction(Instruction *instruction)
    m_instruction_count++;
 
    // Update Common Counters
-   updatePipelineStallCounters(instruction, memory_stall_cycles, execution_unit_stall_cycles);
+   updatePipelineStallCounters(instruction, cost, memory_stall_cycles, execution_unit_stall_cycles);
 }
 
 UInt64 SimpleCoreModel::modelICache(IntPtr ins_address, UInt32 ins_size)
@@ -13,7 +13,10 @@ public:
    void outputSummary(std::ostream &os);
 
 private:
-   void handleInstruction(Instruction *instruction);
+   void handleInstruction(const DecodedInstruction &instruction);
+
+   void checkpointStallCounters(CheckpointWriter& writer);
+   void restoreStallCounters(CheckpointReader& reader);
    
    UInt64 modelICache(IntPtr ins_address, UInt32 ins_size);
    void initializePipelineStallCounters();
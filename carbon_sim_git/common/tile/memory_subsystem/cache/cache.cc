@@ -1,9 +1,11 @@
+#include <cstdlib>
 #include "simulator.h"
 #include "cache.h"
 #include "cache_set.h"
 #include "cache_line_info.h"
 #include "cache_replacement_policy.h"
 #include "cache_hash_fn.h"
+#include "checkpoint.h"
 #include "utils.h"
 #include "log.h"
 
@@ -31,6 +33,7 @@ Cache::Cache(string name,
    , _line_size(line_size)
    , _replacement_policy(replacement_policy)
    , _hash_fn(hash_fn)
+   , _miss_type_tracker(NULL)
    , _power_model(NULL)
    , _area_model(NULL)
    , _track_miss_types(track_miss_types)
@@ -38,10 +41,21 @@ Cache::Cache(string name,
    _num_sets = _cache_size / (_associativity * _line_size);
    _log_line_size = floorLog2(_line_size);
    
+   // The tags, states, line infos and data of all the sets are allocated
+   // in one block each. The tags of a set start on a cache line boundary
+   __attribute(__unused__) int status = posix_memalign((void**) &_tags, 64, _num_sets * _associativity * sizeof(IntPtr));
+   assert(status == 0);
+   _cstates = new UInt8[_num_sets * _associativity];
+   _cache_line_info_array = new CacheLineInfo*[_num_sets * _associativity];
+   _lines = new char[_num_sets * _associativity * _line_size];
+
    _sets = new CacheSet*[_num_sets];
    for (UInt32 i = 0; i < _num_sets; i++)
    {
-      _sets[i] = new CacheSet(i, caching_protocol_type, cache_level, _replacement_policy, _associativity, _line_size);
+      UInt32 way_index = i * _associativity;
+      _sets[i] = new CacheSet(i, caching_protocol_type, cache_level, _replacement_policy, _associativity, _line_size,
+                              &_tags[way_index], &_cstates[way_index], &_cache_line_info_array[way_index],
+                              &_lines[way_index * _line_size]);
    }
 
    if (Config::getSingleton()->getEnablePowerModeling())
@@ -55,6 +69,14 @@ Cache::Cache(string name,
             associativity, access_delay, frequency);
    }
 
+   if (_track_miss_types)
+   {
+      MissTypeTracker::Mode mode = MissTypeTracker::parseMode(Sim()->getCfg()->getString("miss_type_tracking/mode", "approximate"));
+      UInt32 table_size = Sim()->getCfg()->getInt("miss_type_tracking/table_size", 64);
+      bool verify = Sim()->getCfg()->getBool("miss_type_tracking/verify", false);
+      _miss_type_tracker = new MissTypeTracker(mode, table_size * _num_sets * _associativity, verify);
+   }
+
    // Initialize Cache Counters
    // Hit/miss counters
    initializeMissCounters();
@@ -71,6 +93,11 @@ Cache::~Cache()
    for (SInt32 i = 0; i < (SInt32) _num_sets; i++)
       delete _sets[i];
    delete [] _sets;
+   delete [] _lines;
+   delete [] _cache_line_info_array;
+   delete [] _cstates;
+   free(_tags);
+   delete _miss_type_tracker;
 }
 
 void
@@ -128,19 +155,15 @@ Cache::insertCacheLine(IntPtr inserted_address, CacheLineInfo* inserted_cache_li
       assert(*evicted_address != INVALID_ADDRESS);
 
       if (_track_miss_types)
-         _evicted_address_set.insert(*evicted_address);
+         _miss_type_tracker->lineEvicted(*evicted_address);
 
       // Update exclusive/sharing counters
       updateCacheLineStateCounters(evicted_cache_line_info->getCState(), CacheState::INVALID);
    }
 
-   // Clear the miss type tracking sets for this address
+   // The line needs no history while it is in the cache
    if (_track_miss_types)
-      clearMissTypeTrackingSets(inserted_address);
-
-   // Add to fetched set for tracking miss type
-   if (_track_miss_types)
-      _fetched_address_set.insert(inserted_address);
+      _miss_type_tracker->lineFetched(inserted_address);
 
    // Update exclusive/sharing counters
    updateCacheLineStateCounters(CacheState::INVALID, inserted_cache_line_info->getCState());
@@ -220,18 +243,20 @@ Cache::getCacheLineInfo(IntPtr address)
 void
 Cache::setCacheLineInfo(IntPtr address, CacheLineInfo* updated_cache_line_info)
 {
-   CacheLineInfo* cache_line_info = getCacheLineInfo(address);
+   CacheSet* set = getSet(address);
+   UInt32 line_index = -1;
+   __attribute(__unused__) CacheLineInfo* cache_line_info = set->find(getTag(address), &line_index);
    LOG_ASSERT_ERROR(cache_line_info, "Address(%#lx)", address);
 
    // Update exclusive/shared counters
-   updateCacheLineStateCounters(cache_line_info->getCState(), updated_cache_line_info->getCState());
+   updateCacheLineStateCounters(set->getCState(line_index), updated_cache_line_info->getCState());
   
-   // Update _invalidated_address_set
+   // Record the invalidation for tracking miss type
    if ( (updated_cache_line_info->getCState() == CacheState::INVALID) && (_track_miss_types) )
-      _invalidated_address_set.insert(address);
+      _miss_type_tracker->lineInvalidated(address);
 
    // Update the cache line info   
-   cache_line_info->assign(updated_cache_line_info);
+   set->update(line_index, updated_cache_line_info);
    
    if (_enabled)
    {
@@ -330,17 +355,22 @@ Cache::updateMissCounters(IntPtr address, Core::mem_op_t mem_op_type, bool cache
 }
 
 Cache::MissType
-Cache::getMissType(IntPtr address) const
+Cache::getMissType(IntPtr address)
 {
-   // We maintain three address sets to keep track of miss types
-   if (_evicted_address_set.find(address) != _evicted_address_set.end())
-      return CAPACITY_MISS;
-   else if (_invalidated_address_set.find(address) != _invalidated_address_set.end())
+   // A miss to a line in the cache is an upgrade miss
+   CacheLineInfo* line_info = getCacheLineInfo(address);
+   if (line_info && (line_info->getCState() != CacheState::INVALID))
       return SHARING_MISS;
-   else if (_fetched_address_set.find(address) != _fetched_address_set.end())
+
+   switch (_miss_type_tracker->getStateOnMiss(address))
+   {
+   case MissTypeTracker::EVICTED:
+      return CAPACITY_MISS;
+   case MissTypeTracker::INVALIDATED:
       return SHARING_MISS;
-   else
+   default:
       return COLD_MISS;
+   }
 }
 
 void
@@ -364,14 +394,6 @@ Cache::updateMissTypeCounters(IntPtr address, MissType miss_type)
    }
 }
 
-void
-Cache::clearMissTypeTrackingSets(IntPtr address)
-{
-   if (_evicted_address_set.erase(address));
-   else if (_invalidated_address_set.erase(address));
-   else if (_fetched_address_set.erase(address));
-}
-
 void
 Cache::updateCacheLineStateCounters(CacheState::Type old_cstate, CacheState::Type new_cstate)
 {
@@ -434,6 +456,7 @@ Cache::outputSummary(ostream& out)
       out << "      Cold Misses: " << _total_cold_misses << endl;
       out << "      Capacity Misses: " << _total_capacity_misses << endl;
       out << "      Sharing Misses: " << _total_sharing_misses << endl;
+      _miss_type_tracker->outputSummary(out);
    }
 
    // Event Counters Summary
@@ -444,7 +467,79 @@ Cache::outputSummary(ostream& out)
    out << "      Data Array Writes: " << _data_array_writes << endl;
 }
 
+// The line infos are saved in the order of the ways, and the tag and state
+// arrays rebuilt from them. The miss type tracker and the power model are not
+// saved: they restart from the restored contents
+void
+Cache::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("cache");
+   writer << _cache_size << _associativity << _line_size << _num_sets;
+
+   UInt32 num_ways = _num_sets * _associativity;
+   for (UInt32 i = 0; i < num_ways; i++)
+      _cache_line_info_array[i]->checkpoint(writer);
+   writer.put<char>(_lines, num_ways * _line_size);
+   _replacement_policy->checkpoint(writer);
+
+   writer << _total_cache_accesses << _total_cache_misses
+          << _total_read_accesses << _total_read_misses
+          << _total_write_accesses << _total_write_misses
+          << _total_cold_misses << _total_capacity_misses << _total_sharing_misses
+          << _total_evictions << _total_dirty_evictions
+          << _tag_array_reads << _tag_array_writes
+          << _data_array_reads << _data_array_writes;
+   writer.put<UInt64>(&_cache_line_state_counters[0], CacheState::NUM_STATES);
+   writer.endSection();
+}
+
+void
+Cache::restore(CheckpointReader& reader)
+{
+   reader.beginSection("cache");
+   UInt32 cache_size, associativity, line_size, num_sets;
+   reader >> cache_size >> associativity >> line_size >> num_sets;
+   LOG_ASSERT_ERROR((cache_size == _cache_size) && (associativity == _associativity) &&
+                    (line_size == _line_size) && (num_sets == _num_sets),
+                    "Cache(%s) of the checkpoint: size(%u), associativity(%u), line size(%u), "
+                    "expected size(%u), associativity(%u), line size(%u)",
+                    _name.c_str(), cache_size, associativity, line_size,
+                    _cache_size, _associativity, _line_size);
+
+   UInt32 num_ways = _num_sets * _associativity;
+   for (UInt32 i = 0; i < num_ways; i++)
+   {
+      _cache_line_info_array[i]->restore(reader);
+      _tags[i] = _cache_line_info_array[i]->getTag();
+      _cstates[i] = _cache_line_info_array[i]->getCState();
+   }
+   reader.get<char>(_lines, num_ways * _line_size);
+   _replacement_policy->restore(reader);
+
+   reader >> _total_cache_accesses >> _total_cache_misses
+          >> _total_read_accesses >> _total_read_misses
+          >> _total_write_accesses >> _total_write_misses
+          >> _total_cold_misses >> _total_capacity_misses >> _total_sharing_misses
+          >> _total_evictions >> _total_dirty_evictions
+          >> _tag_array_reads >> _tag_array_writes
+          >> _data_array_reads >> _data_array_writes;
+   reader.get<UInt64>(&_cache_line_state_counters[0], CacheState::NUM_STATES);
+   reader.endSection();
+}
+
 // Utilities
+void
+Cache::getDirtyLines(map<IntPtr, const Byte*>& dirty_lines) const
+{
+   UInt32 num_ways = _num_sets * _associativity;
+   for (UInt32 i = 0; i < num_ways; i++)
+   {
+      CacheState::Type cstate = (CacheState::Type) _cstates[i];
+      if ((cstate == CacheState::MODIFIED) || (cstate == CacheState::OWNED) || (cstate == CacheState::DIRTY))
+         dirty_lines.insert(std::make_pair(getAddressFromTag(_tags[i]), (const Byte*) &_lines[i * _line_size]));
+   }
+}
+
 IntPtr
 Cache::getTag(IntPtr address) const
 {
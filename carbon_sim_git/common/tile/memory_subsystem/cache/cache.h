@@ -2,9 +2,11 @@
 
 #include <string>
 #include <set>
+#include <map>
 #include <cassert>
 using std::string;
 using std::set;
+using std::map;
 
 #include "core.h"
 #include "cache_state.h"
@@ -16,12 +18,15 @@ using std::set;
 #include "fixed_types.h"
 #include "caching_protocol_type.h"
 #include "constants.h"
+#include "miss_type_tracker.h"
 
 // Forwards Decls
 class CacheSet;
 class CacheLineInfo;
 class CacheReplacementPolicy;
 class CacheHashFn;
+class CheckpointWriter;
+class CheckpointReader;
 
 class Cache
 {
@@ -91,6 +96,9 @@ public:
    MissType updateMissCounters(IntPtr address, Core::mem_op_t mem_op_type, bool cache_miss);
    // Get cache line state counters
    void getCacheLineStateCounters(vector<UInt64>& cache_line_state_counters) const;
+   // Hit/miss counters
+   UInt64 getTotalAccesses() const { return _total_cache_accesses; }
+   UInt64 getTotalMisses() const   { return _total_cache_misses; }
 
    // Parse Miss Type
    static MissType parseMissType(string miss_type);
@@ -101,6 +109,15 @@ public:
    
    virtual void outputSummary(ostream& out);
 
+   // Contents, replacement state and counters. Restored into a cache of the
+   // same geometry and replacement policy
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+   // Adds the lines in the MODIFIED, OWNED or DIRTY state, by address, that
+   // are not in 'dirty_lines' already (so the caches closer to the core,
+   // which have the latest data, are to be added first)
+   void getDirtyLines(map<IntPtr, const Byte*>& dirty_lines) const;
+
 private:
    // Is enabled?
    bool _enabled;
@@ -110,6 +127,11 @@ private:
    CacheCategory _cache_category;
    WritePolicy _write_policy;
    CacheSet** _sets;
+   // Storage of the sets
+   IntPtr* _tags;
+   UInt8* _cstates;
+   CacheLineInfo** _cache_line_info_array;
+   char* _lines;
 
    // Cache params
    UInt32 _cache_size;
@@ -135,9 +157,7 @@ private:
    UInt64 _total_capacity_misses;
    UInt64 _total_sharing_misses;
    // State for tracking type of cache misses
-   set<IntPtr> _fetched_address_set;
-   set<IntPtr> _evicted_address_set;
-   set<IntPtr> _invalidated_address_set;
+   MissTypeTracker* _miss_type_tracker;
 
    // Evictions
    UInt64 _total_evictions;
@@ -179,9 +199,8 @@ private:
    CacheLineInfo* getCacheLineInfo(IntPtr address);
 
    // Update miss type counters
-   MissType getMissType(IntPtr address) const;
+   MissType getMissType(IntPtr address);
    void updateMissTypeCounters(IntPtr address, MissType miss_type);
-   void clearMissTypeTrackingSets(IntPtr address);
    
    // Update counters that record the state of cache lines
    void updateCacheLineStateCounters(CacheState::Type old_cstate, CacheState::Type new_cstate);
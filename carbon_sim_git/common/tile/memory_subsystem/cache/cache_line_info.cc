@@ -3,6 +3,7 @@
 #include "pr_l1_pr_l2_dram_directory_mosi/cache_line_info.h"
 #include "sh_l1_sh_l2/cache_line_info.h"
 #include "pr_l1_sh_l2_msi/cache_line_info.h"
+#include "checkpoint.h"
 #include "log.h"
 
 CacheLineInfo::CacheLineInfo(IntPtr tag, CacheState::Type cstate)
@@ -49,3 +50,17 @@ CacheLineInfo::assign(CacheLineInfo* cache_line_info)
    _tag = cache_line_info->getTag();
    _cstate = cache_line_info->getCState();
 }
+
+void
+CacheLineInfo::checkpoint(CheckpointWriter& writer)
+{
+   writer << _tag << (UInt32) _cstate;
+}
+
+void
+CacheLineInfo::restore(CheckpointReader& reader)
+{
+   UInt32 cstate;
+   reader >> _tag >> cstate;
+   _cstate = (CacheState::Type) cstate;
+}
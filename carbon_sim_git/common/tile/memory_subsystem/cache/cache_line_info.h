@@ -5,6 +5,9 @@
 #include "cache_utils.h"
 #include "caching_protocol_type.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class CacheLineInfo
 {
 // This can be extended to include other information
@@ -18,6 +21,9 @@ public:
    virtual void invalidate();
    virtual void assign(CacheLineInfo* cache_line_info);
 
+   virtual void checkpoint(CheckpointWriter& writer);
+   virtual void restore(CheckpointReader& reader);
+
    bool isValid() const                        
    { return (_tag != ((IntPtr) ~0)); }
    IntPtr getTag() const                        
@@ -7,6 +7,8 @@ using std::string;
 #include "caching_protocol_type.h"
 
 class CacheLineInfo;
+class CheckpointWriter;
+class CheckpointReader;
 
 class CacheReplacementPolicy
 {
@@ -24,9 +26,13 @@ public:
    static CacheReplacementPolicy* create(string policy_str, UInt32 cache_size, UInt32 associativity, UInt32 cache_line_size);
    static Type parse(string policy_str);
    
-   virtual UInt32 getReplacementWay(CacheLineInfo** cache_line_info_array, UInt32 set_num) = 0;
+   virtual UInt32 getReplacementWay(CacheLineInfo** cache_line_info_array, const IntPtr* tags, UInt32 set_num) = 0;
    virtual void update(CacheLineInfo** cache_line_info_array, UInt32 set_num, UInt32 accessed_way) = 0;
 
+   // State of the policy (none by default). Restored into a policy of the same type
+   virtual void checkpoint(CheckpointWriter& writer) {}
+   virtual void restore(CheckpointReader& reader) {}
+
 protected:
    UInt32 _num_sets;
    UInt32 _associativity;
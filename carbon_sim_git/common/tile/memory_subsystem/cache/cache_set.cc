@@ -1,21 +1,27 @@
 #include <cstring>
 #include "cache_set.h"
 #include "cache.h"
+#include "tag_match.h"
 #include "log.h"
 
 CacheSet::CacheSet(UInt32 set_num, CachingProtocolType caching_protocol_type, SInt32 cache_level,
-                   CacheReplacementPolicy* replacement_policy, UInt32 associativity, UInt32 line_size)
-   : _set_num(set_num)
+                   CacheReplacementPolicy* replacement_policy, UInt32 associativity, UInt32 line_size,
+                   IntPtr* tags, UInt8* cstates, CacheLineInfo** cache_line_info_array, char* lines)
+   : _tags(tags)
+   , _cstates(cstates)
+   , _cache_line_info_array(cache_line_info_array)
+   , _lines(lines)
+   , _set_num(set_num)
    , _replacement_policy(replacement_policy)
    , _associativity(associativity)
    , _line_size(line_size)
 {
-   _cache_line_info_array = new CacheLineInfo*[_associativity];
    for (UInt32 i = 0; i < _associativity; i++)
    {
       _cache_line_info_array[i] = CacheLineInfo::create(caching_protocol_type, cache_level);
+      _tags[i] = _cache_line_info_array[i]->getTag();
+      _cstates[i] = _cache_line_info_array[i]->getCState();
    }
-   _lines = new char[_associativity * _line_size];
    
    memset(_lines, 0x00, _associativity * _line_size);
 }
@@ -24,8 +30,6 @@ CacheSet::~CacheSet()
 {
    for (UInt32 i = 0; i < _associativity; i++)
       delete _cache_line_info_array[i];
-   delete [] _cache_line_info_array;
-   delete [] _lines;
 }
 
 void 
@@ -60,16 +64,24 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buf, UInt32 byte
 CacheLineInfo* 
 CacheSet::find(IntPtr tag, UInt32* line_index)
 {
-   for (SInt32 index = _associativity-1; index >= 0; index--)
-   {
-      if (_cache_line_info_array[index]->getTag() == tag)
-      {
-         if (line_index != NULL)
-            *line_index = index;
-         return (_cache_line_info_array[index]);
-      }
-   }
-   return NULL;
+   // Search from the top way down, as an invalid tag can appear more than once
+   SInt32 index = TagMatch::findLast(_tags, _associativity, tag);
+   if (index < 0)
+      return NULL;
+
+   if (line_index != NULL)
+      *line_index = index;
+   return (_cache_line_info_array[index]);
+}
+
+void
+CacheSet::update(UInt32 line_index, CacheLineInfo* updated_cache_line_info)
+{
+   assert(line_index < _associativity);
+
+   _cache_line_info_array[line_index]->assign(updated_cache_line_info);
+   _tags[line_index] = updated_cache_line_info->getTag();
+   _cstates[line_index] = updated_cache_line_info->getCState();
 }
 
 void 
@@ -80,13 +92,13 @@ CacheSet::insert(CacheLineInfo* inserted_cache_line_info, Byte* fill_buf,
    // cache lines can be voluntarily flushed or invalidated due to another write request
    
    LOG_PRINT("getReplacementWay() start");
-   const UInt32 index = _replacement_policy->getReplacementWay(_cache_line_info_array, _set_num);
+   const UInt32 index = _replacement_policy->getReplacementWay(_cache_line_info_array, _tags, _set_num);
    assert(index < _associativity);
    LOG_PRINT("getReplacementWay() end");
 
    assert(eviction != NULL);
         
-   if (_cache_line_info_array[index]->isValid())
+   if (isValid(index))
    {
       *eviction = true;
       evicted_cache_line_info->assign(_cache_line_info_array[index]);
@@ -99,7 +111,7 @@ CacheSet::insert(CacheLineInfo* inserted_cache_line_info, Byte* fill_buf,
       // Get the line info for the purpose of getting the utilization and birth time
    }
 
-   _cache_line_info_array[index]->assign(inserted_cache_line_info);
+   update(index, inserted_cache_line_info);
    if (fill_buf != NULL)
       memcpy(&_lines[index * _line_size], (void*) fill_buf, _line_size);
 
@@ -1,24 +1,38 @@
 #pragma once
 
 #include "fixed_types.h"
+#include "cache_state.h"
 #include "cache_line_info.h"
 #include "cache_replacement_policy.h"
 
 // Everything related to cache sets
+// The tags and states of the ways are kept in arrays of their own, so a
+// lookup never touches the per-way CacheLineInfo objects. These hold the
+// protocol-specific metadata and are kept in sync with the arrays by update()
+// and insert(). The arrays are slices of cache-wide arrays owned by Cache.
 class CacheSet
 {
 public:
    CacheSet(UInt32 set_num, CachingProtocolType caching_protocol_type, SInt32 cache_level,
-            CacheReplacementPolicy* replacement_policy, UInt32 associativity, UInt32 line_size);
+            CacheReplacementPolicy* replacement_policy, UInt32 associativity, UInt32 line_size,
+            IntPtr* tags, UInt8* cstates, CacheLineInfo** cache_line_info_array, char* lines);
    ~CacheSet();
 
    void read_line(UInt32 line_index, UInt32 offset, Byte *out_buf, UInt32 bytes);
    void write_line(UInt32 line_index, UInt32 offset, Byte *in_buf, UInt32 bytes);
    CacheLineInfo* find(IntPtr tag, UInt32* line_index = NULL);
+   void update(UInt32 line_index, CacheLineInfo* updated_cache_line_info);
    void insert(CacheLineInfo* inserted_cache_line_info, Byte* fill_buf,
                bool* eviction, CacheLineInfo* evicted_cache_line_info, Byte* writeback_buf);
 
+   bool isValid(UInt32 line_index) const
+   { return (_tags[line_index] != ((IntPtr) ~0)); }
+   CacheState::Type getCState(UInt32 line_index) const
+   { return (CacheState::Type) _cstates[line_index]; }
+
 private:
+   IntPtr* _tags;
+   UInt8* _cstates;
    CacheLineInfo** _cache_line_info_array;
    char* _lines;
    UInt32 _set_num;
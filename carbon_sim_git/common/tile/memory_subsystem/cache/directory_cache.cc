@@ -3,6 +3,7 @@
 #include <sstream>
 #include <iomanip>
 #include <math.h>
+#include <cstdlib>
 #include <boost/lexical_cast.hpp>
 using namespace std;
 
@@ -12,6 +13,8 @@ using namespace std;
 #include "config.h"
 #include "log.h"
 #include "utils.h"
+#include "tag_match.h"
+#include "checkpoint.h"
 
 #define DETAILED_TRACKING_ENABLED    1
 
@@ -26,6 +29,10 @@ DirectoryCache::DirectoryCache(Tile* tile,
                                UInt32 num_directories,
                                UInt64 directory_access_delay_in_clock_cycles)
    : _tile(tile)
+   , _address_counter(LOG_ADDRESS_COUNTER_REGISTERS)
+   , _replaced_address_counter(REPLACED_ADDRESS_COUNTER_WIDTH, REPLACED_ADDRESS_COUNTER_DEPTH)
+   , _address_with_max_replacements(INVALID_ADDRESS)
+   , _max_address_replacements(0)
    , _caching_protocol_type(caching_protocol_type)
    , _max_hw_sharers(max_hw_sharers)
    , _max_num_sharers(max_num_sharers)
@@ -47,6 +54,11 @@ DirectoryCache::DirectoryCache(Tile* tile,
    // Instantiate the directory
    _directory = new Directory(caching_protocol_type, _directory_type, total_entries, max_hw_sharers, max_num_sharers);
 
+   __attribute__((unused)) SInt32 err = posix_memalign((void**) &_addresses, 64, _total_entries * sizeof(IntPtr));
+   LOG_ASSERT_ERROR(err == 0, "Could not allocate the directory cache address array");
+   for (UInt32 i = 0; i < _total_entries; i++)
+      _addresses[i] = INVALID_ADDRESS;
+
    initializeParameters();
   
    float core_frequency = Config::getSingleton()->getCoreFrequency(Tile::getMainCoreId(tile->getId()));
@@ -73,6 +85,10 @@ DirectoryCache::DirectoryCache(Tile* tile,
 
 DirectoryCache::~DirectoryCache()
 {
+   vector<DirectoryEntry*>::iterator it;
+   for (it = _replaced_directory_entry_list.begin(); it != _replaced_directory_entry_list.end(); it++)
+      _directory->destroyDirectoryEntry(*it);
+   free(_addresses);
    delete _directory;
 }
 
@@ -93,7 +109,7 @@ DirectoryCache::initializeParameters()
    _log_stack_size = floorLog2(stack_size);
    
 #ifdef DETAILED_TRACKING_ENABLED
-   _set_specific_address_map.resize(_num_sets);
+   _set_address_counters.resize(_num_sets, HyperLogLog(LOG_SET_ADDRESS_COUNTER_REGISTERS));
    _set_replacement_histogram.resize(_num_sets);
 #endif
    LOG_PRINT("initializeParameters() exit");
@@ -143,30 +159,28 @@ DirectoryCache::getDirectoryEntry(IntPtr address)
    // Assume that it always hit in the Dram Directory Cache for now
    splitAddress(address, tag, set_index);
    
+   IntPtr* set_addresses = &_addresses[set_index * _associativity];
+
    // Find the relevant directory entry
-   for (UInt32 i = 0; i < _associativity; i++)
+   SInt32 way = TagMatch::findFirst(set_addresses, _associativity, address);
+   if (way >= 0)
    {
-      DirectoryEntry* directory_entry = _directory->getDirectoryEntry(set_index * _associativity + i);
-
-      if (directory_entry->getAddress() == address)
-      {
-         if (getShmemPerfModel())
-            getShmemPerfModel()->incrCycleCount(directory_entry->getLatency());
-         // Simple check for now. Make sophisticated later
-         return directory_entry;
-      }
+      DirectoryEntry* directory_entry = _directory->getDirectoryEntry(set_index * _associativity + way);
+      if (getShmemPerfModel())
+         getShmemPerfModel()->incrCycleCount(directory_entry->getLatency());
+      // Simple check for now. Make sophisticated later
+      return directory_entry;
    }
 
    // Find a free directory entry if one does not currently exist
-   for (UInt32 i = 0; i < _associativity; i++)
+   way = TagMatch::findFirst(set_addresses, _associativity, INVALID_ADDRESS);
+   if (way >= 0)
    {
-      DirectoryEntry* directory_entry = _directory->getDirectoryEntry(set_index * _associativity + i);
-      if (directory_entry->getAddress() == INVALID_ADDRESS)
-      {
-         // Simple check for now. Make sophisticated later
-         directory_entry->setAddress(address);
-         return directory_entry;
-      }
+      DirectoryEntry* directory_entry = _directory->getDirectoryEntry(set_index * _associativity + way);
+      // Simple check for now. Make sophisticated later
+      directory_entry->setAddress(address);
+      set_addresses[way] = address;
+      return directory_entry;
    }
 
    // Check in the _replaced_directory_entry_list
@@ -212,29 +226,34 @@ DirectoryCache::replaceDirectoryEntry(IntPtr replaced_address, IntPtr address)
    UInt32 set_index;
    splitAddress(replaced_address, tag, set_index);
 
-   for (UInt32 i = 0; i < _associativity; i++)
+   SInt32 way = TagMatch::findFirst(&_addresses[set_index * _associativity], _associativity, replaced_address);
+   if (way < 0)
    {
-      DirectoryEntry* replaced_directory_entry = _directory->getDirectoryEntry(set_index * _associativity + i);
-      if (replaced_directory_entry->getAddress() == replaced_address)
-      {
-         _replaced_directory_entry_list.push_back(replaced_directory_entry);
+      // Should not reach here
+      LOG_PRINT_ERROR("No directory entry found for replacment");
+      return NULL;
+   }
 
-         DirectoryEntry* directory_entry = DirectoryEntry::create(_caching_protocol_type, _directory_type, _max_hw_sharers, _max_num_sharers);
-         directory_entry->setAddress(address);
-         _directory->setDirectoryEntry(set_index * _associativity + i, directory_entry);
+   UInt32 entry_num = set_index * _associativity + way;
+   DirectoryEntry* replaced_directory_entry = _directory->getDirectoryEntry(entry_num);
+   _replaced_directory_entry_list.push_back(replaced_directory_entry);
 
-#ifdef DETAILED_TRACKING_ENABLED
-         _replaced_address_map[replaced_address] ++;
-         _set_replacement_histogram[set_index] ++;
-#endif
+   DirectoryEntry* directory_entry = _directory->createDirectoryEntry();
+   directory_entry->setAddress(address);
+   _directory->setDirectoryEntry(entry_num, directory_entry);
+   _addresses[entry_num] = address;
 
-         return directory_entry;
-      }
+#ifdef DETAILED_TRACKING_ENABLED
+   UInt64 address_replacements = _replaced_address_counter.insert(replaced_address);
+   if (address_replacements > _max_address_replacements)
+   {
+      _max_address_replacements = address_replacements;
+      _address_with_max_replacements = replaced_address;
    }
+   _set_replacement_histogram[set_index] ++;
+#endif
 
-   // Should not reach here
-   LOG_PRINT_ERROR("No directory entry found for replacment");
-   return NULL;
+   return directory_entry;
 }
 
 void
@@ -245,7 +264,7 @@ DirectoryCache::invalidateDirectoryEntry(IntPtr address)
    {
       if ((*it)->getAddress() == address)
       {
-         delete (*it);
+         _directory->destroyDirectoryEntry(*it);
          _replaced_directory_entry_list.erase(it);
 
          return;
@@ -265,8 +284,8 @@ DirectoryCache::splitAddress(IntPtr address, IntPtr& tag, UInt32& set_index)
    set_index = computeSetIndex(address);
   
 #ifdef DETAILED_TRACKING_ENABLED 
-   _address_map[address] ++;
-   _set_specific_address_map[set_index][address] ++;
+   _address_counter.insert(address);
+   _set_address_counters[set_index].insert(address);
 #endif
 }
 
@@ -331,6 +350,37 @@ DirectoryCache::checkDirectorySize(tile_id_t tile_id)
    }
 }
 
+// The detailed tracking sketches are not saved: they restart empty
+void
+DirectoryCache::checkpoint(CheckpointWriter& writer)
+{
+   LOG_ASSERT_ERROR(_replaced_directory_entry_list.empty(),
+                    "%u directory entries being replaced", (UInt32) _replaced_directory_entry_list.size());
+
+   writer.beginSection("directory_cache");
+   writer.put<IntPtr>(_addresses, _total_entries);
+   _directory->checkpoint(writer);
+   writer << _total_directory_accesses
+          << _tag_array_reads << _tag_array_writes
+          << _data_array_reads << _data_array_writes;
+   writer.endSection();
+}
+
+void
+DirectoryCache::restore(CheckpointReader& reader)
+{
+   LOG_ASSERT_ERROR(_replaced_directory_entry_list.empty(),
+                    "%u directory entries being replaced", (UInt32) _replaced_directory_entry_list.size());
+
+   reader.beginSection("directory_cache");
+   reader.get<IntPtr>(_addresses, _total_entries);
+   _directory->restore(reader);
+   reader >> _total_directory_accesses
+          >> _tag_array_reads >> _tag_array_writes
+          >> _data_array_reads >> _data_array_writes;
+   reader.endSection();
+}
+
 void
 DirectoryCache::outputSummary(ostream& out)
 {
@@ -350,8 +400,10 @@ DirectoryCache::outputSummary(ostream& out)
 
 #ifdef DETAILED_TRACKING_ENABLED
 
-   UInt32 max_set_size = 0;
-   UInt32 min_set_size = 100000000;
+   // The address counts are estimates, see HyperLogLog and CountMinSketch
+   UInt64 total_addresses = _address_counter.estimate();
+   UInt64 max_set_size = 0;
+   UInt64 min_set_size = ~((UInt64) 0);
    SInt32 set_index_with_max_size = -1;
    SInt32 set_index_with_min_size = -1;
 
@@ -359,20 +411,18 @@ DirectoryCache::outputSummary(ostream& out)
    UInt64 max_set_evictions = 0;
    SInt32 set_index_with_max_evictions = -1;
 
-   UInt64 max_address_evictions = 0;
-   IntPtr address_with_max_evictions = INVALID_ADDRESS;
-   
    for (UInt32 i = 0; i < _num_sets; i++)
    {
       // max, min, average set size, set evictions
-      if (_set_specific_address_map[i].size() > max_set_size)
+      UInt64 set_size = _set_address_counters[i].estimate();
+      if (set_size > max_set_size)
       {
-         max_set_size = _set_specific_address_map[i].size();
+         max_set_size = set_size;
          set_index_with_max_size = i;
       }
-      if (_set_specific_address_map[i].size() < min_set_size)
+      if (set_size < min_set_size)
       {
-         min_set_size = _set_specific_address_map[i].size();
+         min_set_size = set_size;
          set_index_with_min_size = i;
       }
       if (_set_replacement_histogram[i] > max_set_evictions)
@@ -383,23 +433,13 @@ DirectoryCache::outputSummary(ostream& out)
       total_evictions += _set_replacement_histogram[i];
    }
 
-   for (map<IntPtr,UInt64>::iterator it = _replaced_address_map.begin();
-         it != _replaced_address_map.end(); it++)
-   {
-      if ((*it).second > max_address_evictions)
-      {
-         max_address_evictions = (*it).second;
-         address_with_max_evictions = (*it).first;
-      }
-   }
-
    // Total Number of Addresses
    // Max Set Size, Average Set Size, Min Set Size
    // Evictions: Average per set, Max, Address with max evictions
    out << "    Detailed Counters: " << endl;
-   out << "      Total Addresses: " << _address_map.size() << endl;
+   out << "      Total Addresses: " << total_addresses << endl;
 
-   out << "      Average set size: " << float(_address_map.size()) / _num_sets << endl;
+   out << "      Average set size: " << float(total_addresses) / _num_sets << endl;
    out << "      Set index with max size: " << set_index_with_max_size << endl;
    out << "      Max set size: " << max_set_size << endl;
    out << "      Set index with min size: " << set_index_with_min_size << endl;
@@ -409,8 +449,8 @@ DirectoryCache::outputSummary(ostream& out)
    out << "      Set index with max evictions: " << set_index_with_max_evictions << endl;
    out << "      Max set evictions: " << max_set_evictions << endl;
    
-   out << "      Address with max evictions: 0x" << hex << address_with_max_evictions << dec << endl;
-   out << "      Max address evictions: " << max_address_evictions << endl;
+   out << "      Address with max evictions: 0x" << hex << _address_with_max_replacements << dec << endl;
+   out << "      Max address evictions: " << _max_address_replacements << endl;
 #endif
 }
 
@@ -1,11 +1,9 @@
 #pragma once
 
 #include <string>
-#include <map>
 #include <vector>
 using std::string;
 using std::vector;
-using std::map;
 using std::ostream;
 
 #include "tile.h"
@@ -16,6 +14,7 @@ using std::ostream;
 #include "directory_entry.h"
 #include "directory_type.h"
 #include "caching_protocol_type.h"
+#include "streaming_stats.h"
 
 class DirectoryCache
 {
@@ -44,15 +43,25 @@ public:
    void enable() { _enabled = true; }
    void disable() { _enabled = false; }
 
+   // Only when no entry is being replaced
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
    Tile* _tile;
    Directory* _directory;
+   // Address of every directory entry, laid out by set for TagMatch
+   IntPtr* _addresses;
    vector<DirectoryEntry*> _replaced_directory_entry_list;
    
-   map<IntPtr,UInt64> _address_map;
-   vector<map<IntPtr,UInt64> > _set_specific_address_map;
-   map<IntPtr,UInt64> _replaced_address_map;
+   // Detailed tracking in fixed memory: estimated number of distinct addresses
+   // (overall and per set) and of replacements per address
+   HyperLogLog _address_counter;
+   vector<HyperLogLog> _set_address_counters;
    vector<UInt64> _set_replacement_histogram;
+   CountMinSketch _replaced_address_counter;
+   IntPtr _address_with_max_replacements;
+   UInt64 _max_address_replacements;
 
    CachingProtocolType _caching_protocol_type;
    DirectoryType _directory_type;
@@ -98,4 +107,10 @@ private:
    IntPtr computeSetIndex(IntPtr address);
 
    static void checkDirectorySize(tile_id_t tile_id);
+
+   // Sizes of the detailed tracking sketches
+   static const UInt32 LOG_ADDRESS_COUNTER_REGISTERS = 12;
+   static const UInt32 LOG_SET_ADDRESS_COUNTER_REGISTERS = 5;
+   static const UInt32 REPLACED_ADDRESS_COUNTER_WIDTH = 1024;
+   static const UInt32 REPLACED_ADDRESS_COUNTER_DEPTH = 4;
 };
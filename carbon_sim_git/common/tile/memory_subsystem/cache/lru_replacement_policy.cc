@@ -1,5 +1,7 @@
 #include "lru_replacement_policy.h"
 #include "cache_line_info.h"
+#include "tag_match.h"
+#include "checkpoint.h"
 #include "log.h"
 
 LRUReplacementPolicy::LRUReplacementPolicy(UInt32 cache_size, UInt32 associativity, UInt32 cache_line_size)
@@ -21,16 +23,19 @@ LRUReplacementPolicy::~LRUReplacementPolicy()
 {}
 
 UInt32 
-LRUReplacementPolicy::getReplacementWay(CacheLineInfo** cache_line_info_array, UInt32 set_num)
+LRUReplacementPolicy::getReplacementWay(CacheLineInfo** cache_line_info_array, const IntPtr* tags, UInt32 set_num)
 {
+   // Fill invalid ways first (invalid lines carry the tag ~0)
+   SInt32 invalid_way = TagMatch::findFirst(tags, _associativity, (IntPtr) ~0);
+   if (invalid_way >= 0)
+      return invalid_way;
+
    const vector<UInt8>& lru_bits = _lru_bits_vec[set_num];
    // Invalidations may mess up the LRU bits
    UInt32 way = _associativity;
    for (UInt32 i = 0; i < _associativity; i++)
    {
-      if (!cache_line_info_array[i]->isValid())
-         return i;
-      else if (lru_bits[i] == (_associativity-1))
+      if (lru_bits[i] == (_associativity-1))
          way = i;
    }
    LOG_ASSERT_ERROR(way < _associativity, "Error Finding LRU bits");
@@ -48,3 +53,21 @@ LRUReplacementPolicy::update(CacheLineInfo** cache_line_info_array, UInt32 set_n
    }
    lru_bits[accessed_way] = 0;
 }
+
+void
+LRUReplacementPolicy::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("lru_replacement_policy");
+   for (UInt32 set_num = 0; set_num < _num_sets; set_num ++)
+      writer.put<UInt8>(&_lru_bits_vec[set_num][0], _associativity);
+   writer.endSection();
+}
+
+void
+LRUReplacementPolicy::restore(CheckpointReader& reader)
+{
+   reader.beginSection("lru_replacement_policy");
+   for (UInt32 set_num = 0; set_num < _num_sets; set_num ++)
+      reader.get<UInt8>(&_lru_bits_vec[set_num][0], _associativity);
+   reader.endSection();
+}
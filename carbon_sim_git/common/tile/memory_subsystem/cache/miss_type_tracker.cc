@@ -0,0 +1,208 @@
+#include <cstring>
+#include "miss_type_tracker.h"
+#include "log.h"
+
+using std::endl;
+
+MissTypeTracker::MissTypeTracker(Mode mode, UInt32 num_entries, bool verify)
+   : _mode(mode)
+   , _verify(verify && (mode == APPROXIMATE))
+   , _buckets(NULL)
+   , _num_buckets(0)
+   , _total_misses(0)
+   , _total_lost_entries(0)
+   , _total_misclassified_misses(0)
+{
+   if (_mode == APPROXIMATE)
+   {
+      LOG_ASSERT_ERROR(num_entries > 0, "Need at least 1 miss type tracking entry");
+
+      // Round up to a power of 2 buckets
+      _num_buckets = 1;
+      while (_num_buckets * SLOTS_PER_BUCKET < num_entries)
+         _num_buckets <<= 1;
+      _buckets = new Slot[_num_buckets * SLOTS_PER_BUCKET];
+      memset(_buckets, 0, _num_buckets * SLOTS_PER_BUCKET * sizeof(Slot));
+   }
+}
+
+MissTypeTracker::~MissTypeTracker()
+{
+   delete [] _buckets;
+}
+
+MissTypeTracker::Mode
+MissTypeTracker::parseMode(string mode_str)
+{
+   if (mode_str == "exact")
+      return EXACT;
+   else if (mode_str == "approximate")
+      return APPROXIMATE;
+   else
+   {
+      LOG_PRINT_ERROR("Unrecognized Miss Type Tracking Mode(%s)", mode_str.c_str());
+      return NUM_MODES;
+   }
+}
+
+void
+MissTypeTracker::lineFetched(IntPtr address)
+{
+   if ((_mode == EXACT) || _verify)
+      _state_map.erase(address);
+   if (_mode == APPROXIMATE)
+      clearApproximateState(address);
+}
+
+void
+MissTypeTracker::setState(IntPtr address, State state)
+{
+   if ((_mode == EXACT) || _verify)
+      _state_map[address] = state;
+   if (_mode == APPROXIMATE)
+      setApproximateState(address, state);
+}
+
+MissTypeTracker::State
+MissTypeTracker::getStateOnMiss(IntPtr address)
+{
+   _total_misses ++;
+
+   if (_mode == EXACT)
+      return getExactState(address);
+
+   State state = getApproximateState(address);
+   if (_verify && (state != getExactState(address)))
+      _total_misclassified_misses ++;
+   return state;
+}
+
+MissTypeTracker::State
+MissTypeTracker::getExactState(IntPtr address)
+{
+   map<IntPtr, UInt8>::iterator it = _state_map.find(address);
+   return (it == _state_map.end()) ? NOT_FETCHED : (State) it->second;
+}
+
+MissTypeTracker::State
+MissTypeTracker::getApproximateState(IntPtr address)
+{
+   UInt32 bucket;
+   Slot fingerprint;
+   hash(address, bucket, fingerprint);
+
+   const Slot* slots = &_buckets[bucket * SLOTS_PER_BUCKET];
+   for (UInt32 i = 0; i < SLOTS_PER_BUCKET; i++)
+   {
+      if ((slots[i] >> 2) == fingerprint)
+         return (State) (slots[i] & 0x3);
+   }
+   return NOT_FETCHED;
+}
+
+void
+MissTypeTracker::setApproximateState(IntPtr address, State state)
+{
+   UInt32 bucket;
+   Slot fingerprint;
+   hash(address, bucket, fingerprint);
+
+   Slot* slots = &_buckets[bucket * SLOTS_PER_BUCKET];
+
+   // Move the line to the front of its bucket, pushing out the oldest
+   // line if it is not already there and the bucket is full
+   UInt32 index = SLOTS_PER_BUCKET-1;
+   for (UInt32 i = 0; i < SLOTS_PER_BUCKET; i++)
+   {
+      if ((slots[i] >> 2) == fingerprint)
+      {
+         index = i;
+         break;
+      }
+   }
+   if ((index == SLOTS_PER_BUCKET-1) && (slots[index] != 0) && ((slots[index] >> 2) != fingerprint))
+      _total_lost_entries ++;
+
+   for (UInt32 i = index; i > 0; i--)
+      slots[i] = slots[i-1];
+   slots[0] = (fingerprint << 2) | state;
+}
+
+void
+MissTypeTracker::clearApproximateState(IntPtr address)
+{
+   UInt32 bucket;
+   Slot fingerprint;
+   hash(address, bucket, fingerprint);
+
+   Slot* slots = &_buckets[bucket * SLOTS_PER_BUCKET];
+   for (UInt32 i = 0; i < SLOTS_PER_BUCKET; i++)
+   {
+      if ((slots[i] >> 2) == fingerprint)
+      {
+         for ( ; i < SLOTS_PER_BUCKET-1; i++)
+            slots[i] = slots[i+1];
+         slots[SLOTS_PER_BUCKET-1] = 0;
+         return;
+      }
+   }
+}
+
+void
+MissTypeTracker::hash(IntPtr address, UInt32& bucket, Slot& fingerprint)
+{
+   // 64-bit finalizer of MurmurHash3
+   UInt64 h = (UInt64) address;
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdULL;
+   h ^= h >> 33;
+   h *= 0xc4ceb9fe1a85ec53ULL;
+   h ^= h >> 33;
+
+   bucket = h & (_num_buckets - 1);
+   // Fingerprint 0 marks an empty slot
+   fingerprint = (h >> (64 - FINGERPRINT_BITS));
+   if (fingerprint == 0)
+      fingerprint = 1;
+}
+
+void
+MissTypeTracker::outputSummary(ostream& out)
+{
+   out << "    Miss Type Tracking: " << ((_mode == EXACT) ? "exact" : "approximate") << endl;
+   if (_mode == EXACT)
+   {
+      out << "      Tracked Lines: " << _state_map.size() << endl;
+      return;
+   }
+
+   out << "      Table Entries: " << _num_buckets * SLOTS_PER_BUCKET << endl;
+   out << "      Table Size (KB): " << ((double) _num_buckets * SLOTS_PER_BUCKET * sizeof(Slot)) / 1024 << endl;
+   out << "      Lost Entries: " << _total_lost_entries << endl;
+
+   // Every lost entry misclassifies at most the next miss to its line and
+   // a lookup matches the fingerprint of another line with a probability of
+   // at most SLOTS_PER_BUCKET / (2^FINGERPRINT_BITS - 1)
+   if (_total_misses > 0)
+   {
+      double collision_probability = ((double) SLOTS_PER_BUCKET) / ((1 << FINGERPRINT_BITS) - 1);
+      double max_misclassified_misses = _total_lost_entries + collision_probability * _total_misses;
+      if (max_misclassified_misses > _total_misses)
+         max_misclassified_misses = _total_misses;
+      out << "      Estimated Max Misclassification Rate (%): " << 100.0 * max_misclassified_misses / _total_misses << endl;
+   }
+   else
+   {
+      out << "      Estimated Max Misclassification Rate (%): " << endl;
+   }
+
+   if (_verify)
+   {
+      out << "      Exact Tracked Lines: " << _state_map.size() << endl;
+      out << "      Misclassified Misses: " << _total_misclassified_misses << endl;
+      if (_total_misses > 0)
+         out << "      Misclassification Rate (%): " << 100.0 * _total_misclassified_misses / _total_misses << endl;
+      else
+         out << "      Misclassification Rate (%): " << endl;
+   }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <iostream>
+using std::map;
+using std::string;
+using std::ostream;
+
+#include "fixed_types.h"
+
+// History a cache needs to classify its misses to lines it does not hold:
+// whether the line left the cache through an eviction (capacity miss) or
+// an invalidation (sharing miss), or was never fetched (cold miss). Lines
+// in the cache need no history, a miss to one of them is a sharing miss.
+//   EXACT mode keeps the history of every line that ever left the cache in
+// a map and grows with the footprint of the application.
+//   APPROXIMATE mode keeps it in a fixed size table of 4-slot buckets with a
+// 14-bit fingerprint and the 2-bit state per slot. A line whose history was
+// pushed out of a full bucket looks cold again and a fingerprint collision
+// gives a cold line the history of another one, so misses can be
+// misclassified in both directions. With 'verify' set, the exact history is
+// kept alongside and the misclassified misses are counted.
+class MissTypeTracker
+{
+public:
+   enum Mode
+   {
+      EXACT = 0,
+      APPROXIMATE,
+      NUM_MODES
+   };
+
+   enum State
+   {
+      NOT_FETCHED = 0,
+      EVICTED,
+      INVALIDATED,
+      NUM_STATES
+   };
+
+   MissTypeTracker(Mode mode, UInt32 num_entries, bool verify);
+   ~MissTypeTracker();
+
+   static Mode parseMode(string mode_str);
+
+   // The line with address 'address' was inserted into the cache
+   void lineFetched(IntPtr address);
+   // The line with address 'address' left the cache
+   void lineEvicted(IntPtr address)       { setState(address, EVICTED); }
+   void lineInvalidated(IntPtr address)   { setState(address, INVALIDATED); }
+   // History of the line with address 'address' (not in the cache) on a miss
+   State getStateOnMiss(IntPtr address);
+
+   void outputSummary(ostream& out);
+
+private:
+   typedef UInt16 Slot;
+
+   static const UInt32 SLOTS_PER_BUCKET = 4;
+   static const UInt32 FINGERPRINT_BITS = 14;
+
+   Mode _mode;
+   bool _verify;
+
+   // Exact history
+   map<IntPtr, UInt8> _state_map;
+
+   // Approximate history: fingerprint in the upper 14 bits of a slot (0 if
+   // the slot is empty), state in the lower 2 bits. Each bucket is kept in
+   // insertion order, newest first, with the empty slots at the end
+   Slot* _buckets;
+   UInt32 _num_buckets;
+
+   // Counters
+   UInt64 _total_misses;
+   UInt64 _total_lost_entries;
+   UInt64 _total_misclassified_misses;
+
+   void setState(IntPtr address, State state);
+
+   State getExactState(IntPtr address);
+   State getApproximateState(IntPtr address);
+   void setApproximateState(IntPtr address, State state);
+   void clearApproximateState(IntPtr address);
+
+   void hash(IntPtr address, UInt32& bucket, Slot& fingerprint);
+};
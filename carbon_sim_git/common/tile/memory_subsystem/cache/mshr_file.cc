@@ -0,0 +1,93 @@
+#include "mshr_file.h"
+#include "log.h"
+
+MshrFile::MshrFile(UInt32 num_entries)
+   : _scoreboard(num_entries, 0)
+   , _enabled(false)
+   , _total_primary_misses(0)
+   , _total_secondary_misses(0)
+   , _total_allocation_stall_cycles(0)
+   , _total_secondary_miss_wait_cycles(0)
+{
+   LOG_ASSERT_ERROR(num_entries > 0, "Need at least 1 MSHR, got %u", num_entries);
+}
+
+MshrFile::~MshrFile()
+{}
+
+UInt64
+MshrFile::getAllocationTime(UInt64 time)
+{
+   UInt64 earliest_free_time = _scoreboard[0];
+   for (UInt32 i = 0; i < _scoreboard.size(); i++)
+   {
+      if (_scoreboard[i] <= time)
+         return time;
+      if (_scoreboard[i] < earliest_free_time)
+         earliest_free_time = _scoreboard[i];
+   }
+
+   if (_enabled)
+      _total_allocation_stall_cycles += (earliest_free_time - time);
+   return earliest_free_time;
+}
+
+void
+MshrFile::allocate(IntPtr address, UInt64 start_time, UInt64 completion_time)
+{
+   // Take the register that frees up first (the one getAllocationTime() waited for)
+   UInt32 entry = 0;
+   for (UInt32 i = 1; i < _scoreboard.size(); i++)
+   {
+      if (_scoreboard[i] < _scoreboard[entry])
+         entry = i;
+   }
+   LOG_ASSERT_WARNING(_scoreboard[entry] <= start_time,
+         "MSHR allocated at time(%llu) before it is free at time(%llu)", start_time, _scoreboard[entry]);
+   _scoreboard[entry] = completion_time;
+
+   _inflight_misses[address] = completion_time;
+   if (_inflight_misses.size() > 2 * _scoreboard.size())
+      pruneInflightMisses(start_time);
+
+   if (_enabled)
+      _total_primary_misses ++;
+}
+
+UInt64
+MshrFile::getCompletionTime(IntPtr address, UInt64 time)
+{
+   map<IntPtr, UInt64>::iterator it = _inflight_misses.find(address);
+   if ((it == _inflight_misses.end()) || (it->second <= time))
+      return 0;
+
+   if (_enabled)
+   {
+      _total_secondary_misses ++;
+      _total_secondary_miss_wait_cycles += (it->second - time);
+   }
+   return it->second;
+}
+
+void
+MshrFile::pruneInflightMisses(UInt64 time)
+{
+   map<IntPtr, UInt64>::iterator it = _inflight_misses.begin();
+   while (it != _inflight_misses.end())
+   {
+      if (it->second <= time)
+         _inflight_misses.erase(it++);
+      else
+         it ++;
+   }
+}
+
+void
+MshrFile::outputSummary(ostream& out)
+{
+   out << "    MSHRs: " << _scoreboard.size() << endl;
+   out << "      Primary Misses: " << _total_primary_misses << endl;
+   out << "      Secondary Misses: " << _total_secondary_misses << endl;
+   out << "      Allocation Stall Cycles: " << _total_allocation_stall_cycles << endl;
+   out << "      Secondary Miss Wait Cycles: " << _total_secondary_miss_wait_cycles << endl;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <iostream>
+using std::map;
+using std::vector;
+using std::ostream;
+using std::endl;
+
+#include "fixed_types.h"
+
+// Occupancy timing model of the Miss Status Holding Registers of a cache.
+// Misses are still blocking: the application thread waits for every miss to
+// be filled functionally, so the MSHRs only model timing and do not let the
+// thread run ahead of a miss. Each register is busy from the time a
+// primary miss is issued till the line is filled. A primary miss that finds
+// all registers busy waits for the earliest one to free up, and an access to
+// a line whose fill is still in flight (a secondary miss) is merged into the
+// outstanding miss and completes with it instead of at hit latency.
+class MshrFile
+{
+public:
+   MshrFile(UInt32 num_entries);
+   ~MshrFile();
+
+   // Time at which a primary miss issued at 'time' gets a register
+   UInt64 getAllocationTime(UInt64 time);
+   // Hold a register from 'start_time' till 'completion_time' for a miss to the line 'address'
+   void allocate(IntPtr address, UInt64 start_time, UInt64 completion_time);
+   // Completion time of the miss to 'address' in flight at 'time', 0 if there is none
+   UInt64 getCompletionTime(IntPtr address, UInt64 time);
+
+   UInt32 getNumEntries() { return _scoreboard.size(); }
+
+   void enable()     { _enabled = true; }
+   void disable()    { _enabled = false; }
+
+   void outputSummary(ostream& out);
+
+private:
+   // Time at which each register becomes free
+   vector<UInt64> _scoreboard;
+   // Completion time of the misses that may still be in flight
+   map<IntPtr, UInt64> _inflight_misses;
+
+   bool _enabled;
+
+   UInt64 _total_primary_misses;
+   UInt64 _total_secondary_misses;
+   UInt64 _total_allocation_stall_cycles;
+   UInt64 _total_secondary_miss_wait_cycles;
+
+   void pruneInflightMisses(UInt64 time);
+};
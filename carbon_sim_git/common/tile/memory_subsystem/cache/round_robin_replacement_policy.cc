@@ -1,5 +1,6 @@
 #include "round_robin_replacement_policy.h"
 #include "cache_line_info.h"
+#include "checkpoint.h"
 
 RoundRobinReplacementPolicy::RoundRobinReplacementPolicy(UInt32 cache_size, UInt32 associativity, UInt32 cache_line_size)
    : CacheReplacementPolicy(cache_size, associativity, cache_line_size)
@@ -11,7 +12,7 @@ RoundRobinReplacementPolicy::~RoundRobinReplacementPolicy()
 {}
 
 UInt32
-RoundRobinReplacementPolicy::getReplacementWay(CacheLineInfo** cache_line_info_array, UInt32 set_num)
+RoundRobinReplacementPolicy::getReplacementWay(CacheLineInfo** cache_line_info_array, const IntPtr* tags, UInt32 set_num)
 {
    assert(set_num < _num_sets);
    UInt32 curr_replacement_index = _replacement_index_vec[set_num];
@@ -25,3 +26,19 @@ RoundRobinReplacementPolicy::update(CacheLineInfo** cache_line_info_array, UInt3
 {
    return;
 }
+
+void
+RoundRobinReplacementPolicy::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("round_robin_replacement_policy");
+   writer.put<UInt32>(&_replacement_index_vec[0], _num_sets);
+   writer.endSection();
+}
+
+void
+RoundRobinReplacementPolicy::restore(CheckpointReader& reader)
+{
+   reader.beginSection("round_robin_replacement_policy");
+   reader.get<UInt32>(&_replacement_index_vec[0], _num_sets);
+   reader.endSection();
+}
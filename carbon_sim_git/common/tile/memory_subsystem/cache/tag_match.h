@@ -0,0 +1,108 @@
+#pragma once
+
+#include "fixed_types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Tag lookup over the contiguous per-set tag arrays of CacheSet and
+// DirectoryCache.
+// The common associativities (4, 8 and 16) are unrolled at compile time and
+// compare several ways per instruction (AVX2 if the compiler targets it,
+// SSE2 otherwise); every other associativity, and targets without SSE2,
+// use the scalar loop.
+
+namespace TagMatch
+{
+
+// Bit i of the result is set if tags[i] == tag
+template <UInt32 associativity>
+inline UInt32 match(const IntPtr* tags, IntPtr tag)
+{
+   UInt32 mask = 0;
+#if defined(__AVX2__) && defined(TARGET_X86_64)
+   const __m256i key = _mm256_set1_epi64x(tag);
+   for (UInt32 i = 0; i < associativity; i += 4)
+   {
+      __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*) &tags[i]), key);
+      mask |= ((UInt32) _mm256_movemask_pd(_mm256_castsi256_pd(eq))) << i;
+   }
+#elif defined(__SSE2__) && defined(TARGET_X86_64)
+   // No 64-bit compare in SSE2: both 32-bit halves have to match
+   const __m128i key = _mm_set1_epi64x(tag);
+   for (UInt32 i = 0; i < associativity; i += 2)
+   {
+      __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) &tags[i]), key);
+      eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2,3,0,1)));
+      mask |= ((UInt32) _mm_movemask_pd(_mm_castsi128_pd(eq))) << i;
+   }
+#elif defined(__SSE2__)
+   const __m128i key = _mm_set1_epi32(tag);
+   for (UInt32 i = 0; i < associativity; i += 4)
+   {
+      __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) &tags[i]), key);
+      mask |= ((UInt32) _mm_movemask_ps(_mm_castsi128_ps(eq))) << i;
+   }
+#else
+   for (UInt32 i = 0; i < associativity; i++)
+      mask |= ((UInt32) (tags[i] == tag)) << i;
+#endif
+   return mask;
+}
+
+// Index of the first (lowest) way holding 'tag', -1 if there is none
+inline SInt32 findFirst(const IntPtr* tags, UInt32 associativity, IntPtr tag)
+{
+   UInt32 mask;
+   switch (associativity)
+   {
+   case 4:
+      mask = match<4>(tags, tag);
+      break;
+   case 8:
+      mask = match<8>(tags, tag);
+      break;
+   case 16:
+      mask = match<16>(tags, tag);
+      break;
+   default:
+      for (UInt32 i = 0; i < associativity; i++)
+      {
+         if (tags[i] == tag)
+            return i;
+      }
+      return -1;
+   }
+   return (mask == 0) ? -1 : __builtin_ctz(mask);
+}
+
+// Index of the last (highest) way holding 'tag', -1 if there is none
+inline SInt32 findLast(const IntPtr* tags, UInt32 associativity, IntPtr tag)
+{
+   UInt32 mask;
+   switch (associativity)
+   {
+   case 4:
+      mask = match<4>(tags, tag);
+      break;
+   case 8:
+      mask = match<8>(tags, tag);
+      break;
+   case 16:
+      mask = match<16>(tags, tag);
+      break;
+   default:
+      for (SInt32 i = associativity-1; i >= 0; i--)
+      {
+         if (tags[i] == tag)
+            return i;
+      }
+      return -1;
+   }
+   return (mask == 0) ? -1 : (31 - __builtin_clz(mask));
+}
+
+}
@@ -1,19 +1,30 @@
+#include <cstdlib>
+
 #include "simulator.h"
 #include "directory.h"
 #include "directory_entry.h"
+#include "checkpoint.h"
 #include "log.h"
 
 Directory::Directory(CachingProtocolType caching_protocol_type, DirectoryType directory_type,
                      SInt32 total_entries, SInt32 max_hw_sharers, SInt32 max_num_sharers)
-   : _total_entries(total_entries)
+   : _caching_protocol_type(caching_protocol_type)
+   , _directory_type(directory_type)
+   , _total_entries(total_entries)
+   , _max_hw_sharers(max_hw_sharers)
+   , _max_num_sharers(max_num_sharers)
 {
-   // Look at the type of directory and create 
+   _entry_size = DirectoryEntry::getObjectSize(directory_type, max_hw_sharers, max_num_sharers);
+
+   // Look at the type of directory and create the entries in place
    _directory_entry_list.resize(_total_entries);
+   Byte* slab = allocateSlab(_total_entries);
   
    for (SInt32 i = 0; i < _total_entries; i++)
    {
       _directory_entry_list[i] = DirectoryEntry::create(caching_protocol_type, directory_type,
-                                                        max_hw_sharers, max_num_sharers);
+                                                        max_hw_sharers, max_num_sharers,
+                                                        slab + i * _entry_size);
    }
 
    // Sharer Stats
@@ -24,10 +35,24 @@ Directory::~Directory()
 {
    for (SInt32 i = 0; i < _total_entries; i++)
    {
-      delete _directory_entry_list[i];
+      DirectoryEntry::destroy(_directory_entry_list[i]);
+   }
+   for (vector<Byte*>::iterator it = _slab_list.begin(); it != _slab_list.end(); it++)
+   {
+      free(*it);
    }
 }
 
+Byte*
+Directory::allocateSlab(UInt32 num_entries)
+{
+   Byte* slab = NULL;
+   __attribute__((unused)) SInt32 err = posix_memalign((void**) &slab, 64, num_entries * _entry_size);
+   LOG_ASSERT_ERROR(err == 0, "Could not allocate %u directory entries", num_entries);
+   _slab_list.push_back(slab);
+   return slab;
+}
+
 DirectoryEntry*
 Directory::getDirectoryEntry(SInt32 entry_num)
 {
@@ -40,6 +65,29 @@ Directory::setDirectoryEntry(SInt32 entry_num, DirectoryEntry* directory_entry)
    _directory_entry_list[entry_num] = directory_entry;
 }
 
+DirectoryEntry*
+Directory::createDirectoryEntry()
+{
+   if (_free_entry_list.empty())
+   {
+      Byte* slab = allocateSlab(POOL_GROWTH);
+      for (SInt32 i = POOL_GROWTH-1; i >= 0; i--)
+         _free_entry_list.push_back(slab + i * _entry_size);
+   }
+
+   Byte* memory = _free_entry_list.back();
+   _free_entry_list.pop_back();
+   return DirectoryEntry::create(_caching_protocol_type, _directory_type,
+                                 _max_hw_sharers, _max_num_sharers, memory);
+}
+
+void
+Directory::destroyDirectoryEntry(DirectoryEntry* directory_entry)
+{
+   DirectoryEntry::destroy(directory_entry);
+   _free_entry_list.push_back((Byte*) directory_entry);
+}
+
 void
 Directory::initializeSharerStats()
 {
@@ -67,3 +115,36 @@ Directory::getSharerStats(vector<UInt64>& sharer_count_vec)
 {
    sharer_count_vec = _sharer_count_vec;
 }
+
+void
+Directory::checkpoint(CheckpointWriter& writer)
+{
+   writer << (UInt32) _directory_type << _total_entries << _max_hw_sharers << _max_num_sharers;
+   for (SInt32 i = 0; i < _total_entries; i++)
+      _directory_entry_list[i]->checkpoint(writer);
+   writer << (UInt32) _sharer_count_vec.size();
+   writer.put<UInt64>(&_sharer_count_vec[0], _sharer_count_vec.size());
+}
+
+void
+Directory::restore(CheckpointReader& reader)
+{
+   UInt32 directory_type;
+   SInt32 total_entries, max_hw_sharers, max_num_sharers;
+   reader >> directory_type >> total_entries >> max_hw_sharers >> max_num_sharers;
+   LOG_ASSERT_ERROR(((DirectoryType) directory_type == _directory_type) && (total_entries == _total_entries) &&
+                    (max_hw_sharers == _max_hw_sharers) && (max_num_sharers == _max_num_sharers),
+                    "Directory of the checkpoint: type(%u), entries(%i), max hw sharers(%i), max sharers(%i), "
+                    "expected type(%u), entries(%i), max hw sharers(%i), max sharers(%i)",
+                    directory_type, total_entries, max_hw_sharers, max_num_sharers,
+                    _directory_type, _total_entries, _max_hw_sharers, _max_num_sharers);
+
+   for (SInt32 i = 0; i < _total_entries; i++)
+      _directory_entry_list[i]->restore(reader);
+
+   UInt32 num_sharer_counts;
+   reader >> num_sharer_counts;
+   LOG_ASSERT_ERROR(num_sharer_counts == _sharer_count_vec.size(), "Sharer stats of %u tiles, expected %u",
+                    num_sharer_counts - 1, (UInt32) _sharer_count_vec.size() - 1);
+   reader.get<UInt64>(&_sharer_count_vec[0], _sharer_count_vec.size());
+}
@@ -1,15 +1,25 @@
 #pragma once
 
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 
 // Forward Decls
 class DirectoryEntry;
+class CheckpointWriter;
+class CheckpointReader;
 
 #include "fixed_types.h"
 #include "directory_type.h"
 #include "caching_protocol_type.h"
 
+// The entries of a directory are fixed-size blocks (DirectoryEntry::getObjectSize())
+// carved out of large slabs, with no allocation per entry. The entries are
+// initially laid out in entry_num order in a single slab, so the ways of a set
+// are adjacent. An entry that replaces another one while the replaced entry
+// waits for its sharers to be invalidated is taken from a pool of free blocks,
+// to which the replaced entry returns afterwards.
 class Directory
 {
 public:
@@ -19,16 +29,37 @@ public:
 
    DirectoryEntry* getDirectoryEntry(SInt32 entry_num);
    void setDirectoryEntry(SInt32 entry_num, DirectoryEntry* directory_entry);
+
+   // Allocate a new entry from / release an entry to the pool
+   DirectoryEntry* createDirectoryEntry();
+   void destroyDirectoryEntry(DirectoryEntry* directory_entry);
    
    // Sharer Stats
    void updateSharerStats(SInt32 old_sharer_count, SInt32 new_sharer_count);
    void getSharerStats(vector<UInt64>& sharer_count_vec);
 
+   // The entries (in entry_num order) and the sharer stats
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
+   CachingProtocolType _caching_protocol_type;
+   DirectoryType _directory_type;
    SInt32 _total_entries;
+   SInt32 _max_hw_sharers;
+   SInt32 _max_num_sharers;
+
+   // Size of an entry including its sharers (in bytes)
+   UInt32 _entry_size;
+   vector<Byte*> _slab_list;
+   vector<Byte*> _free_entry_list;
 
    vector<DirectoryEntry*> _directory_entry_list;
    vector<UInt64> _sharer_count_vec;
    
+   // Number of free blocks added to the pool at a time
+   static const UInt32 POOL_GROWTH = 64;
+
+   Byte* allocateSlab(UInt32 num_entries);
    void initializeSharerStats();
 };
@@ -1,3 +1,5 @@
+#include <new>
+
 #include "directory_type.h"
 #include "directory_entry.h"
 #include "directory_entry_full_map.h"
@@ -5,6 +7,7 @@
 #include "directory_entry_limited_no_broadcast.h"
 #include "directory_entry_ackwise.h"
 #include "directory_entry_limitless.h"
+#include "checkpoint.h"
 #include "utils.h"
 #include "log.h"
 
@@ -12,14 +15,10 @@ DirectoryEntry::DirectoryEntry(SInt32 max_hw_sharers)
    : _address(INVALID_ADDRESS)
    , _owner_id(INVALID_TILE_ID)
    , _max_hw_sharers(max_hw_sharers)
-{
-   _directory_block_info = new DirectoryBlockInfo();
-}
+{}
 
 DirectoryEntry::~DirectoryEntry()
-{
-   delete _directory_block_info;
-}
+{}
 
 DirectoryType
 DirectoryEntry::parseDirectoryType(string directory_type)
@@ -42,28 +41,45 @@ DirectoryEntry::parseDirectoryType(string directory_type)
 DirectoryEntry*
 DirectoryEntry::create(CachingProtocolType caching_protocol_type, DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers)
 {
-   return create(directory_type, max_hw_sharers, max_num_sharers);
+   // Released by DirectoryEntry::operator delete when the entry is deleted
+   void* memory = ::operator new(getObjectSize(directory_type, max_hw_sharers, max_num_sharers));
+   return create(directory_type, max_hw_sharers, max_num_sharers, memory);
 }
 
 DirectoryEntry*
-DirectoryEntry::create(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers)
+DirectoryEntry::create(CachingProtocolType caching_protocol_type, DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers,
+                       void* memory)
+{
+   return create(directory_type, max_hw_sharers, max_num_sharers, memory);
+}
+
+// The sharer storage starts right after the object of the entry's class
+#define SHARER_STORAGE(memory, class_name)      ((void*) (((Byte*) (memory)) + sizeof(class_name)))
+
+DirectoryEntry*
+DirectoryEntry::create(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers, void* memory)
 {
    switch (directory_type)
    {
    case FULL_MAP:
-      return new DirectoryEntryFullMap(max_num_sharers);
+      return new (memory) DirectoryEntryFullMap(max_num_sharers,
+                                                (UInt64*) SHARER_STORAGE(memory, DirectoryEntryFullMap));
 
    case LIMITED_NO_BROADCAST:
-      return new DirectoryEntryLimitedNoBroadcast(max_hw_sharers);
+      return new (memory) DirectoryEntryLimitedNoBroadcast(max_hw_sharers,
+                                                           (SInt16*) SHARER_STORAGE(memory, DirectoryEntryLimitedNoBroadcast));
 
    case LIMITED_BROADCAST:
-      return new DirectoryEntryLimitedBroadcast(max_hw_sharers);
+      return new (memory) DirectoryEntryLimitedBroadcast(max_hw_sharers,
+                                                         (SInt16*) SHARER_STORAGE(memory, DirectoryEntryLimitedBroadcast));
 
    case ACKWISE:
-      return new DirectoryEntryAckwise(max_hw_sharers);
+      return new (memory) DirectoryEntryAckwise(max_hw_sharers,
+                                                (SInt16*) SHARER_STORAGE(memory, DirectoryEntryAckwise));
 
    case LIMITLESS:
-      return new DirectoryEntryLimitless(max_hw_sharers, max_num_sharers);
+      return new (memory) DirectoryEntryLimitless(max_hw_sharers, max_num_sharers,
+                                                  (SInt16*) SHARER_STORAGE(memory, DirectoryEntryLimitless));
 
    default:
       LOG_PRINT_ERROR("Unrecognized Directory Type: %u", directory_type);
@@ -71,6 +87,41 @@ DirectoryEntry::create(DirectoryType directory_type, SInt32 max_hw_sharers, SInt
    }
 }
 
+void
+DirectoryEntry::destroy(DirectoryEntry* directory_entry)
+{
+   directory_entry->~DirectoryEntry();
+}
+
+UInt32
+DirectoryEntry::getObjectSize(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers)
+{
+   UInt32 object_size;
+   switch (directory_type)
+   {
+   case FULL_MAP:
+      object_size = sizeof(DirectoryEntryFullMap) + DirectoryEntryFullMap::getSharerStorageSize(max_num_sharers);
+      break;
+   case LIMITED_NO_BROADCAST:
+      object_size = sizeof(DirectoryEntryLimitedNoBroadcast) + DirectoryEntryLimited::getSharerStorageSize(max_hw_sharers);
+      break;
+   case LIMITED_BROADCAST:
+      object_size = sizeof(DirectoryEntryLimitedBroadcast) + DirectoryEntryLimited::getSharerStorageSize(max_hw_sharers);
+      break;
+   case ACKWISE:
+      object_size = sizeof(DirectoryEntryAckwise) + DirectoryEntryLimited::getSharerStorageSize(max_hw_sharers);
+      break;
+   case LIMITLESS:
+      object_size = sizeof(DirectoryEntryLimitless) + DirectoryEntryLimited::getSharerStorageSize(max_hw_sharers);
+      break;
+   default:
+      LOG_PRINT_ERROR("Unrecognized directory type(%u)", directory_type);
+      return 0;
+   }
+   // Keep the entries of an array aligned
+   return (object_size + sizeof(UInt64) - 1) & ~(sizeof(UInt64) - 1);
+}
+
 UInt32
 DirectoryEntry::getSize(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers)
 {
@@ -90,12 +141,6 @@ DirectoryEntry::getSize(DirectoryType directory_type, SInt32 max_hw_sharers, SIn
    }
 }
 
-DirectoryBlockInfo*
-DirectoryEntry::getDirectoryBlockInfo()
-{
-   return _directory_block_info;
-}
-   
 tile_id_t
 DirectoryEntry::getOwner()
 {
@@ -110,6 +155,20 @@ DirectoryEntry::setOwner(tile_id_t owner_id)
    _owner_id = owner_id;
 }
 
+void
+DirectoryEntry::checkpoint(CheckpointWriter& writer)
+{
+   writer << _address << _owner_id << (UInt32) _directory_block_info.getDState();
+}
+
+void
+DirectoryEntry::restore(CheckpointReader& reader)
+{
+   UInt32 dstate;
+   reader >> _address >> _owner_id >> dstate;
+   _directory_block_info.setDState((DirectoryState::Type) dstate);
+}
+
 // Manipulating utilization
 void
 DirectoryEntry::setUtilization(UInt64 utilization)
@@ -10,6 +10,12 @@ using std::string;
 #include "directory_type.h"
 #include "caching_protocol_type.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
+// The sharers of an entry are stored right after the object, so an entry is
+// a single block of getObjectSize() bytes that a Directory can lay out in
+// one array
 class DirectoryEntry
 {
 public:
@@ -17,11 +23,22 @@ public:
    virtual ~DirectoryEntry();
 
    static DirectoryType parseDirectoryType(string directory_type);
+   // Entry allocated on the heap, freed with 'delete'
    static DirectoryEntry* create(CachingProtocolType caching_protocol_type, DirectoryType directory_type,
                                  SInt32 max_hw_sharers, SInt32 max_num_sharers);
+   // Entry constructed in 'memory' (getObjectSize() bytes), freed with destroy()
+   static DirectoryEntry* create(CachingProtocolType caching_protocol_type, DirectoryType directory_type,
+                                 SInt32 max_hw_sharers, SInt32 max_num_sharers, void* memory);
+   static void destroy(DirectoryEntry* directory_entry);
+   // The heap entries of create() are larger than their class, so they must
+   // not be released with a sized delete
+   static void operator delete(void* memory) { ::operator delete(memory); }
+   // Size of the modeled hardware entry (in bits)
    static UInt32 getSize(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers);
+   // Size of an entry object including its sharer storage (in bytes)
+   static UInt32 getObjectSize(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers);
 
-   DirectoryBlockInfo* getDirectoryBlockInfo();
+   DirectoryBlockInfo* getDirectoryBlockInfo() { return &_directory_block_info; }
 
    virtual bool hasSharer(tile_id_t sharer_id) = 0;
    virtual bool addSharer(tile_id_t sharer_id) = 0;
@@ -40,6 +57,11 @@ public:
 
    virtual UInt32 getLatency() = 0;
 
+   // State of the entry. An entry is restored into an entry of the same
+   // type and number of sharers
+   virtual void checkpoint(CheckpointWriter& writer);
+   virtual void restore(CheckpointReader& reader);
+
    // Utilization
    void setUtilization(UInt64 utilization);
    void getUtilizationVec(vector<UInt64>& utilization_vec);
@@ -47,11 +69,11 @@ public:
 
 protected:
    IntPtr _address;
-   DirectoryBlockInfo* _directory_block_info;
+   DirectoryBlockInfo _directory_block_info;
    tile_id_t _owner_id;
    SInt32 _max_hw_sharers;
 
 private:
    vector<UInt64> _utilization_vec;
-   static DirectoryEntry* create(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers);
+   static DirectoryEntry* create(DirectoryType directory_type, SInt32 max_hw_sharers, SInt32 max_num_sharers, void* memory);
 };
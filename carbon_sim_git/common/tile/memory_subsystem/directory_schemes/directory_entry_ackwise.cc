@@ -1,8 +1,9 @@
 #include "directory_entry_ackwise.h"
+#include "checkpoint.h"
 #include "log.h"
 
-DirectoryEntryAckwise::DirectoryEntryAckwise(SInt32 max_hw_sharers)
-   : DirectoryEntryLimited(max_hw_sharers)
+DirectoryEntryAckwise::DirectoryEntryAckwise(SInt32 max_hw_sharers, SInt16* sharers)
+   : DirectoryEntryLimited(max_hw_sharers, sharers)
    , _global_enabled(false)
    , _num_untracked_sharers(0)
 {}
@@ -90,3 +91,17 @@ DirectoryEntryAckwise::getLatency()
 {
    return 0;
 }
+
+void
+DirectoryEntryAckwise::checkpoint(CheckpointWriter& writer)
+{
+   DirectoryEntryLimited::checkpoint(writer);
+   writer << _global_enabled << _num_untracked_sharers;
+}
+
+void
+DirectoryEntryAckwise::restore(CheckpointReader& reader)
+{
+   DirectoryEntryLimited::restore(reader);
+   reader >> _global_enabled >> _num_untracked_sharers;
+}
@@ -5,7 +5,7 @@
 class DirectoryEntryAckwise : public DirectoryEntryLimited
 {
 public:
-   DirectoryEntryAckwise(SInt32 max_hw_sharers);
+   DirectoryEntryAckwise(SInt32 max_hw_sharers, SInt16* sharers);
    ~DirectoryEntryAckwise();
   
    bool addSharer(tile_id_t sharer_id); 
@@ -17,6 +17,9 @@ public:
 
    UInt32 getLatency();
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
    bool _global_enabled;
    SInt32 _num_untracked_sharers;
@@ -1,23 +1,27 @@
+#include <cstring>
+#include <cassert>
+
 #include "directory_entry_full_map.h"
+#include "checkpoint.h"
 #include "log.h"
 
 using namespace std;
 
-DirectoryEntryFullMap::DirectoryEntryFullMap(SInt32 max_hw_sharers)
+DirectoryEntryFullMap::DirectoryEntryFullMap(SInt32 max_hw_sharers, UInt64* sharers)
    : DirectoryEntry(max_hw_sharers)
+   , _sharers(sharers)
+   , _num_sharers(0)
 {
-   _sharers = new BitVector(_max_hw_sharers);
+   memset(_sharers, 0, getSharerStorageSize(_max_hw_sharers));
 }
 
 DirectoryEntryFullMap::~DirectoryEntryFullMap()
-{
-   delete _sharers;
-}
+{}
 
 bool
 DirectoryEntryFullMap::hasSharer(tile_id_t sharer_id)
 {
-   return _sharers->at(sharer_id);
+   return (_sharers[sharer_id >> 6] >> (sharer_id & 63)) & 1;
 }
 
 // Return value says whether the sharer was successfully added
@@ -26,9 +30,10 @@ DirectoryEntryFullMap::hasSharer(tile_id_t sharer_id)
 bool
 DirectoryEntryFullMap::addSharer(tile_id_t sharer_id)
 {
-   LOG_ASSERT_ERROR(!_sharers->at(sharer_id), "Could not add sharer(%i)", sharer_id);
-   _sharers->set(sharer_id);
-   return true;;
+   LOG_ASSERT_ERROR(!hasSharer(sharer_id), "Could not add sharer(%i)", sharer_id);
+   _sharers[sharer_id >> 6] |= (1ULL << (sharer_id & 63));
+   _num_sharers ++;
+   return true;
 }
 
 void
@@ -36,8 +41,9 @@ DirectoryEntryFullMap::removeSharer(tile_id_t sharer_id, bool reply_expected)
 {
    assert(!reply_expected);
 
-   assert(_sharers->at(sharer_id));
-   _sharers->clear(sharer_id);
+   assert(hasSharer(sharer_id));
+   _sharers[sharer_id >> 6] &= ~(1ULL << (sharer_id & 63));
+   _num_sharers --;
 }
 
 // Return a pair:
@@ -47,18 +53,20 @@ DirectoryEntryFullMap::removeSharer(tile_id_t sharer_id, bool reply_expected)
 bool
 DirectoryEntryFullMap::getSharersList(vector<tile_id_t>& sharers_list)
 {
-   sharers_list.resize(_sharers->size());
+   sharers_list.resize(_num_sharers);
 
-   _sharers->resetFind();
-
-   tile_id_t new_sharer = -1;
    SInt32 i = 0;
-   while ((new_sharer = _sharers->find()) != -1)
+   SInt32 num_words = getSharerStorageSize(_max_hw_sharers) / sizeof(UInt64);
+   for (SInt32 w = 0; w < num_words; w++)
    {
-      sharers_list[i] = new_sharer;
-      i++;
-      assert (i <= (tile_id_t) _sharers->size());
+      for (UInt64 word = _sharers[w]; word != 0; word &= (word - 1))
+      {
+         assert(i < _num_sharers);
+         sharers_list[i] = (w << 6) + __builtin_ctzll(word);
+         i++;
+      }
    }
+   assert(i == _num_sharers);
 
    return false;
 }
@@ -76,7 +84,7 @@ DirectoryEntryFullMap::getOneSharer()
 SInt32
 DirectoryEntryFullMap::getNumSharers()
 {
-   return _sharers->size();
+   return _num_sharers;
 }
 
 UInt32
@@ -84,3 +92,19 @@ DirectoryEntryFullMap::getLatency()
 {
    return 0;
 }
+
+void
+DirectoryEntryFullMap::checkpoint(CheckpointWriter& writer)
+{
+   DirectoryEntry::checkpoint(writer);
+   writer.put<UInt64>(_sharers, getSharerStorageSize(_max_hw_sharers) / sizeof(UInt64));
+   writer << _num_sharers;
+}
+
+void
+DirectoryEntryFullMap::restore(CheckpointReader& reader)
+{
+   DirectoryEntry::restore(reader);
+   reader.get<UInt64>(_sharers, getSharerStorageSize(_max_hw_sharers) / sizeof(UInt64));
+   reader >> _num_sharers;
+}
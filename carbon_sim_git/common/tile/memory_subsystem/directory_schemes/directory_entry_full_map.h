@@ -1,15 +1,18 @@
 #pragma once
 
 #include "directory_entry.h"
-#include "bit_vector.h"
 #include "random.h"
 
 class DirectoryEntryFullMap : public DirectoryEntry
 {
 public:
-   DirectoryEntryFullMap(SInt32 max_hw_sharers);
+   // 'sharers' points to getSharerStorageSize(max_hw_sharers) bytes
+   DirectoryEntryFullMap(SInt32 max_hw_sharers, UInt64* sharers);
    ~DirectoryEntryFullMap();
    
+   static UInt32 getSharerStorageSize(SInt32 max_hw_sharers)
+   { return ((max_hw_sharers + 63) >> 6) * sizeof(UInt64); }
+
    bool hasSharer(tile_id_t sharer_id);
    bool addSharer(tile_id_t sharer_id);
    void removeSharer(tile_id_t sharer_id, bool reply_expected);
@@ -23,7 +26,12 @@ public:
 
    UInt32 getLatency();
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
-   BitVector* _sharers;
+   // Bit vector of sharers
+   UInt64* _sharers;
+   SInt32 _num_sharers;
    Random _rand_num;
 };
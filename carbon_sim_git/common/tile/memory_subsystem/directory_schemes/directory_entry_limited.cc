@@ -1,13 +1,14 @@
 #include "directory_entry_limited.h"
+#include "checkpoint.h"
 #include "log.h"
 
 using namespace std;
 
-DirectoryEntryLimited::DirectoryEntryLimited(SInt32 max_hw_sharers)
+DirectoryEntryLimited::DirectoryEntryLimited(SInt32 max_hw_sharers, SInt16* sharers)
    : DirectoryEntry(max_hw_sharers)
+   , _sharers(sharers)
    , _num_tracked_sharers(0)
 {
-   _sharers.resize(_max_hw_sharers);
    for (SInt32 i = 0; i < _max_hw_sharers; i++)
       _sharers[i] = INVALID_SHARER;
 }
@@ -103,3 +104,19 @@ DirectoryEntryLimited::getNumSharers()
 {
    return _num_tracked_sharers;
 }
+
+void
+DirectoryEntryLimited::checkpoint(CheckpointWriter& writer)
+{
+   DirectoryEntry::checkpoint(writer);
+   writer.put<SInt16>(_sharers, _max_hw_sharers);
+   writer << _num_tracked_sharers;
+}
+
+void
+DirectoryEntryLimited::restore(CheckpointReader& reader)
+{
+   DirectoryEntry::restore(reader);
+   reader.get<SInt16>(_sharers, _max_hw_sharers);
+   reader >> _num_tracked_sharers;
+}
@@ -6,9 +6,13 @@
 class DirectoryEntryLimited : public DirectoryEntry
 {
 public:
-   DirectoryEntryLimited(SInt32 max_hw_sharers);
+   // 'sharers' points to getSharerStorageSize(max_hw_sharers) bytes
+   DirectoryEntryLimited(SInt32 max_hw_sharers, SInt16* sharers);
    ~DirectoryEntryLimited();
 
+   static UInt32 getSharerStorageSize(SInt32 max_hw_sharers)
+   { return max_hw_sharers * sizeof(SInt16); }
+
    bool hasSharer(tile_id_t sharer_id);
    bool addSharer(tile_id_t sharer_id);
    void removeSharer(tile_id_t sharer_id);
@@ -17,8 +21,11 @@ public:
    tile_id_t getOneSharer();
    SInt32 getNumSharers();
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 protected:
-   vector<SInt16> _sharers;
+   SInt16* _sharers;
    SInt32 _num_tracked_sharers;
    static const SInt16 INVALID_SHARER = 0xffff;
 
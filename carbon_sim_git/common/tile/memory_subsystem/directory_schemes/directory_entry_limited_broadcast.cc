@@ -1,11 +1,12 @@
 #include "directory_entry_limited_broadcast.h"
 #include "config.h"
+#include "checkpoint.h"
 #include "log.h"
 
 using namespace std;
 
-DirectoryEntryLimitedBroadcast::DirectoryEntryLimitedBroadcast(SInt32 max_hw_sharers)
-   : DirectoryEntryLimited(max_hw_sharers)
+DirectoryEntryLimitedBroadcast::DirectoryEntryLimitedBroadcast(SInt32 max_hw_sharers, SInt16* sharers)
+   : DirectoryEntryLimited(max_hw_sharers, sharers)
    , _global_enabled(false)
    , _num_sharers(0)
 {}
@@ -87,4 +88,16 @@ DirectoryEntryLimitedBroadcast::getLatency()
 {
    return 0;
 }
+void
+DirectoryEntryLimitedBroadcast::checkpoint(CheckpointWriter& writer)
+{
+   DirectoryEntryLimited::checkpoint(writer);
+   writer << _global_enabled << _num_sharers;
+}
 
+void
+DirectoryEntryLimitedBroadcast::restore(CheckpointReader& reader)
+{
+   DirectoryEntryLimited::restore(reader);
+   reader >> _global_enabled >> _num_sharers;
+}
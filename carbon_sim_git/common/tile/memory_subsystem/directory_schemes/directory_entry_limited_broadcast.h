@@ -5,7 +5,7 @@
 class DirectoryEntryLimitedBroadcast : public DirectoryEntryLimited
 {
 public:
-   DirectoryEntryLimitedBroadcast(SInt32 max_hw_sharers);
+   DirectoryEntryLimitedBroadcast(SInt32 max_hw_sharers, SInt16* sharers);
    ~DirectoryEntryLimitedBroadcast();
    
    bool addSharer(tile_id_t sharer_id);
@@ -17,6 +17,9 @@ public:
 
    UInt32 getLatency();
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
    bool _global_enabled;
    UInt32 _num_sharers;
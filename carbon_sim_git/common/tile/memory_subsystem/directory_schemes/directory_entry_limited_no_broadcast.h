@@ -5,7 +5,7 @@
 class DirectoryEntryLimitedNoBroadcast : public DirectoryEntryLimited
 {
 public:
-   DirectoryEntryLimitedNoBroadcast(SInt32 max_hw_sharers);
+   DirectoryEntryLimitedNoBroadcast(SInt32 max_hw_sharers, SInt16* sharers);
    ~DirectoryEntryLimitedNoBroadcast();
    
    void removeSharer(tile_id_t sharer_id, bool reply_expected);
@@ -1,13 +1,14 @@
 #include "directory_entry_limitless.h"
 #include "simulator.h"
 #include "config.h"
+#include "checkpoint.h"
 #include "log.h"
 
 bool DirectoryEntryLimitless::_software_trap_penalty_initialized = false;
 UInt32 DirectoryEntryLimitless::_software_trap_penalty;
 
-DirectoryEntryLimitless::DirectoryEntryLimitless(SInt32 max_hw_sharers, SInt32 max_num_sharers)
-   : DirectoryEntryLimited(max_hw_sharers)
+DirectoryEntryLimitless::DirectoryEntryLimitless(SInt32 max_hw_sharers, SInt32 max_num_sharers, SInt16* sharers)
+   : DirectoryEntryLimited(max_hw_sharers, sharers)
    , _software_sharers(NULL)
    , _max_num_sharers(max_num_sharers)
    , _software_trap_enabled(false)
@@ -135,3 +136,43 @@ DirectoryEntryLimitless::getLatency()
 {
    return (_software_trap_enabled) ? _software_trap_penalty : 0;
 }
+
+// The software sharers are saved as a list of ids
+void
+DirectoryEntryLimitless::checkpoint(CheckpointWriter& writer)
+{
+   DirectoryEntryLimited::checkpoint(writer);
+   writer << _software_trap_enabled;
+   if (_software_trap_enabled)
+   {
+      writer << (UInt32) _software_sharers->size();
+      for (SInt32 i = 0; i < _max_num_sharers; i++)
+      {
+         if (_software_sharers->at(i))
+            writer << (SInt32) i;
+      }
+   }
+}
+
+void
+DirectoryEntryLimitless::restore(CheckpointReader& reader)
+{
+   DirectoryEntryLimited::restore(reader);
+   reader >> _software_trap_enabled;
+
+   delete _software_sharers;
+   _software_sharers = NULL;
+   if (_software_trap_enabled)
+   {
+      _software_sharers = new BitVector(_max_num_sharers);
+      UInt32 num_software_sharers;
+      reader >> num_software_sharers;
+      for (UInt32 i = 0; i < num_software_sharers; i++)
+      {
+         SInt32 sharer_id;
+         reader >> sharer_id;
+         LOG_ASSERT_ERROR(sharer_id >= 0 && sharer_id < _max_num_sharers, "Sharer(%i) out of range", sharer_id);
+         _software_sharers->set(sharer_id);
+      }
+   }
+}
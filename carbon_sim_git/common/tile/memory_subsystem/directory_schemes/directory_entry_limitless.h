@@ -6,7 +6,7 @@
 class DirectoryEntryLimitless : public DirectoryEntryLimited
 {
 public:
-   DirectoryEntryLimitless(SInt32 max_hw_sharers, SInt32 max_num_sharers);
+   DirectoryEntryLimitless(SInt32 max_hw_sharers, SInt32 max_num_sharers, SInt16* sharers);
    ~DirectoryEntryLimitless();
    
    bool hasSharer(tile_id_t sharer_id);
@@ -18,8 +18,11 @@ public:
 
    UInt32 getLatency();
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
-   // Software Sharers
+   // Software Sharers - Only allocated once the hardware sharers overflow
    BitVector* _software_sharers;
 
    // Max Num Sharers - For Software Trap
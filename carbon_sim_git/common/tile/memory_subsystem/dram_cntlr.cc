@@ -2,8 +2,13 @@
 #include "tile.h"
 #include "memory_manager.h"
 #include "clock_converter.h"
+#include "checkpoint.h"
 #include "log.h"
 
+PagedBackingStore* DramCntlr::_backing_store = NULL;
+UInt32 DramCntlr::_num_dram_cntlrs = 0;
+Lock DramCntlr::_backing_store_lock;
+
 DramCntlr::DramCntlr(Tile* tile,
       float dram_access_cost,
       float dram_bandwidth,
@@ -20,6 +25,10 @@ DramCntlr::DramCntlr(Tile* tile,
                                         cache_line_size);
 
    _dram_access_count = new AccessCountMap[NUM_ACCESS_TYPES];
+
+   ScopedLock sl(_backing_store_lock);
+   if (_num_dram_cntlrs ++ == 0)
+      _backing_store = new PagedBackingStore();
 }
 
 DramCntlr::~DramCntlr()
@@ -28,17 +37,20 @@ DramCntlr::~DramCntlr()
    delete [] _dram_access_count;
 
    delete _dram_perf_model;
+
+   ScopedLock sl(_backing_store_lock);
+   if (-- _num_dram_cntlrs == 0)
+   {
+      delete _backing_store;
+      _backing_store = NULL;
+   }
 }
 
 void
 DramCntlr::getDataFromDram(IntPtr address, Byte* data_buf, bool modeled)
 {
-   if (_data_map[address] == NULL)
-   {
-      _data_map[address] = new Byte[_cache_line_size];
-      memset((void*) _data_map[address], 0x00, _cache_line_size);
-   }
-   memcpy((void*) data_buf, (void*) _data_map[address], _cache_line_size);
+   // Lines that were never written read as zeros
+   memcpy((void*) data_buf, (void*) _backing_store->getLine(address), _cache_line_size);
 
    UInt64 dram_access_latency = modeled ? runDramPerfModel() : 0;
    LOG_PRINT("Dram Access Latency(%llu)", dram_access_latency);
@@ -50,11 +62,7 @@ DramCntlr::getDataFromDram(IntPtr address, Byte* data_buf, bool modeled)
 void
 DramCntlr::putDataToDram(IntPtr address, Byte* data_buf, bool modeled)
 {
-   if (_data_map[address] == NULL)
-   {
-      LOG_PRINT_ERROR("Data Buffer does not exist");
-   }
-   memcpy((void*) _data_map[address], (void*) data_buf, _cache_line_size);
+   memcpy((void*) _backing_store->getLine(address), (void*) data_buf, _cache_line_size);
 
    __attribute__((__unused__)) UInt64 dram_access_latency = modeled ? runDramPerfModel() : 0;
    
@@ -98,6 +106,49 @@ DramCntlr::printDramAccessCount()
    }
 }
 
+void
+DramCntlr::checkpoint(CheckpointWriter& writer)
+{
+   _dram_perf_model->checkpoint(writer);
+}
+
+void
+DramCntlr::restore(CheckpointReader& reader)
+{
+   _dram_perf_model->restore(reader);
+}
+
+// Not all the processes have a DRAM controller
+void
+DramCntlr::checkpointBackingStore(CheckpointWriter& writer)
+{
+   writer << (_backing_store != NULL);
+   if (_backing_store)
+      _backing_store->checkpoint(writer);
+}
+
+UInt64
+DramCntlr::hashMemory(const std::map<IntPtr, const Byte*>& dirty_lines, UInt32 line_size)
+{
+   UInt64 hash = 0;
+   if (_backing_store)
+      hash = _backing_store->hash(dirty_lines, line_size);
+   for (std::map<IntPtr, const Byte*>::const_iterator it = dirty_lines.begin(); it != dirty_lines.end(); it++)
+      hash += PagedBackingStore::hashLine(it->first, it->second, line_size);
+   return hash;
+}
+
+void
+DramCntlr::restoreBackingStore(CheckpointReader& reader)
+{
+   bool backing_store_present;
+   reader >> backing_store_present;
+   LOG_ASSERT_ERROR(backing_store_present == (_backing_store != NULL),
+                    "The DRAM controllers of the process differ from the checkpoint");
+   if (_backing_store)
+      _backing_store->restore(reader);
+}
+
 ShmemPerfModel*
 DramCntlr::getShmemPerfModel()
 {
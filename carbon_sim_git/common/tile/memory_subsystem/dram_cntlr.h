@@ -4,9 +4,11 @@
 using std::map;
 
 #include "tile.h"
+#include "lock.h"
 #include "dram_perf_model.h"
 #include "shmem_perf_model.h"
 #include "fixed_types.h"
+#include "paged_backing_store.h"
 
 class DramCntlr
 {
@@ -30,12 +32,25 @@ public:
 
    void getDataFromDram(IntPtr address, Byte* data_buf, bool modeled);
    void putDataToDram(IntPtr address, Byte* data_buf, bool modeled);
+
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+   // Contents of the memory of the process
+   static void checkpointBackingStore(CheckpointWriter& writer);
+   static void restoreBackingStore(CheckpointReader& reader);
+   // Hash of the memory of the process with the cached 'dirty_lines' in
+   // place of the stored copies (see PagedBackingStore::hash())
+   static UInt64 hashMemory(const std::map<IntPtr, const Byte*>& dirty_lines, UInt32 line_size);
    
 private:
    Tile* _tile;
-   map<IntPtr, Byte*> _data_map;
    DramPerfModel* _dram_perf_model;
 
+   // Contents of the memory, shared by the DRAM controllers of the process
+   static PagedBackingStore* _backing_store;
+   static UInt32 _num_dram_cntlrs;
+   static Lock _backing_store_lock;
+
    typedef std::map<IntPtr,UInt64> AccessCountMap;
    AccessCountMap* _dram_access_count;
 
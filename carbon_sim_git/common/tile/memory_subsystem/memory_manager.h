@@ -10,6 +10,9 @@ using namespace std;
 #include "caching_protocol_type.h"
 #include "shmem_perf_model.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 void MemoryManagerNetworkCallback(void* obj, NetPacket packet);
 
 class MemoryManager
@@ -30,11 +33,24 @@ public:
    Tile* getTile()   { return _tile; }
    virtual UInt32 getCacheLineSize() = 0;
    ShmemPerfModel* getShmemPerfModel() { return _shmem_perf_model; }
+   // L1-D and L2 caches on the tile, NULL if not present
+   virtual Cache* getL1DCache() { return NULL; }
+   virtual Cache* getL2Cache() { return NULL; }
 
    virtual tile_id_t getShmemRequester(const void* pkt_data) = 0;
 
    virtual void enableModels() = 0;
    virtual void disableModels() = 0;
+   // Timing and counters of the caches private to the core of the tile only,
+   // turned off while the core fast-forwards. The directory, the DRAM and the
+   // shared caches keep modeling the requests of the other tiles
+   virtual void enableCoreModels() {}
+   virtual void disableCoreModels() {}
+
+   // State of the caches, directory and DRAM controller of the tile. Restored
+   // with the same protocol and memory controller positions
+   virtual void checkpoint(CheckpointWriter& writer) = 0;
+   virtual void restore(CheckpointReader& reader) = 0;
 
    // Modeling
    virtual UInt32 getModeledLength(const void* pkt_data) = 0;
@@ -0,0 +1,194 @@
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "paged_backing_store.h"
+#include "checkpoint.h"
+#include "log.h"
+
+PagedBackingStore::PagedBackingStore()
+   : _num_chunks(0)
+   , _num_chunk_tables(0)
+{
+   _page_table = new Byte**[L1_ENTRIES];
+   memset(_page_table, 0, L1_ENTRIES * sizeof(Byte**));
+}
+
+PagedBackingStore::~PagedBackingStore()
+{
+   LOG_PRINT("Backing store: %llu chunks in %llu chunk tables", _num_chunks, _num_chunk_tables);
+
+   for (UInt32 i = 0; i < L1_ENTRIES; i++)
+   {
+      Byte** chunk_table = _page_table[i];
+      if (!chunk_table)
+         continue;
+
+      for (UInt32 j = 0; j < L2_ENTRIES; j++)
+      {
+         if (chunk_table[j])
+            munmap(chunk_table[j], CHUNK_SIZE);
+      }
+      delete [] chunk_table;
+   }
+   delete [] _page_table;
+}
+
+Byte*
+PagedBackingStore::mapChunk(IntPtr address)
+{
+   UInt64 addr = (UInt64) address;
+   LOG_ASSERT_ERROR((addr >> ADDRESS_BITS) == 0, "Address(%#llx) out of the %u-bit address space", addr, ADDRESS_BITS);
+
+   Byte** volatile* chunk_table_ptr = (Byte** volatile*) &_page_table[(addr >> L1_SHIFT) & (L1_ENTRIES-1)];
+   if (*chunk_table_ptr == NULL)
+   {
+      Byte** chunk_table = new Byte*[L2_ENTRIES];
+      memset(chunk_table, 0, L2_ENTRIES * sizeof(Byte*));
+      if (__sync_bool_compare_and_swap(chunk_table_ptr, (Byte**) NULL, chunk_table))
+         __sync_fetch_and_add(&_num_chunk_tables, 1);
+      else
+         delete [] chunk_table;
+   }
+
+   Byte* volatile* chunk_ptr = (Byte* volatile*) &(*chunk_table_ptr)[(addr >> L2_SHIFT) & (L2_ENTRIES-1)];
+   if (*chunk_ptr == NULL)
+   {
+      void* chunk = mmap(NULL, CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      LOG_ASSERT_ERROR(chunk != MAP_FAILED, "Could not map a backing store chunk, errno(%i)", errno);
+      if (__sync_bool_compare_and_swap(chunk_ptr, (Byte*) NULL, (Byte*) chunk))
+         __sync_fetch_and_add(&_num_chunks, 1);
+      else
+         munmap(chunk, CHUNK_SIZE);
+   }
+
+   return *chunk_ptr;
+}
+
+static bool isZeroPage(const Byte* page, UInt32 size)
+{
+   const UInt64* words = (const UInt64*) page;
+   for (UInt32 i = 0; i < (size / sizeof(UInt64)); i++)
+   {
+      if (words[i] != 0)
+         return false;
+   }
+   return true;
+}
+
+UInt64
+PagedBackingStore::hashLine(IntPtr address, const Byte* data, UInt32 line_size)
+{
+   if (isZeroPage(data, line_size))
+      return 0;
+
+   UInt64 hash = 0xcbf29ce484222325ULL;
+   for (UInt32 i = 0; i < sizeof(address); i++)
+      hash = (hash ^ ((address >> (8*i)) & 0xff)) * 0x100000001b3ULL;
+   for (UInt32 i = 0; i < line_size; i++)
+      hash = (hash ^ data[i]) * 0x100000001b3ULL;
+   return hash;
+}
+
+UInt64
+PagedBackingStore::hash(const std::map<IntPtr, const Byte*>& dirty_lines, UInt32 line_size)
+{
+   UInt64 hash = 0;
+   for (UInt64 i = 0; i < L1_ENTRIES; i++)
+   {
+      Byte** chunk_table = _page_table[i];
+      if (!chunk_table)
+         continue;
+
+      for (UInt64 j = 0; j < L2_ENTRIES; j++)
+      {
+         Byte* chunk = chunk_table[j];
+         if (!chunk)
+            continue;
+
+         for (UInt64 offset = 0; offset < CHUNK_SIZE; offset += PAGE_SIZE)
+         {
+            if (isZeroPage(chunk + offset, PAGE_SIZE))
+               continue;
+            for (UInt64 line_offset = offset; line_offset < offset + PAGE_SIZE; line_offset += line_size)
+            {
+               IntPtr address = (IntPtr) ((i << L1_SHIFT) | (j << L2_SHIFT) | line_offset);
+               if (dirty_lines.find(address) == dirty_lines.end())
+                  hash += hashLine(address, chunk + line_offset, line_size);
+            }
+         }
+      }
+   }
+   return hash;
+}
+
+void
+PagedBackingStore::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("backing_store");
+   writer << (UInt32) PAGE_SIZE;
+
+   UInt64 num_pages = 0;
+   for (UInt64 i = 0; i < L1_ENTRIES; i++)
+   {
+      Byte** chunk_table = _page_table[i];
+      if (!chunk_table)
+         continue;
+
+      for (UInt64 j = 0; j < L2_ENTRIES; j++)
+      {
+         Byte* chunk = chunk_table[j];
+         if (!chunk)
+            continue;
+
+         // Reading the pages that were never touched maps the zero page
+         for (UInt64 offset = 0; offset < CHUNK_SIZE; offset += PAGE_SIZE)
+         {
+            if (isZeroPage(chunk + offset, PAGE_SIZE))
+               continue;
+            IntPtr address = (IntPtr) ((i << L1_SHIFT) | (j << L2_SHIFT) | offset);
+            writer << address << std::make_pair((const void*) (chunk + offset), (UInt64) PAGE_SIZE);
+            num_pages ++;
+         }
+      }
+   }
+   writer << INVALID_ADDRESS;
+   writer.endSection();
+
+   LOG_PRINT("Backing store checkpoint: %llu pages", num_pages);
+}
+
+void
+PagedBackingStore::restore(CheckpointReader& reader)
+{
+   reader.beginSection("backing_store");
+   UInt32 page_size;
+   reader >> page_size;
+   LOG_ASSERT_ERROR(page_size == PAGE_SIZE, "Checkpoint page size(%u), expected(%u)", page_size, PAGE_SIZE);
+
+   // Drop the current contents, the pages of the chunks read as zeros again
+   for (UInt32 i = 0; i < L1_ENTRIES; i++)
+   {
+      Byte** chunk_table = _page_table[i];
+      if (!chunk_table)
+         continue;
+      for (UInt32 j = 0; j < L2_ENTRIES; j++)
+      {
+         if (chunk_table[j])
+            madvise(chunk_table[j], CHUNK_SIZE, MADV_DONTNEED);
+      }
+   }
+
+   UInt64 num_pages = 0;
+   while (true)
+   {
+      IntPtr address;
+      reader >> address;
+      if (address == INVALID_ADDRESS)
+         break;
+      reader >> std::make_pair((void*) getLine(address), (UInt64) PAGE_SIZE);
+      num_pages ++;
+   }
+   reader.endSection();
+
+   LOG_PRINT("Backing store restore: %llu pages", num_pages);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <map>
+
+#include "fixed_types.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Functional contents of the simulated main memory.
+//   The address space is backed by CHUNK_SIZE chunks of anonymous memory,
+// mapped the first time an address in them is touched and found through a
+// two-level page table, so getLine() is a couple of loads once the chunk is
+// there. The chunks are reserved with MAP_NORESERVE and the kernel fills
+// their pages with zeros on first use, so memory is only consumed for the
+// pages that were touched.
+//   The lines of a page are interleaved over all the DRAM controllers, so
+// one store is shared by all of them in a process. Every line is homed at
+// a single controller, so the only contention is on mapping a chunk, which
+// is done with a compare-and-swap.
+class PagedBackingStore
+{
+public:
+   PagedBackingStore();
+   ~PagedBackingStore();
+
+   // Pointer to the memory backing 'address'
+   Byte* getLine(IntPtr address)
+   {
+      UInt64 addr = (UInt64) address;
+      Byte** chunk_table = _page_table[(addr >> L1_SHIFT) & (L1_ENTRIES-1)];
+      if (chunk_table)
+      {
+         Byte* chunk = chunk_table[(addr >> L2_SHIFT) & (L2_ENTRIES-1)];
+         if (chunk)
+            return chunk + (addr & (CHUNK_SIZE-1));
+      }
+      return mapChunk(address) + (addr & (CHUNK_SIZE-1));
+   }
+
+   // The pages that are not all zeros. Restoring drops the current contents
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
+   // Sum of hashLine() over the lines of the store, but the ones in
+   // 'dirty_lines' (their cached copy is the current one)
+   UInt64 hash(const std::map<IntPtr, const Byte*>& dirty_lines, UInt32 line_size);
+   // FNV-1a of the address and data of a line, 0 for a line of zeros so that
+   // the pages that were never written do not count
+   static UInt64 hashLine(IntPtr address, const Byte* data, UInt32 line_size);
+
+private:
+   // 48-bit address = 15-bit L1 index | 12-bit L2 index | 21-bit chunk offset
+   static const UInt32 ADDRESS_BITS = 48;
+   static const UInt32 L2_SHIFT = 21;
+   static const UInt32 L1_SHIFT = 33;
+   static const UInt64 CHUNK_SIZE = 1ULL << L2_SHIFT;
+   static const UInt32 L2_ENTRIES = 1 << (L1_SHIFT - L2_SHIFT);
+   static const UInt32 L1_ENTRIES = 1 << (ADDRESS_BITS - L1_SHIFT);
+   // Unit of the checkpoints
+   static const UInt32 PAGE_SIZE = 4096;
+
+   Byte*** _page_table;
+
+   volatile UInt64 _num_chunks;
+   volatile UInt64 _num_chunk_tables;
+
+   Byte* mapChunk(IntPtr address);
+};
@@ -6,6 +6,7 @@ using namespace std;
 #include "dram_perf_model.h"
 #include "queue_model_history_list.h"
 #include "queue_model_history_tree.h"
+#include "checkpoint.h"
 
 // Note: Each Dram Controller owns a single DramModel object
 // Hence, m_dram_bandwidth is the bandwidth for a single DRAM controller
@@ -134,6 +135,33 @@ DramPerfModel::disable()
    m_enabled = false;
 }
 
+void
+DramPerfModel::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("dram_perf_model");
+   writer << m_num_accesses << (double) m_total_access_latency << (double) m_total_queueing_delay;
+   writer << (m_queue_model != NULL);
+   if (m_queue_model)
+      m_queue_model->checkpoint(writer);
+   writer.endSection();
+}
+
+void
+DramPerfModel::restore(CheckpointReader& reader)
+{
+   reader.beginSection("dram_perf_model");
+   double total_access_latency, total_queueing_delay;
+   reader >> m_num_accesses >> total_access_latency >> total_queueing_delay;
+   m_total_access_latency = total_access_latency;
+   m_total_queueing_delay = total_queueing_delay;
+
+   bool queue_model_present;
+   reader >> queue_model_present;
+   if (queue_model_present && m_queue_model)
+      m_queue_model->restore(reader);
+   reader.endSection();
+}
+
 void
 DramPerfModel::outputSummary(ostream& out)
 {
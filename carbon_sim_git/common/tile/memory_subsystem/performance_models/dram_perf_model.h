@@ -61,5 +61,8 @@ class DramPerfModel
       UInt64 getTotalAccesses() { return m_num_accesses; }
       void outputSummary(ostream& out);
 
+      void checkpoint(CheckpointWriter& writer);
+      void restore(CheckpointReader& reader);
+
       static void dummyOutputSummary(ostream& out);
 };
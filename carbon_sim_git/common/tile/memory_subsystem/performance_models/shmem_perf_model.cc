@@ -5,6 +5,7 @@
 #include "simulator.h"
 #include "tile_manager.h"
 #include "fxsupport.h"
+#include "checkpoint.h"
 
 ShmemPerfModel::ShmemPerfModel():
    _enabled(false)
@@ -99,6 +100,43 @@ ShmemPerfModel::updateInternalVariablesOnFrequencyChange(volatile float core_fre
    _total_memory_access_latency_in_clock_cycles = 0;
 }
 
+void
+ShmemPerfModel::checkpoint(CheckpointWriter& writer, volatile float core_frequency)
+{
+   ScopedLock sl(_shmem_perf_model_lock);
+
+   writer.beginSection("shmem_perf_model");
+   writer << (float) core_frequency;
+   writer.put<UInt64>(_cycle_count, NUM_THREAD_TYPES);
+   writer << _num_memory_accesses
+          << _total_memory_access_latency_in_clock_cycles << _total_memory_access_latency_in_ns;
+   writer.endSection();
+}
+
+void
+ShmemPerfModel::restore(CheckpointReader& reader, volatile float core_frequency)
+{
+   ScopedLock sl(_shmem_perf_model_lock);
+
+   float checkpoint_frequency;
+   reader.beginSection("shmem_perf_model");
+   reader >> checkpoint_frequency;
+   reader.get<UInt64>(_cycle_count, NUM_THREAD_TYPES);
+   reader >> _num_memory_accesses
+          >> _total_memory_access_latency_in_clock_cycles >> _total_memory_access_latency_in_ns;
+   reader.endSection();
+
+   if (checkpoint_frequency != core_frequency)
+   {
+      for (UInt32 i = 0; i < NUM_THREAD_TYPES; i++)
+         _cycle_count[i] = (UInt64) (((double) _cycle_count[i] / checkpoint_frequency) * core_frequency);
+      // The latency so far was spent at the frequency of the checkpoint
+      _total_memory_access_latency_in_ns +=
+         static_cast<UInt64>(ceil(static_cast<float>(_total_memory_access_latency_in_clock_cycles) / checkpoint_frequency));
+      _total_memory_access_latency_in_clock_cycles = 0;
+   }
+}
+
 void
 ShmemPerfModel::outputSummary(ostream& out, volatile float core_frequency)
 {
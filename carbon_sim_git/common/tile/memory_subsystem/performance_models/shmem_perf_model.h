@@ -6,6 +6,9 @@ using std::ostream;
 
 #include "lock.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class ShmemPerfModel
 {
 public:
@@ -39,6 +42,10 @@ public:
 
    void outputSummary(ostream& out, volatile float core_frequency);
 
+   // The cycle counts of a checkpoint taken at another core frequency are converted
+   void checkpoint(CheckpointWriter& writer, volatile float core_frequency);
+   void restore(CheckpointReader& reader, volatile float core_frequency);
+
 private:
    UInt64 _cycle_count[NUM_THREAD_TYPES];
    bool _enabled;
@@ -1,6 +1,7 @@
 #include "cache_line_info.h"
 #include "cache_utils.h"
 #include "utilization_defines.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace PrL1PrL2DramDirectoryMOSI
@@ -51,6 +52,24 @@ PrL1CacheLineInfo::assign(CacheLineInfo* cache_line_info)
 #endif
 }
 
+void
+PrL1CacheLineInfo::checkpoint(CheckpointWriter& writer)
+{
+   CacheLineInfo::checkpoint(writer);
+#ifdef TRACK_DETAILED_CACHE_COUNTERS
+   writer << _utilization;
+#endif
+}
+
+void
+PrL1CacheLineInfo::restore(CheckpointReader& reader)
+{
+   CacheLineInfo::restore(reader);
+#ifdef TRACK_DETAILED_CACHE_COUNTERS
+   reader >> _utilization;
+#endif
+}
+
 //// PrL2 CacheLineInfo
 
 PrL2CacheLineInfo::PrL2CacheLineInfo(IntPtr tag, CacheState::Type cstate, MemComponent::Type cached_loc)
@@ -98,4 +117,20 @@ PrL2CacheLineInfo::assign(CacheLineInfo* cache_line_info)
    _cached_loc = L2_cache_line_info->getCachedLoc();
 }
 
+void
+PrL2CacheLineInfo::checkpoint(CheckpointWriter& writer)
+{
+   PrL1CacheLineInfo::checkpoint(writer);
+   writer << (UInt32) _cached_loc;
+}
+
+void
+PrL2CacheLineInfo::restore(CheckpointReader& reader)
+{
+   PrL1CacheLineInfo::restore(reader);
+   UInt32 cached_loc;
+   reader >> cached_loc;
+   _cached_loc = (MemComponent::Type) cached_loc;
+}
+
 }
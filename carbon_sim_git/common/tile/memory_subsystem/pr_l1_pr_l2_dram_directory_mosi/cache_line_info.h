@@ -25,6 +25,9 @@ public:
 
    void invalidate();
    void assign(CacheLineInfo* cache_line_info);
+
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
    
 private:
 #ifdef TRACK_DETAILED_CACHE_COUNTERS
@@ -46,6 +49,9 @@ public:
    void invalidate();
    void assign(CacheLineInfo* cache_line_info);
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
    MemComponent::Type _cached_loc;
 };
@@ -5,6 +5,7 @@
 #include "clock_converter.h"
 #include "network.h"
 #include "network_model_emesh_hop_by_hop.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace PrL1PrL2DramDirectoryMOSI
@@ -431,6 +432,41 @@ MemoryManager::incrCycleCount(MemComponent::Type mem_component, CachePerfModel::
    }
 }
 
+void
+MemoryManager::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("pr_l1_pr_l2_dram_directory_mosi");
+   _L1_cache_cntlr->getL1ICache()->checkpoint(writer);
+   _L1_cache_cntlr->getL1DCache()->checkpoint(writer);
+   _L2_cache_cntlr->getL2Cache()->checkpoint(writer);
+   writer << _dram_cntlr_present;
+   if (_dram_cntlr_present)
+   {
+      _dram_directory_cntlr->getDramDirectoryCache()->checkpoint(writer);
+      _dram_cntlr->checkpoint(writer);
+   }
+   writer.endSection();
+}
+
+void
+MemoryManager::restore(CheckpointReader& reader)
+{
+   reader.beginSection("pr_l1_pr_l2_dram_directory_mosi");
+   _L1_cache_cntlr->getL1ICache()->restore(reader);
+   _L1_cache_cntlr->getL1DCache()->restore(reader);
+   _L2_cache_cntlr->getL2Cache()->restore(reader);
+   bool dram_cntlr_present;
+   reader >> dram_cntlr_present;
+   LOG_ASSERT_ERROR(dram_cntlr_present == _dram_cntlr_present,
+                    "DRAM controller %s in the checkpoint", dram_cntlr_present ? "present" : "not present");
+   if (_dram_cntlr_present)
+   {
+      _dram_directory_cntlr->getDramDirectoryCache()->restore(reader);
+      _dram_cntlr->restore(reader);
+   }
+   reader.endSection();
+}
+
 void
 MemoryManager::enableModels()
 {
@@ -479,6 +515,42 @@ MemoryManager::disableModels()
    }
 }
 
+// The L1 and L2 caches are private to the core. The lock keeps the sim
+// thread from seeing them change in the middle of a message
+void
+MemoryManager::enableCoreModels()
+{
+   ScopedLock sl(_lock);
+
+   _L1_cache_cntlr->getL1ICache()->enable();
+   _L1_icache_perf_model->enable();
+
+   _L1_cache_cntlr->getL1DCache()->enable();
+   _L1_dcache_perf_model->enable();
+
+   _L2_cache_cntlr->getL2Cache()->enable();
+   _L2_cache_perf_model->enable();
+
+   _L2_cache_cntlr->enable();
+}
+
+void
+MemoryManager::disableCoreModels()
+{
+   ScopedLock sl(_lock);
+
+   _L1_cache_cntlr->getL1ICache()->disable();
+   _L1_icache_perf_model->disable();
+
+   _L1_cache_cntlr->getL1DCache()->disable();
+   _L1_dcache_perf_model->disable();
+
+   _L2_cache_cntlr->getL2Cache()->disable();
+   _L2_cache_perf_model->disable();
+
+   _L2_cache_cntlr->disable();
+}
+
 void
 MemoryManager::outputSummary(std::ostream &os)
 {
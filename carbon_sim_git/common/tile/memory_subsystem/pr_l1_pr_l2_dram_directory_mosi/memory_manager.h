@@ -49,6 +49,11 @@ namespace PrL1PrL2DramDirectoryMOSI
     
       void enableModels();
       void disableModels();
+      void enableCoreModels();
+      void disableCoreModels();
+
+      void checkpoint(CheckpointWriter& writer);
+      void restore(CheckpointReader& reader);
 
       UInt32 getModeledLength(const void* pkt_data)
       { return ((ShmemMsg*) pkt_data)->getModeledLength(); }
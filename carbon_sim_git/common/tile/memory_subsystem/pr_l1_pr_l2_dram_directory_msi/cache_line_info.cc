@@ -1,5 +1,6 @@
 #include "cache_line_info.h"
 #include "cache_utils.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace PrL1PrL2DramDirectoryMSI
@@ -67,4 +68,20 @@ PrL2CacheLineInfo::assign(CacheLineInfo* cache_line_info)
    _cached_loc = L2_cache_line_info->getCachedLoc();
 }
 
+void
+PrL2CacheLineInfo::checkpoint(CheckpointWriter& writer)
+{
+   CacheLineInfo::checkpoint(writer);
+   writer << (UInt32) _cached_loc;
+}
+
+void
+PrL2CacheLineInfo::restore(CheckpointReader& reader)
+{
+   CacheLineInfo::restore(reader);
+   UInt32 cached_loc;
+   reader >> cached_loc;
+   _cached_loc = (MemComponent::Type) cached_loc;
+}
+
 }
@@ -26,6 +26,9 @@ public:
    void invalidate();
    void assign(CacheLineInfo* cache_line_info);
 
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
+
 private:
    MemComponent::Type _cached_loc;
 };
@@ -13,11 +13,13 @@ L1CacheCntlr::L1CacheCntlr(MemoryManager* memory_manager,
                            string l1_icache_replacement_policy,
                            UInt32 l1_icache_access_delay,
                            bool l1_icache_track_miss_types,
+                           UInt32 l1_icache_num_mshrs,
                            UInt32 l1_dcache_size,
                            UInt32 l1_dcache_associativity,
                            string l1_dcache_replacement_policy,
                            UInt32 l1_dcache_access_delay,
                            bool l1_dcache_track_miss_types,
+                           UInt32 l1_dcache_num_mshrs,
                            float frequency)
    : _memory_manager(memory_manager)
    , _l2_cache_cntlr(NULL)
@@ -55,6 +57,9 @@ L1CacheCntlr::L1CacheCntlr(MemoryManager* memory_manager,
          l1_dcache_access_delay,
          frequency,
          l1_icache_track_miss_types);
+
+   _l1_icache_mshr_file = new MshrFile(l1_icache_num_mshrs);
+   _l1_dcache_mshr_file = new MshrFile(l1_dcache_num_mshrs);
 }
 
 L1CacheCntlr::~L1CacheCntlr()
@@ -65,6 +70,8 @@ L1CacheCntlr::~L1CacheCntlr()
    delete _l1_dcache_replacement_policy_obj;
    delete _l1_icache_hash_fn_obj;
    delete _l1_dcache_hash_fn_obj;
+   delete _l1_icache_mshr_file;
+   delete _l1_dcache_mshr_file;
 }      
 
 void
@@ -87,6 +94,12 @@ L1CacheCntlr::processMemOpFromTile(MemComponent::Type mem_component,
    bool l1_cache_hit = true;
    UInt32 access_num = 0;
 
+   MshrFile* l1_mshr_file = getL1MshrFile(mem_component);
+   MshrFile* l2_mshr_file = _l2_cache_cntlr->getL2MshrFile();
+   // Times at which the L1 and L2 MSHRs were allocated for this miss
+   UInt64 l1_mshr_allocation_time = 0;
+   UInt64 l2_mshr_allocation_time = 0;
+
    while(1)
    {
       access_num ++;
@@ -101,11 +114,23 @@ L1CacheCntlr::processMemOpFromTile(MemComponent::Type mem_component,
 
       if (operationPermissibleinL1Cache(mem_component, ca_address, mem_op_type, access_num))
       {
+         // Secondary miss: the line is still being filled by an earlier miss
+         if (access_num == 1)
+            waitForOutstandingMiss(l1_mshr_file, ca_address);
+
          // Increment Shared Mem Perf model cycle counts
          // L1 Cache
          getMemoryManager()->incrCycleCount(mem_component, CachePerfModel::ACCESS_CACHE_DATA_AND_TAGS);
 
          accessCache(mem_component, mem_op_type, ca_address, offset, data_buf, data_length);
+
+         if (access_num == 2)
+         {
+            // The line has been filled, free the MSHRs
+            UInt64 completion_time = getShmemPerfModel()->getCycleCount();
+            l2_mshr_file->allocate(ca_address, l2_mshr_allocation_time, completion_time);
+            l1_mshr_file->allocate(ca_address, l1_mshr_allocation_time, completion_time);
+         }
                  
          return l1_cache_hit;
       }
@@ -117,6 +142,9 @@ L1CacheCntlr::processMemOpFromTile(MemComponent::Type mem_component,
       
       LOG_ASSERT_ERROR(lock_signal != Core::UNLOCK, "Expected to find address(%#lx) in L1 Cache", ca_address);
 
+      // Wait for a free L1 MSHR
+      l1_mshr_allocation_time = waitForFreeMshr(l1_mshr_file);
+
       // Invalidate the cache line before passing the request to L2 Cache
       invalidateCacheLine(mem_component, ca_address);
 
@@ -128,6 +156,9 @@ L1CacheCntlr::processMemOpFromTile(MemComponent::Type mem_component,
       // Is cache hit?
       if (!l2_cache_miss)
       {
+         // Secondary miss in the L2 cache
+         waitForOutstandingMiss(l2_mshr_file, ca_address);
+
          // Increment Shared Mem Perf model cycle counts
          // L2 Cache
          getMemoryManager()->incrCycleCount(MemComponent::L2_CACHE, CachePerfModel::ACCESS_CACHE_DATA_AND_TAGS);
@@ -136,11 +167,16 @@ L1CacheCntlr::processMemOpFromTile(MemComponent::Type mem_component,
 
          accessCache(mem_component, mem_op_type, ca_address, offset, data_buf, data_length);
 
+         l1_mshr_file->allocate(ca_address, l1_mshr_allocation_time, getShmemPerfModel()->getCycleCount());
+
          return false;
       }
 
       // Increment shared mem perf model cycle counts
       getMemoryManager()->incrCycleCount(MemComponent::L2_CACHE, CachePerfModel::ACCESS_CACHE_TAGS);
+
+      // Wait for a free L2 MSHR before sending the request out
+      l2_mshr_allocation_time = waitForFreeMshr(l2_mshr_file);
       
       // Is the miss type modeled? If yes, all the msgs' created by this miss are modeled 
       bool msg_modeled = ::MemoryManager::isMissTypeModeled(l2_cache_miss_type) &&
@@ -163,6 +199,25 @@ L1CacheCntlr::processMemOpFromTile(MemComponent::Type mem_component,
    return false;
 }
 
+UInt64
+L1CacheCntlr::waitForFreeMshr(MshrFile* mshr_file)
+{
+   UInt64 curr_time = getShmemPerfModel()->getCycleCount();
+   UInt64 allocation_time = mshr_file->getAllocationTime(curr_time);
+   if (allocation_time > curr_time)
+      getShmemPerfModel()->setCycleCount(allocation_time);
+   return allocation_time;
+}
+
+void
+L1CacheCntlr::waitForOutstandingMiss(MshrFile* mshr_file, IntPtr address)
+{
+   UInt64 curr_time = getShmemPerfModel()->getCycleCount();
+   UInt64 completion_time = mshr_file->getCompletionTime(address, curr_time);
+   if (completion_time > curr_time)
+      getShmemPerfModel()->setCycleCount(completion_time);
+}
+
 void
 L1CacheCntlr::accessCache(MemComponent::Type mem_component,
       Core::mem_op_t mem_op_type, IntPtr ca_address, UInt32 offset,
@@ -323,6 +378,23 @@ L1CacheCntlr::getL1Cache(MemComponent::Type mem_component)
    }
 }
 
+MshrFile*
+L1CacheCntlr::getL1MshrFile(MemComponent::Type mem_component)
+{
+   switch (mem_component)
+   {
+   case MemComponent::L1_ICACHE:
+      return _l1_icache_mshr_file;
+
+   case MemComponent::L1_DCACHE:
+      return _l1_dcache_mshr_file;
+
+   default:
+      LOG_PRINT_ERROR("Unrecognized Memory Component(%u)", mem_component);
+      return NULL;
+   }
+}
+
 tile_id_t
 L1CacheCntlr::getTileId()
 {
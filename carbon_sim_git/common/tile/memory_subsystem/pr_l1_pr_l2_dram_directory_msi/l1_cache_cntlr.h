@@ -12,6 +12,7 @@ namespace PrL1PrL2DramDirectoryMSI
 
 #include "tile.h"
 #include "cache.h"
+#include "mshr_file.h"
 #include "shmem_msg.h"
 #include "mem_component.h"
 #include "fixed_types.h"
@@ -31,16 +32,19 @@ namespace PrL1PrL2DramDirectoryMSI
                    string l1_icache_replacement_policy,
                    UInt32 l1_icache_access_delay,
                    bool l1_icache_track_miss_types,
+                   UInt32 l1_icache_num_mshrs,
                    UInt32 l1_dcache_size,
                    UInt32 l1_dcache_associativity,
                    string l1_dcache_replacement_policy,
                    UInt32 l1_dcache_access_delay,
                    bool l1_dcache_track_miss_types,
+                   UInt32 l1_dcache_num_mshrs,
                    float frequency);
       ~L1CacheCntlr();
 
       Cache* getL1ICache() { return _l1_icache; }
       Cache* getL1DCache() { return _l1_dcache; }
+      MshrFile* getL1MshrFile(MemComponent::Type mem_component);
 
       void setL2CacheCntlr(L2CacheCntlr* l2_cache_cntlr);
 
@@ -67,12 +71,17 @@ namespace PrL1PrL2DramDirectoryMSI
       CacheReplacementPolicy* _l1_dcache_replacement_policy_obj;
       CacheHashFn* _l1_icache_hash_fn_obj;
       CacheHashFn* _l1_dcache_hash_fn_obj;
+      MshrFile* _l1_icache_mshr_file;
+      MshrFile* _l1_dcache_mshr_file;
       L2CacheCntlr* _l2_cache_cntlr;
 
       void accessCache(MemComponent::Type mem_component,
             Core::mem_op_t mem_op_type, 
             IntPtr ca_address, UInt32 offset,
             Byte* data_buf, UInt32 data_length);
+      // Timing of the MSHRs
+      UInt64 waitForFreeMshr(MshrFile* mshr_file);
+      void waitForOutstandingMiss(MshrFile* mshr_file, IntPtr address);
       bool operationPermissibleinL1Cache(MemComponent::Type mem_component,
             IntPtr address, Core::mem_op_t mem_op_type,
             UInt32 access_num);
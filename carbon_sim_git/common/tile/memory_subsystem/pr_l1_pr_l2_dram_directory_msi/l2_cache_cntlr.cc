@@ -15,6 +15,7 @@ L2CacheCntlr::L2CacheCntlr(MemoryManager* memory_manager,
                            string l2_cache_replacement_policy,
                            UInt32 l2_cache_access_delay,
                            bool l2_cache_track_miss_types,
+                           UInt32 l2_cache_num_mshrs,
                            float frequency)
    : _memory_manager(memory_manager)
    , _l1_cache_cntlr(l1_cache_cntlr)
@@ -37,6 +38,8 @@ L2CacheCntlr::L2CacheCntlr(MemoryManager* memory_manager,
          l2_cache_access_delay,
          frequency,
          l2_cache_track_miss_types);
+
+   _l2_mshr_file = new MshrFile(l2_cache_num_mshrs);
 }
 
 L2CacheCntlr::~L2CacheCntlr()
@@ -44,6 +47,7 @@ L2CacheCntlr::~L2CacheCntlr()
    delete _l2_cache;
    delete _l2_cache_replacement_policy_obj;
    delete _l2_cache_hash_fn_obj;
+   delete _l2_mshr_file;
 }
 
 void
@@ -150,8 +154,9 @@ L2CacheCntlr::insertCacheLineInL1(MemComponent::Type mem_component, IntPtr addre
 void
 L2CacheCntlr::insertCacheLineInHierarchy(IntPtr address, CacheState::Type cstate, Byte* fill_buf)
 {
-   assert(address == _outstanding_shmem_msg.getAddress());
-   MemComponent::Type mem_component = _outstanding_shmem_msg.getSenderMemComponent();
+   map<IntPtr, OutstandingMiss>::iterator it = _outstanding_misses.find(address);
+   assert(it != _outstanding_misses.end());
+   MemComponent::Type mem_component = it->second.sender_mem_component;
   
    // Insert Line in the L2 cache
    insertCacheLine(address, cstate, fill_buf, mem_component);
@@ -203,12 +208,15 @@ L2CacheCntlr::handleMsgFromL1Cache(ShmemMsg* shmem_msg)
    assert(shmem_msg->getDataBuf() == NULL);
    assert(shmem_msg->getDataLength() == 0);
 
-   assert(_outstanding_shmem_msg.getAddress() == INVALID_ADDRESS);
+   LOG_ASSERT_ERROR(_outstanding_misses.find(address) == _outstanding_misses.end(),
+                    "Miss to address(%#lx) already outstanding", address);
+   LOG_ASSERT_ERROR(_outstanding_misses.size() < _l2_mshr_file->getNumEntries(),
+                    "No free MSHR for address(%#lx)", address);
 
-   // Set outstanding shmem msg parameters
-   _outstanding_shmem_msg.setAddress(address);
-   _outstanding_shmem_msg.setSenderMemComponent(sender_mem_component);
-   _outstanding_shmem_msg_time = getShmemPerfModel()->getCycleCount();
+   // Set outstanding miss parameters
+   OutstandingMiss& outstanding_miss = _outstanding_misses[address];
+   outstanding_miss.sender_mem_component = sender_mem_component;
+   outstanding_miss.time = getShmemPerfModel()->getCycleCount();
    
    switch (shmem_msg_type)
    {
@@ -288,13 +296,17 @@ L2CacheCntlr::handleMsgFromDramDirectory(tile_id_t sender, ShmemMsg* shmem_msg)
 
    if ((shmem_msg_type == ShmemMsg::EX_REP) || (shmem_msg_type == ShmemMsg::SH_REP))
    {
-      LOG_ASSERT_ERROR(_outstanding_shmem_msg_time <= getShmemPerfModel()->getCycleCount(),
+      map<IntPtr, OutstandingMiss>::iterator it = _outstanding_misses.find(shmem_msg->getAddress());
+      assert(it != _outstanding_misses.end());
+      UInt64 outstanding_miss_time = it->second.time;
+
+      LOG_ASSERT_ERROR(outstanding_miss_time <= getShmemPerfModel()->getCycleCount(),
                        "Outstanding msg time(%llu), Curr cycle count(%llu)",
-                       _outstanding_shmem_msg_time, getShmemPerfModel()->getCycleCount());
+                       outstanding_miss_time, getShmemPerfModel()->getCycleCount());
       
       // Reset the clock to the time the request left the tile is miss type is not modeled
       if (!shmem_msg->isModeled())
-         getShmemPerfModel()->setCycleCount(_outstanding_shmem_msg_time);
+         getShmemPerfModel()->setCycleCount(outstanding_miss_time);
 
       // Increment the clock by the time taken to update the L2 cache
       getMemoryManager()->incrCycleCount(MemComponent::L2_CACHE, CachePerfModel::ACCESS_CACHE_DATA_AND_TAGS);
@@ -303,8 +315,8 @@ L2CacheCntlr::handleMsgFromDramDirectory(tile_id_t sender, ShmemMsg* shmem_msg)
       getShmemPerfModel()->setCycleCount(ShmemPerfModel::_APP_THREAD, 
                                          getShmemPerfModel()->getCycleCount());
       
-      // There are no more outstanding memory requests
-      _outstanding_shmem_msg.setAddress(INVALID_ADDRESS);
+      // The miss is no longer outstanding
+      _outstanding_misses.erase(it);
       
       _memory_manager->wakeUpAppThread();
       _memory_manager->waitForAppThread();
@@ -13,6 +13,7 @@ namespace PrL1PrL2DramDirectoryMSI
 }
 
 #include "cache.h"
+#include "mshr_file.h"
 #include "cache_line_info.h"
 #include "address_home_lookup.h"
 #include "shmem_msg.h"
@@ -36,10 +37,12 @@ namespace PrL1PrL2DramDirectoryMSI
                    string l2_cache_replacement_policy,
                    UInt32 l2_cache_access_delay,
                    bool l2_cache_track_miss_types,
+                   UInt32 l2_cache_num_mshrs,
                    float frequency);
       ~L2CacheCntlr();
 
       Cache* getL2Cache() { return _l2_cache; }
+      MshrFile* getL2MshrFile() { return _l2_mshr_file; }
 
       // Handle Request from L1 Cache - This is done for better simulator performance
       pair<bool,Cache::MissType> processShmemRequestFromL1Cache(MemComponent::Type mem_component, Core::mem_op_t mem_op_type, IntPtr address);
@@ -57,12 +60,18 @@ namespace PrL1PrL2DramDirectoryMSI
       Cache* _l2_cache;
       CacheReplacementPolicy* _l2_cache_replacement_policy_obj;
       CacheHashFn* _l2_cache_hash_fn_obj;
+      MshrFile* _l2_mshr_file;
       L1CacheCntlr* _l1_cache_cntlr;
       AddressHomeLookup* _dram_directory_home_lookup;
       
-      // Outstanding Miss information
-      ShmemMsg _outstanding_shmem_msg;
-      UInt64 _outstanding_shmem_msg_time;
+      // Outstanding Miss information, indexed by address. Has an entry per
+      // L2 MSHR although the APP thread currently waits for every miss
+      struct OutstandingMiss
+      {
+         MemComponent::Type sender_mem_component;
+         UInt64 time;
+      };
+      map<IntPtr, OutstandingMiss> _outstanding_misses;
       
       // L2 cache operations
       void readCacheLine(IntPtr address, Byte* data_buf);
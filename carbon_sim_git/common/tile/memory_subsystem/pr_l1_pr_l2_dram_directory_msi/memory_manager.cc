@@ -3,6 +3,7 @@
 #include "simulator.h"
 #include "tile_manager.h"
 #include "clock_converter.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace PrL1PrL2DramDirectoryMSI
@@ -28,6 +29,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
    UInt32 l1_icache_tags_access_time = 0;
    std::string l1_icache_perf_model_type;
    bool l1_icache_track_miss_types = false;
+   UInt32 l1_icache_num_mshrs = 0;
 
    std::string l1_dcache_type;
    UInt32 l1_dcache_line_size = 0;
@@ -38,6 +40,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
    UInt32 l1_dcache_tags_access_time = 0;
    std::string l1_dcache_perf_model_type;
    bool l1_dcache_track_miss_types = false;
+   UInt32 l1_dcache_num_mshrs = 0;
 
    std::string l2_cache_type;
    UInt32 l2_cache_line_size = 0;
@@ -48,6 +51,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
    UInt32 l2_cache_tags_access_time = 0;
    std::string l2_cache_perf_model_type;
    bool l2_cache_track_miss_types = false;
+   UInt32 l2_cache_num_mshrs = 0;
 
    UInt32 dram_directory_total_entries = 0;
    UInt32 dram_directory_associativity = 0;
@@ -76,6 +80,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
       l1_icache_tags_access_time = Sim()->getCfg()->getInt(l1_icache_type + "/tags_access_time");
       l1_icache_perf_model_type = Sim()->getCfg()->getString(l1_icache_type + "/perf_model_type");
       l1_icache_track_miss_types = Sim()->getCfg()->getBool(l1_icache_type + "/track_miss_types");
+      l1_icache_num_mshrs = Sim()->getCfg()->getInt(l1_icache_type + "/num_mshrs", 1);
 
       // L1 DCache
       l1_dcache_type = "l1_dcache/" + Config::getSingleton()->getL1DCacheType(getTile()->getId());
@@ -87,6 +92,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
       l1_dcache_tags_access_time = Sim()->getCfg()->getInt(l1_dcache_type + "/tags_access_time");
       l1_dcache_perf_model_type = Sim()->getCfg()->getString(l1_dcache_type + "/perf_model_type");
       l1_dcache_track_miss_types = Sim()->getCfg()->getBool(l1_dcache_type + "/track_miss_types");
+      l1_dcache_num_mshrs = Sim()->getCfg()->getInt(l1_dcache_type + "/num_mshrs", 1);
 
       // L2 Cache
       l2_cache_type = "l2_cache/" + Config::getSingleton()->getL2CacheType(getTile()->getId());
@@ -98,6 +104,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
       l2_cache_tags_access_time = Sim()->getCfg()->getInt(l2_cache_type + "/tags_access_time");
       l2_cache_perf_model_type = Sim()->getCfg()->getString(l2_cache_type + "/perf_model_type");
       l2_cache_track_miss_types = Sim()->getCfg()->getBool(l2_cache_type + "/track_miss_types");
+      l2_cache_num_mshrs = Sim()->getCfg()->getInt(l2_cache_type + "/num_mshrs", 1);
 
       // Dram Directory Cache
       dram_directory_total_entries = Sim()->getCfg()->getInt("dram_directory/total_entries");
@@ -181,11 +188,13 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
          l1_icache_replacement_policy,
          l1_icache_data_access_time,
          l1_icache_track_miss_types,
+         l1_icache_num_mshrs,
          l1_dcache_size,
          l1_dcache_associativity,
          l1_dcache_replacement_policy,
          l1_dcache_data_access_time,
          l1_dcache_track_miss_types,
+         l1_dcache_num_mshrs,
          core_frequency);
    
    LOG_PRINT("Instantiated L1 Cache Cntlr");
@@ -199,6 +208,7 @@ MemoryManager::MemoryManager(Tile* tile, Network* network, ShmemPerfModel* shmem
          l2_cache_replacement_policy,
          l2_cache_data_access_time,
          l2_cache_track_miss_types,
+         l2_cache_num_mshrs,
          core_frequency);
 
    LOG_PRINT("Instantiated L2 Cache Cntlr");
@@ -412,6 +422,41 @@ MemoryManager::incrCycleCount(MemComponent::Type mem_component, CachePerfModel::
    }
 }
 
+void
+MemoryManager::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("pr_l1_pr_l2_dram_directory_msi");
+   _l1_cache_cntlr->getL1ICache()->checkpoint(writer);
+   _l1_cache_cntlr->getL1DCache()->checkpoint(writer);
+   _l2_cache_cntlr->getL2Cache()->checkpoint(writer);
+   writer << _dram_cntlr_present;
+   if (_dram_cntlr_present)
+   {
+      _dram_directory_cntlr->getDramDirectoryCache()->checkpoint(writer);
+      _dram_cntlr->checkpoint(writer);
+   }
+   writer.endSection();
+}
+
+void
+MemoryManager::restore(CheckpointReader& reader)
+{
+   reader.beginSection("pr_l1_pr_l2_dram_directory_msi");
+   _l1_cache_cntlr->getL1ICache()->restore(reader);
+   _l1_cache_cntlr->getL1DCache()->restore(reader);
+   _l2_cache_cntlr->getL2Cache()->restore(reader);
+   bool dram_cntlr_present;
+   reader >> dram_cntlr_present;
+   LOG_ASSERT_ERROR(dram_cntlr_present == _dram_cntlr_present,
+                    "DRAM controller %s in the checkpoint", dram_cntlr_present ? "present" : "not present");
+   if (_dram_cntlr_present)
+   {
+      _dram_directory_cntlr->getDramDirectoryCache()->restore(reader);
+      _dram_cntlr->restore(reader);
+   }
+   reader.endSection();
+}
+
 void
 MemoryManager::enableModels()
 {
@@ -419,12 +464,15 @@ MemoryManager::enableModels()
    _enabled = true;
 
    _l1_cache_cntlr->getL1ICache()->enable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_ICACHE)->enable();
    _l1_icache_perf_model->enable();
    
    _l1_cache_cntlr->getL1DCache()->enable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_DCACHE)->enable();
    _l1_dcache_perf_model->enable();
    
    _l2_cache_cntlr->getL2Cache()->enable();
+   _l2_cache_cntlr->getL2MshrFile()->enable();
    _l2_cache_perf_model->enable();
 
    if (_dram_cntlr_present)
@@ -442,12 +490,15 @@ MemoryManager::disableModels()
    _enabled = false;
 
    _l1_cache_cntlr->getL1ICache()->disable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_ICACHE)->disable();
    _l1_icache_perf_model->disable();
 
    _l1_cache_cntlr->getL1DCache()->disable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_DCACHE)->disable();
    _l1_dcache_perf_model->disable();
 
    _l2_cache_cntlr->getL2Cache()->disable();
+   _l2_cache_cntlr->getL2MshrFile()->disable();
    _l2_cache_perf_model->disable();
 
    if (_dram_cntlr_present)
@@ -458,13 +509,54 @@ MemoryManager::disableModels()
    LOG_PRINT("disableModels() end");
 }
 
+// The L1 and L2 caches are private to the core. The lock keeps the sim
+// thread from seeing them change in the middle of a message
+void
+MemoryManager::enableCoreModels()
+{
+   ScopedLock sl(_lock);
+
+   _l1_cache_cntlr->getL1ICache()->enable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_ICACHE)->enable();
+   _l1_icache_perf_model->enable();
+
+   _l1_cache_cntlr->getL1DCache()->enable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_DCACHE)->enable();
+   _l1_dcache_perf_model->enable();
+
+   _l2_cache_cntlr->getL2Cache()->enable();
+   _l2_cache_cntlr->getL2MshrFile()->enable();
+   _l2_cache_perf_model->enable();
+}
+
+void
+MemoryManager::disableCoreModels()
+{
+   ScopedLock sl(_lock);
+
+   _l1_cache_cntlr->getL1ICache()->disable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_ICACHE)->disable();
+   _l1_icache_perf_model->disable();
+
+   _l1_cache_cntlr->getL1DCache()->disable();
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_DCACHE)->disable();
+   _l1_dcache_perf_model->disable();
+
+   _l2_cache_cntlr->getL2Cache()->disable();
+   _l2_cache_cntlr->getL2MshrFile()->disable();
+   _l2_cache_perf_model->disable();
+}
+
 void
 MemoryManager::outputSummary(std::ostream &os)
 {
    os << "Cache Summary:\n";
    _l1_cache_cntlr->getL1ICache()->outputSummary(os);
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_ICACHE)->outputSummary(os);
    _l1_cache_cntlr->getL1DCache()->outputSummary(os);
+   _l1_cache_cntlr->getL1MshrFile(MemComponent::L1_DCACHE)->outputSummary(os);
    _l2_cache_cntlr->getL2Cache()->outputSummary(os);
+   _l2_cache_cntlr->getL2MshrFile()->outputSummary(os);
 
    if (_dram_cntlr_present)
    {      
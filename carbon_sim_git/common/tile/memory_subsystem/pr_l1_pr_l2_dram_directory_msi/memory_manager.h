@@ -46,6 +46,11 @@ namespace PrL1PrL2DramDirectoryMSI
      
       void enableModels();
       void disableModels();
+      void enableCoreModels();
+      void disableCoreModels();
+
+      void checkpoint(CheckpointWriter& writer);
+      void restore(CheckpointReader& reader);
 
       tile_id_t getShmemRequester(const void* pkt_data)
       { return ((ShmemMsg*) pkt_data)->getRequester(); }
@@ -1,4 +1,6 @@
 #include "cache_line_info.h"
+#include "l2_directory_cfg.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace PrL1ShL2MSI
@@ -38,4 +40,36 @@ ShL2CacheLineInfo::assign(CacheLineInfo* cache_line_info)
    _caching_component = L2_cache_line_info->getCachingComponent();
 }
 
+void
+ShL2CacheLineInfo::checkpoint(CheckpointWriter& writer)
+{
+   CacheLineInfo::checkpoint(writer);
+   writer << (UInt32) _caching_component;
+   if (isValid())
+      _directory_entry->checkpoint(writer);
+}
+
+// A valid line owns its directory entry (see L2CacheCntlr::allocateCacheLine())
+void
+ShL2CacheLineInfo::restore(CheckpointReader& reader)
+{
+   if (isValid())
+      delete _directory_entry;
+   _directory_entry = NULL;
+
+   CacheLineInfo::restore(reader);
+   UInt32 caching_component;
+   reader >> caching_component;
+   _caching_component = (MemComponent::Type) caching_component;
+
+   if (isValid())
+   {
+      _directory_entry = DirectoryEntry::create(PR_L1_SH_L2_MSI,
+                                                L2DirectoryCfg::getDirectoryType(),
+                                                L2DirectoryCfg::getMaxHWSharers(),
+                                                L2DirectoryCfg::getMaxNumSharers());
+      _directory_entry->restore(reader);
+   }
+}
+
 }
@@ -18,6 +18,10 @@ public:
    ~ShL2CacheLineInfo();
 
    void assign(CacheLineInfo* cache_line_info);
+
+   // The directory entry is saved with the line
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
    
    DirectoryEntry* getDirectoryEntry() const
    { return _directory_entry; }
@@ -55,6 +55,10 @@ namespace PrL1ShL2MSI
       void handleMsgFromCore(ShmemMsg* shmem_msg);
       void handleMsgFromL2Cache(tile_id_t sender, ShmemMsg* shmem_msg);
 
+      // Locks since both app and sim threads work on this object
+      void acquireLock(MemComponent::Type mem_component);
+      void releaseLock(MemComponent::Type mem_component);
+
    private:
       MemoryManager* _memory_manager;
       Cache* _L1_icache;
@@ -109,10 +113,6 @@ namespace PrL1ShL2MSI
       MemoryManager* getMemoryManager()   { return _memory_manager; }
       ShmemPerfModel* getShmemPerfModel();
 
-      // Locks since both app and sim threads work on this object
-      void acquireLock(MemComponent::Type mem_component);
-      void releaseLock(MemComponent::Type mem_component);
-      
       // Synchronization operations between User and sim threads
       void wakeUpAppThread();
       void waitForAppThread();
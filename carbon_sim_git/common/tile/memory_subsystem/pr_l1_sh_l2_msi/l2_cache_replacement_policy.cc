@@ -20,7 +20,7 @@ L2CacheReplacementPolicy::~L2CacheReplacementPolicy()
 {}
 
 UInt32
-L2CacheReplacementPolicy::getReplacementWay(CacheLineInfo** cache_line_info_array, UInt32 set_num)
+L2CacheReplacementPolicy::getReplacementWay(CacheLineInfo** cache_line_info_array, const IntPtr* tags, UInt32 set_num)
 {
    UInt32 way = UINT32_MAX_;
    SInt32 min_num_sharers = (SInt32) Config::getSingleton()->getTotalTiles() + 1;
@@ -14,7 +14,7 @@ public:
                             HashMapQueue<IntPtr,ShmemReq*>& L2_cache_req_queue_list);
    ~L2CacheReplacementPolicy();
 
-   UInt32 getReplacementWay(CacheLineInfo** cache_line_info_array, UInt32 set_num);
+   UInt32 getReplacementWay(CacheLineInfo** cache_line_info_array, const IntPtr* tags, UInt32 set_num);
    void update(CacheLineInfo** cache_line_info_array, UInt32 set_num, UInt32 accessed_way);
 
 private:
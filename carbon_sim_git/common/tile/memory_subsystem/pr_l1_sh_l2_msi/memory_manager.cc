@@ -5,6 +5,7 @@
 #include "clock_converter.h"
 #include "l2_directory_cfg.h"
 #include "network.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace PrL1ShL2MSI
@@ -421,6 +422,39 @@ MemoryManager::incrCycleCount(MemComponent::Type mem_component, CachePerfModel::
    }
 }
 
+void
+MemoryManager::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("pr_l1_sh_l2_msi");
+   _L1_cache_cntlr->getL1ICache()->checkpoint(writer);
+   _L1_cache_cntlr->getL1DCache()->checkpoint(writer);
+   _L2_cache_cntlr->getL2Cache()->checkpoint(writer);
+   writer << _dram_cntlr_present;
+   if (_dram_cntlr_present)
+   {
+      _dram_cntlr->checkpoint(writer);
+   }
+   writer.endSection();
+}
+
+void
+MemoryManager::restore(CheckpointReader& reader)
+{
+   reader.beginSection("pr_l1_sh_l2_msi");
+   _L1_cache_cntlr->getL1ICache()->restore(reader);
+   _L1_cache_cntlr->getL1DCache()->restore(reader);
+   _L2_cache_cntlr->getL2Cache()->restore(reader);
+   bool dram_cntlr_present;
+   reader >> dram_cntlr_present;
+   LOG_ASSERT_ERROR(dram_cntlr_present == _dram_cntlr_present,
+                    "DRAM controller %s in the checkpoint", dram_cntlr_present ? "present" : "not present");
+   if (_dram_cntlr_present)
+   {
+      _dram_cntlr->restore(reader);
+   }
+   reader.endSection();
+}
+
 void
 MemoryManager::enableModels()
 {
@@ -465,6 +499,36 @@ MemoryManager::disableModels()
    }
 }
 
+// Only the L1 caches are private to the core (the L2 slice of the tile is
+// shared). They are changed under their locks, as the sim thread uses them
+void
+MemoryManager::enableCoreModels()
+{
+   _L1_cache_cntlr->acquireLock(MemComponent::L1_ICACHE);
+   _L1_cache_cntlr->getL1ICache()->enable();
+   _L1_icache_perf_model->enable();
+   _L1_cache_cntlr->releaseLock(MemComponent::L1_ICACHE);
+
+   _L1_cache_cntlr->acquireLock(MemComponent::L1_DCACHE);
+   _L1_cache_cntlr->getL1DCache()->enable();
+   _L1_dcache_perf_model->enable();
+   _L1_cache_cntlr->releaseLock(MemComponent::L1_DCACHE);
+}
+
+void
+MemoryManager::disableCoreModels()
+{
+   _L1_cache_cntlr->acquireLock(MemComponent::L1_ICACHE);
+   _L1_cache_cntlr->getL1ICache()->disable();
+   _L1_icache_perf_model->disable();
+   _L1_cache_cntlr->releaseLock(MemComponent::L1_ICACHE);
+
+   _L1_cache_cntlr->acquireLock(MemComponent::L1_DCACHE);
+   _L1_cache_cntlr->getL1DCache()->disable();
+   _L1_dcache_perf_model->disable();
+   _L1_cache_cntlr->releaseLock(MemComponent::L1_DCACHE);
+}
+
 void
 MemoryManager::outputSummary(std::ostream &os)
 {
@@ -45,6 +45,11 @@ namespace PrL1ShL2MSI
     
       void enableModels();
       void disableModels();
+      void enableCoreModels();
+      void disableCoreModels();
+
+      void checkpoint(CheckpointWriter& writer);
+      void restore(CheckpointReader& reader);
 
       UInt32 getModeledLength(const void* pkt_data)
       { return ((ShmemMsg*) pkt_data)->getModeledLength(); }
@@ -3,6 +3,7 @@
 #include "simulator.h"
 #include "tile_manager.h"
 #include "clock_converter.h"
+#include "checkpoint.h"
 #include "log.h"
 
 namespace ShL1ShL2
@@ -280,6 +281,26 @@ MemoryManager::incrCycleCount(MemComponent::Type mem_component, CachePerfModel::
    }
 }
 
+void
+MemoryManager::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("sh_l1_sh_l2");
+   _l2_cache_cntlr->getL2Cache()->checkpoint(writer);
+   _dram_directory_cntlr->getDramDirectoryCache()->checkpoint(writer);
+   _dram_cntlr->checkpoint(writer);
+   writer.endSection();
+}
+
+void
+MemoryManager::restore(CheckpointReader& reader)
+{
+   reader.beginSection("sh_l1_sh_l2");
+   _l2_cache_cntlr->getL2Cache()->restore(reader);
+   _dram_directory_cntlr->getDramDirectoryCache()->restore(reader);
+   _dram_cntlr->restore(reader);
+   reader.endSection();
+}
+
 void
 MemoryManager::enableModels()
 {
@@ -43,6 +43,9 @@ namespace ShL1ShL2
       void enableModels();
       void disableModels();
 
+      void checkpoint(CheckpointWriter& writer);
+      void restore(CheckpointReader& reader);
+
       tile_id_t getShmemRequester(const void* pkt_data)
       { return ((ShmemMsg*) pkt_data)->getRequester(); }
       UInt32 getModeledLength(const void* pkt_data)
@@ -4,6 +4,7 @@
 #include "network_model.h"
 #include "syscall_model.h"
 #include "sync_client.h"
+#include "sync_server.h"
 #include "network_types.h"
 #include "memory_manager.h"
 #include "pin_memory_manager.h"
@@ -12,6 +13,7 @@
 #include "main_core.h"
 #include "core.h"
 #include "simulator.h"
+#include "checkpoint.h"
 #include "log.h"
 
 using namespace std;
@@ -25,6 +27,9 @@ Tile::Tile(tile_id_t id)
 
    m_network = new Network(this);
 
+   // Home of the mutexes/conds/barriers that hash to this tile
+   m_sync_server = new SyncServer(this);
+
    if (Config::getSingleton()->isSimulatingSharedMemory())
    {
       m_shmem_perf_model = new ShmemPerfModel();
@@ -43,7 +48,9 @@ Tile::Tile(tile_id_t id)
 
 Tile::~Tile()
 {
+   delete m_filtered_ingestor;
    delete m_main_core;
+   delete m_sync_server;
    if (Config::getSingleton()->isSimulatingSharedMemory())
    {
       delete m_memory_manager;
@@ -62,6 +69,7 @@ void Tile::outputSummary(std::ostream &os)
    }
    LOG_PRINT("Network Summary");
    getNetwork()->outputSummary(os);
+   m_filtered_ingestor->outputSummary(os);
 
    LOG_PRINT("Memory Model Summary");
    if (Config::getSingleton()->isSimulatingSharedMemory())
@@ -97,6 +105,43 @@ void Tile::disablePerformanceModels()
    LOG_PRINT("disablePerformanceModels(%i) end", m_tile_id);
 }
 
+// The network models are not saved: their counters restart at the checkpoint
+void
+Tile::checkpoint(CheckpointWriter& writer)
+{
+   writer.beginSection("tile");
+   writer << m_tile_id;
+   getCore()->getPerformanceModel()->checkpoint(writer);
+   writer << Config::getSingleton()->isSimulatingSharedMemory();
+   if (Config::getSingleton()->isSimulatingSharedMemory())
+   {
+      getCore()->getShmemPerfModel()->checkpoint(writer, getCore()->getPerformanceModel()->getFrequency());
+      getCore()->getMemoryManager()->checkpoint(writer);
+   }
+   writer.endSection();
+}
+
+void
+Tile::restore(CheckpointReader& reader)
+{
+   tile_id_t tile_id;
+   bool simulating_shared_memory;
+
+   reader.beginSection("tile");
+   reader >> tile_id;
+   LOG_ASSERT_ERROR(tile_id == m_tile_id, "Restoring the state of tile(%i) into tile(%i)", tile_id, m_tile_id);
+   getCore()->getPerformanceModel()->restore(reader);
+   reader >> simulating_shared_memory;
+   LOG_ASSERT_ERROR(simulating_shared_memory == Config::getSingleton()->isSimulatingSharedMemory(),
+                    "Checkpoint %s shared memory", simulating_shared_memory ? "with" : "without");
+   if (simulating_shared_memory)
+   {
+      getCore()->getShmemPerfModel()->restore(reader, getCore()->getPerformanceModel()->getFrequency());
+      getCore()->getMemoryManager()->restore(reader);
+   }
+   reader.endSection();
+}
+
 void
 Tile::updateInternalVariablesOnFrequencyChange(volatile float frequency)
 {
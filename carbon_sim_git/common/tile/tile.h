@@ -8,7 +8,10 @@
 class MemoryManager;
 class SyscallMdl;
 class SyncClient;
+class SyncServer;
 class ClockSkewMinimizationClient;
+class CheckpointWriter;
+class CheckpointReader;
 
 #include "mem_component.h"
 #include "fixed_types.h"
@@ -46,6 +49,10 @@ public:
 
    void enablePerformanceModels();
    void disablePerformanceModels();
+
+   // State of the core and memory models (see Simulator::checkpointCurrentProcess())
+   void checkpoint(CheckpointWriter& writer);
+   void restore(CheckpointReader& reader);
    
    FilteredIngestor *m_filtered_ingestor; //TODO:fix
 
@@ -54,6 +61,7 @@ private:
    Network *m_network;
    ShmemPerfModel* m_shmem_perf_model;
    MemoryManager *m_memory_manager;
+   SyncServer *m_sync_server;
    Core *m_main_core;
 };
 
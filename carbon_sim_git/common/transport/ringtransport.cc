@@ -0,0 +1,234 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <limits.h>
+
+#include "ringtransport.h"
+#include "simulator.h"
+#include "config.h"
+#include "log.h"
+
+// -- RingTransport -- //
+
+RingTransport::RingTransport()
+{
+   LOG_ASSERT_ERROR(Config::getSingleton()->getProcessCount() == 1, "Can only use RingTransport with a single process.");
+
+   Config::getSingleton()->setProcessNum(0);
+
+   m_ring_size = Sim()->getCfg()->getInt("transport/ring/queue_size", 1024);
+   m_buffer_size = Sim()->getCfg()->getInt("transport/ring/buffer_size", 256);
+   m_pool_size = Sim()->getCfg()->getInt("transport/ring/pool_size", 256);
+   m_spin_count = Sim()->getCfg()->getInt("transport/ring/spin_count", 1000);
+
+   m_global_node = new RingNode(-1, this);
+
+   m_num_tiles = Config::getSingleton()->getTotalTiles();
+   m_tile_nodes = new RingNode* [m_num_tiles];
+   for (UInt32 i = 0; i < m_num_tiles; i++)
+      m_tile_nodes[i] = NULL;
+}
+
+RingTransport::~RingTransport()
+{
+   // The networks delete the Transport::Nodes
+   delete [] m_tile_nodes;
+   delete m_global_node;
+}
+
+Transport::Node* RingTransport::createNode(tile_id_t tile_id)
+{
+   LOG_ASSERT_ERROR((UInt32) tile_id < m_num_tiles, "Request index out of range: %d", tile_id);
+   LOG_ASSERT_ERROR(m_tile_nodes[tile_id] == NULL, "Transport already allocated for id: %d.", tile_id);
+
+   m_tile_nodes[tile_id] = new RingNode(tile_id, this);
+
+   LOG_PRINT("Created node: %p on id: %d", m_tile_nodes[tile_id], tile_id);
+
+   return m_tile_nodes[tile_id];
+}
+
+void RingTransport::barrier()
+{
+   // We assume a single process, so this is a NOOP
+}
+
+Transport::Node* RingTransport::getGlobalNode()
+{
+   return m_global_node;
+}
+
+RingTransport::RingNode* RingTransport::getNodeFromId(tile_id_t tile_id)
+{
+   LOG_ASSERT_ERROR((UInt32) tile_id < m_num_tiles, "Tile id out of range: %d", tile_id);
+   return m_tile_nodes[tile_id];
+}
+
+void RingTransport::clearNodeForId(tile_id_t tile_id)
+{
+   if ((UInt32) tile_id < m_num_tiles)
+      m_tile_nodes[tile_id] = NULL;
+}
+
+// -- RingTransport::RingNode -- //
+
+RingTransport::RingNode::RingNode(tile_id_t tile_id, RingTransport *rt)
+   : Node(tile_id)
+   , m_rt(rt)
+   , m_recv_ring(rt->m_ring_size)
+   , m_buffer_pool(rt->m_pool_size)
+   , m_overflow_count(0)
+   , m_waiting(0)
+   , m_futx(0)
+{
+}
+
+RingTransport::RingNode::~RingNode()
+{
+   LOG_ASSERT_WARNING(!query(), "Unread messages in queue for tile: %d", getTileId());
+
+   // Buffers received by this node come out of its own pool, so return
+   // the unread ones before freeing the pool
+   Byte *buffer;
+   while (pop(buffer))
+      releaseBuffer(buffer);
+
+   Byte *raw;
+   while (m_buffer_pool.pop(raw))
+      delete [] raw;
+
+   m_rt->clearNodeForId(getTileId());
+}
+
+void RingTransport::RingNode::globalSend(SInt32 dest_proc, const void *buffer, UInt32 length)
+{
+   LOG_ASSERT_ERROR(dest_proc == 0, "Destination other than zero: %d", dest_proc);
+   send(m_rt->m_global_node, buffer, length);
+}
+
+void RingTransport::RingNode::send(tile_id_t dest_tile, const void *buffer, UInt32 length)
+{
+   RingNode *dest_node = m_rt->getNodeFromId(dest_tile);
+   LOG_ASSERT_ERROR(dest_node != NULL, "Attempt to send to non-existent node: %d", dest_tile);
+   send(dest_node, buffer, length);
+}
+
+void RingTransport::RingNode::send(RingNode *dest_node, const void *buffer, UInt32 length)
+{
+   Byte *data = dest_node->allocateBuffer(length);
+   memcpy(data, buffer, length);
+
+   LOG_PRINT("sending msg -- size: %i, data: %p, dest: %p", length, data, dest_node);
+
+   // Packets go to the overflow queue as long as it is not empty, so they
+   // are received after the ones already there
+   if ((dest_node->m_overflow_count > 0) || !dest_node->m_recv_ring.push(data))
+   {
+      ScopedLock sl(dest_node->m_overflow_lock);
+      dest_node->m_overflow_queue.push(data);
+      dest_node->m_overflow_count ++;
+   }
+
+   dest_node->wakeup();
+}
+
+Byte* RingTransport::RingNode::allocateBuffer(UInt32 length)
+{
+   Byte *raw = NULL;
+   BufferHeader *header;
+
+   if (length <= m_rt->m_buffer_size)
+   {
+      if (!m_buffer_pool.pop(raw))
+         raw = new Byte[sizeof(BufferHeader) + m_rt->m_buffer_size];
+      header = (BufferHeader*) raw;
+      header->pool_owner = this;
+   }
+   else
+   {
+      raw = new Byte[sizeof(BufferHeader) + length];
+      header = (BufferHeader*) raw;
+      header->pool_owner = NULL;
+   }
+
+   return raw + sizeof(BufferHeader);
+}
+
+void RingTransport::RingNode::releaseBuffer(Byte *buffer)
+{
+   Byte *raw = buffer - sizeof(BufferHeader);
+   BufferHeader *header = (BufferHeader*) raw;
+
+   if ( (header->pool_owner == NULL) || (!header->pool_owner->m_buffer_pool.push(raw)) )
+      delete [] raw;
+}
+
+void RingTransport::RingNode::wakeup()
+{
+   __sync_synchronize();
+   if (m_waiting)
+   {
+      m_futx = 1;
+      syscall(SYS_futex, (void*) &m_futx, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+   }
+}
+
+// The ring holds the packets sent before the overflow queue filled up, so
+// it is drained first
+bool RingTransport::RingNode::pop(Byte* &data)
+{
+   if (m_recv_ring.pop(data))
+      return true;
+
+   if (m_overflow_count == 0)
+      return false;
+
+   ScopedLock sl(m_overflow_lock);
+   if (m_overflow_queue.empty())
+      return false;
+   data = m_overflow_queue.front();
+   m_overflow_queue.pop();
+   m_overflow_count --;
+   return true;
+}
+
+Byte* RingTransport::RingNode::recv()
+{
+   LOG_PRINT("attempting recv -- this: %p", this);
+
+   Byte *data;
+
+   while (true)
+   {
+      for (UInt32 i = 0; i < m_rt->m_spin_count; i++)
+      {
+         if (pop(data))
+         {
+            LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
+            return data;
+         }
+         __asm__ __volatile__("pause" ::: "memory");
+      }
+
+      // Announce that we are going to sleep and check once more, so a
+      // sender either sees m_waiting set or we see its packet
+      m_futx = 0;
+      __sync_fetch_and_add(&m_waiting, 1);
+
+      if (pop(data))
+      {
+         __sync_fetch_and_sub(&m_waiting, 1);
+         LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
+         return data;
+      }
+
+      syscall(SYS_futex, (void*) &m_futx, FUTEX_WAIT, 0, NULL, NULL, 0);
+      __sync_fetch_and_sub(&m_waiting, 1);
+   }
+}
+
+bool RingTransport::RingNode::query()
+{
+   return (!m_recv_ring.empty() || (m_overflow_count > 0));
+}
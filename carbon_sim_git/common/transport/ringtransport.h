@@ -0,0 +1,85 @@
+#ifndef RING_TRANSPORT_H
+#define RING_TRANSPORT_H
+
+#include <queue>
+
+#include "transport.h"
+#include "lockfree_ring.h"
+#include "lock.h"
+
+// In-process transport for single-process simulations. Every node owns
+// a bounded lock-free receive ring and a pool of fixed-size buffers that
+// senders copy their payload into, so a tile-to-tile send takes neither
+// a lock nor a heap allocation (payloads larger than a pool buffer, or
+// sends that find the pool empty, fall back to the heap).
+//   A sender never waits for a full ring (the receiver may itself be
+// blocked sending to the sender): the packet goes to an unbounded overflow
+// queue of the receiver instead, and later packets follow it there until
+// the receiver has drained it, so packets stay in order.
+//   The receiver spins for a while when its ring is empty and then
+// sleeps on a futex that senders only touch when it is actually asleep.
+
+class RingTransport : public Transport
+{
+public:
+   RingTransport();
+   ~RingTransport();
+
+   class RingNode : public Node
+   {
+   public:
+      RingNode(tile_id_t tile_id, RingTransport *rt);
+      ~RingNode();
+
+      void globalSend(SInt32 dest_proc, const void *buffer, UInt32 length);
+      void send(tile_id_t dest_tile, const void *buffer, UInt32 length);
+      Byte* recv();
+      bool query();
+      void releaseBuffer(Byte *buffer);
+
+   private:
+      // Precedes the payload of every buffer handed out by recv()
+      struct BufferHeader
+      {
+         RingNode *pool_owner;   // NULL if heap-allocated
+      };
+
+      void send(RingNode *dest_node, const void *buffer, UInt32 length);
+      Byte* allocateBuffer(UInt32 length);
+      void wakeup();
+      bool pop(Byte* &data);
+
+      RingTransport *m_rt;
+
+      LockFreeRing<Byte*> m_recv_ring;
+      LockFreeRing<Byte*> m_buffer_pool;
+
+      // Packets that found the ring full
+      std::queue<Byte*> m_overflow_queue;
+      Lock m_overflow_lock;
+      volatile UInt32 m_overflow_count;
+
+      volatile SInt32 m_waiting;
+      SInt32 m_futx;
+   };
+
+   Node* createNode(tile_id_t tile_id);
+
+   void barrier();
+   Node* getGlobalNode();
+
+private:
+   RingNode *m_global_node;
+   RingNode **m_tile_nodes;
+   UInt32 m_num_tiles;
+
+   UInt32 m_ring_size;
+   UInt32 m_buffer_size;
+   UInt32 m_pool_size;
+   UInt32 m_spin_count;
+
+   RingNode* getNodeFromId(tile_id_t tile_id);
+   void clearNodeForId(tile_id_t tile_id);
+};
+
+#endif // RING_TRANSPORT_H
@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "log.h"
+#include "config.h"
+#include "simulator.h"
+#include "shmtransport.h"
+
+#ifdef __CHECKSUM_ENABLED__
+#include "checksum.h"
+#endif // __CHECKSUM_ENABLED__
+
+using std::string;
+
+ShmTransport::ShmTransport()
+   : SockTransport()
+   , m_recv_thread_state(RUNNING)
+{
+   m_ring_size = Sim()->getCfg()->getInt("transport/shm/ring_size", DEFAULT_RING_SIZE);
+   m_spin_count = Sim()->getCfg()->getInt("transport/shm/spin_count", 1000);
+   LOG_ASSERT_ERROR((m_ring_size & (m_ring_size - 1)) == 0, "transport/shm/ring_size(%u) must be a power of 2", m_ring_size);
+
+   m_segment_size = SEGMENT_HEADER_SIZE + m_num_procs * (sizeof(Ring) + m_ring_size);
+   m_shm_packets_sent = new UInt64[m_num_procs];
+   m_socket_packets_sent = new UInt64[m_num_procs];
+   m_peer_segments = new Byte*[m_num_procs];
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      m_shm_packets_sent[proc] = 0;
+      m_socket_packets_sent[proc] = 0;
+      m_peer_segments[proc] = NULL;
+   }
+
+   // Export our segment, wait for everyone else to do the same and then
+   // map the segments of the processes on this host
+   m_local_segment = mapSegment(m_proc_index, true);
+
+   barrier();
+
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      if ((proc != m_proc_index) && isOnLocalHost(proc))
+         m_peer_segments[proc] = mapSegment(proc, false);
+   }
+
+   // Barrier messages from the local peers now come through the rings
+   m_recv_thread = Thread::create(recvThreadFunc, this);
+   m_recv_thread->run();
+
+   // All peers have the segment mapped, the name is no longer needed
+   barrier();
+   shm_unlink(getSegmentName(m_proc_index).c_str());
+}
+
+ShmTransport::~ShmTransport()
+{
+   terminateRecvThread();
+
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      if (m_peer_segments[proc])
+         munmap(m_peer_segments[proc], m_segment_size);
+   }
+   munmap(m_local_segment, m_segment_size);
+
+   delete [] m_peer_segments;
+   delete [] m_socket_packets_sent;
+   delete [] m_shm_packets_sent;
+}
+
+string ShmTransport::getSegmentName(SInt32 proc)
+{
+   char name[64];
+   snprintf(name, sizeof(name), "/graphite_%d_%d", m_base_port, proc);
+   return string(name);
+}
+
+Byte* ShmTransport::mapSegment(SInt32 proc, bool create)
+{
+   string name = getSegmentName(proc);
+
+   SInt32 fd = shm_open(name.c_str(), create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0600);
+   LOG_ASSERT_ERROR(fd >= 0, "Failed to open shared memory segment %s, errno(%i)", name.c_str(), errno);
+
+   if (create)
+   {
+      __attribute__((unused)) SInt32 err = ftruncate(fd, m_segment_size);
+      LOG_ASSERT_ERROR(err == 0, "Failed to size shared memory segment %s", name.c_str());
+   }
+
+   void *segment = mmap(NULL, m_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   LOG_ASSERT_ERROR(segment != MAP_FAILED, "Failed to map shared memory segment %s, errno(%i)", name.c_str(), errno);
+   close(fd);
+
+   if (create)
+   {
+      // ftruncate zero-fills, so the rings start out empty
+      SegmentHeader *header = getSegmentHeader((Byte*) segment);
+      header->num_rings = m_num_procs;
+      header->ring_size = m_ring_size;
+   }
+   else
+   {
+      __attribute__((unused)) SegmentHeader *header = getSegmentHeader((Byte*) segment);
+      LOG_ASSERT_ERROR(header->num_rings == (UInt32) m_num_procs && header->ring_size == m_ring_size,
+                       "Shared memory segment %s has unexpected geometry", name.c_str());
+   }
+
+   return (Byte*) segment;
+}
+
+ShmTransport::Ring* ShmTransport::getRing(Byte *segment, SInt32 src_proc)
+{
+   return (Ring*) (segment + SEGMENT_HEADER_SIZE + src_proc * (sizeof(Ring) + m_ring_size));
+}
+
+void ShmTransport::copyToRing(Byte *data, UInt64 pos, UInt32 ring_size, const void *src, UInt32 length)
+{
+   UInt32 offset = pos & (ring_size - 1);
+   UInt32 first = (length < ring_size - offset) ? length : (ring_size - offset);
+   memcpy(data + offset, src, first);
+   memcpy(data, (const Byte*) src + first, length - first);
+}
+
+void ShmTransport::copyFromRing(const Byte *data, UInt64 pos, UInt32 ring_size, void *dst, UInt32 length)
+{
+   UInt32 offset = pos & (ring_size - 1);
+   UInt32 first = (length < ring_size - offset) ? length : (ring_size - offset);
+   memcpy(dst, data + offset, first);
+   memcpy((Byte*) dst + first, data, length - first);
+}
+
+void ShmTransport::sendRemote(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length,
+                              const UInt64 *checksum)
+{
+   Byte *segment = m_peer_segments[dest_proc];
+   if (segment == NULL)
+   {
+      SockTransport::sendRemote(dest_proc, tag, buffer, length, checksum);
+      return;
+   }
+
+   UInt32 pkt_len = 2 * sizeof(UInt32) + length + (checksum ? sizeof(*checksum) : 0);
+
+   // The send lock makes this process the only producer on the ring
+   ScopedLock sl(m_send_locks[dest_proc]);
+
+   if (pkt_len <= m_ring_size)
+   {
+      sendToRing(dest_proc, tag, buffer, length, checksum);
+      m_shm_packets_sent[dest_proc] ++;
+      return;
+   }
+
+   // Everything in the ring is received before the socket packet, and the
+   // marker keeps what follows in the ring from overtaking it
+   Ring *ring = getRing(segment, m_proc_index);
+   while (ring->head != ring->tail)
+      sched_yield();
+
+   UInt64 sequence_num = ++ m_socket_packets_sent[dest_proc];
+   sendToRing(dest_proc, SOCKET_PACKET_TAG, &sequence_num, sizeof(sequence_num), NULL);
+
+   SockTransport::sendRemoteLocked(dest_proc, tag, buffer, length, checksum);
+}
+
+void ShmTransport::sendBarrierMessage(SInt32 dest_proc)
+{
+   if (m_peer_segments[dest_proc] == NULL)
+   {
+      SockTransport::sendBarrierMessage(dest_proc);
+      return;
+   }
+
+   SInt32 message = 0;
+
+   ScopedLock sl(m_send_locks[dest_proc]);
+   sendToRing(dest_proc, BARRIER_TAG, &message, sizeof(message), NULL);
+}
+
+// Must be called with m_send_locks[dest_proc] held
+void ShmTransport::sendToRing(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length,
+                              const UInt64 *checksum)
+{
+   Byte *segment = m_peer_segments[dest_proc];
+
+   // Length, Tag, Data, (Checksum)
+   UInt32 header[2] = { length, (UInt32) tag };
+   UInt32 pkt_len = sizeof(header) + length + (checksum ? sizeof(*checksum) : 0);
+
+   Ring *ring = getRing(segment, m_proc_index);
+   Byte *data = getRingData(segment, m_proc_index);
+
+   UInt64 tail = ring->tail;
+   while (tail + pkt_len - ring->head > m_ring_size)
+      sched_yield();
+
+   copyToRing(data, tail, m_ring_size, header, sizeof(header));
+   copyToRing(data, tail + sizeof(header), m_ring_size, buffer, length);
+   if (checksum)
+      copyToRing(data, tail + sizeof(header) + length, m_ring_size, checksum, sizeof(*checksum));
+
+   __sync_synchronize();
+   ring->tail = tail + pkt_len;
+   __sync_synchronize();
+
+   // Ring the doorbell only if the receiver went to sleep
+   SegmentHeader *seg_header = getSegmentHeader(segment);
+   if (seg_header->waiting)
+   {
+      __sync_fetch_and_add(&seg_header->doorbell, 1);
+      syscall(SYS_futex, (void*) &seg_header->doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+   }
+}
+
+void ShmTransport::recvThreadFunc(void *vp)
+{
+   LOG_PRINT("Starting recvThreadFunc");
+
+   ShmTransport *st = (ShmTransport*) vp;
+   SegmentHeader *seg_header = st->getSegmentHeader(st->m_local_segment);
+
+   UInt32 idle_iterations = 0;
+
+   while (st->m_recv_thread_state == RUNNING)
+   {
+      bool received = false;
+      for (SInt32 proc = 0; proc < st->m_num_procs; proc++)
+      {
+         if (st->m_peer_segments[proc])
+            received |= st->processRing(proc);
+      }
+
+      if (received)
+      {
+         idle_iterations = 0;
+      }
+      else if (++idle_iterations >= st->m_spin_count)
+      {
+         // Announce that we are going to sleep and look once more, so a
+         // sender either sees 'waiting' set or we see its packet
+         SInt32 doorbell = seg_header->doorbell;
+         seg_header->waiting = 1;
+         __sync_synchronize();
+
+         for (SInt32 proc = 0; proc < st->m_num_procs; proc++)
+         {
+            if (st->m_peer_segments[proc])
+               received |= st->processRing(proc);
+         }
+
+         if (!received && st->m_recv_thread_state == RUNNING)
+            syscall(SYS_futex, (void*) &seg_header->doorbell, FUTEX_WAIT, doorbell, NULL, NULL, 0);
+
+         seg_header->waiting = 0;
+         idle_iterations = 0;
+      }
+   }
+
+   st->m_recv_thread_state = EXITED;
+
+   LOG_PRINT("Leaving recvThreadFunc");
+}
+
+// Deliver every complete packet in the ring from 'src_proc'
+bool ShmTransport::processRing(SInt32 src_proc)
+{
+   Ring *ring = getRing(m_local_segment, src_proc);
+   const Byte *data = getRingData(m_local_segment, src_proc);
+
+   UInt64 head = ring->head;
+   UInt64 tail = ring->tail;
+   __sync_synchronize();
+
+   if (head == tail)
+      return false;
+
+   while (head != tail)
+   {
+      UInt32 header[2];
+      copyFromRing(data, head, m_ring_size, header, sizeof(header));
+      UInt32 length = header[0];
+      SInt32 tag = (SInt32) header[1];
+
+      switch (tag)
+      {
+      case BARRIER_TAG:
+         head += sizeof(header) + length;
+         m_barrier_sem.signal();
+         break;
+
+      case SOCKET_PACKET_TAG:
+         {
+            // The packet is on its way through the socket, so wait for it
+            // here (it does not take long)
+            UInt64 sequence_num;
+            copyFromRing(data, head + sizeof(header), m_ring_size, &sequence_num, sizeof(sequence_num));
+            head += sizeof(header) + length;
+            while (m_recv_packet_counts[src_proc] < sequence_num)
+               sched_yield();
+         }
+         break;
+
+      default:
+         {
+            // receivers own the buffer they get from recv()
+            Byte *buffer = new Byte[length];
+            copyFromRing(data, head + sizeof(header), m_ring_size, buffer, length);
+            head += sizeof(header) + length;
+
+#ifdef __CHECKSUM_ENABLED__
+            UInt64 checksum;
+            copyFromRing(data, head, m_ring_size, &checksum, sizeof(checksum));
+            head += sizeof(checksum);
+            insertInBufferList(tag, buffer, new Header(length, checksum));
+#else
+            insertInBufferList(tag, buffer);
+#endif // __CHECKSUM_ENABLED__
+         }
+         break;
+      }
+   }
+
+   __sync_synchronize();
+   ring->head = head;
+
+   return true;
+}
+
+void ShmTransport::terminateRecvThread()
+{
+   LOG_PRINT("Stopping shared memory receive thread.");
+
+   SegmentHeader *seg_header = getSegmentHeader(m_local_segment);
+
+   m_recv_thread_state = EXITING;
+   while (m_recv_thread_state != EXITED)
+   {
+      __sync_fetch_and_add(&seg_header->doorbell, 1);
+      syscall(SYS_futex, (void*) &seg_header->doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+      sched_yield();
+   }
+
+   delete m_recv_thread;
+}
+
+void ShmTransport::outputProcessSummary(std::ostream &out)
+{
+   SockTransport::outputProcessSummary(out);
+
+   UInt64 total_shm_packets_sent = 0;
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      ScopedLock sl(m_send_locks[proc]);
+      total_shm_packets_sent += m_shm_packets_sent[proc];
+   }
+   out << "    Shared Memory Packets Sent: " << total_shm_packets_sent << std::endl;
+}
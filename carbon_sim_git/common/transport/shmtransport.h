@@ -0,0 +1,86 @@
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include "socktransport.h"
+
+// Socket transport for multi-process simulations that moves the traffic
+// between processes running on the same host into POSIX shared memory.
+//   Every process exports one segment holding a single-producer/
+// single-consumer byte ring per sending process, framed exactly like
+// SockTransport::Packet. Sends to a process on the same host append to
+// that ring (under the per-destination send lock, hence one producer)
+// and ring a futex doorbell in the segment only if the receiving
+// thread is asleep. Barrier messages to a peer on the same host go
+// through the ring too, behind the data sent before them.
+//   Packets that do not fit in a ring go through the socket: the sender
+// waits for the ring to drain and leaves a marker in it, and the
+// receiving thread holds back the packets behind the marker until the
+// socket packet has arrived. Peers on other hosts and the terminate
+// message (sent by a process to itself) use the sockets as before.
+
+class ShmTransport : public SockTransport
+{
+public:
+   ShmTransport();
+   ~ShmTransport();
+
+protected:
+   void outputProcessSummary(std::ostream &out);
+
+private:
+   struct SegmentHeader
+   {
+      volatile SInt32 doorbell;
+      volatile SInt32 waiting;
+      UInt32 num_rings;
+      UInt32 ring_size;
+   };
+
+   struct Ring
+   {
+      volatile UInt64 head;   // Consumer position
+      char pad0[56];
+      volatile UInt64 tail;   // Producer position
+      char pad1[56];
+   };
+
+   static const UInt32 SEGMENT_HEADER_SIZE = 64;
+   static const UInt32 DEFAULT_RING_SIZE = 262144;
+   static const SInt32 SOCKET_PACKET_TAG = -4;
+
+   void sendRemote(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length, const UInt64 *checksum);
+   void sendBarrierMessage(SInt32 dest_proc);
+   void sendToRing(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length, const UInt64 *checksum);
+
+   std::string getSegmentName(SInt32 proc);
+   Byte* mapSegment(SInt32 proc, bool create);
+
+   SegmentHeader* getSegmentHeader(Byte *segment) { return (SegmentHeader*) segment; }
+   Ring* getRing(Byte *segment, SInt32 src_proc);
+   Byte* getRingData(Byte *segment, SInt32 src_proc) { return (Byte*) (getRing(segment, src_proc) + 1); }
+
+   static void copyToRing(Byte *data, UInt64 pos, UInt32 ring_size, const void *src, UInt32 length);
+   static void copyFromRing(const Byte *data, UInt64 pos, UInt32 ring_size, void *dst, UInt32 length);
+
+   static void recvThreadFunc(void *vp);
+   bool processRing(SInt32 src_proc);
+   void terminateRecvThread();
+
+   UInt32 m_ring_size;
+   size_t m_segment_size;
+   UInt32 m_spin_count;
+
+   // Segment exported by this process, and the ones of every local peer
+   // (NULL for remote peers)
+   Byte *m_local_segment;
+   Byte **m_peer_segments;
+
+   UInt64 *m_shm_packets_sent;
+   // Packets sent to every local peer through its socket
+   UInt64 *m_socket_packets_sent;
+
+   Thread *m_recv_thread;
+   volatile UpdateThreadState m_recv_thread_state;
+};
+
+#endif // SHM_TRANSPORT_H
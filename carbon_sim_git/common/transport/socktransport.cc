@@ -9,14 +9,16 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <sched.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <cassert>
+#include <sstream>
 
 #include "log.h"
 #include "config.h"
 #include "simulator.h" //interface to config file singleton
 #include "socktransport.h"
 
-// #define __CHECKSUM_ENABLED__     1
-
 #ifdef __CHECKSUM_ENABLED__
 #include "checksum.h"
 #endif // __CHECKSUM_ENABLED__
@@ -25,6 +27,7 @@ using std::string;
 
 SockTransport::SockTransport()
    : m_update_thread_state(RUNNING)
+   , m_flush_thread_state(RUNNING)
 {
    m_base_port = Sim()->getCfg()->getInt("transport/base_port", DEFAULT_BASE_PORT);
 
@@ -35,6 +38,13 @@ SockTransport::SockTransport()
    m_update_thread = Thread::create(updateThreadFunc, this);
    m_update_thread->run();
 
+   m_flush_thread = NULL;
+   if (m_send_batch_delay > 0)
+   {
+      m_flush_thread = Thread::create(flushThreadFunc, this);
+      m_flush_thread->run();
+   }
+
    m_global_node = new SockNode(GLOBAL_TAG, this);
 }
 
@@ -72,6 +82,18 @@ void SockTransport::initSockets()
    m_send_sockets = new Socket[m_num_procs];
    m_send_locks = new Lock[m_num_procs];
 
+   m_send_batch_size = Sim()->getCfg()->getInt("transport/send_batch_size", DEFAULT_SEND_BATCH_SIZE);
+   m_send_batch_delay = Sim()->getCfg()->getInt("transport/send_batch_delay", DEFAULT_SEND_BATCH_DELAY);
+   m_send_batches = new SendBatch[m_num_procs];
+   m_send_counters = new SendCounters[m_num_procs];
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      m_send_batches[proc].data = (m_send_batch_delay > 0) ? new Byte[m_send_batch_size] : NULL;
+      m_send_batches[proc].length = 0;
+      m_send_batches[proc].num_packets = 0;
+      memset(&m_send_counters[proc], 0, sizeof(SendCounters));
+   }
+
    for (SInt32 proc = 0; proc < m_num_procs; proc++)
    {
       // Look up the mapping in the config file to find the address for this
@@ -96,7 +118,6 @@ void SockTransport::initSockets()
 
    // -- accept connections
    m_recv_sockets = new Socket[m_num_procs];
-   m_recv_locks = new Lock[m_num_procs];
 
    for (SInt32 proc = 0; proc < m_num_procs; proc++)
    {
@@ -111,6 +132,40 @@ void SockTransport::initSockets()
 
       m_recv_sockets[proc_index] = sock;
    }
+
+   // -- receive engine: the update thread sleeps in epoll_wait() until one
+   // of the peers has data, and then drains it into a per-peer buffer
+   UInt32 recv_buffer_size = Sim()->getCfg()->getInt("transport/recv_buffer_size", DEFAULT_RECV_BUFFER_SIZE);
+   m_recv_buffers = new RecvBuffer[m_num_procs];
+   m_recv_packet_counts = new UInt64[m_num_procs];
+
+   m_epoll_fd = epoll_create(m_num_procs);
+   LOG_ASSERT_ERROR(m_epoll_fd >= 0, "Failed to create epoll instance.");
+
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      m_recv_buffers[proc].data = new Byte[recv_buffer_size];
+      m_recv_buffers[proc].capacity = recv_buffer_size;
+      m_recv_buffers[proc].head = 0;
+      m_recv_buffers[proc].tail = 0;
+      m_recv_packet_counts[proc] = 0;
+
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN;
+      event.data.u32 = proc;
+      __attribute__((unused)) SInt32 err = epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_recv_sockets[proc].getFd(), &event);
+      LOG_ASSERT_ERROR(err >= 0, "Failed to add socket for process(%i) to epoll set", proc);
+   }
+
+   // -- send batches that are not full are flushed by a timer thread
+   m_flush_timer_fd = -1;
+   m_flush_timer_armed = 0;
+   if (m_send_batch_delay > 0)
+   {
+      m_flush_timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+      LOG_ASSERT_ERROR(m_flush_timer_fd >= 0, "Failed to create send batch flush timer.");
+   }
 }
 
 void SockTransport::initBufferLists()
@@ -135,84 +190,162 @@ void SockTransport::updateThreadFunc(void *vp)
 
    SockTransport *st = (SockTransport*)vp;
 
+   struct epoll_event *events = new struct epoll_event[st->m_num_procs];
+
    while (st->m_update_thread_state == RUNNING)
    {
-      st->updateBufferLists();
-      sched_yield();
+      SInt32 num_events = epoll_wait(st->m_epoll_fd, events, st->m_num_procs, -1);
+      LOG_ASSERT_ERROR(num_events >= 0 || errno == EINTR, "epoll_wait failed, errno(%i)", errno);
+
+      for (SInt32 i = 0; i < num_events; i++)
+      {
+         if (!st->updateBufferList(events[i].data.u32))
+            break;
+      }
    }
 
+   delete [] events;
+
    st->m_update_thread_state = EXITED;
 
    LOG_PRINT("Leaving updateThreadFunc");
 }
 
-void SockTransport::updateBufferLists()
+// Sends can block, so batches are flushed from their own thread rather
+// than from the update thread, which must keep draining the sockets
+void SockTransport::flushThreadFunc(void *vp)
 {
-   for (SInt32 i = 0; i < m_num_procs; i++)
+   LOG_PRINT("Starting flushThreadFunc");
+
+   SockTransport *st = (SockTransport*)vp;
+
+   while (st->m_flush_thread_state == RUNNING)
    {
-      while (true)
+      UInt64 expirations;
+      if (::read(st->m_flush_timer_fd, &expirations, sizeof(expirations)) < 0)
       {
-         UInt32 length;
+         LOG_ASSERT_ERROR(errno == EINTR, "Failed to read send batch flush timer, errno(%i)", errno);
+         continue;
+      }
 
-         m_recv_locks[i].acquire();
+      st->m_flush_timer_armed = 0;
+      st->flushAllSendBatches();
+   }
 
-         // first get packet length, abort if none available
-         if (!m_recv_sockets[i].recv(&length, sizeof(length), false))
+   st->m_flush_thread_state = EXITED;
+
+   LOG_PRINT("Leaving flushThreadFunc");
+}
+
+// Drain everything that process 'proc' has sent so far. Returns false
+// once the terminate message has been received.
+bool SockTransport::updateBufferList(SInt32 proc)
+{
+   RecvBuffer &rb = m_recv_buffers[proc];
+
+   while (true)
+   {
+      if (rb.tail == rb.capacity)
+      {
+         if (rb.head > 0)
          {
-            m_recv_locks[i].release();
-            break;
+            // Move the partial packet to the front
+            memmove(rb.data, rb.data + rb.head, rb.tail - rb.head);
+            rb.tail -= rb.head;
+            rb.head = 0;
+         }
+         else
+         {
+            // A single packet larger than the buffer
+            Byte *data = new Byte[2 * rb.capacity];
+            memcpy(data, rb.data, rb.tail);
+            delete [] rb.data;
+            rb.data = data;
+            rb.capacity *= 2;
          }
+      }
 
-         // now receive tag
-         SInt32 tag;
-         m_recv_sockets[i].recv(&tag, sizeof(tag), true);
+      SInt32 recvd = m_recv_sockets[proc].recvAvailable(rb.data + rb.tail, rb.capacity - rb.tail);
+      if (recvd <= 0)
+      {
+         if (recvd < 0)
+         {
+            // Peer shut down; stop watching its socket
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, m_recv_sockets[proc].getFd(), NULL);
+         }
+         return true;
+      }
+      rb.tail += recvd;
 
-         // now receive packet
-         Byte *buffer = new Byte[length];
-         m_recv_sockets[i].recv(buffer, length, true);
+      if (!processRecvBuffer(proc))
+         return false;
+   }
+}
 
+// Frame the packets of process 'proc' in place: Length, Tag, Data, (Checksum)
+bool SockTransport::processRecvBuffer(SInt32 proc)
+{
+   RecvBuffer &rb = m_recv_buffers[proc];
+   const UInt32 header_length = sizeof(UInt32) + sizeof(SInt32);
+
+   while (rb.tail - rb.head >= header_length)
+   {
+      Packet *p = (Packet*) (rb.data + rb.head);
+      UInt32 length = p->length;
+      SInt32 tag = p->tag;
+
+      UInt32 packet_length = header_length + length;
 #ifdef __CHECKSUM_ENABLED__
-         // now receive checksum
-         UInt64 checksum = 0;
-         if ((tag != TERMINATE_TAG) && (tag != BARRIER_TAG))
-         {
-            m_recv_sockets[i].recv(&checksum, sizeof(checksum), true);
-         }
+      if ((tag != TERMINATE_TAG) && (tag != BARRIER_TAG))
+         packet_length += sizeof(UInt64);
 #endif // __CHECKSUM_ENABLED__
 
-         m_recv_locks[i].release();
+      // wait for the rest of the packet
+      if (rb.tail - rb.head < packet_length)
+         break;
+
+      rb.head += packet_length;
 
-         switch (tag)
+      switch (tag)
+      {
+      case TERMINATE_TAG:
+         LOG_PRINT("Quit message received.");
+         LOG_ASSERT_ERROR(m_update_thread_state == RUNNING, "Terminate received in unexpected state: %d", m_update_thread_state);
+         LOG_ASSERT_ERROR(proc == m_proc_index, "Terminate received from unexpected process: %d != %d", proc, m_proc_index);
+         m_update_thread_state = EXITING;
+         return false;
+
+      case BARRIER_TAG:
+         m_barrier_sem.signal();
+         LOG_ASSERT_ERROR(proc == (m_proc_index + m_num_procs - 1) % m_num_procs,
+                          "Barrier update from unexpected process: %d", proc);
+         break;
+
+      case GLOBAL_TAG:
+      default:
          {
-         case TERMINATE_TAG:
-            LOG_PRINT("Quit message received.");
-            LOG_ASSERT_ERROR(m_update_thread_state == RUNNING, "Terminate received in unexpected state: %d", m_update_thread_state);
-            LOG_ASSERT_ERROR(i == m_proc_index, "Terminate received from unexpected process: %d != %d", i, m_proc_index);
-            m_update_thread_state = EXITING;
-
-            delete [] buffer;
-            return;
-
-         case BARRIER_TAG:
-            m_barrier_sem.signal();
-            LOG_ASSERT_ERROR(i == (m_proc_index + m_num_procs - 1) % m_num_procs,
-                             "Barrier update from unexpected process: %d", i);
-            delete [] buffer;
-            break;
+            // receivers own the buffer they get from recv()
+            Byte *buffer = new Byte[length];
+            memcpy(buffer, &p->data, length);
 
-         case GLOBAL_TAG:
-         default:
 #ifdef __CHECKSUM_ENABLED__
+            UInt64 checksum;
+            memcpy(&checksum, &p->data + length, sizeof(checksum));
             Header* header = new Header(length, checksum);
             insertInBufferList(tag, buffer, header);
 #else
             insertInBufferList(tag, buffer);
 #endif // __CHECKSUM_ENABLED__
-            // do NOT delete buffer
-            break;
-         };
-      }
+            m_recv_packet_counts[proc] ++;
+         }
+         break;
+      };
    }
+
+   if (rb.head == rb.tail)
+      rb.head = rb.tail = 0;
+
+   return true;
 }
 
 void SockTransport::insertInBufferList(SInt32 tag, Byte *buffer, Header* header)
@@ -238,7 +371,7 @@ void SockTransport::terminateUpdateThread()
    LOG_PRINT("Sending quit message.");
 
    // include m_proc_index as a dummy message body just to avoid extra
-   // code paths in updateBufferLists
+   // code paths in processRecvBuffer
    SInt32 quit_message[] = { sizeof(m_proc_index), TERMINATE_TAG, m_proc_index };
    m_send_sockets[m_proc_index].send(quit_message, sizeof(quit_message));
 
@@ -248,12 +381,33 @@ void SockTransport::terminateUpdateThread()
    LOG_PRINT("Quit.");
 }
 
+void SockTransport::terminateFlushThread()
+{
+   if (m_flush_thread == NULL)
+      return;
+
+   // Fire the timer right away so the thread sees the state change
+   m_flush_thread_state = EXITING;
+
+   struct itimerspec timeout;
+   memset(&timeout, 0, sizeof(timeout));
+   timeout.it_value.tv_nsec = 1;
+   timerfd_settime(m_flush_timer_fd, 0, &timeout, NULL);
+
+   while (m_flush_thread_state != EXITED)
+      sched_yield();
+
+   delete m_flush_thread;
+}
+
 SockTransport::~SockTransport()
 {
    LOG_PRINT("dtor");
 
    delete m_global_node;
 
+   terminateFlushThread();
+   flushAllSendBatches();
    terminateUpdateThread();
    delete m_update_thread;
 
@@ -273,8 +427,18 @@ SockTransport::~SockTransport()
    }
    m_server_socket.close();
    
-   delete [] m_recv_locks;
+   if (m_flush_timer_fd >= 0)
+      ::close(m_flush_timer_fd);
+   ::close(m_epoll_fd);
+   for (SInt32 i = 0; i < m_num_procs; i++)
+      delete [] m_recv_buffers[i].data;
+   delete [] m_recv_buffers;
+   delete [] m_recv_packet_counts;
    delete [] m_recv_sockets;
+   for (SInt32 i = 0; i < m_num_procs; i++)
+      delete [] m_send_batches[i].data;
+   delete [] m_send_batches;
+   delete [] m_send_counters;
    delete [] m_send_locks;
    delete [] m_send_sockets;
 }
@@ -300,22 +464,40 @@ void SockTransport::barrier()
 
    LOG_PRINT("Entering transport barrier");
 
-   Socket &sock = m_send_sockets[(m_proc_index+1) % m_num_procs];
-   SInt32 message[] = { sizeof(SInt32), BARRIER_TAG, 0 };
+   SInt32 next_proc = (m_proc_index+1) % m_num_procs;
+
+   // Everything sent before the barrier must be out before it
+   flushAllSendBatches();
 
    if (m_proc_index != 0)
       m_barrier_sem.wait();
 
-   sock.send(message, sizeof(message));
+   sendBarrierMessage(next_proc);
 
    m_barrier_sem.wait();
 
    if (m_proc_index != m_num_procs - 1)
-      sock.send(message, sizeof(message));
+   {
+      sendBarrierMessage(next_proc);
+   }
 
    LOG_PRINT("Exiting transport barrier");
 }
 
+void SockTransport::sendBarrierMessage(SInt32 dest_proc)
+{
+   SInt32 message[] = { sizeof(SInt32), BARRIER_TAG, 0 };
+
+   ScopedLock sl(m_send_locks[dest_proc]);
+   m_send_sockets[dest_proc].send(message, sizeof(message));
+}
+
+// The send sockets are connected to the addresses of the process map
+bool SockTransport::isOnLocalHost(SInt32 proc)
+{
+   return (m_send_sockets[proc].getPeerAddress() == m_send_sockets[m_proc_index].getPeerAddress());
+}
+
 Transport::Node* SockTransport::getGlobalNode()
 {
    return m_global_node;
@@ -426,32 +608,174 @@ void SockTransport::SockNode::send(SInt32 dest_proc,
    else
    {
 #ifdef __CHECKSUM_ENABLED__
-      SInt32 pkt_len = sizeof(length) + sizeof(tag) + length + sizeof(checksum);
+      m_transport->sendRemote(dest_proc, tag, buffer, length, &checksum);
 #else
-      SInt32 pkt_len = sizeof(length) + sizeof(tag) + length;
+      m_transport->sendRemote(dest_proc, tag, buffer, length, NULL);
 #endif // __CHECKSUM_ENABLED__
+   }
 
-      Byte *pkt_buff = new Byte[pkt_len];
+   LOG_PRINT("Message sent.");
+}
 
-      // Length, Tag, Data, (Checksum)
-      Packet *p = (Packet*)pkt_buff;
-      
-      p->length = length;
-      p->tag = tag;
-      memcpy(&p->data, buffer, length);
+void SockTransport::sendRemote(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length,
+                               const UInt64 *checksum)
+{
+   ScopedLock sl(m_send_locks[dest_proc]);
+   sendRemoteLocked(dest_proc, tag, buffer, length, checksum);
+}
 
-#ifdef __CHECKSUM_ENABLED__
-      memcpy(&p->data + length, &checksum, sizeof(checksum));
-#endif // __CHECKSUM_ENABLED__
+// Must be called with m_send_locks[dest_proc] held
+void SockTransport::sendRemoteLocked(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length,
+                                     const UInt64 *checksum)
+{
+   // Length, Tag, Data, (Checksum)
+   UInt32 header[2] = { length, (UInt32) tag };
+   UInt32 pkt_len = sizeof(header) + length + (checksum ? sizeof(*checksum) : 0);
+
+   SendBatch &batch = m_send_batches[dest_proc];
+   SendCounters &counters = m_send_counters[dest_proc];
+
+   counters.packets ++;
+
+   if ( (m_send_batch_delay > 0) && (pkt_len <= m_send_batch_size) )
+   {
+      if (batch.length + pkt_len > m_send_batch_size)
+         flushSendBatch(dest_proc);
+
+      bool first_packet = (batch.length == 0);
+
+      Byte *pos = batch.data + batch.length;
+      memcpy(pos, header, sizeof(header));
+      memcpy(pos + sizeof(header), buffer, length);
+      if (checksum)
+         memcpy(pos + sizeof(header) + length, checksum, sizeof(*checksum));
+
+      batch.length += pkt_len;
+      batch.num_packets ++;
 
-      m_transport->m_send_locks[dest_proc].acquire();
-      m_transport->m_send_sockets[dest_proc].send(pkt_buff, pkt_len);
-      m_transport->m_send_locks[dest_proc].release();
+      // The flush thread sends the batch if it is not full by then
+      if (first_packet)
+         armFlushTimer();
+   }
+   else
+   {
+      // Keep packets to the same process in order
+      flushSendBatch(dest_proc);
+
+      // Send the header and the caller's buffer without copying them together
+      struct iovec iov[3];
+      iov[0].iov_base = header;
+      iov[0].iov_len = sizeof(header);
+      iov[1].iov_base = (void*) buffer;
+      iov[1].iov_len = length;
+      iov[2].iov_base = (void*) checksum;
+      iov[2].iov_len = checksum ? sizeof(*checksum) : 0;
+
+      m_send_sockets[dest_proc].send(iov, checksum ? 3 : 2);
+      counters.syscalls ++;
+   }
+}
+
+// Must be called with m_send_locks[dest_proc] held
+void SockTransport::flushSendBatch(SInt32 dest_proc)
+{
+   SendBatch &batch = m_send_batches[dest_proc];
+   if (batch.length == 0)
+      return;
+
+   m_send_sockets[dest_proc].send(batch.data, batch.length);
+
+   SendCounters &counters = m_send_counters[dest_proc];
+   counters.syscalls ++;
+   counters.batches ++;
+   counters.batched_packets += batch.num_packets;
+
+   batch.length = 0;
+   batch.num_packets = 0;
+}
 
-      delete [] pkt_buff;
+void SockTransport::flushAllSendBatches()
+{
+   if (m_send_batch_delay == 0)
+      return;
+
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      ScopedLock sl(m_send_locks[proc]);
+      flushSendBatch(proc);
    }
+}
 
-   LOG_PRINT("Message sent.");
+void SockTransport::armFlushTimer()
+{
+   // Only the first batch started since the last expiry arms the timer;
+   // every batch pending when it fires gets flushed
+   if (!__sync_bool_compare_and_swap(&m_flush_timer_armed, 0, 1))
+      return;
+
+   struct itimerspec timeout;
+   memset(&timeout, 0, sizeof(timeout));
+   timeout.it_value.tv_sec = m_send_batch_delay / 1000000;
+   timeout.it_value.tv_nsec = (m_send_batch_delay % 1000000) * 1000;
+
+   __attribute__((unused)) SInt32 err = timerfd_settime(m_flush_timer_fd, 0, &timeout, NULL);
+   LOG_ASSERT_ERROR(err >= 0, "Failed to arm send batch flush timer");
+}
+
+// Only process 0 writes the summary. The other processes send it theirs
+// when asked to, as in TileManager::outputSummary
+void SockTransport::outputSummary(std::ostream &out)
+{
+   std::ostringstream summary;
+   outputProcessSummary(summary);
+
+   Node *global_node = getGlobalNode();
+
+   if (m_proc_index != 0)
+   {
+      Byte *buf = global_node->recv();
+      assert(*((SInt32*) buf) == m_proc_index);
+      global_node->releaseBuffer(buf);
+
+      string str = summary.str();
+      global_node->globalSend(0, str.c_str(), str.length() + 1);
+      return;
+   }
+
+   out << summary.str();
+   for (SInt32 proc = 1; proc < m_num_procs; proc++)
+   {
+      global_node->globalSend(proc, &proc, sizeof(proc));
+
+      Byte *buf = global_node->recv();
+      out << (char*) buf;
+      global_node->releaseBuffer(buf);
+   }
+}
+
+void SockTransport::outputProcessSummary(std::ostream &out)
+{
+   SendCounters total;
+   memset(&total, 0, sizeof(total));
+   for (SInt32 proc = 0; proc < m_num_procs; proc++)
+   {
+      ScopedLock sl(m_send_locks[proc]);
+      total.packets += m_send_counters[proc].packets;
+      total.syscalls += m_send_counters[proc].syscalls;
+      total.batches += m_send_counters[proc].batches;
+      total.batched_packets += m_send_counters[proc].batched_packets;
+   }
+
+   out << "Transport summary (process " << m_proc_index << "):" << std::endl;
+   out << "    Remote Packets Sent: " << total.packets << std::endl;
+   out << "    Send Syscalls: " << total.syscalls << std::endl;
+   out << "    Send Syscalls Saved: " << (total.packets - total.syscalls) << std::endl;
+   out << "    Send Batches: " << total.batches << std::endl;
+   if (total.batches > 0)
+   {
+      out << "    Average Batch Size (in packets): " <<
+         ((float) total.batched_packets) / total.batches << std::endl;
+   }
 }
 
 // -- Socket
@@ -573,6 +897,35 @@ void SockTransport::Socket::send(const void* buffer, UInt32 length)
    LOG_ASSERT_ERROR(sent == SInt32(length), "Failure sending packet on socket %d -- %d != %d", m_socket, sent, length);
 }
 
+void SockTransport::Socket::send(struct iovec *iov, SInt32 iov_count)
+{
+   struct msghdr msg;
+   memset(&msg, 0, sizeof(msg));
+   msg.msg_iov = iov;
+   msg.msg_iovlen = iov_count;
+
+   while (msg.msg_iovlen > 0)
+   {
+      SInt32 sent = ::sendmsg(m_socket, &msg, 0);
+      LOG_ASSERT_ERROR(sent >= 0 || errno == EINTR, "Failure sending packet on socket %d -- errno(%i)", m_socket, errno);
+      if (sent < 0)
+         continue;
+
+      // Skip over what has been sent in case of a partial write
+      while ((msg.msg_iovlen > 0) && ((size_t) sent >= msg.msg_iov->iov_len))
+      {
+         sent -= msg.msg_iov->iov_len;
+         msg.msg_iov ++;
+         msg.msg_iovlen --;
+      }
+      if (msg.msg_iovlen > 0)
+      {
+         msg.msg_iov->iov_base = (Byte*) msg.msg_iov->iov_base + sent;
+         msg.msg_iov->iov_len -= sent;
+      }
+   }
+}
+
 bool SockTransport::Socket::recv(void *buffer, UInt32 length, bool block)
 {
    SInt32 recvd;
@@ -616,6 +969,32 @@ bool SockTransport::Socket::recv(void *buffer, UInt32 length, bool block)
    }
 }
 
+in_addr_t SockTransport::Socket::getPeerAddress() const
+{
+   struct sockaddr_in saddr;
+   socklen_t saddr_len = sizeof(saddr);
+   __attribute__((unused)) SInt32 err = getpeername(m_socket, (struct sockaddr*) &saddr, &saddr_len);
+   LOG_ASSERT_ERROR(err >= 0, "Failed to get peer address of socket(%i), errno(%i)", m_socket, errno);
+   return saddr.sin_addr.s_addr;
+}
+
+SInt32 SockTransport::Socket::recvAvailable(void *buffer, UInt32 length)
+{
+   while (true)
+   {
+      SInt32 recvd = ::recv(m_socket, buffer, length, MSG_DONTWAIT);
+
+      if (recvd > 0)
+         return recvd;
+      else if (recvd == 0)
+         return -1;
+      else if (errno == EAGAIN || errno == EWOULDBLOCK)
+         return 0;
+
+      LOG_ASSERT_ERROR(errno == EINTR, "Error on socket(%i): errno(%i)", m_socket, errno);
+   }
+}
+
 void SockTransport::Socket::close()
 {
    LOG_PRINT("Closing socket: %d", m_socket);
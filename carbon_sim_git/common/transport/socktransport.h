@@ -6,6 +6,10 @@
 #include "semaphore.h"
 
 #include <list>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+// #define __CHECKSUM_ENABLED__     1
 
 class SockTransport : public Transport
 {
@@ -35,7 +39,12 @@ public:
    void barrier();
    Node *getGlobalNode();
 
-private:
+   void outputSummary(std::ostream &out);
+
+protected:
+   // Summary of the current process
+   virtual void outputProcessSummary(std::ostream &out);
+
    struct Packet
    {
       UInt32 length;
@@ -57,10 +66,22 @@ private:
    void initBufferLists();
    void insertInBufferList(SInt32 tag, Byte *buffer, Header* header = NULL);
 
+   virtual void sendRemote(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length, const UInt64 *checksum);
+   void sendRemoteLocked(SInt32 dest_proc, SInt32 tag, const void *buffer, UInt32 length, const UInt64 *checksum);
+   virtual void sendBarrierMessage(SInt32 dest_proc);
+   void flushSendBatch(SInt32 dest_proc);
+   void flushAllSendBatches();
+   void armFlushTimer();
+
    static void updateThreadFunc(void *vp);
-   void updateBufferLists();
+   static void flushThreadFunc(void *vp);
+   void terminateFlushThread();
+   bool updateBufferList(SInt32 proc);
+   bool processRecvBuffer(SInt32 proc);
    void terminateUpdateThread();
 
+   bool isOnLocalHost(SInt32 proc);
+
    class Socket
    {
    public:
@@ -75,7 +96,14 @@ private:
       void connect(const char *addr, SInt32 port);
 
       void send(const void* buffer, UInt32 length);
+      void send(struct iovec *iov, SInt32 iov_count);
       bool recv(void *buffer, UInt32 length, bool block);
+      // Reads whatever is available without blocking. Returns the number
+      // of bytes read, 0 if none are available and -1 if the peer closed
+      SInt32 recvAvailable(void *buffer, UInt32 length);
+
+      SInt32 getFd() const { return m_socket; }
+      in_addr_t getPeerAddress() const;
 
       void close();
 
@@ -85,6 +113,34 @@ private:
       SInt32 m_socket;
    };
 
+   // Bytes read from a peer that have not been framed into packets yet.
+   // Packets are parsed in place; [head, tail) holds the pending bytes
+   struct RecvBuffer
+   {
+      Byte *data;
+      UInt32 capacity;
+      UInt32 head;
+      UInt32 tail;
+   };
+
+   // Small packets to the same process are coalesced and sent with a
+   // single syscall once the batch fills up or the flush timer expires
+   struct SendBatch
+   {
+      Byte *data;
+      UInt32 length;
+      UInt32 num_packets;
+   };
+
+   // Per-destination send statistics
+   struct SendCounters
+   {
+      UInt64 packets;
+      UInt64 syscalls;
+      UInt64 batches;
+      UInt64 batched_packets;
+   };
+
    enum UpdateThreadState
    {
       RUNNING,
@@ -93,6 +149,9 @@ private:
    };
 
    static const SInt32 DEFAULT_BASE_PORT = 2000;
+   static const SInt32 DEFAULT_RECV_BUFFER_SIZE = 65536;
+   static const SInt32 DEFAULT_SEND_BATCH_SIZE = 8192;
+   static const SInt32 DEFAULT_SEND_BATCH_DELAY = 0;
    static const SInt32 GLOBAL_TAG = -1;
    static const SInt32 BARRIER_TAG = -2;
    static const SInt32 TERMINATE_TAG = -3;
@@ -106,13 +165,26 @@ private:
    Semaphore m_barrier_sem;
 
    Socket m_server_socket;
-   Lock *m_recv_locks;
    Socket *m_recv_sockets;
+   RecvBuffer *m_recv_buffers;
+   // Data packets received from every process through its socket
+   volatile UInt64 *m_recv_packet_counts;
+   SInt32 m_epoll_fd;
    Lock *m_send_locks;
    Socket *m_send_sockets;
+   SendBatch *m_send_batches;
+   SendCounters *m_send_counters;
+
+   // Batching is disabled when the delay is zero
+   UInt32 m_send_batch_size;
+   UInt32 m_send_batch_delay;    // In microseconds
+   SInt32 m_flush_timer_fd;
+   volatile SInt32 m_flush_timer_armed;
 
    Thread *m_update_thread;
-   UpdateThreadState m_update_thread_state;
+   volatile UpdateThreadState m_update_thread_state;
+   Thread *m_flush_thread;
+   volatile UpdateThreadState m_flush_thread_state;
 
    typedef std::list<Byte*> buffer_list;
    SInt32 m_num_lists;
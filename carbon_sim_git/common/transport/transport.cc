@@ -6,7 +6,10 @@
 #include "smtransport.h"
 //#include "mpitransport.h"
 #include "socktransport.h"
+#include "shmtransport.h"
+#include "ringtransport.h"
 
+#include "simulator.h"
 #include "config.h"
 #include "log.h"
 
@@ -20,13 +23,24 @@ Transport::Transport()
 
 Transport* Transport::create()
 {
-   // dynamically choose the transport based on number of processes
-   // this is required since MPICH seems to break in single-process mode
+   // choose the transport from the config file. 'shared_memory' and
+   // 'ring' only work with a single process
 
    assert(m_singleton == NULL);
 
-   if (true)
+   std::string type = Sim()->getCfg()->getString("transport/type", "socket");
+
+   if (type == "socket")
       m_singleton = new SockTransport();
+
+   else if (type == "shm")
+      m_singleton = new ShmTransport();
+
+   else if (type == "shared_memory")
+      m_singleton = new SmTransport();
+
+   else if (type == "ring")
+      m_singleton = new RingTransport();
    
    // else if (Config::getSingleton()->getProcessCount() == 1)
    //    m_singleton = new SmTransport();
@@ -35,7 +49,7 @@ Transport* Transport::create()
    //    m_singleton = new MpiTransport();
    
    else
-      LOG_PRINT_ERROR("Negative no. processes ?!");
+      LOG_PRINT_ERROR("Unrecognized transport type(%s)", type.c_str());
 
    return m_singleton;
 }
@@ -4,6 +4,7 @@
 #include "fixed_types.h"
 
 #include <map>
+#include <iostream>
 
 class Transport
 {
@@ -19,6 +20,8 @@ public:
       virtual void send(tile_id_t dest, const void *buffer, UInt32 length) = 0;
       virtual Byte* recv() = 0;
       virtual bool query() = 0;
+      // Buffers returned by recv() must be handed back here
+      virtual void releaseBuffer(Byte *buffer) { delete [] buffer; }
 
    protected:
       tile_id_t getTileId();
@@ -36,6 +39,8 @@ public:
    virtual void barrier() = 0;
    virtual Node* getGlobalNode() = 0; // for communication not linked to a tile
 
+   virtual void outputSummary(std::ostream &out) { }
+
 protected:
    Transport();
 
@@ -46,6 +46,8 @@ int CarbonStartSim(int argc, char **argv)
    {
       // Main process
       Sim()->getTileManager()->initializeThread(Tile::getMainCoreId(0));
+      // Set the CoreState to 'RUNNING' (as for the threads spawned later)
+      Sim()->getTileManager()->getCurrentCore()->setState(Core::RUNNING);
    
       CarbonSpawnThreadSpawner();
 
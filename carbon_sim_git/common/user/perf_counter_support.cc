@@ -56,6 +56,48 @@ void CarbonDisableModels()
    }
 } 
 
+void CarbonCheckpoint()
+{
+   bool save = false;
+   bool restore = false;
+   string file_name;
+   try
+   {
+      save = Sim()->getCfg()->getBool("checkpoint/save", false);
+      restore = Sim()->getCfg()->getBool("checkpoint/restore", false);
+      file_name = Sim()->getCfg()->getString("checkpoint/file", "./checkpoint");
+   }
+   catch (...)
+   {
+      LOG_PRINT_ERROR("Could not read [checkpoint] from the cfg file");
+   }
+   LOG_ASSERT_ERROR(!(save && restore), "checkpoint/save and checkpoint/restore are both set");
+   if (!save && !restore)
+      return;
+
+   // Acquire & Release a barrier: no memory request is in flight past it
+   CarbonBarrierWait(&models_barrier);
+
+   if (Sim()->getTileManager()->getCurrentTileIndex() == 0)
+   {
+      if (save)
+      {
+         fprintf(stderr, "[[Graphite]] --> [ Saving Model State to %s ]\n", file_name.c_str());
+         Simulator::checkpointCurrentProcess(file_name);
+      }
+      else
+      {
+         fprintf(stderr, "[[Graphite]] --> [ Restoring Model State from %s ]\n", file_name.c_str());
+         // The models were left disabled until here (see routine_replace.cc)
+         Simulator::restoreCurrentProcess(file_name);
+         Simulator::enablePerformanceModelsInCurrentProcess();
+      }
+   }
+
+   // Acquire & Release a barrier again
+   CarbonBarrierWait(&models_barrier);
+}
+
 void CarbonResetCacheCounters()
 {
    UInt32 msg = MCP_MESSAGE_RESET_CACHE_COUNTERS;
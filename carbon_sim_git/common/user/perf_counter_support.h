@@ -8,6 +8,9 @@ extern "C" {
 void CarbonInitModels(void);
 void CarbonEnableModels(void);
 void CarbonDisableModels(void);
+// Saves or restores the state of the models at this point, as set by
+// [checkpoint] in the cfg file. Must be called by all the threads
+void CarbonCheckpoint(void);
 
 void CarbonResetCacheCounters(void);
 void CarbonDisableCacheCounters(void);
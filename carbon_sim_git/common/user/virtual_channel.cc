@@ -98,7 +98,7 @@ bool VirtualChannel::send_message(int payload_byte, int message_signature_byte,
   CAPI_return_t ret = CAPI_message_send_w_ex((CAPI_endpoint_t) owner_tile_id, (CAPI_endpoint_t) CAPI_ENDPOINT_ALL, (char *) msg, sizeof(Message), CARBON_NET_USER_1);
   if(ret == 0) //Successful transfer.
      return true;
-  else //Either core is not initialized or size of sent and msg are different.
-     return false; //ret == -1 if size mismatch. otherwise ret == CAPI_ReceiverNotInitialized.
+  else //Either core is not initialized, size of sent and msg are different or a lambda queue is full (retry later).
+     return false; //ret == -1 if size mismatch or no lambda queue credits. otherwise ret == CAPI_ReceiverNotInitialized.
 }
 
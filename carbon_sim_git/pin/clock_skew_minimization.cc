@@ -3,6 +3,7 @@
 #include "tile_manager.h"
 #include "tile.h"
 #include "clock_skew_minimization_object.h"
+#include "network.h"
 
 static bool enabled()
 {
@@ -20,6 +21,9 @@ void handlePeriodicSync()
       return;
    }
 
+   // Route the packets the network event engines held back for this clock
+   Network::synchronizeEventEngines(tile->getId());
+
    ClockSkewMinimizationClient *client = tile->getCore()->getClockSkewMinimizationClient();
 
    if (client)
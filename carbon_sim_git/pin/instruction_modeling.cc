@@ -6,14 +6,12 @@
 #include "tile_manager.h"
 #include "tile.h"
 
-void handleBasicBlock(BasicBlock *sim_basic_block)
+void handleBasicBlock(BasicBlock *sim_basic_block, BOOL flush)
 {
    CoreModel *prfmdl = Sim()->getTileManager()->getCurrentCore()->getPerformanceModel();
 
-   prfmdl->queueBasicBlock(sim_basic_block);
-
-   //FIXME: put this in a thread
-   prfmdl->iterate();
+   // Modeled in batches, see CoreModel::traceBasicBlock()
+   prfmdl->traceBasicBlock(sim_basic_block, flush);
 }
 
 void handleBranch(BOOL taken, ADDRINT target)
@@ -22,7 +20,7 @@ void handleBranch(BOOL taken, ADDRINT target)
    CoreModel *prfmdl = Sim()->getTileManager()->getCurrentCore()->getPerformanceModel();
 
    DynamicInstructionInfo info = DynamicInstructionInfo::createBranchInfo(taken, target);
-   prfmdl->pushDynamicInstructionInfo(info);
+   prfmdl->traceDynamicInstructionInfo(info);
 }
 
 void fillOperandListMemOps(OperandList *list, INS ins)
@@ -199,6 +197,12 @@ VOID addInstructionModeling(INS ins)
 
    basic_block->front()->setAddress(INS_Address(ins));
    basic_block->front()->setSize(INS_Size(ins));
+   basic_block->decode();
+
+   // Replaced routines and syscalls read the cycle count of the core, so all
+   // the instructions before them must have been modeled. Memory accesses
+   // drain the buffer themselves (MainCore::initiateMemoryAccess)
+   BOOL flush = INS_IsCall(ins) || INS_IsSyscall(ins);
 
-   INS_InsertCall(ins, IPOINT_BEFORE, AFUNPTR(handleBasicBlock), IARG_PTR, basic_block, IARG_END);
+   INS_InsertCall(ins, IPOINT_BEFORE, AFUNPTR(handleBasicBlock), IARG_PTR, basic_block, IARG_BOOL, flush, IARG_END);
 }
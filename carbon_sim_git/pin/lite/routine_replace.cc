@@ -48,6 +48,20 @@ void routineCallback(RTN rtn, void* v)
             IARG_END);
    }
 
+   // Checkpoint
+   if (rtn_name == "CarbonCheckpoint")
+   {
+      PROTO proto = PROTO_Allocate(PIN_PARG(void),
+            CALLINGSTD_DEFAULT,
+            "CarbonCheckpoint",
+            PIN_PARG_END());
+
+      RTN_ReplaceSignature(rtn,
+            AFUNPTR(CarbonCheckpoint),
+            IARG_PROTOTYPE, proto,
+            IARG_END);
+   }
+
    // _start
    if (rtn_name == "_start")
    {
@@ -65,8 +79,9 @@ void routineCallback(RTN rtn, void* v)
    {
       RTN_Open(rtn);
 
-      // Before main()
-      if (! Sim()->getCfg()->getBool("general/trigger_models_within_application", false))
+      // Before main(). When restoring a checkpoint, CarbonCheckpoint() enables the models
+      if (! Sim()->getCfg()->getBool("general/trigger_models_within_application", false) &&
+          ! Sim()->getCfg()->getBool("checkpoint/restore", false))
       {
          RTN_InsertCall(rtn, IPOINT_BEFORE,
                AFUNPTR(Simulator::enablePerformanceModelsInCurrentProcess),
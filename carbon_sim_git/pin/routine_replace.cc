@@ -92,6 +92,7 @@ bool replaceUserAPIFunction(RTN& rtn, string& name)
    // Enable/Disable/Reset Models
    else if (name == "CarbonEnableModels") msg_ptr = AFUNPTR(replacementEnableModels);
    else if (name == "CarbonDisableModels") msg_ptr = AFUNPTR(replacementDisableModels);
+   else if (name == "CarbonCheckpoint") msg_ptr = AFUNPTR(replacementCarbonCheckpoint);
 
    // Resetting Cache Counters
    else if (name == "CarbonResetCacheCounters") msg_ptr = AFUNPTR(replacementResetCacheCounters);
@@ -126,8 +127,9 @@ bool replaceUserAPIFunction(RTN& rtn, string& name)
    {
       RTN_Open (rtn);
 
-      // Before main()
-      if (! Sim()->getCfg()->getBool("general/trigger_models_within_application",false))
+      // Before main(). When restoring a checkpoint, CarbonCheckpoint() enables the models
+      if (! Sim()->getCfg()->getBool("general/trigger_models_within_application",false) &&
+          ! Sim()->getCfg()->getBool("checkpoint/restore",false))
       {
          RTN_InsertCall(rtn, IPOINT_BEFORE,
                AFUNPTR(Simulator::enablePerformanceModelsInCurrentProcess),
@@ -957,6 +959,14 @@ void replacementDisableModels(CONTEXT* ctxt)
    retFromReplacedRtn(ctxt, ret_val);
 }
 
+void replacementCarbonCheckpoint(CONTEXT* ctxt)
+{
+   CarbonCheckpoint();
+
+   ADDRINT ret_val = PIN_GetContextReg(ctxt, REG_GAX);
+   retFromReplacedRtn(ctxt, ret_val);
+}
+
 void replacementResetCacheCounters (CONTEXT *ctxt)
 {
    CarbonResetCacheCounters();
@@ -61,6 +61,7 @@ void replacementPthreadExitNull(CONTEXT *ctxt);
 // Enable/Disable Models
 void replacementEnableModels(CONTEXT* ctxt);
 void replacementDisableModels(CONTEXT* ctxt);
+void replacementCarbonCheckpoint(CONTEXT* ctxt);
 
 // Cache Counters
 void replacementResetCacheCounters(CONTEXT *ctxt);
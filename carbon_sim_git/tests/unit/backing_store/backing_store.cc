@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+using std::map;
+using std::vector;
+
+#include "paged_backing_store.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Fill and writeback throughput of the DRAM controller's functional memory:
+// PagedBackingStore against the map of individually allocated lines it
+// replaced. Lines are picked at random from a 64 MB region (the store is
+// shared by all the DRAM controllers of a process, so it sees all of them),
+// and the contents of the two stores are compared at the end.
+
+#define CACHE_LINE_SIZE    64
+#define REGION_LINES       (1 << 20)
+#define NUM_ACCESSES       (1 << 22)
+
+// The store the DRAM controller used to have
+class MapStore
+{
+public:
+   ~MapStore()
+   {
+      for (map<IntPtr, Byte*>::iterator it = _data_map.begin(); it != _data_map.end(); it++)
+         delete [] it->second;
+   }
+
+   Byte* getLine(IntPtr address)
+   {
+      if (_data_map[address] == NULL)
+      {
+         _data_map[address] = new Byte[CACHE_LINE_SIZE];
+         memset((void*) _data_map[address], 0x00, CACHE_LINE_SIZE);
+      }
+      return _data_map[address];
+   }
+
+private:
+   map<IntPtr, Byte*> _data_map;
+};
+
+template <class Store>
+static UInt64 runAccesses(Store& store, const vector<IntPtr>& addresses)
+{
+   Byte data_buf[CACHE_LINE_SIZE];
+
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      IntPtr address = addresses[i];
+      // Fill, then write back a modified line
+      memcpy(data_buf, store.getLine(address), CACHE_LINE_SIZE);
+      data_buf[i % CACHE_LINE_SIZE] ++;
+      memcpy(store.getLine(address), data_buf, CACHE_LINE_SIZE);
+   }
+   return getTimeInUs() - start_time;
+}
+
+// Returns whether both stores end up with the same contents
+static bool benchmark(const vector<IntPtr>& addresses)
+{
+   MapStore map_store;
+   UInt64 map_time = runAccesses(map_store, addresses);
+
+   PagedBackingStore paged_store;
+   UInt64 paged_time = runAccesses(paged_store, addresses);
+
+   bool passed = true;
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      if (memcmp(map_store.getLine(addresses[i]), paged_store.getLine(addresses[i]), CACHE_LINE_SIZE) != 0)
+      {
+         printf("Contents differ at Address(%#llx)\n", (unsigned long long) addresses[i]);
+         passed = false;
+         break;
+      }
+   }
+
+   printf("Map: %.1f M accesses/s, Paged: %.1f M accesses/s, Speedup(%.2f)\n",
+          2.0 * NUM_ACCESSES / map_time, 2.0 * NUM_ACCESSES / paged_time,
+          ((double) map_time) / paged_time);
+
+   return passed;
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   // Lines spread over a heap-like region
+   IntPtr base_address = 0x7f0000000000ULL;
+   vector<IntPtr> addresses(NUM_ACCESSES);
+   srand(1);
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      UInt32 line = rand() % REGION_LINES;
+      addresses[i] = base_address + ((IntPtr) line) * CACHE_LINE_SIZE;
+   }
+
+   // The stores log when they are destroyed, before the simulator is
+   bool passed = benchmark(addresses);
+
+   CarbonStopSim();
+
+   printf(passed ? "Backing Store test passed\n" : "Backing Store test failed\n");
+   return passed ? 0 : 1;
+}
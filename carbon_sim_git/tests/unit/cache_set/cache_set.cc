@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+using std::vector;
+
+#include "cache_set.h"
+#include "cache_line_info.h"
+#include "cache_replacement_policy.h"
+#include "pr_l1_pr_l2_dram_directory_msi/cache_level.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Lookup and insert throughput of the tag stores of the L2 caches (512 KB,
+// 64 byte lines) of NUM_TILES tiles for CacheSet, with its storage laid out the way Cache allocates it
+// (cache-wide tag, state and data arrays), and for the layout CacheSet used
+// to have: every set allocating its own data and an array of pointers to
+// individually allocated CacheLineInfo objects that are dereferenced for
+// every way compared.
+
+#define CACHE_SIZE         512      // In KB
+#define CACHE_LINE_SIZE    64       // In Bytes
+#define NUM_TILES          64
+#define NUM_LOOKUPS        (1 << 24)
+#define NUM_INSERTS        (1 << 22)
+
+// Set with the old layout
+class PointerCacheSet
+{
+public:
+   PointerCacheSet(UInt32 set_num, CacheReplacementPolicy* replacement_policy, UInt32 associativity)
+      : _set_num(set_num)
+      , _replacement_policy(replacement_policy)
+      , _associativity(associativity)
+   {
+      _cache_line_info_array = new CacheLineInfo*[_associativity];
+      for (UInt32 i = 0; i < _associativity; i++)
+         _cache_line_info_array[i] = CacheLineInfo::create(PR_L1_PR_L2_DRAM_DIRECTORY_MSI, PrL1PrL2DramDirectoryMSI::L2);
+      _lines = new char[_associativity * CACHE_LINE_SIZE];
+      memset(_lines, 0x00, _associativity * CACHE_LINE_SIZE);
+      // Only kept for the replacement policy
+      _tags = new IntPtr[_associativity];
+      for (UInt32 i = 0; i < _associativity; i++)
+         _tags[i] = _cache_line_info_array[i]->getTag();
+   }
+   ~PointerCacheSet()
+   {
+      for (UInt32 i = 0; i < _associativity; i++)
+         delete _cache_line_info_array[i];
+      delete [] _cache_line_info_array;
+      delete [] _lines;
+      delete [] _tags;
+   }
+
+   CacheLineInfo* find(IntPtr tag)
+   {
+      for (SInt32 index = _associativity-1; index >= 0; index--)
+      {
+         if (_cache_line_info_array[index]->getTag() == tag)
+            return _cache_line_info_array[index];
+      }
+      return NULL;
+   }
+
+   void insert(CacheLineInfo* inserted_cache_line_info, CacheLineInfo* evicted_cache_line_info)
+   {
+      UInt32 index = _replacement_policy->getReplacementWay(_cache_line_info_array, _tags, _set_num);
+      if (_cache_line_info_array[index]->isValid())
+         evicted_cache_line_info->assign(_cache_line_info_array[index]);
+      _cache_line_info_array[index]->assign(inserted_cache_line_info);
+      _tags[index] = inserted_cache_line_info->getTag();
+      _replacement_policy->update(_cache_line_info_array, _set_num, index);
+   }
+
+private:
+   CacheLineInfo** _cache_line_info_array;
+   char* _lines;
+   IntPtr* _tags;
+   UInt32 _set_num;
+   CacheReplacementPolicy* _replacement_policy;
+   UInt32 _associativity;
+};
+
+// Addresses touching 2x the capacity, so about half the lookups miss
+static void generateAddresses(vector<IntPtr>& addresses, UInt32 num_lines)
+{
+   for (UInt32 i = 0; i < addresses.size(); i++)
+      addresses[i] = ((IntPtr) (rand() % (2 * num_lines))) * CACHE_LINE_SIZE;
+}
+
+template <class Set>
+static UInt64 runLookups(vector<Set*>& sets, const vector<IntPtr>& addresses, UInt32 num_sets)
+{
+   UInt64 hits = 0;
+   for (UInt32 i = 0; i < NUM_LOOKUPS; i++)
+   {
+      IntPtr line = addresses[i % addresses.size()] / CACHE_LINE_SIZE;
+      if (sets[line % num_sets]->find(line / num_sets))
+         hits ++;
+   }
+   return hits;
+}
+
+static void benchmark(UInt32 associativity)
+{
+   // The sets of all the tiles are indexed as if they were one big cache
+   UInt32 num_lines = NUM_TILES * CACHE_SIZE * 1024 / CACHE_LINE_SIZE;
+   UInt32 num_sets = num_lines / associativity;
+
+   CacheReplacementPolicy* replacement_policy = CacheReplacementPolicy::create("lru", NUM_TILES * CACHE_SIZE, associativity, CACHE_LINE_SIZE);
+
+   // Storage allocated as in Cache::Cache()
+   IntPtr* tags;
+   __attribute__((unused)) int status = posix_memalign((void**) &tags, 64, num_lines * sizeof(IntPtr));
+   UInt8* cstates = new UInt8[num_lines];
+   CacheLineInfo** cache_line_info_array = new CacheLineInfo*[num_lines];
+   char* lines = new char[num_lines * CACHE_LINE_SIZE];
+
+   vector<CacheSet*> sets(num_sets);
+   vector<PointerCacheSet*> pointer_sets(num_sets);
+   for (UInt32 i = 0; i < num_sets; i++)
+   {
+      UInt32 way_index = i * associativity;
+      sets[i] = new CacheSet(i, PR_L1_PR_L2_DRAM_DIRECTORY_MSI, PrL1PrL2DramDirectoryMSI::L2, replacement_policy,
+                             associativity, CACHE_LINE_SIZE, &tags[way_index], &cstates[way_index],
+                             &cache_line_info_array[way_index], &lines[way_index * CACHE_LINE_SIZE]);
+      pointer_sets[i] = new PointerCacheSet(i, replacement_policy, associativity);
+   }
+
+   vector<IntPtr> addresses(1 << 20);
+   generateAddresses(addresses, num_lines);
+
+   CacheLineInfo* inserted_cache_line_info = CacheLineInfo::create(PR_L1_PR_L2_DRAM_DIRECTORY_MSI, PrL1PrL2DramDirectoryMSI::L2);
+   CacheLineInfo* evicted_cache_line_info = CacheLineInfo::create(PR_L1_PR_L2_DRAM_DIRECTORY_MSI, PrL1PrL2DramDirectoryMSI::L2);
+   inserted_cache_line_info->setCState(CacheState::SHARED);
+
+   // Inserts
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_INSERTS; i++)
+   {
+      IntPtr line = addresses[i % addresses.size()] / CACHE_LINE_SIZE;
+      inserted_cache_line_info->setTag(line / num_sets);
+      bool eviction;
+      sets[line % num_sets]->insert(inserted_cache_line_info, NULL, &eviction, evicted_cache_line_info, NULL);
+   }
+   UInt64 insert_time = getTimeInUs() - start_time;
+
+   start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_INSERTS; i++)
+   {
+      IntPtr line = addresses[i % addresses.size()] / CACHE_LINE_SIZE;
+      inserted_cache_line_info->setTag(line / num_sets);
+      pointer_sets[line % num_sets]->insert(inserted_cache_line_info, evicted_cache_line_info);
+   }
+   UInt64 pointer_insert_time = getTimeInUs() - start_time;
+
+   // Lookups
+   generateAddresses(addresses, num_lines);
+
+   start_time = getTimeInUs();
+   UInt64 hits = runLookups(sets, addresses, num_sets);
+   UInt64 lookup_time = getTimeInUs() - start_time;
+
+   start_time = getTimeInUs();
+   UInt64 pointer_hits = runLookups(pointer_sets, addresses, num_sets);
+   UInt64 pointer_lookup_time = getTimeInUs() - start_time;
+
+   if (hits != pointer_hits)
+   {
+      fprintf(stderr, "Mismatch in hits: CacheSet(%llu), Pointer Layout(%llu)\n",
+              (long long unsigned int) hits, (long long unsigned int) pointer_hits);
+      exit(-1);
+   }
+
+   printf("%6u %18.2f %18.2f %18.2f %18.2f\n", associativity,
+          (double) NUM_LOOKUPS / lookup_time, (double) NUM_LOOKUPS / pointer_lookup_time,
+          (double) NUM_INSERTS / insert_time, (double) NUM_INSERTS / pointer_insert_time);
+
+   for (UInt32 i = 0; i < num_sets; i++)
+   {
+      delete sets[i];
+      delete pointer_sets[i];
+   }
+   delete [] lines;
+   delete [] cache_line_info_array;
+   delete [] cstates;
+   free(tags);
+   delete inserted_cache_line_info;
+   delete evicted_cache_line_info;
+   delete replacement_policy;
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   printf("Throughput in millions of operations per second\n");
+   printf("%6s %18s %18s %18s %18s\n", "Assoc", "Lookup (CacheSet)", "Lookup (Pointers)",
+          "Insert (CacheSet)", "Insert (Pointers)");
+
+   srand(1);
+   for (UInt32 associativity = 4; associativity <= 16; associativity *= 2)
+      benchmark(associativity);
+
+   CarbonStopSim();
+   return 0;
+}
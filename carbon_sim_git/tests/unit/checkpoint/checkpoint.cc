@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <sstream>
+
+#include "tile.h"
+#include "core.h"
+#include "core_model.h"
+#include "mem_component.h"
+#include "memory_manager.h"
+#include "cache.h"
+#include "tile_manager.h"
+#include "simulator.h"
+#include "config.h"
+
+#include "carbon_user.h"
+#include "fixed_types.h"
+
+using namespace std;
+
+// Saves the state of the models, changes the caches through both tiles
+// (leaving the memory with the same values, as a run that reaches the
+// checkpoint again would) and restores it: the caches, the counters and the
+// clock of the cores are back to what they were at the checkpoint. The hash
+// of the memory follows the values, not where the dirty lines are
+
+#define NUM_ADDRESSES      64
+#define NUM_TILES          2
+
+static IntPtr getAddress(UInt32 i)
+{
+   // Spread over several DRAM pages and cache sets
+   return 0x100000 + i * 0x1040;
+}
+
+static void writeAll(Core* core, UInt32 base_val)
+{
+   for (UInt32 i = 0; i < NUM_ADDRESSES; i++)
+   {
+      UInt32 val = base_val + i;
+      core->initiateMemoryAccess(MemComponent::L1_DCACHE, Core::NONE, Core::WRITE, getAddress(i), (Byte*) &val, sizeof(val), true);
+   }
+}
+
+static void checkAll(Core* core, UInt32 base_val)
+{
+   for (UInt32 i = 0; i < NUM_ADDRESSES; i++)
+   {
+      UInt32 val = 0;
+      core->initiateMemoryAccess(MemComponent::L1_DCACHE, Core::NONE, Core::READ, getAddress(i), (Byte*) &val, sizeof(val), true);
+      LOG_ASSERT_ERROR(val == base_val + i, "Address(%#lx): read(%u), expected(%u)", getAddress(i), val, base_val + i);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   printf("Starting (checkpoint)\n");
+   CarbonStartSim(argc, argv);
+
+   Simulator::enablePerformanceModelsInCurrentProcess();
+
+   Core* cores[NUM_TILES];
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+      cores[j] = Sim()->getTileManager()->getTileFromID(j)->getCore();
+
+   // Tile 0 writes the values, tile 1 reads them (and shares the lines)
+   writeAll(cores[0], 1000);
+   checkAll(cores[1], 1000);
+
+   UInt64 l1_dcache_accesses[NUM_TILES];
+   UInt64 l1_dcache_misses[NUM_TILES];
+   UInt64 cycle_count[NUM_TILES];
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+   {
+      l1_dcache_accesses[j] = cores[j]->getMemoryManager()->getL1DCache()->getTotalAccesses();
+      l1_dcache_misses[j] = cores[j]->getMemoryManager()->getL1DCache()->getTotalMisses();
+      cycle_count[j] = cores[j]->getPerformanceModel()->getCycleCount();
+   }
+
+   ostringstream file_name;
+   file_name << "/tmp/graphite_checkpoint_test." << getpid();
+   Simulator::checkpointCurrentProcess(file_name.str());
+   UInt64 memory_hash = Simulator::hashMemoryOfCurrentProcess();
+
+   // Tile 1 overwrites the values, then writes the old ones back: the lines
+   // are now dirty in tile 1
+   writeAll(cores[1], 2000);
+   checkAll(cores[0], 2000);
+   LOG_ASSERT_ERROR(Simulator::hashMemoryOfCurrentProcess() != memory_hash,
+                    "Memory hash(%#llx) did not change with the values", memory_hash);
+   writeAll(cores[1], 1000);
+   LOG_ASSERT_ERROR(Simulator::hashMemoryOfCurrentProcess() == memory_hash,
+                    "Memory hash(%#llx), expected(%#llx)", Simulator::hashMemoryOfCurrentProcess(), memory_hash);
+
+   Simulator::restoreCurrentProcess(file_name.str());
+
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+   {
+      Cache* l1_dcache = cores[j]->getMemoryManager()->getL1DCache();
+      LOG_ASSERT_ERROR(l1_dcache->getTotalAccesses() == l1_dcache_accesses[j],
+                       "Tile(%u): L1-D accesses(%llu), expected(%llu)", j, l1_dcache->getTotalAccesses(), l1_dcache_accesses[j]);
+      LOG_ASSERT_ERROR(l1_dcache->getTotalMisses() == l1_dcache_misses[j],
+                       "Tile(%u): L1-D misses(%llu), expected(%llu)", j, l1_dcache->getTotalMisses(), l1_dcache_misses[j]);
+      LOG_ASSERT_ERROR(cores[j]->getPerformanceModel()->getCycleCount() == cycle_count[j],
+                       "Tile(%u): cycle count(%llu), expected(%llu)", j, cores[j]->getPerformanceModel()->getCycleCount(), cycle_count[j]);
+   }
+
+   // The values written before the checkpoint are back, and both tiles
+   // still hit on the lines they had
+   checkAll(cores[0], 1000);
+   checkAll(cores[1], 1000);
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+   {
+      Cache* l1_dcache = cores[j]->getMemoryManager()->getL1DCache();
+      LOG_ASSERT_ERROR(l1_dcache->getTotalAccesses() == l1_dcache_accesses[j] + NUM_ADDRESSES,
+                       "Tile(%u): L1-D accesses(%llu), expected(%llu)",
+                       j, l1_dcache->getTotalAccesses(), l1_dcache_accesses[j] + NUM_ADDRESSES);
+      LOG_ASSERT_ERROR(l1_dcache->getTotalMisses() == l1_dcache_misses[j],
+                       "Tile(%u): L1-D misses(%llu), expected(%llu)", j, l1_dcache->getTotalMisses(), l1_dcache_misses[j]);
+   }
+
+   // One file per process
+   file_name << "." << Config::getSingleton()->getCurrentProcessNum();
+   unlink(file_name.str().c_str());
+
+   Simulator::disablePerformanceModelsInCurrentProcess();
+   CarbonStopSim();
+
+   printf("Finished (checkpoint) - SUCCESS\n");
+   return 0;
+}
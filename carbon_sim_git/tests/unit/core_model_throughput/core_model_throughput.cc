@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+using std::vector;
+
+#include "simulator.h"
+#include "tile_manager.h"
+#include "core.h"
+#include "core_model.h"
+#include "simple_core_model.h"
+#include "iocoom_core_model.h"
+#include "basic_block.h"
+#include "instruction.h"
+#include "dynamic_instruction_info.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Throughput of the simple and iocoom core models, in millions of dynamic
+// instructions modeled per second, over a synthetic mix of one-instruction
+// basic blocks (as Pin creates them): 60% ALU, 10% multiplies, 20% loads and
+// 10% stores over 32 registers. The instructions have no size so the L1-I
+// is not accessed and only the core model is measured.
+//
+// It also compares the operand handling of the iocoom model before the
+// instructions were pre-decoded (four passes over the OperandList of the
+// Instruction) with the one over the DecodedInstruction records, on the same
+// register scoreboard.
+
+#define NUM_STATIC_INSTRUCTIONS  4096
+#define NUM_DYNAMIC_INSTRUCTIONS (1 << 23)
+#define NUM_USED_REGISTERS       32
+
+static Operand reg(Operand::Direction direction)
+{
+   return Operand(Operand::REG, 1 + rand() % NUM_USED_REGISTERS, direction);
+}
+
+static BasicBlock* createBasicBlock()
+{
+   OperandList ops;
+   Instruction* instruction;
+
+   UInt32 kind = rand() % 10;
+   if (kind < 6)
+   {
+      ops.push_back(reg(Operand::READ));
+      ops.push_back(reg(Operand::READ));
+      ops.push_back(reg(Operand::WRITE));
+      instruction = new GenericInstruction(0, ops);
+   }
+   else if (kind < 7)
+   {
+      ops.push_back(reg(Operand::READ));
+      ops.push_back(reg(Operand::READ));
+      ops.push_back(reg(Operand::WRITE));
+      instruction = new ArithInstruction(INST_MUL, 0, ops);
+   }
+   else if (kind < 9)
+   {
+      ops.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
+      ops.push_back(reg(Operand::WRITE));
+      instruction = new GenericInstruction(0, ops);
+   }
+   else
+   {
+      ops.push_back(reg(Operand::READ));
+      ops.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
+      instruction = new GenericInstruction(0, ops);
+   }
+
+   BasicBlock* basic_block = new BasicBlock();
+   basic_block->push_back(instruction);
+   basic_block->decode();
+   return basic_block;
+}
+
+static double benchmark(CoreModel* core_model, const vector<BasicBlock*>& basic_blocks)
+{
+   core_model->enable();
+
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_DYNAMIC_INSTRUCTIONS; i++)
+   {
+      BasicBlock* basic_block = basic_blocks[i % basic_blocks.size()];
+
+      // Memory infos, as pushed by the memory accesses of the instruction
+      const DecodedInstruction& instruction = basic_block->getDecodedInstructions()[0];
+      for (UInt32 j = 0; j < instruction.getNumMemoryOperands(); j++)
+      {
+         IntPtr address = (IntPtr) (i * 64);
+         DynamicInstructionInfo info = DynamicInstructionInfo::createMemoryInfo(i % 4, address,
+               instruction.isMemoryWrite(j) ? Operand::WRITE : Operand::READ, 0);
+         core_model->pushDynamicInstructionInfo(info);
+      }
+
+      core_model->queueBasicBlock(basic_block);
+      core_model->iterate();
+   }
+   UInt64 elapsed_time = getTimeInUs() - start_time;
+
+   core_model->disable();
+   return (double) NUM_DYNAMIC_INSTRUCTIONS / elapsed_time;
+}
+
+// Register scoreboard updates of the iocoom model, over the OperandList as
+// the model did before the instructions were pre-decoded
+static UInt64 walkOperandList(const Instruction* instruction, vector<UInt64>& scoreboard, UInt64 time)
+{
+   const OperandList& ops = instruction->getOperands();
+   UInt64 ready = time;
+   for (unsigned int i = 0; i < ops.size(); i++)
+   {
+      const Operand& o = ops[i];
+      if ((o.m_direction != Operand::READ) || (o.m_type != Operand::REG))
+         continue;
+      if (ready < scoreboard[o.m_value])
+         ready = scoreboard[o.m_value];
+   }
+   for (unsigned int i = 0; i < ops.size(); i++)
+   {
+      const Operand& o = ops[i];
+      if (o.m_type != Operand::MEMORY)
+         continue;
+      ready += (o.m_direction == Operand::READ) ? 2 : 0;
+   }
+   for (unsigned int i = 0; i < ops.size(); i++)
+   {
+      const Operand& o = ops[i];
+      if ((o.m_direction != Operand::WRITE) || (o.m_type != Operand::REG))
+         continue;
+      scoreboard[o.m_value] = ready + 1;
+   }
+   for (unsigned int i = 0; i < ops.size(); i++)
+   {
+      const Operand& o = ops[i];
+      if ((o.m_direction != Operand::WRITE) || (o.m_type != Operand::MEMORY))
+         continue;
+      ready ++;
+   }
+   return ready;
+}
+
+// Same updates over the DecodedInstruction record
+static UInt64 walkDecodedInstruction(const DecodedInstruction& instruction, vector<UInt64>& scoreboard, UInt64 time)
+{
+   UInt64 ready = time;
+   for (UInt32 i = 0; i < instruction.getNumReadRegisters(); i++)
+   {
+      UInt32 reg = instruction.getReadRegister(i);
+      if (ready < scoreboard[reg])
+         ready = scoreboard[reg];
+   }
+   for (UInt32 i = 0; i < instruction.getNumMemoryOperands(); i++)
+      ready += instruction.isMemoryWrite(i) ? 0 : 2;
+   for (UInt32 i = 0; i < instruction.getNumWriteRegisters(); i++)
+      scoreboard[instruction.getWriteRegister(i)] = ready + 1;
+   for (UInt32 i = 0; i < instruction.getNumMemoryOperands(); i++)
+      ready += instruction.isMemoryWrite(i) ? 1 : 0;
+   return ready;
+}
+
+static double benchmarkOperands(const vector<BasicBlock*>& basic_blocks, bool decoded, UInt64& time)
+{
+   vector<UInt64> scoreboard(DecodedInstruction::NUM_REGISTERS, 0);
+
+   time = 0;
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_DYNAMIC_INSTRUCTIONS; i++)
+   {
+      BasicBlock* basic_block = basic_blocks[i % basic_blocks.size()];
+      if (decoded)
+         time = walkDecodedInstruction(basic_block->getDecodedInstructions()[0], scoreboard, time);
+      else
+         time = walkOperandList(basic_block->front(), scoreboard, time);
+   }
+   UInt64 elapsed_time = getTimeInUs() - start_time;
+
+   return (double) NUM_DYNAMIC_INSTRUCTIONS / elapsed_time;
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   srand(1);
+   vector<BasicBlock*> basic_blocks(NUM_STATIC_INSTRUCTIONS);
+   for (UInt32 i = 0; i < NUM_STATIC_INSTRUCTIONS; i++)
+      basic_blocks[i] = createBasicBlock();
+
+   Core* core = Sim()->getTileManager()->getCurrentCore();
+
+   SimpleCoreModel* simple_core_model = new SimpleCoreModel(core, 1.0);
+   IOCOOMCoreModel* iocoom_core_model = new IOCOOMCoreModel(core, 1.0);
+
+   double simple_throughput = benchmark(simple_core_model, basic_blocks);
+   double iocoom_throughput = benchmark(iocoom_core_model, basic_blocks);
+
+   printf("Throughput in millions of instructions modeled per second\n");
+   printf("%12s %12s\n", "Simple", "IOCOOM");
+   printf("%12.2f %12.2f\n", simple_throughput, iocoom_throughput);
+   printf("Cycles: Simple(%llu), IOCOOM(%llu)\n",
+          (long long unsigned int) simple_core_model->getCycleCount(),
+          (long long unsigned int) iocoom_core_model->getCycleCount());
+
+   UInt64 operand_list_time, decoded_time;
+   double operand_list_throughput = benchmarkOperands(basic_blocks, false, operand_list_time);
+   double decoded_throughput = benchmarkOperands(basic_blocks, true, decoded_time);
+   LOG_ASSERT_ERROR(operand_list_time == decoded_time,
+                    "Operand list time(%llu) != Decoded time(%llu)", operand_list_time, decoded_time);
+
+   printf("Operand handling throughput in millions of instructions per second\n");
+   printf("%12s %12s\n", "OperandList", "Decoded");
+   printf("%12.2f %12.2f\n", operand_list_throughput, decoded_throughput);
+
+   delete simple_core_model;
+   delete iocoom_core_model;
+   for (UInt32 i = 0; i < NUM_STATIC_INSTRUCTIONS; i++)
+   {
+      delete basic_blocks[i]->front();
+      delete basic_blocks[i];
+   }
+
+   CarbonStopSim();
+   return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <set>
+#include <vector>
+using std::set;
+using std::vector;
+
+#include "directory.h"
+#include "directory_entry.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Startup profile of the DRAM directories: the time to construct them and
+// the heap memory they hold, per directory type, at the default directory
+// size and with sharers tracked for up to 1024 tiles. A random sequence of
+// sharer updates is then checked against a reference set of sharers, and
+// every entry is replaced through the pool of free entries.
+
+#define TOTAL_ENTRIES         16384
+#define NUM_DIRECTORIES       16
+#define MAX_HW_SHARERS        4
+#define MAX_NUM_SHARERS       1024
+#define NUM_SHARER_UPDATES    (1 << 20)
+
+// Heap memory in use (in bytes)
+static UInt64 getHeapUsage()
+{
+   struct mallinfo info = mallinfo();
+   return ((UInt64) (UInt32) info.uordblks) + ((UInt64) (UInt32) info.hblkhd);
+}
+
+static bool checkSharers(Directory* directory, DirectoryType directory_type)
+{
+   // Full map and limitless track every sharer exactly
+   bool exact = (directory_type == FULL_MAP) || (directory_type == LIMITLESS);
+
+   vector<set<tile_id_t> > sharers(TOTAL_ENTRIES);
+   srand(1);
+   for (UInt32 i = 0; i < NUM_SHARER_UPDATES; i++)
+   {
+      SInt32 entry_num = rand() % TOTAL_ENTRIES;
+      tile_id_t sharer_id = rand() % MAX_NUM_SHARERS;
+      DirectoryEntry* directory_entry = directory->getDirectoryEntry(entry_num);
+
+      if (directory_entry->hasSharer(sharer_id))
+      {
+         directory_entry->removeSharer(sharer_id, false);
+         sharers[entry_num].erase(sharer_id);
+      }
+      else if (directory_entry->getNumSharers() < MAX_HW_SHARERS || exact)
+      {
+         if (!directory_entry->addSharer(sharer_id))
+         {
+            printf("Could not add Sharer(%i) to Entry(%i)\n", sharer_id, entry_num);
+            return false;
+         }
+         sharers[entry_num].insert(sharer_id);
+      }
+   }
+
+   for (SInt32 entry_num = 0; entry_num < TOTAL_ENTRIES; entry_num++)
+   {
+      vector<tile_id_t> sharers_list;
+      directory->getDirectoryEntry(entry_num)->getSharersList(sharers_list);
+      if (set<tile_id_t>(sharers_list.begin(), sharers_list.end()) != sharers[entry_num])
+      {
+         printf("Sharers of Entry(%i) differ\n", entry_num);
+         return false;
+      }
+   }
+   return true;
+}
+
+// Replace entries the way DirectoryCache does, recycling the replaced ones
+static bool checkReplacements(Directory* directory)
+{
+   vector<DirectoryEntry*> replaced_entries;
+   for (SInt32 entry_num = 0; entry_num < TOTAL_ENTRIES; entry_num++)
+   {
+      replaced_entries.push_back(directory->getDirectoryEntry(entry_num));
+      DirectoryEntry* directory_entry = directory->createDirectoryEntry();
+      directory_entry->setAddress(entry_num);
+      directory->setDirectoryEntry(entry_num, directory_entry);
+
+      // Allow a few outstanding replacements
+      if (replaced_entries.size() == 8)
+      {
+         for (UInt32 i = 0; i < replaced_entries.size(); i++)
+            directory->destroyDirectoryEntry(replaced_entries[i]);
+         replaced_entries.clear();
+      }
+   }
+   for (UInt32 i = 0; i < replaced_entries.size(); i++)
+      directory->destroyDirectoryEntry(replaced_entries[i]);
+
+   for (SInt32 entry_num = 0; entry_num < TOTAL_ENTRIES; entry_num++)
+   {
+      DirectoryEntry* directory_entry = directory->getDirectoryEntry(entry_num);
+      if ((directory_entry->getAddress() != (IntPtr) entry_num) || (directory_entry->getNumSharers() != 0))
+      {
+         printf("Replaced Entry(%i) is not a new entry\n", entry_num);
+         return false;
+      }
+   }
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   const char* directory_type_names[] = { "full_map", "limited_no_broadcast", "limited_broadcast", "ackwise", "limitless" };
+   bool passed = true;
+
+   for (UInt32 t = 0; t < sizeof(directory_type_names) / sizeof(directory_type_names[0]); t++)
+   {
+      DirectoryType directory_type = DirectoryEntry::parseDirectoryType(directory_type_names[t]);
+      Directory* directories[NUM_DIRECTORIES];
+
+      UInt64 start_heap_usage = getHeapUsage();
+      UInt64 start_time = getTimeInUs();
+      for (UInt32 i = 0; i < NUM_DIRECTORIES; i++)
+         directories[i] = new Directory(PR_L1_PR_L2_DRAM_DIRECTORY_MOSI, directory_type,
+                                        TOTAL_ENTRIES, MAX_HW_SHARERS, MAX_NUM_SHARERS);
+      UInt64 construction_time = getTimeInUs() - start_time;
+      UInt64 heap_usage = getHeapUsage() - start_heap_usage;
+
+      printf("%s: Construction Time per Directory (us): %.1f, Memory per Entry (bytes): %.1f\n",
+             directory_type_names[t], ((double) construction_time) / NUM_DIRECTORIES,
+             ((double) heap_usage) / (NUM_DIRECTORIES * TOTAL_ENTRIES));
+
+      if (!checkSharers(directories[0], directory_type))
+         passed = false;
+      if (!checkReplacements(directories[1]))
+         passed = false;
+
+      for (UInt32 i = 0; i < NUM_DIRECTORIES; i++)
+         delete directories[i];
+   }
+
+   CarbonStopSim();
+
+   printf(passed ? "Directory Startup test passed\n" : "Directory Startup test failed\n");
+   return passed ? 0 : 1;
+}
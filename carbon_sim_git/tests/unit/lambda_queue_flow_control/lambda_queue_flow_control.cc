@@ -0,0 +1,84 @@
+#include <stdio.h>
+
+#include "simulator.h"
+#include "tile.h"
+#include "tile_manager.h"
+#include "core.h"
+#include "network.h"
+#include "packet_type.h"
+#include "lambda_queue_flow_control.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+
+// The broadcasts of tile 0 are received by tiles 1, 2 and 3, each with 2
+// slots in its lambda queue. The credits are returned by calling
+// receiveCredit() directly, so no broadcast is sent: a broadcast must get a
+// slot only when every receiver returned the credit of the oldest one.
+
+#define LAMBDA_QUEUE_LENGTH      2
+
+static void returnCredit(LambdaQueueFlowControl* flow_control, tile_id_t receiver)
+{
+   NetPacket credit(0, LAMBDA_QUEUE_CREDIT_TYPE, receiver, 0, 0, NULL);
+   flow_control->receiveCredit(credit);
+}
+
+static void checkBroadcasts(LambdaQueueFlowControl* flow_control, UInt32 num_broadcasts, const char* step)
+{
+   for (UInt32 i = 0; i < num_broadcasts; i++)
+   {
+      LOG_ASSERT_ERROR(flow_control->acquireBroadcastCredits(USER_1),
+                       "%s: broadcast(%u) of %u got no credits", step, i, num_broadcasts);
+   }
+   LOG_ASSERT_ERROR(!flow_control->acquireBroadcastCredits(USER_1),
+                    "%s: more than %u broadcasts got credits", step, num_broadcasts);
+   printf("%s: %u broadcasts\n", step, num_broadcasts);
+}
+
+int main(int argc, char *argv[])
+{
+   printf("Starting (lambda_queue_flow_control)\n");
+   CarbonStartSim(argc, argv);
+
+   Simulator::enablePerformanceModelsInCurrentProcess();
+
+   LambdaQueueFlowControl* flow_control = Sim()->getTileManager()->getTileFromID(0)->getCore()->getLambdaQueueFlowControl();
+   LOG_ASSERT_ERROR(flow_control->isEnabled(), "Lambda queue flow control disabled");
+
+   // Every lambda queue is empty
+   checkBroadcasts(flow_control, LAMBDA_QUEUE_LENGTH, "Empty queues");
+
+   // The minimum only rises with the credit of the last receiver
+   returnCredit(flow_control, 1);
+   returnCredit(flow_control, 2);
+   LOG_ASSERT_ERROR(!flow_control->acquireBroadcastCredits(USER_1), "Broadcast without the credit of tile 3");
+   returnCredit(flow_control, 3);
+   checkBroadcasts(flow_control, 1, "1 credit from every receiver");
+
+   // A receiver ahead of the others does not raise the minimum
+   returnCredit(flow_control, 1);
+   returnCredit(flow_control, 1);
+   LOG_ASSERT_ERROR(!flow_control->acquireBroadcastCredits(USER_1), "Broadcast with credits from tile 1 only");
+   returnCredit(flow_control, 3);
+   returnCredit(flow_control, 2);
+   checkBroadcasts(flow_control, 1, "2 credits from every receiver");
+
+   // Tile 1 is no longer at the minimum: the credits of tiles 2 and 3 raise it
+   returnCredit(flow_control, 2);
+   returnCredit(flow_control, 3);
+   checkBroadcasts(flow_control, 1, "3 credits from every receiver");
+
+   // The credits of all the 5 broadcasts returned: every slot is free again
+   for (tile_id_t receiver = 1; receiver <= 3; receiver++)
+   {
+      for (UInt32 i = 3; i < 5; i++)
+         returnCredit(flow_control, receiver);
+   }
+   checkBroadcasts(flow_control, LAMBDA_QUEUE_LENGTH, "5 credits from every receiver");
+
+   Simulator::disablePerformanceModelsInCurrentProcess();
+   CarbonStopSim();
+
+   printf("Finished (lambda_queue_flow_control) - SUCCESS\n");
+   return 0;
+}
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <vector>
+#include <queue>
+using std::vector;
+using std::queue;
+
+#include "lax_barrier_tree.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+
+// Shape of the combining tree of the lax_barrier_tree scheme for a range of
+// tile counts, fan-ins and process counts (tiles strided over the processes):
+// every tile must reach the root, a node must have at most fan_in children
+// (2 * fan_in for the roots of the process subtrees), only the process roots
+// may have a parent in another process, and the depth must be logarithmic.
+//   Then the protocol of the nodes (LaxBarrierTreeNode), over a tree of 7
+// tiles whose messages are delivered in an order picked by the test: the
+// MCP must hear of every tile that reaches a barrier, either through the
+// tree or with a late arrival, including a tile that resumes and reaches the
+// barrier after the MCP excused it but before the excuse got to its node.
+
+static UInt32 ceilLog(UInt32 n, UInt32 base)
+{
+   UInt32 depth = 0;
+   for (UInt64 size = 1; size < n; size *= base)
+      depth ++;
+   return depth;
+}
+
+static bool checkTree(UInt32 num_tiles, UInt32 fan_in, UInt32 num_processes)
+{
+   vector< vector<tile_id_t> > groups(num_processes);
+   vector<UInt32> process(num_tiles);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      process[tile_id] = tile_id % num_processes;
+      groups[process[tile_id]].push_back(tile_id);
+   }
+
+   vector<tile_id_t> parent;
+   tile_id_t root = LaxBarrierTree::build(groups, fan_in, num_tiles, parent);
+
+   vector<UInt32> num_children(num_tiles, 0);
+   UInt32 max_depth = 0;
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      if (tile_id == root)
+      {
+         if (parent[tile_id] != INVALID_TILE_ID)
+            return false;
+         continue;
+      }
+      if (parent[tile_id] == INVALID_TILE_ID)
+      {
+         printf("tile(%i) is a second root\n", tile_id);
+         return false;
+      }
+      num_children[parent[tile_id]] ++;
+
+      bool group_root = (groups[process[tile_id]][0] == tile_id);
+      if (!group_root && (process[parent[tile_id]] != process[tile_id]))
+      {
+         printf("tile(%i) has a parent(%i) in another process\n", tile_id, parent[tile_id]);
+         return false;
+      }
+
+      UInt32 depth = 0;
+      for (tile_id_t node = tile_id; node != root; node = parent[node])
+      {
+         if (++depth > num_tiles)
+         {
+            printf("tile(%i) is in a cycle\n", tile_id);
+            return false;
+         }
+      }
+      if (depth > max_depth)
+         max_depth = depth;
+   }
+
+   UInt32 max_children = 0;
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      bool group_root = (groups[process[tile_id]][0] == tile_id);
+      if (num_children[tile_id] > (group_root ? 2 * fan_in : fan_in))
+      {
+         printf("tile(%i) has %u children\n", tile_id, num_children[tile_id]);
+         return false;
+      }
+      if (num_children[tile_id] > max_children)
+         max_children = num_children[tile_id];
+   }
+
+   UInt32 tiles_per_process = (num_tiles + num_processes - 1) / num_processes;
+   UInt32 max_expected_depth = ceilLog(tiles_per_process, fan_in) + ceilLog(num_processes, fan_in);
+   printf("tiles(%u), fan_in(%u), processes(%u): depth(%u), max children(%u)\n",
+          num_tiles, fan_in, num_processes, max_depth, max_children);
+   if (max_depth > max_expected_depth)
+   {
+      printf("depth(%u) > expected(%u)\n", max_depth, max_expected_depth);
+      return false;
+   }
+   return true;
+}
+
+// Message between the nodes, or from a node to the MCP (to == INVALID_TILE_ID)
+struct TreeMsg
+{
+   LaxBarrierTree::MsgType type;
+   tile_id_t from;
+   tile_id_t to;
+   UInt32 epoch;
+   UInt64 time;
+};
+
+static queue<TreeMsg> _tree_msg_queue;
+static vector<TreeMsg> _mcp_msg_list;
+static vector<UInt32> _num_releases;
+
+class TestNode : public LaxBarrierTreeNode
+{
+public:
+   TestNode(tile_id_t tile_id, tile_id_t parent, const vector<tile_id_t>& children, UInt64 first_barrier_time)
+      : LaxBarrierTreeNode(parent, children, first_barrier_time), _tile_id(tile_id) {}
+
+private:
+   tile_id_t _tile_id;
+
+   void releaseCore()
+   { _num_releases[_tile_id] ++; }
+   void sendSubtreeDone(tile_id_t parent, UInt32 epoch, UInt64 min_wait_time)
+   { send(LaxBarrierTree::SUBTREE_DONE, parent, epoch, min_wait_time); }
+   void sendLateArrival(UInt32 epoch, UInt64 time)
+   { send(LaxBarrierTree::LATE_ARRIVAL, INVALID_TILE_ID, epoch, time); }
+
+   void send(LaxBarrierTree::MsgType type, tile_id_t to, UInt32 epoch, UInt64 time)
+   {
+      TreeMsg msg = { type, _tile_id, to, epoch, time };
+      if (to == INVALID_TILE_ID)
+         _mcp_msg_list.push_back(msg);
+      else
+         _tree_msg_queue.push(msg);
+   }
+};
+
+static vector<TestNode*> _nodes;
+
+static void deliverTreeMsgs()
+{
+   while (!_tree_msg_queue.empty())
+   {
+      TreeMsg msg = _tree_msg_queue.front();
+      _tree_msg_queue.pop();
+      _nodes[msg.to]->processSubtreeDone(msg.epoch, msg.time);
+   }
+}
+
+// Release from the MCP, passed on from the root to every node
+static void releaseBarrier(UInt32 epoch, UInt64 next_barrier_time, const vector<bool>& running)
+{
+   _mcp_msg_list.clear();
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) _nodes.size(); tile_id++)
+      _nodes[tile_id]->processBarrierRelease(epoch, next_barrier_time, running[tile_id]);
+   deliverTreeMsgs();
+}
+
+// Did the MCP hear of the arrival of 'tile_id' at 'time'? The tree done
+// message must come in and carry the earliest time
+static bool checkMCPHeardOf(tile_id_t tile_id, UInt32 epoch, UInt64 time, bool through_tree)
+{
+   bool tree_done = false;
+   bool late_arrival = false;
+   for (UInt32 i = 0; i < _mcp_msg_list.size(); i++)
+   {
+      const TreeMsg& msg = _mcp_msg_list[i];
+      if (msg.epoch != epoch)
+         continue;
+      if (msg.type == LaxBarrierTree::SUBTREE_DONE)
+         tree_done = true;
+      if ((msg.type == LaxBarrierTree::LATE_ARRIVAL) && (msg.from == tile_id) && (msg.time == time))
+         late_arrival = true;
+   }
+
+   if (!tree_done)
+      printf("Epoch(%u): the tree did not report\n", epoch);
+   if (!through_tree && !late_arrival)
+      printf("Epoch(%u): no late arrival from tile(%i)\n", epoch, tile_id);
+   return tree_done && (through_tree || late_arrival);
+}
+
+static bool checkNodeProtocol()
+{
+   const UInt32 num_tiles = 7;
+   const UInt64 quantum = 1000;
+
+   vector< vector<tile_id_t> > groups(1);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+      groups[0].push_back(tile_id);
+   vector<tile_id_t> parent;
+   LaxBarrierTree::build(groups, 2, num_tiles, parent);
+
+   vector< vector<tile_id_t> > children(num_tiles);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      if (parent[tile_id] != INVALID_TILE_ID)
+         children[parent[tile_id]].push_back(tile_id);
+   }
+   _num_releases.assign(num_tiles, 0);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+      _nodes.push_back(new TestNode(tile_id, parent[tile_id], children[tile_id], quantum));
+
+   bool passed = true;
+   vector<bool> running(num_tiles, true);
+   // A leaf, whose arrival goes up through the tree
+   tile_id_t tile = num_tiles - 1;
+
+   // Epoch 1: every tile arrives
+   releaseBarrier(1, 2 * quantum, running);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+      _nodes[tile_id]->processBarrierWait(2 * quantum + tile_id);
+   deliverTreeMsgs();
+   passed = checkMCPHeardOf(tile, 1, 2 * quantum + tile, true) && passed;
+   passed = ((_mcp_msg_list.size() == 1) && (_mcp_msg_list[0].time == 2 * quantum)) && passed;
+
+   // Epoch 2: the tile is excused, and the excuse gets to its node before
+   // it resumes and arrives
+   releaseBarrier(2, 3 * quantum, running);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      if (tile_id != tile)
+         _nodes[tile_id]->processBarrierWait(3 * quantum);
+   }
+   _nodes[tile]->processExcuse(2);
+   deliverTreeMsgs();
+   _nodes[tile]->processBarrierWait(3 * quantum + 7);
+   passed = checkMCPHeardOf(tile, 2, 3 * quantum + 7, false) && passed;
+
+   // Epoch 3: the tile resumes and arrives before the excuse gets to its node
+   releaseBarrier(3, 4 * quantum, running);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      if (tile_id != tile)
+         _nodes[tile_id]->processBarrierWait(4 * quantum);
+   }
+   _nodes[tile]->processBarrierWait(4 * quantum + 3);
+   deliverTreeMsgs();
+   _nodes[tile]->processExcuse(3);
+   passed = checkMCPHeardOf(tile, 3, 4 * quantum + 3, false) && passed;
+
+   // Epoch 4: the tile was not running at the release, and arrives
+   running[tile] = false;
+   releaseBarrier(4, 5 * quantum, running);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+      _nodes[tile_id]->processBarrierWait(5 * quantum + 1);
+   deliverTreeMsgs();
+   passed = checkMCPHeardOf(tile, 4, 5 * quantum + 1, false) && passed;
+
+   // Every arrival released by the next barrier
+   running[tile] = true;
+   releaseBarrier(5, 6 * quantum, running);
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) num_tiles; tile_id++)
+   {
+      if (_num_releases[tile_id] != 4)
+      {
+         printf("tile(%i) released %u times, expected 4\n", tile_id, _num_releases[tile_id]);
+         passed = false;
+      }
+      delete _nodes[tile_id];
+   }
+   _nodes.clear();
+
+   printf("Node protocol: %s\n", passed ? "passed" : "failed");
+   return passed;
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   UInt32 tile_counts[] = { 1, 2, 7, 64, 1000, 4096 };
+   UInt32 fan_ins[] = { 2, 8 };
+   UInt32 process_counts[] = { 1, 3, 16 };
+
+   bool passed = true;
+   for (UInt32 i = 0; i < sizeof(tile_counts) / sizeof(tile_counts[0]); i++)
+   {
+      for (UInt32 j = 0; j < sizeof(fan_ins) / sizeof(fan_ins[0]); j++)
+      {
+         for (UInt32 k = 0; k < sizeof(process_counts) / sizeof(process_counts[0]); k++)
+         {
+            if (process_counts[k] > tile_counts[i])
+               continue;
+            passed = checkTree(tile_counts[i], fan_ins[j], process_counts[k]) && passed;
+         }
+      }
+   }
+
+   passed = checkNodeProtocol() && passed;
+
+   CarbonStopSim();
+
+   if (passed)
+   {
+      printf("Lax barrier tree test passed\n");
+      return 0;
+   }
+   else
+   {
+      printf("Lax barrier tree test failed\n");
+      return 1;
+   }
+}
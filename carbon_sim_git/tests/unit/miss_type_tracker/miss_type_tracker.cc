@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+using std::vector;
+
+#include "miss_type_tracker.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Drives an 8-way LRU model of a 512 KB cache with 64 byte lines with a
+// stream of accesses (mostly to a working set 1.5x the capacity of the
+// cache, the rest spread over 64 MB) and random invalidations, and
+// classifies every miss with an exact MissTypeTracker and approximate ones
+// of different table sizes. Reports how often each approximate tracker
+// disagrees with the exact one and the time spent in the trackers.
+//   Misses to lines last evicted longer ago than the table can remember
+// look cold, so the error falls as the table gets closer to the footprint.
+
+#define CACHE_LINE_SIZE       64
+#define NUM_SETS              1024
+#define ASSOCIATIVITY         8
+#define NUM_LINES             (NUM_SETS * ASSOCIATIVITY)
+#define WORKING_SET_LINES     (NUM_LINES * 3 / 2)
+#define FOOTPRINT_LINES       (1 << 20)
+#define NUM_ACCESSES          (1 << 22)
+
+struct Event
+{
+   enum Type { ACCESS, INVALIDATE };
+   Type type;
+   IntPtr address;
+};
+
+// Generate the events tracked by a cache: misses, evictions and fills on
+// accesses, and invalidations
+static void generateEvents(vector<Event>& events)
+{
+   vector<IntPtr> tags(NUM_LINES, (IntPtr) ~0);
+   vector<UInt32> lru(NUM_LINES);
+   for (UInt32 i = 0; i < NUM_LINES; i++)
+      lru[i] = i % ASSOCIATIVITY;
+
+   srand(1);
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      IntPtr line = (rand() % 4 != 0) ? (rand() % WORKING_SET_LINES) : (rand() % FOOTPRINT_LINES);
+      UInt32 set_num = line % NUM_SETS;
+      IntPtr* set_tags = &tags[set_num * ASSOCIATIVITY];
+      UInt32* set_lru = &lru[set_num * ASSOCIATIVITY];
+
+      if (rand() % 64 == 0)
+      {
+         // Invalidate a line of the set
+         UInt32 way = rand() % ASSOCIATIVITY;
+         if (set_tags[way] != (IntPtr) ~0)
+         {
+            Event event = { Event::INVALIDATE, set_tags[way] * CACHE_LINE_SIZE };
+            events.push_back(event);
+            set_tags[way] = ~0;
+         }
+         continue;
+      }
+
+      UInt32 way = ASSOCIATIVITY;
+      for (UInt32 w = 0; w < ASSOCIATIVITY; w++)
+      {
+         if (set_tags[w] == line)
+            way = w;
+      }
+      if (way == ASSOCIATIVITY)
+      {
+         // Miss: replace an invalid line or the LRU one
+         Event event = { Event::ACCESS, line * CACHE_LINE_SIZE };
+         events.push_back(event);
+         for (UInt32 w = 0; w < ASSOCIATIVITY; w++)
+         {
+            if ((set_tags[w] == (IntPtr) ~0) || ((way == ASSOCIATIVITY) && (set_lru[w] == ASSOCIATIVITY-1)))
+            {
+               way = w;
+               if (set_tags[w] == (IntPtr) ~0)
+                  break;
+            }
+         }
+         if (set_tags[way] != (IntPtr) ~0)
+         {
+            Event eviction = { Event::INVALIDATE, set_tags[way] * CACHE_LINE_SIZE };
+            // Distinguish evictions from invalidations by the low bit
+            eviction.address |= 1;
+            events.push_back(eviction);
+         }
+         set_tags[way] = line;
+      }
+      for (UInt32 w = 0; w < ASSOCIATIVITY; w++)
+      {
+         if (set_lru[w] < set_lru[way])
+            set_lru[w] ++;
+      }
+      set_lru[way] = 0;
+   }
+}
+
+// Replay the events on 'tracker', recording the miss classification
+static UInt64 replayEvents(MissTypeTracker& tracker, const vector<Event>& events, vector<UInt8>& miss_types)
+{
+   miss_types.clear();
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < events.size(); i++)
+   {
+      const Event& event = events[i];
+      if (event.type == Event::ACCESS)
+      {
+         miss_types.push_back(tracker.getStateOnMiss(event.address));
+         tracker.lineFetched(event.address);
+      }
+      else if (event.address & 1)
+      {
+         tracker.lineEvicted(event.address & ~((IntPtr) 1));
+      }
+      else
+      {
+         tracker.lineInvalidated(event.address);
+      }
+   }
+   return getTimeInUs() - start_time;
+}
+
+int main(int argc, char *argv[])
+{
+   UInt32 table_sizes[] = { 16, 64, 256 };
+   double last_misclassification_rate = 100.0;
+   bool passed = true;
+
+   vector<Event> events;
+   generateEvents(events);
+
+   vector<UInt8> exact_miss_types;
+   MissTypeTracker exact_tracker(MissTypeTracker::EXACT, 0, false);
+   UInt64 exact_time = replayEvents(exact_tracker, events, exact_miss_types);
+
+   UInt64 num_misses = exact_miss_types.size();
+   UInt64 miss_type_counts[MissTypeTracker::NUM_STATES] = { 0 };
+   for (UInt32 i = 0; i < num_misses; i++)
+      miss_type_counts[exact_miss_types[i]] ++;
+
+   printf("Misses(%llu): Cold(%llu), Capacity(%llu), Sharing(%llu)\n",
+          (unsigned long long) num_misses,
+          (unsigned long long) miss_type_counts[MissTypeTracker::NOT_FETCHED],
+          (unsigned long long) miss_type_counts[MissTypeTracker::EVICTED],
+          (unsigned long long) miss_type_counts[MissTypeTracker::INVALIDATED]);
+   printf("Exact: Time(%.2f s)\n", exact_time / 1e6);
+   exact_tracker.outputSummary(std::cout);
+
+   for (UInt32 t = 0; t < sizeof(table_sizes) / sizeof(table_sizes[0]); t++)
+   {
+      vector<UInt8> miss_types;
+      MissTypeTracker tracker(MissTypeTracker::APPROXIMATE, table_sizes[t] * NUM_LINES, false);
+      UInt64 time = replayEvents(tracker, events, miss_types);
+
+      UInt64 misclassified_misses = 0;
+      for (UInt32 i = 0; i < num_misses; i++)
+      {
+         if (miss_types[i] != exact_miss_types[i])
+            misclassified_misses ++;
+      }
+
+      double misclassification_rate = 100.0 * misclassified_misses / num_misses;
+      printf("Approximate, Table Size(%u entries/line): Time(%.2f s), Misclassification Rate(%.3f %%)\n",
+             table_sizes[t], time / 1e6, misclassification_rate);
+      tracker.outputSummary(std::cout);
+
+      // More entries should not make it worse, and a table covering the
+      // footprint should stay within 1% of exact mode
+      if (misclassification_rate > last_misclassification_rate)
+         passed = false;
+      if ((table_sizes[t] * NUM_LINES >= FOOTPRINT_LINES) && (misclassification_rate > 1.0))
+         passed = false;
+      last_misclassification_rate = misclassification_rate;
+   }
+
+   printf(passed ? "Miss Type Tracker test passed\n" : "Miss Type Tracker test failed\n");
+   return passed ? 0 : 1;
+}
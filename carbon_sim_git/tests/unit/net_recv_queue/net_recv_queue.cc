@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <cassert>
+#include <list>
+using std::list;
+
+#include "net_recv_queue.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Measures the cost of a targeted receive (fixed sender and type) as a
+// function of the number of packets already sitting in the receive queue,
+// for the demultiplexed NetRecvQueue and for a linear scan over a list
+// (the way Network used to search its queue).
+
+#define NUM_ITERATIONS  100000
+
+static NetPacket makePacket(SInt32 sender, SInt32 receiver, PacketType type, UInt64 time)
+{
+   NetPacket packet;
+   packet.time = time;
+   packet.type = type;
+   packet.sender = (core_id_t) {sender, MAIN_CORE_TYPE};
+   packet.receiver = (core_id_t) {receiver, MAIN_CORE_TYPE};
+   return packet;
+}
+
+static bool linearScanRecv(list<NetPacket>& queue, core_id_t sender, PacketType type, NetPacket& packet)
+{
+   for (list<NetPacket>::iterator it = queue.begin(); it != queue.end(); it++)
+   {
+      if ( (it->sender.tile_id == sender.tile_id) && (it->sender.core_type == sender.core_type) &&
+           (it->type == type) )
+      {
+         packet = *it;
+         queue.erase(it);
+         return true;
+      }
+   }
+   return false;
+}
+
+int main(int argc, char *argv[])
+{
+   const SInt32 receiver = 0;
+   const PacketType types[] = {USER_1, USER_2, MCP_RESPONSE_TYPE, MCP_SYSTEM_TYPE};
+   const UInt32 num_types = sizeof(types) / sizeof(types[0]);
+
+   printf("%10s %20s %20s\n", "Depth", "NetRecvQueue (ns)", "Linear Scan (ns)");
+
+   for (UInt32 depth = 16; depth <= 16384; depth *= 4)
+   {
+      NetRecvQueue recv_queue;
+      list<NetPacket> linear_queue;
+
+      // Background traffic that the receive never matches
+      for (UInt32 i = 0; i < depth; i++)
+      {
+         NetPacket packet = makePacket(1 + (i % 1024), receiver, types[i % num_types], i);
+         recv_queue.enqueue(packet);
+         linear_queue.push_back(packet);
+      }
+
+      // The packet being looked for is always at the back of the queue
+      core_id_t target_sender = {2000, MAIN_CORE_TYPE};
+      NetMatch match;
+      match.senders.push_back(target_sender);
+      match.types.push_back(USER_1);
+      match.receiver = (core_id_t) {receiver, MAIN_CORE_TYPE};
+
+      UInt64 start_time = getTimeInUs();
+      for (UInt32 i = 0; i < NUM_ITERATIONS; i++)
+      {
+         recv_queue.enqueue(makePacket(target_sender.tile_id, receiver, USER_1, depth + i));
+         NetPacket packet = recv_queue.dequeue(match, match.receiver);
+         assert(packet.sender.tile_id == target_sender.tile_id && packet.time == depth + i);
+      }
+      UInt64 recv_queue_time = getTimeInUs() - start_time;
+
+      start_time = getTimeInUs();
+      for (UInt32 i = 0; i < NUM_ITERATIONS; i++)
+      {
+         linear_queue.push_back(makePacket(target_sender.tile_id, receiver, USER_1, depth + i));
+         NetPacket packet;
+         __attribute__((unused)) bool found = linearScanRecv(linear_queue, target_sender, USER_1, packet);
+         assert(found && packet.time == depth + i);
+      }
+      UInt64 linear_queue_time = getTimeInUs() - start_time;
+
+      assert(recv_queue.size() == depth && linear_queue.size() == depth);
+
+      printf("%10u %20.1f %20.1f\n", depth,
+             ((double) recv_queue_time) * 1000 / NUM_ITERATIONS,
+             ((double) linear_queue_time) * 1000 / NUM_ITERATIONS);
+   }
+
+   // Wildcard and broadcast matching
+   NetRecvQueue recv_queue;
+   recv_queue.enqueue(makePacket(3, receiver, USER_2, 30));
+   recv_queue.enqueue(makePacket(4, NetPacket::BROADCAST, USER_1, 10));
+   recv_queue.enqueue(makePacket(5, receiver, USER_1, 20));
+
+   NetMatch any_match;
+   any_match.receiver = (core_id_t) {receiver, MAIN_CORE_TYPE};
+   NetPacket packet;
+   __attribute__((unused)) bool found = recv_queue.tryDequeue(any_match, any_match.receiver, packet);
+   assert(found && packet.sender.tile_id == 4);
+   packet = recv_queue.dequeue(any_match, any_match.receiver);
+   assert(packet.sender.tile_id == 3);
+   found = recv_queue.tryDequeue(any_match, (core_id_t) {receiver + 1, MAIN_CORE_TYPE}, packet);
+   assert(!found);
+
+   printf("Net Recv Queue tests successful\n");
+
+   return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+
+#include "tile.h"
+#include "core.h"
+#include "core_model.h"
+#include "mem_component.h"
+#include "network.h"
+#include "network_event_engine.h"
+#include "packet_type.h"
+#include "tile_manager.h"
+#include "simulator.h"
+
+#include "carbon_user.h"
+#include "fixed_types.h"
+
+// The memory networks (emesh_hop_by_hop) are routed by the event engine:
+// each tile writes its share of the addresses and every tile reads all of
+// them, so the coherence messages cross the mesh between the partitions of
+// the engine and have to be delivered with the right data.
+//   A packet the main core sends on the 1st user network at its clock is
+// held back by that clock, and has to be routed once the core waits for
+// it, or once its periodic synchronization goes past it
+
+#define NUM_ADDRESSES      64
+#define NUM_TILES          4
+
+static IntPtr getAddress(UInt32 i)
+{
+   return 0x100000 + i * 0x1040;
+}
+
+int main(int argc, char *argv[])
+{
+   printf("Starting (network_event_engine)\n");
+   CarbonStartSim(argc, argv);
+
+   Simulator::enablePerformanceModelsInCurrentProcess();
+
+   Core* cores[NUM_TILES];
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+      cores[j] = Sim()->getTileManager()->getTileFromID(j)->getCore();
+
+   for (UInt32 i = 0; i < NUM_ADDRESSES; i++)
+   {
+      UInt32 val = 1000 + i;
+      cores[i % NUM_TILES]->initiateMemoryAccess(MemComponent::L1_DCACHE, Core::NONE, Core::WRITE,
+                                                 getAddress(i), (Byte*) &val, sizeof(val), true);
+   }
+
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+   {
+      for (UInt32 i = 0; i < NUM_ADDRESSES; i++)
+      {
+         UInt32 val = 0;
+         cores[j]->initiateMemoryAccess(MemComponent::L1_DCACHE, Core::NONE, Core::READ,
+                                        getAddress(i), (Byte*) &val, sizeof(val), true);
+         LOG_ASSERT_ERROR(val == 1000 + i, "Tile(%u), address(%#lx): read(%u), expected(%u)",
+                          j, getAddress(i), val, 1000 + i);
+      }
+   }
+
+   // Lookahead of the mesh: router delay + link delay
+   for (SInt32 network_id = STATIC_NETWORK_MEMORY_1; network_id <= STATIC_NETWORK_MEMORY_2; network_id++)
+   {
+      NetworkEventEngine* event_engine = Network::getEventEngine(network_id);
+      LOG_ASSERT_ERROR(event_engine, "No event engine for network(%i)", network_id);
+      LOG_ASSERT_ERROR(event_engine->getLookahead() == 2, "Network(%i): lookahead(%llu), expected(2)",
+                       network_id, event_engine->getLookahead());
+   }
+   LOG_ASSERT_ERROR(Network::getEventEngine(STATIC_NETWORK_MEMORY_1)->getTotalWindows() > 0,
+                    "No packet routed by the event engine");
+
+   NetworkEventEngine* event_engine = Network::getEventEngine(STATIC_NETWORK_USER_1);
+   LOG_ASSERT_ERROR(event_engine, "No event engine for network(%i)", STATIC_NETWORK_USER_1);
+   Network* network = cores[0]->getTile()->getNetwork();
+   CoreModel* core_model = cores[0]->getPerformanceModel();
+
+   for (UInt32 j = 0; j < NUM_TILES; j++)
+   {
+      UInt64 num_windows = event_engine->getTotalWindows();
+      UInt32 val = 2000 + j;
+      network->netSend(cores[j]->getId(), USER_1, &val, sizeof(val));
+      LOG_ASSERT_ERROR(event_engine->getTotalWindows() == num_windows,
+                       "Packet to tile(%u) routed at the clock of the main core", j);
+
+      // The main core waits for its own packet, the packets to the other
+      // tiles are released by the synchronization
+      if (j != 0)
+      {
+         core_model->setCycleCount(core_model->getCycleCount() + 1000);
+         Network::synchronizeEventEngines(0);
+         LOG_ASSERT_ERROR(event_engine->getTotalWindows() > num_windows,
+                          "Packet to tile(%u) not routed by the synchronization", j);
+      }
+
+      NetPacket packet = cores[j]->getTile()->getNetwork()->netRecv(cores[0]->getId(), cores[j]->getId(), USER_1);
+      LOG_ASSERT_ERROR(*((UInt32*) packet.data) == val, "Tile(%u): received(%u), expected(%u)",
+                       j, *((UInt32*) packet.data), val);
+      if (packet.shared_payload)
+         packet.releasePayload();
+      else
+         delete [] (Byte*) packet.data;
+   }
+
+   Simulator::disablePerformanceModelsInCurrentProcess();
+   CarbonStopSim();
+
+   printf("Finished (network_event_engine) - SUCCESS\n");
+   return 0;
+}
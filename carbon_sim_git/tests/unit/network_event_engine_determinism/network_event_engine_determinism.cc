@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <sched.h>
+#include <vector>
+using std::vector;
+
+#include "simulator.h"
+#include "config.h"
+#include "tile.h"
+#include "tile_manager.h"
+#include "core.h"
+#include "core_model.h"
+#include "network.h"
+#include "network_model.h"
+#include "network_event_engine.h"
+#include "packet_type.h"
+#include "lock.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+
+// The same traffic is routed on the 1st user network by an event engine with
+// 1 host thread, injected in order, and on the 2nd user network (with the
+// same emesh_hop_by_hop model) by an event engine with 4 host threads,
+// injected in the reverse order. The packets are held back by the clock of
+// the main core (the other cores are idle) until they are all injected, so
+// both engines must compute the same arrival times and contention delays.
+
+#define NUM_PACKETS_PER_TILE     64
+#define PACKET_SIZE              64
+#define START_TIME               1000
+
+struct Arrival
+{
+   UInt64 _time;
+   UInt64 _contention_delay;
+};
+
+static vector<Arrival> _arrival_list;
+static UInt32 _num_arrivals;
+static Lock _arrival_lock;
+
+static void receivePacket(void* obj, NetPacket packet)
+{
+   UInt32 packet_id = *((UInt32*) packet.data);
+
+   ScopedLock sl(_arrival_lock);
+   _arrival_list[packet_id]._time = packet.time;
+   _arrival_list[packet_id]._contention_delay = packet.contention_delay;
+   _num_arrivals ++;
+}
+
+static vector<Arrival> routeTraffic(PacketType packet_type, SInt32 num_threads, bool reverse_order)
+{
+   SInt32 num_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   UInt32 num_packets = num_tiles * NUM_PACKETS_PER_TILE;
+   CoreModel* core_model = Sim()->getTileManager()->getTileFromID(0)->getCore()->getPerformanceModel();
+
+   _arrival_list.assign(num_packets, Arrival());
+   _num_arrivals = 0;
+
+   // Only the main core runs: its clock holds back the engine
+   core_model->setCycleCount(0);
+   NetworkEventEngine* event_engine = new NetworkEventEngine(g_type_to_static_network_map[packet_type], num_threads);
+
+   for (UInt32 n = 0; n < num_packets; n++)
+   {
+      UInt32 packet_id = reverse_order ? (num_packets - 1 - n) : n;
+      UInt32 i = packet_id / num_tiles;
+      tile_id_t sender = packet_id % num_tiles;
+      tile_id_t receiver = (13 * ((sender + i) % num_tiles) + 5) % num_tiles;
+
+      // A packet every cycle from every tile, so the routers are contended
+      NetPacket packet(START_TIME + i, packet_type, sender, receiver, PACKET_SIZE, NULL);
+      Byte data[PACKET_SIZE] = {0};
+      *((UInt32*) data) = packet_id;
+      packet.node_type = NetworkModel::SEND_TILE;
+      packet.data = NetPacketPayload::create(data, PACKET_SIZE)->getData();
+      packet.shared_payload = true;
+
+      event_engine->injectPacket(packet);
+      packet.releasePayload();
+   }
+   LOG_ASSERT_ERROR(event_engine->getTotalWindows() == 0,
+                    "Threads(%i): %llu windows routed above the clock of the main core",
+                    num_threads, event_engine->getTotalWindows());
+
+   // Release the packets: past the arrival of the last one
+   core_model->setCycleCount(START_TIME + NUM_PACKETS_PER_TILE * num_tiles * PACKET_SIZE);
+   event_engine->advance();
+   while (true)
+   {
+      _arrival_lock.acquire();
+      bool done = (_num_arrivals == num_packets);
+      _arrival_lock.release();
+      if (done)
+         break;
+      sched_yield();
+   }
+
+   LOG_ASSERT_ERROR(event_engine->getTotalLateInjections() == 0,
+                    "Threads(%i): %llu late injections", num_threads, event_engine->getTotalLateInjections());
+   printf("Threads(%i): windows(%llu)\n", num_threads, (long long unsigned int) event_engine->getTotalWindows());
+
+   delete event_engine;
+   core_model->setCycleCount(0);
+
+   return _arrival_list;
+}
+
+int main(int argc, char *argv[])
+{
+   printf("Starting (network_event_engine_determinism)\n");
+   CarbonStartSim(argc, argv);
+
+   Simulator::enablePerformanceModelsInCurrentProcess();
+
+   SInt32 num_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   for (tile_id_t tile_id = 0; tile_id < num_tiles; tile_id++)
+   {
+      Network* network = Sim()->getTileManager()->getTileFromID(tile_id)->getNetwork();
+      network->registerCallback(USER_1, receivePacket, NULL);
+      network->registerCallback(USER_2, receivePacket, NULL);
+   }
+
+   vector<Arrival> arrival_list_1 = routeTraffic(USER_1, 1, false);
+   vector<Arrival> arrival_list_4 = routeTraffic(USER_2, 4, true);
+
+   UInt64 total_contention_delay = 0;
+   for (UInt32 n = 0; n < arrival_list_1.size(); n++)
+   {
+      LOG_ASSERT_ERROR((arrival_list_1[n]._time == arrival_list_4[n]._time) &&
+                       (arrival_list_1[n]._contention_delay == arrival_list_4[n]._contention_delay),
+                       "Packet(%u): arrival(%llu), contention delay(%llu) with 1 thread, "
+                       "arrival(%llu), contention delay(%llu) with 4 threads",
+                       n, arrival_list_1[n]._time, arrival_list_1[n]._contention_delay,
+                       arrival_list_4[n]._time, arrival_list_4[n]._contention_delay);
+      total_contention_delay += arrival_list_1[n]._contention_delay;
+   }
+   LOG_ASSERT_ERROR(total_contention_delay > 0, "No contention in the traffic");
+   printf("Total contention delay(%llu)\n", (long long unsigned int) total_contention_delay);
+
+   for (tile_id_t tile_id = 0; tile_id < num_tiles; tile_id++)
+   {
+      Network* network = Sim()->getTileManager()->getTileFromID(tile_id)->getNetwork();
+      network->unregisterCallback(USER_1);
+      network->unregisterCallback(USER_2);
+   }
+
+   Simulator::disablePerformanceModelsInCurrentProcess();
+   CarbonStopSim();
+
+   printf("Finished (network_event_engine_determinism) - SUCCESS\n");
+   return 0;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <sched.h>
+#include <algorithm>
+using std::max;
+
+#include "simulator.h"
+#include "config.h"
+#include "tile.h"
+#include "tile_manager.h"
+#include "core.h"
+#include "core_model.h"
+#include "network.h"
+#include "network_model.h"
+#include "network_event_engine.h"
+#include "network_traffic.h"
+#include "packet_type.h"
+#include "lock.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Scaling of the network event engine of the 2nd user network with its
+// number of host threads: the uniform random traffic is injected while the
+// clock of the main core (the other cores are idle) holds the engine back,
+// and is then routed (and delivered) by one call to the engine.
+
+#define NUM_ITERATIONS     200
+#define PACKET_SIZE        8
+#define RUN_OFFSET         (1ULL << 24)
+
+static SInt32 _num_tiles;
+
+static UInt64 _num_packets_received;
+static Lock _receive_lock;
+
+static void receivePacket(void* obj, NetPacket packet)
+{
+   ScopedLock sl(_receive_lock);
+   _num_packets_received ++;
+}
+
+// Returns the time (in us) to route the traffic with 'num_threads' host threads
+static UInt64 benchmark(SInt32 num_threads, UInt64 start_time, UInt64& total_windows)
+{
+   Byte data[PACKET_SIZE] = {0};
+   SyntheticTrafficPattern traffic_pattern(SyntheticTrafficPattern::UNIFORM_RANDOM, _num_tiles);
+   CoreModel* core_model = Sim()->getTileManager()->getTileFromID(0)->getCore()->getPerformanceModel();
+
+   core_model->setCycleCount(0);
+   NetworkEventEngine* event_engine = new NetworkEventEngine(STATIC_NETWORK_USER_2, num_threads);
+   _num_packets_received = 0;
+
+   UInt64 num_packets = 0;
+   for (UInt32 i = 0; i < NUM_ITERATIONS; i++)
+   {
+      for (tile_id_t sender = 0; sender < _num_tiles; sender++)
+      {
+         tile_id_t receiver = traffic_pattern.computeReceiver(sender, i);
+         if (receiver == sender)
+            continue;
+
+         NetPacket packet(start_time + i, USER_2, sender, receiver, PACKET_SIZE, NULL);
+         packet.node_type = NetworkModel::SEND_TILE;
+         packet.data = NetPacketPayload::create(data, PACKET_SIZE)->getData();
+         packet.shared_payload = true;
+         event_engine->injectPacket(packet);
+         packet.releasePayload();
+         num_packets ++;
+      }
+   }
+
+   UInt64 begin_time = getTimeInUs();
+   core_model->setCycleCount(start_time + RUN_OFFSET / 2);
+   event_engine->advance();
+   while (true)
+   {
+      _receive_lock.acquire();
+      bool done = (_num_packets_received == num_packets);
+      _receive_lock.release();
+      if (done)
+         break;
+      sched_yield();
+   }
+   UInt64 elapsed_time = getTimeInUs() - begin_time;
+
+   total_windows = event_engine->getTotalWindows();
+   delete event_engine;
+   core_model->setCycleCount(0);
+
+   return elapsed_time;
+}
+
+static void benchmarkScaling()
+{
+   for (tile_id_t tile_id = 0; tile_id < _num_tiles; tile_id++)
+      Sim()->getTileManager()->getTileFromID(tile_id)->getNetwork()->registerCallback(USER_2, receivePacket, NULL);
+
+   printf("Event engine routing time of the %s traffic\n", SyntheticTrafficPattern::getName(SyntheticTrafficPattern::UNIFORM_RANDOM));
+   printf("%8s %12s %12s %12s\n", "Threads", "Windows", "Time (us)", "Speedup");
+   UInt64 base_time = 0;
+   for (SInt32 num_threads = 1, run = 1; num_threads <= 8; num_threads *= 2, run ++)
+   {
+      // Far enough from the previous run that the contention models have drained
+      UInt64 total_windows = 0;
+      UInt64 elapsed_time = benchmark(num_threads, run * RUN_OFFSET, total_windows);
+      if (num_threads == 1)
+         base_time = elapsed_time;
+      printf("%8i %12llu %12llu %12.2f\n", num_threads, (long long unsigned int) total_windows,
+             (long long unsigned int) elapsed_time, (double) base_time / max<UInt64>(elapsed_time, 1));
+   }
+
+   for (tile_id_t tile_id = 0; tile_id < _num_tiles; tile_id++)
+      Sim()->getTileManager()->getTileFromID(tile_id)->getNetwork()->unregisterCallback(USER_2);
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   Simulator::enablePerformanceModelsInCurrentProcess();
+
+   _num_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   NetworkModel* network_model = Sim()->getTileManager()->getTileFromID(0)->getNetwork()->getNetworkModelFromPacketType(USER_2);
+   LOG_ASSERT_ERROR(network_model->supportsEventEngine(), "The model of the 2nd user network has no event engine");
+
+   benchmarkScaling();
+
+   Simulator::disablePerformanceModelsInCurrentProcess();
+   CarbonStopSim();
+   return 0;
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <vector>
+#include <utility>
+using std::vector;
+using std::pair;
+
+#include "simulator.h"
+#include "config.h"
+#include "tile.h"
+#include "tile_manager.h"
+#include "network.h"
+#include "network_model.h"
+#include "network_traffic.h"
+#include "packet_type.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Throughput of the routing function of the network model of the 2nd user
+// network, in millions of hops routed per second, over the synthetic traffic
+// patterns of network_traffic.h (including a broadcast from every tile). The
+// packets are routed on the calling thread, through the models of
+// the tiles they go through (as the network threads do), without being
+// delivered. The first iteration also checks that every packet reaches its
+// receivers exactly once.
+
+#define NUM_ITERATIONS     1000
+#define PACKET_SIZE        8
+
+static SInt32 _num_tiles;
+static vector<NetworkModel*> _model_list;
+
+static NetworkModel* getNetworkModel(tile_id_t tile_id)
+{
+   return Sim()->getTileManager()->getTileFromID(tile_id)->getNetwork()->getNetworkModelFromPacketType(USER_2);
+}
+
+static void checkReceivers(const NetPacket& packet, const vector<pair<tile_id_t, NetPacket> >& received_packets)
+{
+   vector<UInt32> num_packets_received(Config::getSingleton()->getTotalTiles(), 0);
+   for (vector<pair<tile_id_t, NetPacket> >::const_iterator it = received_packets.begin(); it != received_packets.end(); it++)
+      num_packets_received[(*it).first] ++;
+
+   for (tile_id_t tile_id = 0; tile_id < _num_tiles; tile_id++)
+   {
+      UInt32 expected = ((TILE_ID(packet.receiver) == NetPacket::BROADCAST) ||
+                         (TILE_ID(packet.receiver) == tile_id)) ? 1 : 0;
+      LOG_ASSERT_ERROR(num_packets_received[tile_id] == expected,
+                       "Packet from tile(%i) to tile(%i): tile(%i) received(%u), expected(%u)",
+                       TILE_ID(packet.sender), TILE_ID(packet.receiver), tile_id,
+                       num_packets_received[tile_id], expected);
+   }
+}
+
+static double benchmark(const SyntheticTrafficPattern& traffic_pattern, UInt64& total_hops)
+{
+   Byte data[PACKET_SIZE] = {0};
+   vector<pair<tile_id_t, NetPacket> > received_packets;
+
+   total_hops = 0;
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_ITERATIONS; i++)
+   {
+      for (tile_id_t sender = 0; sender < _num_tiles; sender++)
+      {
+         // Uniform random: a permutation of the tiles in each iteration
+         tile_id_t receiver = traffic_pattern.computeReceiver(sender, i);
+         if (receiver == sender)
+            continue;
+
+         // Packets injected one cycle apart, so the contention models see a steady load
+         NetPacket packet(i, USER_2, sender, receiver, PACKET_SIZE, data);
+         packet.node_type = NetworkModel::SEND_TILE;
+
+         received_packets.clear();
+         total_hops += routePacketThroughModels(packet, _model_list, received_packets);
+         if (i == 0)
+            checkReceivers(packet, received_packets);
+      }
+   }
+   UInt64 elapsed_time = getTimeInUs() - start_time;
+
+   return (double) total_hops / elapsed_time;
+}
+
+int main(int argc, char *argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   Simulator::enablePerformanceModelsInCurrentProcess();
+
+   _num_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   for (tile_id_t tile_id = 0; tile_id < (tile_id_t) Config::getSingleton()->getTotalTiles(); tile_id++)
+      _model_list.push_back(getNetworkModel(tile_id));
+
+   printf("Routing throughput in millions of hops routed per second\n");
+   printf("%18s %12s %12s\n", "Traffic Pattern", "Hops", "Throughput");
+   for (SInt32 i = 0; i < SyntheticTrafficPattern::NUM_TYPES; i++)
+   {
+      SyntheticTrafficPattern::Type type = (SyntheticTrafficPattern::Type) i;
+      // Without a broadcast capability, the network sends a unicast to every tile
+      if ((type == SyntheticTrafficPattern::BROADCAST) && !getNetworkModel(0)->hasBroadcastCapability())
+         continue;
+
+      UInt64 total_hops = 0;
+      double throughput = benchmark(SyntheticTrafficPattern(type, _num_tiles), total_hops);
+      printf("%18s %12llu %12.2f\n", SyntheticTrafficPattern::getName(type), (long long unsigned int) total_hops, throughput);
+   }
+
+   Simulator::disablePerformanceModelsInCurrentProcess();
+   CarbonStopSim();
+   return 0;
+}
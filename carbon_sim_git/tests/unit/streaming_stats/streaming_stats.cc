@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <map>
+#include <algorithm>
+#include <vector>
+using std::map;
+using std::vector;
+
+#include "streaming_stats.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Accuracy and update cost of the sketches the DRAM directory uses for its
+// detailed counters, against the maps they replaced: distinct addresses
+// (overall and per set of a default-sized directory) on a stream of
+// directory accesses with a hot and a cold footprint, and the most
+// replaced address on a Zipf-distributed stream of replacements.
+
+#define CACHE_LINE_SIZE    64
+#define NUM_SETS           1024
+#define FOOTPRINT_LINES    (1 << 18)
+#define NUM_ACCESSES       (1 << 22)
+#define NUM_REPLACEMENTS   (1 << 20)
+
+int main(int argc, char *argv[])
+{
+   // 90% of the accesses go to 10% of the lines
+   vector<IntPtr> addresses(NUM_ACCESSES);
+   srand(1);
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      UInt32 line = ((rand() % 10) != 0) ? (rand() % (FOOTPRINT_LINES / 10)) : (rand() % FOOTPRINT_LINES);
+      addresses[i] = 0x10000000 + ((IntPtr) line) * CACHE_LINE_SIZE;
+   }
+
+   // Zipf(1) over the footprint
+   vector<double> zipf_cdf(FOOTPRINT_LINES);
+   double zipf_sum = 0;
+   for (UInt32 i = 0; i < FOOTPRINT_LINES; i++)
+   {
+      zipf_sum += 1.0 / (i + 1);
+      zipf_cdf[i] = zipf_sum;
+   }
+   vector<IntPtr> replaced_addresses(NUM_REPLACEMENTS);
+   for (UInt32 i = 0; i < NUM_REPLACEMENTS; i++)
+   {
+      double r = zipf_sum * rand() / RAND_MAX;
+      UInt32 line = std::lower_bound(zipf_cdf.begin(), zipf_cdf.end(), r) - zipf_cdf.begin();
+      if (line >= FOOTPRINT_LINES)
+         line = FOOTPRINT_LINES - 1;
+      // Scatter the ranks over the footprint
+      line = (line * 40503) % FOOTPRINT_LINES;
+      replaced_addresses[i] = 0x10000000 + ((IntPtr) line) * CACHE_LINE_SIZE;
+   }
+
+   // Exact counters
+   UInt64 start_time = getTimeInUs();
+   map<IntPtr, UInt64> address_map;
+   vector<map<IntPtr, UInt64> > set_address_maps(NUM_SETS);
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      address_map[addresses[i]] ++;
+      set_address_maps[(addresses[i] / CACHE_LINE_SIZE) % NUM_SETS][addresses[i]] ++;
+   }
+   map<IntPtr, UInt64> replaced_address_map;
+   for (UInt32 i = 0; i < NUM_REPLACEMENTS; i++)
+      replaced_address_map[replaced_addresses[i]] ++;
+   UInt64 map_time = getTimeInUs() - start_time;
+
+   // Sketches
+   start_time = getTimeInUs();
+   HyperLogLog address_counter(12);
+   vector<HyperLogLog> set_address_counters(NUM_SETS, HyperLogLog(5));
+   for (UInt32 i = 0; i < NUM_ACCESSES; i++)
+   {
+      address_counter.insert(addresses[i]);
+      set_address_counters[(addresses[i] / CACHE_LINE_SIZE) % NUM_SETS].insert(addresses[i]);
+   }
+   CountMinSketch replaced_address_counter(1024, 4);
+   IntPtr address_with_max_count = 0;
+   UInt64 max_count = 0;
+   for (UInt32 i = 0; i < NUM_REPLACEMENTS; i++)
+   {
+      UInt64 count = replaced_address_counter.insert(replaced_addresses[i]);
+      if (count > max_count)
+      {
+         max_count = count;
+         address_with_max_count = replaced_addresses[i];
+      }
+   }
+   UInt64 sketch_time = getTimeInUs() - start_time;
+
+   bool passed = true;
+
+   // Distinct addresses: 3 standard errors of a 4096 register sketch
+   double total_error = fabs((double) address_counter.estimate() - address_map.size()) / address_map.size();
+   printf("Total Addresses: Exact(%lu), Estimate(%llu), Error(%.2f%%)\n",
+          address_map.size(), (unsigned long long) address_counter.estimate(), 100 * total_error);
+   if (total_error > 3 * 1.04 / sqrt(4096.0))
+      passed = false;
+
+   // Set sizes: the average error of 32 register sketches
+   double set_error = 0;
+   for (UInt32 i = 0; i < NUM_SETS; i++)
+      set_error += fabs((double) set_address_counters[i].estimate() - set_address_maps[i].size()) / set_address_maps[i].size();
+   set_error /= NUM_SETS;
+   printf("Set Sizes: Mean Error(%.2f%%)\n", 100 * set_error);
+   if (set_error > 1.04 / sqrt(32.0))
+      passed = false;
+
+   // The most replaced address: the estimate is never below its count or the
+   // true maximum, and within 1% of the replacements of the true maximum
+   IntPtr exact_address_with_max_count = 0;
+   UInt64 exact_max_count = 0;
+   for (map<IntPtr, UInt64>::iterator it = replaced_address_map.begin(); it != replaced_address_map.end(); it++)
+   {
+      if (it->second > exact_max_count)
+      {
+         exact_max_count = it->second;
+         exact_address_with_max_count = it->first;
+      }
+   }
+   printf("Max Address Replacements: Exact(%llu) for Address(%#llx), Estimate(%llu) for Address(%#llx)\n",
+          (unsigned long long) exact_max_count, (unsigned long long) exact_address_with_max_count,
+          (unsigned long long) max_count, (unsigned long long) address_with_max_count);
+   if ((max_count < replaced_address_map[address_with_max_count]) ||
+       (max_count < exact_max_count) ||
+       (max_count > exact_max_count + 0.01 * NUM_REPLACEMENTS))
+      passed = false;
+
+   // Running mean and variance of the uniform distribution on [0,1)
+   RunningStatistics running_stats;
+   for (UInt32 i = 0; i < NUM_REPLACEMENTS; i++)
+      running_stats.insert((double) rand() / ((double) RAND_MAX + 1));
+   printf("Running Statistics: Mean(%.4f), Variance(%.4f), 95%% Confidence Interval(+/- %.4f)\n",
+          running_stats.getMean(), running_stats.getVariance(), running_stats.getConfidenceInterval());
+   if ((fabs(running_stats.getMean() - 0.5) > 4 * running_stats.getConfidenceInterval()) ||
+       (fabs(running_stats.getVariance() - 1.0 / 12) > 0.001))
+      passed = false;
+
+   UInt32 num_updates = 2 * NUM_ACCESSES + NUM_REPLACEMENTS;
+   printf("Maps: %.1f M updates/s, Sketches: %.1f M updates/s, Speedup(%.2f)\n",
+          ((double) num_updates) / map_time, ((double) num_updates) / sketch_time,
+          ((double) map_time) / sketch_time);
+
+   printf(passed ? "Streaming Stats test passed\n" : "Streaming Stats test failed\n");
+   return passed ? 0 : 1;
+}
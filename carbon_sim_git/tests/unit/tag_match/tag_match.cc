@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+using std::vector;
+
+#include "tag_match.h"
+#include "fixed_types.h"
+#include "utils.h"
+
+// Lookup throughput of TagMatch::findLast() against the scalar loop
+// CacheSet::find() used before, over the tag arrays of a 512 KB cache for
+// the associativities TagMatch unrolls (4, 8, 16) and one it does not (12).
+// About half the lookups miss, and the results of the two are compared.
+
+#define NUM_SETS           1024
+#define NUM_LOOKUPS        (1 << 25)
+
+// Not static: template arguments need external linkage before C++11
+SInt32 scalarFindLast(const IntPtr* tags, UInt32 associativity, IntPtr tag)
+{
+   for (SInt32 index = associativity-1; index >= 0; index--)
+   {
+      if (tags[index] == tag)
+         return index;
+   }
+   return -1;
+}
+
+struct Lookup
+{
+   UInt32 set_offset;
+   IntPtr tag;
+};
+
+template <SInt32 (*find)(const IntPtr*, UInt32, IntPtr)>
+static UInt64 runLookups(const IntPtr* tags, const vector<Lookup>& lookups, UInt32 associativity, UInt64& checksum)
+{
+   checksum = 0;
+
+   UInt64 start_time = getTimeInUs();
+   for (UInt32 i = 0; i < NUM_LOOKUPS; i++)
+   {
+      const Lookup& lookup = lookups[i & (lookups.size() - 1)];
+      checksum += find(&tags[lookup.set_offset], associativity, lookup.tag) + 1;
+   }
+   return getTimeInUs() - start_time;
+}
+
+int main(int argc, char *argv[])
+{
+   UInt32 associativities[] = { 4, 8, 12, 16 };
+   bool passed = true;
+
+   IntPtr* tags = new IntPtr[NUM_SETS * 16];
+   vector<Lookup> lookups(1 << 16);
+
+   for (UInt32 a = 0; a < sizeof(associativities) / sizeof(associativities[0]); a++)
+   {
+      UInt32 associativity = associativities[a];
+
+      // Fill every set with one of the two tags 2*way and 2*way+1 per way,
+      // leaving a few ways invalid, and look up tags from 0 to 4*associativity
+      srand(associativity);
+      for (UInt32 set_num = 0; set_num < NUM_SETS; set_num++)
+      {
+         for (UInt32 way = 0; way < associativity; way++)
+         {
+            tags[set_num * associativity + way] = (rand() % 16 == 0) ?
+                                                  ((IntPtr) ~0) : (IntPtr) (2 * way + rand() % 2);
+         }
+      }
+      for (UInt32 i = 0; i < lookups.size(); i++)
+      {
+         lookups[i].set_offset = (rand() % NUM_SETS) * associativity;
+         lookups[i].tag = rand() % (4 * associativity);
+      }
+
+      UInt64 scalar_checksum, simd_checksum;
+      UInt64 scalar_time = runLookups<scalarFindLast>(tags, lookups, associativity, scalar_checksum);
+      UInt64 simd_time = runLookups<TagMatch::findLast>(tags, lookups, associativity, simd_checksum);
+
+      if (scalar_checksum != simd_checksum)
+      {
+         printf("Associativity(%u): results differ\n", associativity);
+         passed = false;
+      }
+
+      printf("Associativity(%2u): Scalar(%.1f M lookups/s), TagMatch(%.1f M lookups/s), Speedup(%.2f)\n",
+             associativity,
+             ((double) NUM_LOOKUPS) / scalar_time, ((double) NUM_LOOKUPS) / simd_time,
+             ((double) scalar_time) / simd_time);
+   }
+
+   delete [] tags;
+
+   printf(passed ? "Tag Match test passed\n" : "Tag Match test failed\n");
+   return passed ? 0 : 1;
+}
@@ -0,0 +1,479 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+using namespace std;
+
+#include "simulator.h"
+#include "config.h"
+#include "tile.h"
+#include "tile_manager.h"
+#include "network.h"
+#include "network_model.h"
+#include "network_traffic.h"
+#include "packet_type.h"
+#include "carbon_user.h"
+#include "fixed_types.h"
+#include "utils.h"
+#include "log.h"
+
+// Standalone, trace-driven simulation of a network model (without Pin).
+//   The driver creates a model for each tile with NetworkModel::createModel()
+// and replays on them a packet trace captured by a simulation (see
+// [network/packet_trace] in the cfg file) or a synthetic traffic pattern (see
+// network_traffic.h), as fast as the host allows. The
+// packets are not delivered: a packet is routed hop-by-hop through the models
+// of the tiles it goes through, up to its receivers, where the serialization
+// latency is added.
+//   The tiles are partitioned across the host threads, and a thread routes
+// the packets sent by its tiles in time order. With more than one host
+// thread, the order in which the packets of different threads go through a
+// router (and so the contention delays) depends on the interleaving of the
+// threads.
+//   The summaries of the models (event counters of the routers and links, and
+// their utilization when the queue models are enabled) are written to the
+// output file.
+
+// Latencies are counted cycle by cycle up to this bound
+#define MAX_LATENCY                 4096
+
+class TracePacket
+{
+public:
+   TracePacket(UInt64 time, tile_id_t sender, tile_id_t receiver, UInt32 length)
+      : _time(time), _sender(sender), _receiver(receiver), _length(length) {}
+   ~TracePacket() {}
+
+   bool operator<(const TracePacket& packet) const { return (_time < packet._time); }
+
+   UInt64 _time;
+   tile_id_t _sender;
+   // NetPacket::BROADCAST for a broadcast
+   tile_id_t _receiver;
+   // Modeled length (in bytes)
+   UInt32 _length;
+};
+
+// Tiles of one host thread, the packets they send, and the statistics of
+// these packets
+class Partition
+{
+public:
+   Partition()
+      : _first_tile_id(0), _last_tile_id(0)
+      , _total_packets_injected(0), _total_flits_injected(0)
+      , _total_packets_delivered(0), _total_flits_delivered(0)
+      , _last_delivery_time(0)
+      , _total_latency(0.0), _total_latency_squared(0.0), _max_latency(0)
+      , _latency_histogram(MAX_LATENCY + 1, 0) {}
+   ~Partition() {}
+
+   tile_id_t _first_tile_id;
+   tile_id_t _last_tile_id;
+   vector<TracePacket> _packet_list;
+
+   UInt64 _total_packets_injected;
+   UInt64 _total_flits_injected;
+   UInt64 _total_packets_delivered;
+   UInt64 _total_flits_delivered;
+   UInt64 _last_delivery_time;
+   double _total_latency;
+   double _total_latency_squared;
+   UInt64 _max_latency;
+   vector<UInt64> _latency_histogram;
+};
+
+static string _trace_file;
+static SyntheticTrafficPattern::Type _traffic_pattern = SyntheticTrafficPattern::UNIFORM_RANDOM;
+static bool _synthetic = true;
+static string _model_name;
+static string _enabled_networks_line;
+static double _offered_load = 0.1;       // Packets injected per tile per cycle (synthetic traffic)
+static SInt32 _packet_size = 8;          // Size of each packet in bytes (synthetic traffic)
+static UInt64 _total_packets = 1000;     // Packets injected per tile (synthetic traffic)
+static SInt32 _num_threads = 1;
+static string _output_file = "network_trace_driver.out";
+
+static SInt32 _num_application_tiles;
+static SInt32 _total_tiles;
+static vector<NetworkModel*> _model_list;
+
+static void printHelpMessage()
+{
+   fprintf(stderr, "[Usage]: ./network_trace_driver (-t <trace> | -p <pattern>) [-m <model>] [-n <networks>] [-l <load>] [-s <size>] [-N <packets>] [-T <threads>] [-o <file>] -c <simulator arguments>\n");
+   fprintf(stderr, "where -t <trace>    = Packet trace captured with [network/packet_trace] enabled\n");
+   fprintf(stderr, "  or  -p <pattern>  = Synthetic Traffic Pattern (uniform_random, bit_complement, shuffle, transpose, tornado, nearest_neighbor, broadcast) (default uniform_random)\n");
+   fprintf(stderr, " and  -m <model>    = Network Model (magic, emesh_hop_counter, emesh_hop_by_hop, atac) (default: the model of the user_2 network)\n");
+   fprintf(stderr, " and  -n <networks> = Comma separated list of the networks of the trace replayed (default: all)\n");
+   fprintf(stderr, " and  -l <load>     = Number of Packets injected into the Network per Tile per Cycle (synthetic traffic, default 0.1)\n");
+   fprintf(stderr, " and  -s <size>     = Size of each Packet in Bytes (synthetic traffic, default 8)\n");
+   fprintf(stderr, " and  -N <packets>  = Total Number of Packets injected into the Network per Tile (synthetic traffic, default 1000)\n");
+   fprintf(stderr, " and  -T <threads>  = Number of Host Threads (default 1)\n");
+   fprintf(stderr, " and  -o <file>     = Output File for the summaries of the models, under the output directory (default network_trace_driver.out)\n");
+}
+
+static SyntheticTrafficPattern::Type parseTrafficPattern(string traffic_pattern)
+{
+   SyntheticTrafficPattern::Type type = SyntheticTrafficPattern::parseType(traffic_pattern);
+   if (type == SyntheticTrafficPattern::NUM_TYPES)
+   {
+      fprintf(stderr, "** ERROR **\n");
+      fprintf(stderr, "Unrecognized Network Traffic Pattern Type (Use uniform_random, bit_complement, shuffle, transpose, tornado, nearest_neighbor, broadcast)\n");
+      exit(-1);
+   }
+   return type;
+}
+
+// Bernoulli injection at the offered load, as synthetic_network_traffic_generator does
+static void generateSyntheticTraffic(vector<Partition>& partition_list)
+{
+   SyntheticTrafficPattern traffic_pattern(_traffic_pattern, _num_application_tiles);
+   LOG_ASSERT_ERROR(_offered_load > 0, "Offered Load(%f) must be > 0", _offered_load);
+
+   // Modeled as the user network packets of the generator: header and payload
+   UInt32 length = sizeof(NetPacket) + _packet_size;
+
+   for (vector<Partition>::iterator it = partition_list.begin(); it != partition_list.end(); it++)
+   {
+      Partition& partition = *it;
+      for (tile_id_t sender = partition._first_tile_id; sender <= partition._last_tile_id; sender++)
+      {
+         if (sender >= _num_application_tiles)
+            break;
+
+         struct drand48_data rand_buffer;
+         srand48_r(sender, &rand_buffer);
+
+         UInt64 num_packets = 0;
+         for (UInt64 time = 0; num_packets < _total_packets; time++)
+         {
+            double rand_num;
+            drand48_r(&rand_buffer, &rand_num);
+            if (rand_num >= _offered_load)
+               continue;
+
+            // Any other tile for the uniform random traffic
+            long int offset = 0;
+            if (_traffic_pattern == SyntheticTrafficPattern::UNIFORM_RANDOM)
+               lrand48_r(&rand_buffer, &offset);
+            tile_id_t receiver = traffic_pattern.computeReceiver(sender, offset);
+            num_packets ++;
+            if (receiver != sender)
+               partition._packet_list.push_back(TracePacket(time, sender, receiver, length));
+         }
+      }
+   }
+}
+
+static void loadPacketTrace(vector<Partition>& partition_list, vector<SInt32>& tile_to_partition_map)
+{
+   // Networks replayed
+   bool network_enabled[NUM_STATIC_NETWORKS];
+   for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id++)
+      network_enabled[network_id] = _enabled_networks_line.empty();
+
+   vector<string> enabled_networks;
+   splitIntoTokens(_enabled_networks_line, enabled_networks, ", ");
+   for (vector<string>::iterator it = enabled_networks.begin(); it != enabled_networks.end(); it++)
+   {
+      bool found = false;
+      for (SInt32 network_id = 0; network_id < NUM_STATIC_NETWORKS; network_id++)
+      {
+         if (g_static_network_name_list[network_id] == *it)
+         {
+            network_enabled[network_id] = true;
+            found = true;
+         }
+      }
+      LOG_ASSERT_ERROR(found, "Unrecognized network(%s) in -n", (*it).c_str());
+   }
+
+   ifstream trace(_trace_file.c_str());
+   LOG_ASSERT_ERROR(trace.good(), "Could not open packet trace(%s)", _trace_file.c_str());
+
+   string line;
+   UInt64 line_num = 0;
+   while (getline(trace, line))
+   {
+      line_num ++;
+      if (line.empty() || (line[0] == '#'))
+         continue;
+
+      UInt64 time;
+      tile_id_t sender, receiver;
+      SInt32 type;
+      UInt32 length;
+      istringstream fields(line);
+      fields >> time >> sender >> receiver >> type >> length;
+      LOG_ASSERT_ERROR(!fields.fail(), "Packet trace(%s), line(%llu): could not parse (%s)",
+                       _trace_file.c_str(), line_num, line.c_str());
+      LOG_ASSERT_ERROR((type >= 0) && (type < NUM_PACKET_TYPES) &&
+                       (sender >= 0) && (sender < _total_tiles) &&
+                       (receiver >= -1) && (receiver < _total_tiles),
+                       "Packet trace(%s), line(%llu): type(%i), sender(%i), receiver(%i) out of range",
+                       _trace_file.c_str(), line_num, type, sender, receiver);
+
+      if (!network_enabled[g_type_to_static_network_map[type]])
+         continue;
+
+      if (receiver == -1)
+         receiver = NetPacket::BROADCAST;
+      Partition& partition = partition_list[tile_to_partition_map[sender]];
+      partition._packet_list.push_back(TracePacket(time, sender, receiver, length));
+   }
+}
+
+static void recordDelivery(Partition& partition, const NetPacket& pkt, UInt64 injection_time, NetworkModel* model)
+{
+   UInt64 latency = pkt.time - injection_time;
+
+   partition._total_packets_delivered ++;
+   partition._total_flits_delivered += model->computeNumFlits(model->getModeledLength(pkt));
+   partition._last_delivery_time = max<UInt64>(partition._last_delivery_time, pkt.time);
+   partition._total_latency += latency;
+   partition._total_latency_squared += ((double) latency) * latency;
+   partition._max_latency = max<UInt64>(partition._max_latency, latency);
+   partition._latency_histogram[min<UInt64>(latency, MAX_LATENCY)] ++;
+}
+
+// Route the packet to its receivers and add the serialization latency there
+static void routePacket(Partition& partition, const NetPacket& packet)
+{
+   vector<pair<tile_id_t, NetPacket> > received_packets;
+   routePacketThroughModels(packet, _model_list, received_packets);
+
+   for (vector<pair<tile_id_t, NetPacket> >::iterator it = received_packets.begin(); it != received_packets.end(); it++)
+   {
+      tile_id_t tile_id = (*it).first;
+      if (tile_id >= _num_application_tiles)
+         continue;
+      NetworkModel* model = _model_list[tile_id];
+      model->__processReceivedPacket((*it).second);
+      recordDelivery(partition, (*it).second, packet.time, model);
+   }
+}
+
+static void* replayTraffic(void* arg)
+{
+   Partition& partition = *((Partition*) arg);
+
+   for (vector<TracePacket>::iterator it = partition._packet_list.begin(); it != partition._packet_list.end(); it++)
+   {
+      const TracePacket& trace_packet = *it;
+      NetworkModel* model = _model_list[trace_packet._sender];
+
+      NetPacket packet(trace_packet._time, NETWORK_TRACE_REPLAY_TYPE,
+                       CORE_ID(trace_packet._sender), CORE_ID(trace_packet._receiver),
+                       trace_packet._length, NULL);
+
+      partition._total_packets_injected ++;
+      partition._total_flits_injected += model->computeNumFlits(model->getModeledLength(packet));
+
+      // Sent as a unicast to every tile if the model has no broadcast capability (as in Network::netSend())
+      if ((trace_packet._receiver == NetPacket::BROADCAST) && (!model->hasBroadcastCapability()))
+      {
+         for (tile_id_t receiver = 0; receiver < _total_tiles; receiver++)
+         {
+            packet.receiver = CORE_ID(receiver);
+            routePacket(partition, packet);
+         }
+      }
+      else
+      {
+         routePacket(partition, packet);
+      }
+   }
+   return NULL;
+}
+
+static UInt64 computeLatencyPercentile(const vector<UInt64>& latency_histogram, UInt64 total, double percentile)
+{
+   UInt64 count = 0;
+   for (UInt64 latency = 0; latency < latency_histogram.size(); latency++)
+   {
+      count += latency_histogram[latency];
+      if (count >= (UInt64) ceil(percentile * total))
+         return latency;
+   }
+   return MAX_LATENCY;
+}
+
+static void outputSummary(vector<Partition>& partition_list, UInt64 host_time)
+{
+   Partition total;
+   UInt64 last_injection_time = 0;
+   for (vector<Partition>::iterator it = partition_list.begin(); it != partition_list.end(); it++)
+   {
+      total._total_packets_injected += (*it)._total_packets_injected;
+      total._total_flits_injected += (*it)._total_flits_injected;
+      total._total_packets_delivered += (*it)._total_packets_delivered;
+      total._total_flits_delivered += (*it)._total_flits_delivered;
+      total._last_delivery_time = max<UInt64>(total._last_delivery_time, (*it)._last_delivery_time);
+      total._total_latency += (*it)._total_latency;
+      total._total_latency_squared += (*it)._total_latency_squared;
+      total._max_latency = max<UInt64>(total._max_latency, (*it)._max_latency);
+      for (UInt32 i = 0; i <= MAX_LATENCY; i++)
+         total._latency_histogram[i] += (*it)._latency_histogram[i];
+      if (!(*it)._packet_list.empty())
+         last_injection_time = max<UInt64>(last_injection_time, (*it)._packet_list.back()._time);
+   }
+
+   UInt64 num_delivered = total._total_packets_delivered;
+   double average_latency = (num_delivered > 0) ? (total._total_latency / num_delivered) : 0.0;
+   double latency_variance = (num_delivered > 0) ?
+                             ((total._total_latency_squared / num_delivered) - (average_latency * average_latency)) : 0.0;
+   double offered_throughput = ((double) total._total_flits_injected) / (_num_application_tiles * (last_injection_time + 1));
+   double accepted_throughput = ((double) total._total_flits_delivered) / (_num_application_tiles * (total._last_delivery_time + 1));
+
+   printf("Network Trace Driver Summary:\n");
+   printf("  Model: %s, Tiles: %i, Host Threads: %i\n", _model_name.c_str(), _num_application_tiles, _num_threads);
+   printf("  Traffic: %s\n", _synthetic ? SyntheticTrafficPattern::getName(_traffic_pattern) : _trace_file.c_str());
+   printf("  Packets Injected: %llu\n", (long long unsigned int) total._total_packets_injected);
+   printf("  Packets Delivered: %llu (one per receiver)\n", (long long unsigned int) num_delivered);
+   printf("  Simulated Cycles: %llu\n", (long long unsigned int) total._last_delivery_time);
+   printf("  Average Packet Latency (in cycles): %.2f\n", average_latency);
+   printf("  Packet Latency Standard Deviation (in cycles): %.2f\n", sqrt(max<double>(latency_variance, 0.0)));
+   printf("  Max Packet Latency (in cycles): %llu\n", (long long unsigned int) total._max_latency);
+   printf("  Packet Latency Percentiles (in cycles): 50%%: %llu, 90%%: %llu, 99%%: %llu\n",
+          (long long unsigned int) computeLatencyPercentile(total._latency_histogram, num_delivered, 0.50),
+          (long long unsigned int) computeLatencyPercentile(total._latency_histogram, num_delivered, 0.90),
+          (long long unsigned int) computeLatencyPercentile(total._latency_histogram, num_delivered, 0.99));
+   printf("  Offered Throughput (flits per tile per cycle): %.4f\n", offered_throughput);
+   printf("  Accepted Throughput (flits per tile per cycle): %.4f\n", accepted_throughput);
+   printf("  Host Time (in seconds): %.3f\n", host_time / 1e6);
+   printf("  Packets Routed per Second: %.0f\n", (host_time > 0) ? (total._total_packets_injected * 1e6 / host_time) : 0.0);
+
+   printf("  Packet Latency Distribution (in cycles):\n");
+   for (UInt64 start = 0, end = 1; start <= MAX_LATENCY; start = end, end *= 2)
+   {
+      UInt64 count = 0;
+      for (UInt64 latency = start; (latency < end) && (latency <= MAX_LATENCY); latency++)
+         count += total._latency_histogram[latency];
+      if (start == MAX_LATENCY)
+         printf("    [%llu, inf): %llu\n", (long long unsigned int) start, (long long unsigned int) count);
+      else
+         printf("    [%llu, %llu): %llu\n", (long long unsigned int) start, (long long unsigned int) end, (long long unsigned int) count);
+   }
+
+   // Router and link event counters (and utilization with the queue models)
+   string output_file = Config::getSingleton()->formatOutputFileName(_output_file);
+   ofstream out(output_file.c_str());
+   for (tile_id_t tile_id = 0; tile_id < _num_application_tiles; tile_id++)
+   {
+      out << "Tile " << tile_id << ":" << endl;
+      _model_list[tile_id]->outputSummary(out);
+   }
+   out.close();
+   printf("  Model Summaries: %s\n", output_file.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+   CarbonStartSim(argc, argv);
+
+   // Read Command Line Arguments
+   for (SInt32 i = 1; i < argc-1; i += 2)
+   {
+      if (string(argv[i]) == "-t")
+      {
+         _trace_file = argv[i+1];
+         _synthetic = false;
+      }
+      else if (string(argv[i]) == "-p")
+         _traffic_pattern = parseTrafficPattern(string(argv[i+1]));
+      else if (string(argv[i]) == "-m")
+         _model_name = argv[i+1];
+      else if (string(argv[i]) == "-n")
+         _enabled_networks_line = argv[i+1];
+      else if (string(argv[i]) == "-l")
+         _offered_load = (double) atof(argv[i+1]);
+      else if (string(argv[i]) == "-s")
+         _packet_size = (SInt32) atoi(argv[i+1]);
+      else if (string(argv[i]) == "-N")
+         _total_packets = (UInt64) atoi(argv[i+1]);
+      else if (string(argv[i]) == "-T")
+         _num_threads = (SInt32) atoi(argv[i+1]);
+      else if (string(argv[i]) == "-o")
+         _output_file = argv[i+1];
+      else if (string(argv[i]) == "-c") // Simulator arguments
+         break;
+      else if (string(argv[i]) == "-h")
+      {
+         printHelpMessage();
+         exit(0);
+      }
+      else
+      {
+         fprintf(stderr, "** ERROR **\n");
+         printHelpMessage();
+         exit(-1);
+      }
+   }
+
+   LOG_ASSERT_ERROR(Config::getSingleton()->getProcessCount() == 1,
+                    "The network trace driver runs in a single process, not (%i)", Config::getSingleton()->getProcessCount());
+   LOG_ASSERT_ERROR(_num_threads > 0, "Number of Host Threads(%i) must be > 0", _num_threads);
+
+   _num_application_tiles = (SInt32) Config::getSingleton()->getApplicationTiles();
+   _total_tiles = (SInt32) Config::getSingleton()->getTotalTiles();
+
+   // Create the models
+   if (_model_name.empty())
+      _model_name = Config::getSingleton()->getNetworkType(STATIC_NETWORK_USER_2);
+   UInt32 model_type = NetworkModel::parseNetworkType(_model_name);
+   LOG_ASSERT_ERROR(model_type != (UInt32) -1, "Unrecognized Network Model(%s)", _model_name.c_str());
+   LOG_ASSERT_ERROR(NetworkModel::isTileCountPermissible(model_type, _num_application_tiles),
+                    "Network Model(%s) does not support (%i) tiles", _model_name.c_str(), _num_application_tiles);
+
+   _model_list.resize(_total_tiles);
+   for (tile_id_t tile_id = 0; tile_id < _total_tiles; tile_id++)
+   {
+      Network* network = Sim()->getTileManager()->getTileFromID(tile_id)->getNetwork();
+      _model_list[tile_id] = NetworkModel::createModel(network, STATIC_NETWORK_USER_2, model_type);
+      _model_list[tile_id]->enable();
+   }
+
+   // Partition the tiles across the host threads
+   _num_threads = min<SInt32>(_num_threads, _total_tiles);
+   vector<Partition> partition_list(_num_threads);
+   vector<SInt32> tile_to_partition_map(_total_tiles);
+   for (SInt32 i = 0; i < _num_threads; i++)
+   {
+      partition_list[i]._first_tile_id = (i * _total_tiles) / _num_threads;
+      partition_list[i]._last_tile_id = (((i+1) * _total_tiles) / _num_threads) - 1;
+      for (tile_id_t tile_id = partition_list[i]._first_tile_id; tile_id <= partition_list[i]._last_tile_id; tile_id++)
+         tile_to_partition_map[tile_id] = i;
+   }
+
+   if (_synthetic)
+      generateSyntheticTraffic(partition_list);
+   else
+      loadPacketTrace(partition_list, tile_to_partition_map);
+
+   for (vector<Partition>::iterator it = partition_list.begin(); it != partition_list.end(); it++)
+      stable_sort((*it)._packet_list.begin(), (*it)._packet_list.end());
+
+   // Replay
+   UInt64 start_time = getTimeInUs();
+   vector<pthread_t> thread_list(_num_threads);
+   for (SInt32 i = 1; i < _num_threads; i++)
+      pthread_create(&thread_list[i], NULL, replayTraffic, &partition_list[i]);
+   replayTraffic(&partition_list[0]);
+   for (SInt32 i = 1; i < _num_threads; i++)
+      pthread_join(thread_list[i], NULL);
+   UInt64 host_time = getTimeInUs() - start_time;
+
+   outputSummary(partition_list, host_time);
+
+   for (tile_id_t tile_id = 0; tile_id < _total_tiles; tile_id++)
+      delete _model_list[tile_id];
+
+   CarbonStopSim();
+   return 0;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Host time of stream and fft with the instructions modeled one at a time
+# (batch_size = 1) and in batches of the Pin trace buffer
+# Usage: tools/run_trace_buffer_bench.sh [batch sizes]  (from the carbon_sim root)
+
+BATCH_SIZES=${*:-"1 16 64 256"}
+LOG=run_trace_buffer_bench.log
+
+run()
+{
+   # 1 - app directory, 2 - cores, 3 - batch size
+   OUTPUT_FILE=sim_$(basename $1)_$3.out
+   START=$(date +%s.%N)
+   make -C $1 SIM_FLAGS="-c $(pwd)/carbon_sim.cfg --general/total_cores=$2 --general/num_processes=1 --general/enable_shared_mem=true --general/output_file=$OUTPUT_FILE --core/trace_buffer/batch_size=$3" >>$LOG 2>&1
+   END=$(date +%s.%N)
+   COMPLETION_TIME=$(grep -m1 "Completion Time" output_files/$OUTPUT_FILE | awk -F'|' '{print $2}')
+   echo "BENCH: $(basename $1) batch_size=$3 host_time=$(echo "$END - $START" | bc) s completion_time=$COMPLETION_TIME"
+}
+
+date >$LOG
+for b in $BATCH_SIZES ; do
+   run tests/apps/stream 9 $b
+   run tests/benchmarks/fft 65 $b
+done | tee -a $LOG